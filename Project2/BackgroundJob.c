@@ -0,0 +1,191 @@
+/*
+ * File: BackgroundJob.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Long-running operations computed on background thread, with progress and cancellation
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include "BackgroundJob.h"
+#include "Spectrum.h"
+
+/*
+ * Function <private>:  _runJob
+ * --------------------
+ *      body of background thread - computes operation and wakes up threads waiting for it
+ *
+ */
+static void* _runJob( void *argument )
+{
+    BackgroundJob *job = argument;
+    int errorCode;
+
+    if( job->operation == JOB_MULTIPLY )
+        errorCode = multiplySquareMatrixControlled( job->operands[0], job->operands[1], &job->result, &job->control );
+    else if( job->operation == JOB_POWER )
+        errorCode = powerSquareMatrixControlled( job->operands[0], job->exponent, job->modulus, &job->result,
+                                                 &job->control );
+    else if( job->operation == JOB_DETERMINANT )
+        errorCode = detSquareMatrixControlled( job->operands[0], &job->scalar, &job->control );
+    else
+    {
+        job->degree = job->operands[0]->size;
+        job->polynomial = calloc( ( size_t )job->degree + 1, sizeof( BigInteger ) );
+        errorCode = job->polynomial == NULL ? -1 : characteristicPolynomialControlled( job->operands[0],
+                                                       job->polynomial, &job->polynomialArena, &job->control );
+    }
+    if( errorCode != 0 )
+        job->result = NULL;
+
+    // Operands are no longer needed - release blocks shared with them, so editing originals doesn't copy them
+    deleteSquareMatrix( job->operands[0] );
+    deleteSquareMatrix( job->operands[1] );
+    job->operands[0] = job->operands[1] = NULL;
+
+    pthread_mutex_lock( &job->lock );
+    job->errorCode = errorCode;
+    job->finished = 1;
+    pthread_cond_broadcast( &job->done );
+    pthread_mutex_unlock( &job->lock );
+    return NULL;
+}
+
+/*
+ * Function:  startBackgroundJob
+ * --------------------
+ *      takes snapshots of operands and starts thread computing operation on them
+ *
+ *      operation: one of JobOperation values
+ *      m1, m2:    operands (m2 is used only by JOB_MULTIPLY and can be NULL otherwise)
+ *      exponent, modulus: parameters of JOB_POWER (modulus = 0 means exact result)
+ *      output:    pointer to memory where pointer to started job should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if thread can't be created
+ *
+ */
+int startBackgroundJob( int operation, Matrix *m1, Matrix *m2, unsigned long exponent, long modulus,
+                        BackgroundJob **output )
+{
+    BackgroundJob *job = calloc( 1, sizeof( BackgroundJob ) );
+    if( job == NULL )
+        return -1;
+    job->operation = operation;
+    job->exponent = exponent;
+    job->modulus = modulus;
+    initLimbArena( &job->polynomialArena );
+
+    if( snapshotSquareMatrix( m1, &job->operands[0] ) != 0
+        || ( m2 != NULL && snapshotSquareMatrix( m2, &job->operands[1] ) != 0 ) )
+    {
+        deleteSquareMatrix( job->operands[0] );
+        free( job );
+        return -1;
+    }
+
+    pthread_mutex_init( &job->lock, NULL );
+    pthread_cond_init( &job->done, NULL );
+    if( pthread_create( &job->thread, NULL, _runJob, job ) != 0 )
+    {
+        pthread_mutex_destroy( &job->lock );
+        pthread_cond_destroy( &job->done );
+        deleteSquareMatrix( job->operands[0] );
+        deleteSquareMatrix( job->operands[1] );
+        free( job );
+        return -2;
+    }
+    *output = job;
+    return 0;
+}
+
+/*
+ * Function:  waitForBackgroundJob
+ * --------------------
+ *      waits until job is finished, but no longer than given time
+ *
+ *      milliseconds: maximal time of waiting (negative value means no limit)
+ *
+ *      returns: 1 if job is finished, 0 otherwise
+ *
+ */
+int waitForBackgroundJob( BackgroundJob *job, long milliseconds )
+{
+    struct timespec deadline;
+    int timedOut = 0;
+
+    clock_gettime( CLOCK_REALTIME, &deadline );
+    deadline.tv_sec += milliseconds / 1000;
+    deadline.tv_nsec += milliseconds % 1000 * 1000000;
+    if( deadline.tv_nsec >= 1000000000 )
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock( &job->lock );
+    while( !job->finished && !timedOut )
+        if( milliseconds < 0 )
+            pthread_cond_wait( &job->done, &job->lock );
+        else
+            timedOut = pthread_cond_timedwait( &job->done, &job->lock, &deadline ) == ETIMEDOUT;
+    int finished = job->finished;
+    pthread_mutex_unlock( &job->lock );
+    return finished;
+}
+
+/*
+ * Function:  isBackgroundJobFinished
+ * --------------------
+ *      returns 1 if job is finished (its result or error code can be read), 0 otherwise
+ *
+ */
+int isBackgroundJobFinished( BackgroundJob *job )
+{
+    return waitForBackgroundJob( job, 0 );
+}
+
+/*
+ * Function:  backgroundJobProgress
+ * --------------------
+ *      returns fraction of operation done so far (in range <0, 1>)
+ *
+ */
+double backgroundJobProgress( BackgroundJob *job )
+{
+    return isBackgroundJobFinished( job ) ? 1.0 : operationProgress( &job->control );
+}
+
+/*
+ * Function:  cancelBackgroundJob
+ * --------------------
+ *      asks job to stop; operation notices it within one row of tiles (one minor of determinant, one prime of
+ *      characteristic polynomial) and then finishes with error code OPERATION_CANCELLED, releasing partial result
+ *      and workspace
+ *
+ */
+void cancelBackgroundJob( BackgroundJob *job )
+{
+    cancelOperation( &job->control );
+}
+
+/*
+ * Function:  deleteBackgroundJob
+ * --------------------
+ *      cancels job (if it is still running), waits for its thread and frees memory used by job and its result
+ *      (unless result was taken by setting field "result" to NULL)
+ *
+ */
+void deleteBackgroundJob( BackgroundJob *job )
+{
+    if( job == NULL )
+        return;
+    cancelBackgroundJob( job );
+    pthread_join( job->thread, NULL );
+    pthread_mutex_destroy( &job->lock );
+    pthread_cond_destroy( &job->done );
+    deleteSquareMatrix( job->result );
+    free( job->polynomial );
+    freeLimbArena( &job->polynomialArena );
+    free( job );
+}
@@ -0,0 +1,57 @@
+/*
+ * File: BackgroundJob.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file BackgroundJob.c
+ */
+
+#ifndef PROJEKT2_BACKGROUNDJOB_H
+#define PROJEKT2_BACKGROUNDJOB_H
+
+#include <pthread.h>
+#include "SquareMatrix.h"
+#include "BigInteger.h"
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Operations which can be run on background thread
+enum JobOperation {
+    JOB_MULTIPLY, JOB_POWER, JOB_DETERMINANT, JOB_CHARACTERISTIC_POLYNOMIAL
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Operation computed by separate thread on snapshots of operands, so they can be modified or deleted meanwhile
+struct BackgroundJob {
+    int operation;                              // One of JobOperation values
+    Matrix *operands[2];                        // Snapshots of operands (second one is NULL if not used)
+    unsigned long exponent;                     // Parameters of power
+    long modulus;
+    OperationControl control;                   // Progress and cancellation flag
+    int finished;                               // Set when thread stopped (protected by lock)
+    int errorCode;                              // Code returned by operation (valid after job finished)
+    Matrix *result;                             // Result of multiplication or power (owned by job until set to NULL)
+    long scalar;                                // Result of determinant
+    BigInteger *polynomial;                     // Coefficients of characteristic polynomial (degree + 1 numbers)
+    LimbArena polynomialArena;                  // Arena of limbs of coefficients
+    int degree;                                 // Size of matrix
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t done;                        // Signalled when job is finished
+};
+typedef struct BackgroundJob BackgroundJob;
+
+/************************************
+ * Function declarations
+ ************************************/
+int startBackgroundJob( int operation, Matrix *m1, Matrix *m2, unsigned long exponent, long modulus,
+                        BackgroundJob **output );
+int waitForBackgroundJob( BackgroundJob *job, long milliseconds );
+int isBackgroundJobFinished( BackgroundJob *job );
+double backgroundJobProgress( BackgroundJob *job );
+void cancelBackgroundJob( BackgroundJob *job );
+void deleteBackgroundJob( BackgroundJob *job );
+
+#endif //PROJEKT2_BACKGROUNDJOB_H
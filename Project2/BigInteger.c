@@ -0,0 +1,729 @@
+/*
+ * File: BigInteger.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Integers of arbitrary size used as exact elements of matrices. Numbers below 2^128 are stored
+ *              inline, bigger ones take limbs from arena (usually one per matrix), so no operation calls malloc
+ *              for single number. Big factors are multiplied with Karatsuba algorithm, division uses Knuth's
+ *              algorithm D
+ */
+
+#include "BigInteger.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define LIMB_BITS 64
+#define DECIMAL_CHUNK 10000000000000000000UL    // 10^19 - the biggest power of 10 fitting in limb
+#define DECIMAL_CHUNK_DIGITS 19
+
+/************************************
+ * Arena
+ ************************************/
+/*
+ * Function:  initLimbArena
+ * --------------------
+ *      initializes empty arena
+ *
+ */
+void initLimbArena( LimbArena *arena )
+{
+    arena->current = NULL;
+}
+
+/*
+ * Function <private>:  _addLimbChunk
+ * --------------------
+ *      allocates new chunk of arena (at least LIMB_ARENA_CHUNK limbs) with room for "count" limbs
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _addLimbChunk( LimbArena *arena, size_t count )
+{
+    const size_t capacity = count > LIMB_ARENA_CHUNK ? count : LIMB_ARENA_CHUNK;
+    if( capacity > ( SIZE_MAX - sizeof( LimbChunk ) ) / sizeof( uint64_t ) )
+        return -1;
+    LimbChunk *chunk = malloc( sizeof( LimbChunk ) + sizeof( uint64_t ) * capacity );
+    if( chunk == NULL )
+        return -1;
+    chunk->previous = arena->current;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    arena->current = chunk;
+    return 0;
+}
+
+/*
+ * Function:  allocateLimbs
+ * --------------------
+ *      takes "count" limbs from arena; if they don't fit in current chunk, new chunk (at least LIMB_ARENA_CHUNK
+ *      limbs) is allocated
+ *
+ *      returns: pointer to limbs (aligned to 8 bytes, not initialized) or NULL on out of memory
+ *
+ */
+uint64_t* allocateLimbs( LimbArena *arena, size_t count )
+{
+    if( ( arena->current == NULL || arena->current->capacity - arena->current->used < count )
+        && _addLimbChunk( arena, count ) != 0 )
+        return NULL;
+    arena->current->used += count;
+    return arena->current->limbs + arena->current->used - count;
+}
+
+/*
+ * Function:  reserveLimbArena
+ * --------------------
+ *      makes sure that next "count" limbs are taken from current chunk, so that allocations of this many limbs
+ *      (also repeated after releasing them with releaseLimbArena) can't fail
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int reserveLimbArena( LimbArena *arena, size_t count )
+{
+    if( arena->current != NULL && arena->current->capacity - arena->current->used >= count )
+        return 0;
+    return _addLimbChunk( arena, count );
+}
+
+/*
+ * Function:  markLimbArena
+ * --------------------
+ *      returns current state of arena - limbs allocated later can be freed at once with releaseLimbArena
+ *
+ */
+LimbArenaMark markLimbArena( LimbArena *arena )
+{
+    LimbArenaMark mark = { arena->current, arena->current == NULL ? 0 : arena->current->used };
+    return mark;
+}
+
+/*
+ * Function:  releaseLimbArena
+ * --------------------
+ *      frees all limbs allocated after mark was taken (numbers using them can't be used any more)
+ *
+ */
+void releaseLimbArena( LimbArena *arena, LimbArenaMark mark )
+{
+    while( arena->current != mark.chunk )
+    {
+        LimbChunk *previous = arena->current->previous;
+        free( arena->current );
+        arena->current = previous;
+    }
+    if( arena->current != NULL )
+        arena->current->used = mark.used;
+}
+
+/*
+ * Function:  freeLimbArena
+ * --------------------
+ *      frees all memory of arena; it stays valid (empty) and can be used again
+ *
+ */
+void freeLimbArena( LimbArena *arena )
+{
+    LimbArenaMark empty = { NULL, 0 };
+    releaseLimbArena( arena, empty );
+}
+
+/************************************
+ * Operations on arrays of limbs
+ ************************************/
+/*
+ * Function <private>:  _limbs
+ * --------------------
+ *      returns pointer to magnitude of number
+ *
+ */
+static uint64_t* _limbs( BigInteger *number )
+{
+    return number->capacity == 0 ? number->magnitude.small : number->magnitude.limbs;
+}
+
+static const uint64_t* _constLimbs( const BigInteger *number )
+{
+    return number->capacity == 0 ? number->magnitude.small : number->magnitude.limbs;
+}
+
+/*
+ * Function <private>:  _trim
+ * --------------------
+ *      returns length of magnitude without leading zero limbs
+ *
+ */
+static int _trim( const uint64_t *limbs, int length )
+{
+    while( length > 0 && limbs[length - 1] == 0 )
+        length--;
+    return length;
+}
+
+/*
+ * Function <private>:  _compareLimbs
+ * --------------------
+ *      compares magnitudes without leading zeros
+ *
+ *      returns: negative value, zero or positive value if a is smaller, equal or bigger than b
+ *
+ */
+static int _compareLimbs( const uint64_t *a, int aLength, const uint64_t *b, int bLength )
+{
+    if( aLength != bLength )
+        return aLength < bLength ? -1 : 1;
+    for( int i = aLength - 1; i >= 0; i-- )
+        if( a[i] != b[i] )
+            return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Function <private>:  _addLimbs
+ * --------------------
+ *      stores a + b (aLength >= bLength) in aLength limbs of output, which can be the same array as a or b
+ *
+ *      returns: carry out of the highest limb
+ *
+ */
+static uint64_t _addLimbs( uint64_t *output, const uint64_t *a, int aLength, const uint64_t *b, int bLength )
+{
+    unsigned __int128 carry = 0;
+    for( int i = 0; i < aLength; i++ )
+    {
+        carry += ( unsigned __int128 )a[i] + ( i < bLength ? b[i] : 0 );
+        output[i] = ( uint64_t )carry;
+        carry >>= LIMB_BITS;
+    }
+    return ( uint64_t )carry;
+}
+
+/*
+ * Function <private>:  _subLimbs
+ * --------------------
+ *      stores a - b (a >= b, aLength >= bLength) in aLength limbs of output, which can be the same array as a or b
+ *
+ */
+static void _subLimbs( uint64_t *output, const uint64_t *a, int aLength, const uint64_t *b, int bLength )
+{
+    uint64_t borrow = 0;
+    for( int i = 0; i < aLength; i++ )
+    {
+        const uint64_t subtrahend = i < bLength ? b[i] : 0;
+        const uint64_t difference = a[i] - subtrahend - borrow;
+        borrow = a[i] < subtrahend || ( a[i] == subtrahend && borrow );
+        output[i] = difference;
+    }
+}
+
+/*
+ * Function <private>:  _multiplyLimbs
+ * --------------------
+ *      stores a * b in aLength + bLength limbs of output (not overlapping with factors). Factors having at least
+ *      KARATSUBA_THRESHOLD limbs are multiplied by Karatsuba algorithm: with a = a1 * B^m + a0, b = b1 * B^m + b0
+ *      product is a1b1 * B^2m + ((a0 + a1)(b0 + b1) - a0b0 - a1b1) * B^m + a0b0 - three multiplications of half
+ *      length instead of four; much longer factor is cut into pieces of length of the shorter one
+ *
+ *      scratch: arena for temporary values (released before return)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _multiplyLimbs( uint64_t *output, const uint64_t *a, int aLength, const uint64_t *b, int bLength,
+                           LimbArena *scratch )
+{
+    if( aLength < bLength )                                 // Longer factor is always the first one
+    {
+        const uint64_t *swapped = a;
+        a = b;
+        b = swapped;
+        int swappedLength = aLength;
+        aLength = bLength;
+        bLength = swappedLength;
+    }
+    memset( output, 0, sizeof( uint64_t ) * ( size_t )( aLength + bLength ) );
+    if( bLength == 0 )
+        return 0;
+
+    if( bLength < KARATSUBA_THRESHOLD )                     // Schoolbook multiplication
+    {
+        for( int i = 0; i < bLength; i++ )
+        {
+            unsigned __int128 carry = 0;
+            for( int j = 0; j < aLength; j++ )
+            {
+                carry += ( unsigned __int128 )a[j] * b[i] + output[i + j];
+                output[i + j] = ( uint64_t )carry;
+                carry >>= LIMB_BITS;
+            }
+            output[i + aLength] = ( uint64_t )carry;
+        }
+        return 0;
+    }
+
+    LimbArenaMark mark = markLimbArena( scratch );
+    int errorCode = 0;
+
+    if( aLength >= 2 * bLength )                            // Unbalanced - pieces of a multiplied by whole b
+    {
+        uint64_t *piece = allocateLimbs( scratch, 2 * ( size_t )bLength );
+        for( int offset = 0; piece != NULL && offset < aLength && errorCode == 0; offset += bLength )
+        {
+            const int pieceLength = aLength - offset < bLength ? aLength - offset : bLength;
+            errorCode = _multiplyLimbs( piece, a + offset, pieceLength, b, bLength, scratch );
+            _addLimbs( output + offset, output + offset, aLength + bLength - offset, piece, pieceLength + bLength );
+        }
+        if( piece == NULL )
+            errorCode = -1;
+    } else                                                  // Karatsuba
+    {
+        const int m = aLength / 2;                          // bLength > m, so b1 isn't empty
+        const int sumALength = aLength - m + 1, sumBLength = ( bLength - m > m ? bLength - m : m ) + 1;
+        uint64_t *sumA = allocateLimbs( scratch, ( size_t )sumALength );
+        uint64_t *sumB = allocateLimbs( scratch, ( size_t )sumBLength );
+        uint64_t *middle = allocateLimbs( scratch, ( size_t )( sumALength + sumBLength ) );
+        if( sumA == NULL || sumB == NULL || middle == NULL )
+            errorCode = -1;
+        else
+        {
+            sumA[sumALength - 1] = _addLimbs( sumA, a + m, aLength - m, a, m );
+            if( bLength - m >= m )
+                sumB[sumBLength - 1] = _addLimbs( sumB, b + m, bLength - m, b, m );
+            else
+                sumB[sumBLength - 1] = _addLimbs( sumB, b, m, b + m, bLength - m );
+            const int trimmedA = _trim( sumA, sumALength ), trimmedB = _trim( sumB, sumBLength );
+            const int middleLength = trimmedA + trimmedB;
+
+            if( ( errorCode = _multiplyLimbs( output, a, _trim( a, m ), b, _trim( b, m ), scratch ) ) == 0
+                && ( errorCode = _multiplyLimbs( output + 2 * m, a + m, aLength - m, b + m, bLength - m, scratch ) ) == 0
+                && ( errorCode = _multiplyLimbs( middle, sumA, trimmedA, sumB, trimmedB, scratch ) ) == 0 )
+            {
+                // middle = (a0 + a1)(b0 + b1) - a0b0 - a1b1 is non-negative, so a0b0 and a1b1 aren't longer than it
+                _subLimbs( middle, middle, middleLength, output, _trim( output, 2 * m ) );
+                _subLimbs( middle, middle, middleLength, output + 2 * m, _trim( output + 2 * m, aLength + bLength - 2 * m ) );
+                _addLimbs( output + m, output + m, aLength + bLength - m, middle, _trim( middle, middleLength ) );
+            }
+        }
+    }
+
+    releaseLimbArena( scratch, mark );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _divideLimbs
+ * --------------------
+ *      computes quotient of a / b (aLength >= bLength >= 1, highest limb of b isn't zero) by Knuth's algorithm D
+ *      (see D. Knuth, "The Art of Computer Programming", vol. 2, 4.3.1); quotient is stored in
+ *      aLength - bLength + 1 limbs of output, remainder is dropped
+ *
+ *      scratch: arena for normalized copies of operands (released before return)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _divideLimbs( uint64_t *output, const uint64_t *a, int aLength, const uint64_t *b, int bLength,
+                         LimbArena *scratch )
+{
+    const unsigned __int128 base = ( unsigned __int128 )1 << LIMB_BITS;
+
+    if( bLength == 1 )                                      // Short division
+    {
+        unsigned __int128 remainder = 0;
+        for( int i = aLength - 1; i >= 0; i-- )
+        {
+            remainder = remainder << LIMB_BITS | a[i];
+            output[i] = ( uint64_t )( remainder / b[0] );
+            remainder %= b[0];
+        }
+        return 0;
+    }
+
+    LimbArenaMark mark = markLimbArena( scratch );
+    uint64_t *u = allocateLimbs( scratch, ( size_t )aLength + 1 ), *v = allocateLimbs( scratch, ( size_t )bLength );
+    if( u == NULL || v == NULL )
+    {
+        releaseLimbArena( scratch, mark );
+        return -1;
+    }
+
+    // Normalization - the highest bit of divisor is set, so estimated digits of quotient are off by at most 2
+    const int shift = __builtin_clzl( b[bLength - 1] );
+    for( int i = bLength - 1; i > 0; i-- )
+        v[i] = shift == 0 ? b[i] : b[i] << shift | b[i - 1] >> ( LIMB_BITS - shift );
+    v[0] = b[0] << shift;
+    u[aLength] = shift == 0 ? 0 : a[aLength - 1] >> ( LIMB_BITS - shift );
+    for( int i = aLength - 1; i > 0; i-- )
+        u[i] = shift == 0 ? a[i] : a[i] << shift | a[i - 1] >> ( LIMB_BITS - shift );
+    u[0] = a[0] << shift;
+
+    for( int j = aLength - bLength; j >= 0; j-- )
+    {
+        const unsigned __int128 numerator = ( unsigned __int128 )u[j + bLength] << LIMB_BITS | u[j + bLength - 1];
+        unsigned __int128 estimate = numerator / v[bLength - 1];
+        unsigned __int128 remainder = numerator - estimate * v[bLength - 1];
+
+        // Product is computed only if estimate < base, so it fits in 128 bits
+        while( estimate >= base || estimate * v[bLength - 2] > ( remainder << LIMB_BITS | u[j + bLength - 2] ) )
+        {
+            estimate--;
+            remainder += v[bLength - 1];
+            if( remainder >= base )
+                break;
+        }
+
+        __int128 borrow = 0, difference;                    // Multiply and subtract
+        for( int i = 0; i < bLength; i++ )
+        {
+            const unsigned __int128 product = estimate * v[i];
+            difference = ( __int128 )u[i + j] - borrow - ( __int128 )( uint64_t )product;
+            u[i + j] = ( uint64_t )difference;
+            borrow = ( __int128 )( product >> LIMB_BITS ) - ( difference >> LIMB_BITS );
+        }
+        difference = ( __int128 )u[j + bLength] - borrow;
+        u[j + bLength] = ( uint64_t )difference;
+
+        output[j] = ( uint64_t )estimate;
+        if( difference < 0 )                                // Estimate was too big by one - add divisor back
+        {
+            output[j]--;
+            u[j + bLength] += _addLimbs( u + j, u + j, bLength, v, bLength );
+        }
+    }
+
+    releaseLimbArena( scratch, mark );
+    return 0;
+}
+
+/************************************
+ * Operations on numbers
+ ************************************/
+/*
+ * Function <private>:  _reserve
+ * --------------------
+ *      makes room for at least "length" limbs of magnitude of number; when number is moved to bigger array, its
+ *      value is kept (if keepValue is non-zero) and capacity at least doubles, so numbers growing step by step
+ *      waste at most half of taken limbs
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _reserve( BigInteger *number, int length, LimbArena *arena, int keepValue )
+{
+    const int capacity = number->capacity == 0 ? BIG_INTEGER_INLINE_LIMBS : number->capacity;
+    if( length <= capacity )
+        return 0;
+
+    const int newCapacity = length > 2 * capacity ? length : 2 * capacity;
+    uint64_t *limbs = allocateLimbs( arena, ( size_t )newCapacity );
+    if( limbs == NULL )
+        return -1;
+    if( keepValue )
+        memcpy( limbs, _limbs( number ), sizeof( uint64_t ) * ( size_t )abs( number->length ) );
+    number->magnitude.limbs = limbs;
+    number->capacity = newCapacity;
+    return 0;
+}
+
+/*
+ * Function:  setBigInteger
+ * --------------------
+ *      sets number to value of long integer (limbs of number, if it has any, are reused)
+ *
+ */
+void setBigInteger( BigInteger *number, long value )
+{
+    const uint64_t magnitude = value < 0 ? -( uint64_t )value : ( uint64_t )value;
+    _limbs( number )[0] = magnitude;
+    number->length = value == 0 ? 0 : value < 0 ? -1 : 1;
+}
+
+/*
+ * Function:  copyBigInteger
+ * --------------------
+ *      sets output to value of input
+ *
+ *      arena: arena from which limbs of output are taken if it needs more of them
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int copyBigInteger( BigInteger *output, const BigInteger *input, LimbArena *arena )
+{
+    if( output == input )
+        return 0;
+    if( _reserve( output, abs( input->length ), arena, 0 ) != 0 )
+        return -1;
+    memcpy( _limbs( output ), _constLimbs( input ), sizeof( uint64_t ) * ( size_t )abs( input->length ) );
+    output->length = input->length;
+    return 0;
+}
+
+/*
+ * Function:  bigIntegerToLong
+ * --------------------
+ *      converts number to long integer
+ *
+ *      returns: 0 on success, -2 if number doesn't fit in long integer
+ *
+ */
+int bigIntegerToLong( const BigInteger *number, long *value )
+{
+    if( number->length == 0 )
+    {
+        *value = 0;
+        return 0;
+    }
+    const uint64_t magnitude = _constLimbs( number )[0];
+    if( abs( number->length ) > 1 || magnitude > ( uint64_t )LONG_MAX + ( number->length < 0 ) )
+        return -2;
+    *value = number->length < 0 ? ( long )-magnitude : ( long )magnitude;
+    return 0;
+}
+
+/*
+ * Function:  compareBigInteger
+ * --------------------
+ *      returns: negative value, zero or positive value if a is smaller, equal or bigger than b
+ *
+ */
+int compareBigInteger( const BigInteger *a, const BigInteger *b )
+{
+    if( ( a->length < 0 ) != ( b->length < 0 ) )
+        return a->length < 0 ? -1 : 1;
+    const int magnitudeOrder = _compareLimbs( _constLimbs( a ), abs( a->length ), _constLimbs( b ), abs( b->length ) );
+    return a->length < 0 ? -magnitudeOrder : magnitudeOrder;
+}
+
+/*
+ * Function <private>:  _addSigned
+ * --------------------
+ *      stores a + (negateB ? -b : b) in output (which can be the same number as a or b)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _addSigned( BigInteger *output, const BigInteger *a, const BigInteger *b, int negateB, LimbArena *arena )
+{
+    const int aLength = abs( a->length ), bLength = abs( b->length );
+    const int aNegative = a->length < 0, bNegative = ( b->length < 0 ) != negateB;
+    const int longer = aLength > bLength ? aLength : bLength;
+    const BigInteger *first = a, *second = b;
+
+    // Reserving keeps value, so pointers to limbs of operands being the same number as output stay valid
+    if( _reserve( output, longer + 1, arena, 1 ) != 0 )
+        return -1;
+    uint64_t *result = _limbs( output );
+
+    if( aNegative == bNegative )                            // |a| + |b| with sign of a
+    {
+        if( aLength < bLength )
+        {
+            first = b;
+            second = a;
+        }
+        result[longer] = _addLimbs( result, _constLimbs( first ), abs( first->length ),
+                                    _constLimbs( second ), abs( second->length ) );
+        const int length = _trim( result, longer + 1 );
+        output->length = aNegative ? -length : length;
+        return 0;
+    }
+
+    // Signs differ - smaller magnitude is subtracted from bigger one, result has sign of the bigger one
+    int negative = aNegative;
+    if( _compareLimbs( _constLimbs( a ), aLength, _constLimbs( b ), bLength ) < 0 )
+    {
+        first = b;
+        second = a;
+        negative = bNegative;
+    }
+    _subLimbs( result, _constLimbs( first ), abs( first->length ), _constLimbs( second ), abs( second->length ) );
+    const int length = _trim( result, abs( first->length ) );
+    output->length = negative ? -length : length;
+    return 0;
+}
+
+/*
+ * Function:  addBigInteger
+ * --------------------
+ *      stores a + b in output (which can be the same number as a or b)
+ *
+ *      arena: arena from which limbs of output are taken if it needs more of them
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int addBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena )
+{
+    return _addSigned( output, a, b, 0, arena );
+}
+
+/*
+ * Function:  subBigInteger
+ * --------------------
+ *      stores a - b in output (which can be the same number as a or b)
+ *
+ *      arena: arena from which limbs of output are taken if it needs more of them
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int subBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena )
+{
+    return _addSigned( output, a, b, 1, arena );
+}
+
+/*
+ * Function:  multiplyBigInteger
+ * --------------------
+ *      stores a * b in output (which must not be the same number as a or b)
+ *
+ *      arena:   arena from which limbs of output are taken if it needs more of them
+ *      scratch: arena for temporary values of Karatsuba algorithm (can be the same as arena - only temporary
+ *               values are released)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int multiplyBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena,
+                        LimbArena *scratch )
+{
+    const int aLength = abs( a->length ), bLength = abs( b->length );
+
+    if( aLength == 0 || bLength == 0 )
+    {
+        output->length = 0;
+        return 0;
+    }
+    if( _reserve( output, aLength + bLength, arena, 0 ) != 0
+        || _multiplyLimbs( _limbs( output ), _constLimbs( a ), aLength, _constLimbs( b ), bLength, scratch ) != 0 )
+        return -1;
+    const int length = _trim( _limbs( output ), aLength + bLength );
+    output->length = ( a->length < 0 ) != ( b->length < 0 ) ? -length : length;
+    return 0;
+}
+
+/*
+ * Function:  addProductBigInteger
+ * --------------------
+ *      adds a * b to output (which must not be the same number as a or b); product is kept in scratch only until
+ *      it's added
+ *
+ *      arena:   arena from which limbs of output are taken if it needs more of them
+ *      scratch: arena for product (must be different from arena)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int addProductBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena,
+                          LimbArena *scratch )
+{
+    LimbArenaMark mark = markLimbArena( scratch );
+    BigInteger product = { 0 };
+
+    int errorCode = multiplyBigInteger( &product, a, b, scratch, scratch );
+    if( errorCode == 0 )
+        errorCode = addBigInteger( output, output, &product, arena );
+    releaseLimbArena( scratch, mark );
+    return errorCode;
+}
+
+/*
+ * Function:  divideBigInteger
+ * --------------------
+ *      stores a / b rounded towards zero in output (which must not be the same number as a or b)
+ *
+ *      arena:   arena from which limbs of output are taken if it needs more of them
+ *      scratch: arena for temporary values (can be the same as arena - only temporary values are released)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on division by zero
+ *
+ */
+int divideBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena,
+                      LimbArena *scratch )
+{
+    const int aLength = abs( a->length ), bLength = abs( b->length );
+
+    if( bLength == 0 )
+        return -2;
+    if( _compareLimbs( _constLimbs( a ), aLength, _constLimbs( b ), bLength ) < 0 )
+    {
+        output->length = 0;
+        return 0;
+    }
+    if( _reserve( output, aLength - bLength + 1, arena, 0 ) != 0
+        || _divideLimbs( _limbs( output ), _constLimbs( a ), aLength, _constLimbs( b ), bLength, scratch ) != 0 )
+        return -1;
+    const int length = _trim( _limbs( output ), aLength - bLength + 1 );
+    output->length = ( a->length < 0 ) != ( b->length < 0 ) ? -length : length;
+    return 0;
+}
+
+/*
+ * Function:  bigIntegerDecimalLength
+ * --------------------
+ *      returns size of buffer sufficient for decimal form of number (with sign and terminating NULL)
+ *
+ */
+size_t bigIntegerDecimalLength( const BigInteger *number )
+{
+    return ( size_t )abs( number->length ) * 20 + 2;       // 2^64 has 20 decimal digits
+}
+
+/*
+ * Function:  bigIntegerToString
+ * --------------------
+ *      writes decimal form of number to buffer of at least bigIntegerDecimalLength( number ) bytes; magnitude is
+ *      divided by 10^19 repeatedly, giving groups of 19 digits from the lowest one
+ *
+ *      scratch: arena for copy of magnitude (released before return)
+ *
+ *      returns: number of written characters (without terminating NULL), -1 on out of memory
+ *
+ */
+int bigIntegerToString( const BigInteger *number, char *buffer, LimbArena *scratch )
+{
+    int length = abs( number->length ), written = 0;
+
+    if( length == 0 )
+    {
+        strcpy( buffer, "0" );
+        return 1;
+    }
+
+    LimbArenaMark mark = markLimbArena( scratch );
+    uint64_t *magnitude = allocateLimbs( scratch, ( size_t )length );
+    if( magnitude == NULL )
+        return -1;
+    memcpy( magnitude, _constLimbs( number ), sizeof( uint64_t ) * ( size_t )length );
+
+    while( length > 0 )                                     // Digits are written in reversed order
+    {
+        unsigned __int128 remainder = 0;
+        for( int i = length - 1; i >= 0; i-- )
+        {
+            remainder = remainder << LIMB_BITS | magnitude[i];
+            magnitude[i] = ( uint64_t )( remainder / DECIMAL_CHUNK );
+            remainder %= DECIMAL_CHUNK;
+        }
+        length = _trim( magnitude, length );
+
+        uint64_t chunk = ( uint64_t )remainder;
+        for( int digit = 0; digit < DECIMAL_CHUNK_DIGITS && ( length > 0 || chunk != 0 ); digit++, chunk /= 10 )
+            buffer[written++] = ( char )( '0' + chunk % 10 );
+    }
+    if( number->length < 0 )
+        buffer[written++] = '-';
+    buffer[written] = 0;
+
+    for( int i = 0; i < written / 2; i++ )
+    {
+        const char swapped = buffer[i];
+        buffer[i] = buffer[written - 1 - i];
+        buffer[written - 1 - i] = swapped;
+    }
+    releaseLimbArena( scratch, mark );
+    return written;
+}
@@ -0,0 +1,84 @@
+/*
+ * File: BigInteger.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file BigInteger.c
+ */
+
+#ifndef PROJEKT2_BIGINTEGER_H
+#define PROJEKT2_BIGINTEGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define BIG_INTEGER_INLINE_LIMBS    2           // Limbs stored inside BigInteger (numbers below 2^128 need no arena)
+#define KARATSUBA_THRESHOLD         32          // Minimal number of limbs of both factors multiplied by Karatsuba
+#define LIMB_ARENA_CHUNK            4096        // Minimal number of limbs allocated by arena at once
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Chunk of memory of arena - limbs are taken from its beginning
+struct LimbChunk {
+    struct LimbChunk *previous;     // Chunk allocated before this one (NULL for the first one)
+    size_t capacity;                // Number of limbs in chunk
+    size_t used;                    // Number of limbs already taken
+    uint64_t limbs[];
+};
+typedef struct LimbChunk LimbChunk;
+
+// Region allocator of limbs; limbs aren't freed one by one - all of them are freed with the arena, or all taken
+// after given mark are freed with releaseLimbArena (so arena can be used as a stack of temporary values)
+struct LimbArena {
+    LimbChunk *current;             // Chunk from which limbs are taken (NULL if nothing was allocated yet)
+};
+typedef struct LimbArena LimbArena;
+
+// State of arena returned by markLimbArena
+struct LimbArenaMark {
+    LimbChunk *chunk;
+    size_t used;
+};
+typedef struct LimbArenaMark LimbArenaMark;
+
+// Integer of arbitrary size; magnitude is stored as little-endian array of 64-bit limbs, either inside the structure
+// (when it has at most BIG_INTEGER_INLINE_LIMBS limbs) or in limbs taken from arena. Zero-initialized structure
+// is number 0
+struct BigInteger {
+    int length;                     // Number of limbs of magnitude (without leading zeros), negative for negative numbers
+    int capacity;                   // Number of limbs in "limbs", 0 if magnitude is stored inline
+    union {
+        uint64_t small[BIG_INTEGER_INLINE_LIMBS];
+        uint64_t *limbs;
+    } magnitude;
+};
+typedef struct BigInteger BigInteger;
+
+/************************************
+ * Function declarations
+ ************************************/
+void initLimbArena( LimbArena *arena );
+uint64_t* allocateLimbs( LimbArena *arena, size_t count );
+int reserveLimbArena( LimbArena *arena, size_t count );
+LimbArenaMark markLimbArena( LimbArena *arena );
+void releaseLimbArena( LimbArena *arena, LimbArenaMark mark );
+void freeLimbArena( LimbArena *arena );
+void setBigInteger( BigInteger *number, long value );
+int copyBigInteger( BigInteger *output, const BigInteger *input, LimbArena *arena );
+int bigIntegerToLong( const BigInteger *number, long *value );
+int compareBigInteger( const BigInteger *a, const BigInteger *b );
+int addBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena );
+int subBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena );
+int multiplyBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena,
+                        LimbArena *scratch );
+int addProductBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena,
+                          LimbArena *scratch );
+int divideBigInteger( BigInteger *output, const BigInteger *a, const BigInteger *b, LimbArena *arena,
+                      LimbArena *scratch );
+size_t bigIntegerDecimalLength( const BigInteger *number );
+int bigIntegerToString( const BigInteger *number, char *buffer, LimbArena *scratch );
+
+#endif //PROJEKT2_BIGINTEGER_H
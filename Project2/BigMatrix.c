@@ -0,0 +1,351 @@
+/*
+ * File: BigMatrix.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Exact arithmetic on square matrices of integers of arbitrary size - results never overflow, so
+ *              operations fail only when memory runs out. Limbs of all elements of matrix come from its arena and
+ *              temporary values of every operation from one scratch arena, so elements are never allocated one by one
+ */
+
+#include "BigMatrix.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Function:  createBigMatrix
+ * --------------------
+ *      creates matrix of given size filled with zeros
+ *
+ *      size:    number of cols|rows
+ *      output:  pointer to memory where pointer to structure should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createBigMatrix( int size, BigMatrix **output )
+{
+    BigMatrix *matrix = malloc( sizeof( BigMatrix ) );
+    if( matrix == NULL )
+        return -1;
+
+    matrix->size = size;
+    matrix->elements = malloc( sizeof( BigInteger* ) * ( size_t )( size > 0 ? size : 1 ) );
+    matrix->data = calloc( ( size_t )size * ( size_t )size + 1, sizeof( BigInteger ) );    // Zeroed number is 0
+    if( matrix->elements == NULL || matrix->data == NULL )
+    {
+        free( matrix->elements );
+        free( matrix->data );
+        free( matrix );
+        return -1;
+    }
+    for( int row = 0; row < size; row++ )
+        matrix->elements[row] = matrix->data + ( size_t )row * ( size_t )size;
+    initLimbArena( &matrix->arena );
+
+    *output = matrix;
+    return 0;
+}
+
+/*
+ * Function:  bigMatrixFromMatrix
+ * --------------------
+ *      creates matrix of integers of arbitrary size with the same elements as matrix of long integers (all of them
+ *      are stored inline, so arena of created matrix stays empty)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int bigMatrixFromMatrix( Matrix *matrix, BigMatrix **output )
+{
+    if( createBigMatrix( matrix->size, output ) != 0 )
+        return -1;
+    for( int row = 0; row < matrix->size; row++ )
+        for( int col = 0; col < matrix->size; col++ )
+            setBigInteger( &( *output )->elements[row][col], matrix->elements[row][col] );
+    return 0;
+}
+
+/*
+ * Function:  bigMatrixToMatrix
+ * --------------------
+ *      creates matrix of long integers with the same elements as matrix of integers of arbitrary size
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if some element doesn't fit in long integer
+ *
+ */
+int bigMatrixToMatrix( BigMatrix *matrix, Matrix **output )
+{
+    if( createSquareMatrix( matrix->size, output ) != 0 )
+        return -1;
+    for( int row = 0; row < matrix->size; row++ )
+        for( int col = 0; col < matrix->size; col++ )
+            if( bigIntegerToLong( &matrix->elements[row][col], &( *output )->elements[row][col] ) != 0 )
+            {
+                deleteSquareMatrix( *output );
+                return -2;
+            }
+    return 0;
+}
+
+/*
+ * Function:  deleteBigMatrix
+ * --------------------
+ *      frees all memory of matrix (including limbs of its elements)
+ *
+ */
+void deleteBigMatrix( BigMatrix *matrix )
+{
+    if( matrix == NULL )
+        return;
+    freeLimbArena( &matrix->arena );
+    free( matrix->elements );
+    free( matrix->data );
+    free( matrix );
+}
+
+/*
+ * Function <private>:  _copyBigMatrix
+ * --------------------
+ *      creates copy of matrix (limbs of copy are taken from its own arena)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _copyBigMatrix( BigMatrix *matrix, BigMatrix **output )
+{
+    if( createBigMatrix( matrix->size, output ) != 0 )
+        return -1;
+    for( int row = 0; row < matrix->size; row++ )
+        for( int col = 0; col < matrix->size; col++ )
+            if( copyBigInteger( &( *output )->elements[row][col], &matrix->elements[row][col], &( *output )->arena ) != 0 )
+            {
+                deleteBigMatrix( *output );
+                return -1;
+            }
+    return 0;
+}
+
+/*
+ * Function <private>:  _addBigMatrix
+ * --------------------
+ *      creates matrix being sum (or difference, if "subtract" is non-zero) of matrices
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size
+ *
+ */
+static int _addBigMatrix( BigMatrix *m1, BigMatrix *m2, int subtract, BigMatrix **output )
+{
+    if( m1->size != m2->size )
+        return -2;
+    if( createBigMatrix( m1->size, output ) != 0 )
+        return -1;
+
+    for( int row = 0; row < m1->size; row++ )
+        for( int col = 0; col < m1->size; col++ )
+        {
+            BigInteger *result = &( *output )->elements[row][col];
+            const int errorCode = subtract ? subBigInteger( result, &m1->elements[row][col], &m2->elements[row][col], &( *output )->arena )
+                                           : addBigInteger( result, &m1->elements[row][col], &m2->elements[row][col], &( *output )->arena );
+            if( errorCode != 0 )
+            {
+                deleteBigMatrix( *output );
+                return -1;
+            }
+        }
+    return 0;
+}
+
+/*
+ * Function:  sumBigMatrix
+ * --------------------
+ *      creates matrix and sets its elements to sum of matrices being arguments
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size
+ *
+ */
+int sumBigMatrix( BigMatrix *m1, BigMatrix *m2, BigMatrix **output )
+{
+    return _addBigMatrix( m1, m2, 0, output );
+}
+
+/*
+ * Function:  subBigMatrix
+ * --------------------
+ *      creates matrix and sets its elements to difference of matrices being arguments
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size
+ *
+ */
+int subBigMatrix( BigMatrix *m1, BigMatrix *m2, BigMatrix **output )
+{
+    return _addBigMatrix( m1, m2, 1, output );
+}
+
+/*
+ * Function:  multiplyBigMatrix
+ * --------------------
+ *      creates matrix and sets its elements to product of matrices being arguments; products of elements are
+ *      accumulated directly in elements of result (row of m1 times rows of m2, zero elements of m1 are skipped)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size
+ *
+ */
+int multiplyBigMatrix( BigMatrix *m1, BigMatrix *m2, BigMatrix **output )
+{
+    LimbArena scratch;
+    int errorCode = 0;
+
+    if( m1->size != m2->size )
+        return -2;
+    if( createBigMatrix( m1->size, output ) != 0 )
+        return -1;
+    initLimbArena( &scratch );
+
+    for( int row = 0; row < m1->size && errorCode == 0; row++ )
+        for( int k = 0; k < m1->size && errorCode == 0; k++ )
+        {
+            const BigInteger *factor = &m1->elements[row][k];
+            if( factor->length == 0 )
+                continue;
+            for( int col = 0; col < m1->size && errorCode == 0; col++ )
+                errorCode = addProductBigInteger( &( *output )->elements[row][col], factor, &m2->elements[k][col],
+                                                  &( *output )->arena, &scratch );
+        }
+
+    freeLimbArena( &scratch );
+    if( errorCode != 0 )
+    {
+        deleteBigMatrix( *output );
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Function:  powerBigMatrix
+ * --------------------
+ *      creates matrix and sets its elements to matrix raised to the power of exponent (by repeated squaring)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int powerBigMatrix( BigMatrix *matrix, unsigned long exponent, BigMatrix **output )
+{
+    BigMatrix *result, *square, *product;
+
+    if( createBigMatrix( matrix->size, &result ) != 0 )
+        return -1;
+    for( int i = 0; i < matrix->size; i++ )
+        setBigInteger( &result->elements[i][i], 1 );
+    if( _copyBigMatrix( matrix, &square ) != 0 )
+    {
+        deleteBigMatrix( result );
+        return -1;
+    }
+
+    while( exponent != 0 )
+    {
+        if( exponent & 1 )
+        {
+            if( multiplyBigMatrix( result, square, &product ) != 0 )
+                break;
+            deleteBigMatrix( result );
+            result = product;
+        }
+        exponent >>= 1;
+        if( exponent != 0 )
+        {
+            if( multiplyBigMatrix( square, square, &product ) != 0 )
+                break;
+            deleteBigMatrix( square );
+            square = product;
+        }
+    }
+
+    deleteBigMatrix( square );
+    if( exponent != 0 )                                     // Loop was stopped by out of memory
+    {
+        deleteBigMatrix( result );
+        return -1;
+    }
+    *output = result;
+    return 0;
+}
+
+/*
+ * Function:  detBigMatrix
+ * --------------------
+ *      computes determinant of matrix with fraction-free Bareiss algorithm: in step k every element (i, j) below and
+ *      right of pivot becomes (a[k][k] * a[i][j] - a[i][k] * a[k][j]) / a[k-1][k-1]; division is always exact, so
+ *      only O(n^3) operations on integers are done and size of elements grows at most linearly with k. The last
+ *      element is the determinant (with sign changed by every swap of rows)
+ *
+ *      matrix:  pointer to BigMatrix structure
+ *      result:  pointer to number where determinant should be stored
+ *      arena:   arena from which limbs of result are taken
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int detBigMatrix( BigMatrix *matrix, BigInteger *result, LimbArena *arena )
+{
+    const int size = matrix->size;
+    BigInteger one = { 0 };
+    const BigInteger *previousPivot = &one;
+    BigMatrix *work;
+    LimbArena scratch;
+    int negate = 0, errorCode = 0;
+
+    setBigInteger( &one, 1 );
+    if( size == 0 )
+        return copyBigInteger( result, &one, arena );
+    if( _copyBigMatrix( matrix, &work ) != 0 )
+        return -1;
+    initLimbArena( &scratch );
+
+    for( int k = 0; k < size - 1 && errorCode == 0; k++ )
+    {
+        if( work->elements[k][k].length == 0 )              // Find row with non-zero pivot
+        {
+            int pivotRow = k + 1;
+            while( pivotRow < size && work->elements[pivotRow][k].length == 0 )
+                pivotRow++;
+            if( pivotRow == size )                          // Whole column is zero - determinant is 0
+            {
+                setBigInteger( &work->elements[size - 1][size - 1], 0 );
+                break;
+            }
+            BigInteger *swapped = work->elements[k];
+            work->elements[k] = work->elements[pivotRow];
+            work->elements[pivotRow] = swapped;
+            negate = !negate;
+        }
+
+        const BigInteger *pivot = &work->elements[k][k];
+        for( int row = k + 1; row < size && errorCode == 0; row++ )
+            for( int col = k + 1; col < size && errorCode == 0; col++ )
+            {
+                LimbArenaMark mark = markLimbArena( &scratch );
+                BigInteger left = { 0 }, right = { 0 };
+                BigInteger *element = &work->elements[row][col];
+
+                if( multiplyBigInteger( &left, pivot, element, &scratch, &scratch ) != 0
+                    || multiplyBigInteger( &right, &work->elements[row][k], &work->elements[k][col], &scratch, &scratch ) != 0
+                    || subBigInteger( &left, &left, &right, &scratch ) != 0
+                    || divideBigInteger( element, &left, previousPivot, &work->arena, &scratch ) != 0 )
+                    errorCode = -1;
+                releaseLimbArena( &scratch, mark );
+            }
+        previousPivot = pivot;                              // Row k and column k aren't changed any more
+    }
+
+    if( errorCode == 0 )
+    {
+        errorCode = copyBigInteger( result, &work->elements[size - 1][size - 1], arena );
+        if( negate )
+            result->length = -result->length;
+    }
+    freeLimbArena( &scratch );
+    deleteBigMatrix( work );
+    return errorCode;
+}
@@ -0,0 +1,39 @@
+/*
+ * File: BigMatrix.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file BigMatrix.c
+ */
+
+#ifndef PROJEKT2_BIGMATRIX_H
+#define PROJEKT2_BIGMATRIX_H
+
+#include "BigInteger.h"
+#include "SquareMatrix.h"
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Square matrix of integers of arbitrary size; limbs of all elements are taken from arena of matrix
+struct BigMatrix {
+    int size;
+    BigInteger **elements;          // Pointers to rows (elements[row][col])
+    BigInteger *data;               // All elements, row after row
+    LimbArena arena;                // Limbs of elements
+};
+typedef struct BigMatrix BigMatrix;
+
+/************************************
+ * Function declarations
+ ************************************/
+int createBigMatrix( int size, BigMatrix **output );
+int bigMatrixFromMatrix( Matrix *matrix, BigMatrix **output );
+int bigMatrixToMatrix( BigMatrix *matrix, Matrix **output );
+void deleteBigMatrix( BigMatrix *matrix );
+int sumBigMatrix( BigMatrix *m1, BigMatrix *m2, BigMatrix **output );
+int subBigMatrix( BigMatrix *m1, BigMatrix *m2, BigMatrix **output );
+int multiplyBigMatrix( BigMatrix *m1, BigMatrix *m2, BigMatrix **output );
+int powerBigMatrix( BigMatrix *matrix, unsigned long exponent, BigMatrix **output );
+int detBigMatrix( BigMatrix *matrix, BigInteger *result, LimbArena *arena );
+
+#endif //PROJEKT2_BIGMATRIX_H
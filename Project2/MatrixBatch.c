@@ -0,0 +1,1150 @@
+/*
+ * File: MatrixBatch.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Non-interactive execution of scripts of matrix operations
+ *
+ * Script contains one command per line; empty lines and lines starting with '#' are skipped. Matrices are
+ * referred to by name or id (see registryFind), results are stored under given name (existing matrix with this
+ * name is replaced). Available commands:
+ *      create NAME SIZE            - creates matrix filled with zeros
+ *      generate NAME SIZE PATTERN [SEED [MIN MAX [LOWER UPPER]]]
+ *                                  - creates matrix with pattern: random, identity, diagonal, banded (LOWER and
+ *                                    UPPER diagonals around main one, 1 by default), toeplitz or hilbert; random
+ *                                    values are from range <MIN, MAX> (range of edited values by default)
+ *      fill NAME V1 V2 ...         - sets all SIZE * SIZE elements of matrix (row after row)
+ *      load NAME PATH              - loads matrix from binary file
+ *      save MATRIX PATH            - saves matrix to binary file
+ *      mulfile OUTPUT PATH1 PATH2 [BUDGET]
+ *                                  - multiplies matrices from binary files into file OUTPUT out of core, using
+ *                                    at most BUDGET megabytes for tiles (OUT_OF_CORE_DEFAULT_BUDGET by default)
+ *      add|sub|mul NAME M1 M2      - stores sum|difference|product of matrices under NAME
+ *      det MATRIX                  - computes determinant
+ *      inverse NAME MATRIX         - stores adjugate of MATRIX under NAME and prints determinant (inverse of
+ *                                    MATRIX is adjugate divided by determinant)
+ *      power NAME MATRIX EXP [MOD] - stores MATRIX^EXP (modulo MOD) under NAME
+ *      chain NAME M1 M2 ...        - stores product of matrices computed in the cheapest order under NAME
+ *      transpose NAME MATRIX       - stores transposition of MATRIX under NAME
+ *      exact add|sub|mul M1 M2, exact power MATRIX EXP, exact det MATRIX
+ *                                  - computes result exactly with integers of arbitrary size and prints it
+ *      charpoly MATRIX             - prints coefficients of characteristic polynomial det(xI - MATRIX), from x^SIZE
+ *      eigen MATRIX                - prints eigenvalues (real and imaginary part) of matrix
+ *      detall [SIZE]               - computes exact determinants of all dense matrices (only of given size)
+ *      mulall MATRIX               - multiplies every dense matrix by MATRIX, products are stored as new matrices
+ *      sumall NAME [SIZE]          - stores sum of all dense matrices (only of given size) under NAME
+ *      modrank MATRIX P            - computes rank of matrix (dense or sparse) over GF(P), P prime
+ *      modrref NAME MATRIX P       - stores reduced row echelon form of MATRIX over GF(P) under NAME
+ *      modnull NAME MATRIX P       - stores basis of null space of MATRIX over GF(P) under NAME (vectors are rows)
+ *      modsolve NAME A B P         - stores solution X of system AX = B over GF(P) under NAME
+ *      stats [PATH]                - writes statistics of operations (calls, wall time, arithmetic operations,
+ *                                    memory of matrices, hardware counters) as JSON to PATH
+ *      profile on|off|reset|counters|nocounters
+ *                                  - enables|disables profiling (disabled at start, operations aren't measured),
+ *                                    clears statistics or enables|disables hardware counters (cycles, cache misses)
+ *      print MATRIX                - prints all elements of matrix
+ *      delete MATRIX               - deletes matrix
+ *
+ * For every command exactly one tab-separated status line is written:
+ *      ok|error <TAB> line number <TAB> command <TAB> wall time in milliseconds <TAB> result or error message
+ * Commands "print" and "exact" precede their status line with one line per row of matrix: "row", then elements,
+ * all separated by tabs ("exact det" prints single line "value", then determinant). Command "charpoly" prints line
+ * "coefficients", then all coefficients, and "eigen" prints line "eigenvalue", real and imaginary part for every
+ * eigenvalue. Commands "detall" and "mulall" print line "item", id and name of matrix (or '-'), then determinant, id of
+ * product or error message for every matrix. Matrices are processed concurrently on all processors. Command "stats"
+ * without path prints line "stats", then statistics as JSON object (see writeProfileJson).
+ */
+
+#include "MatrixBatch.h"
+#include "MatrixFile.h"
+#include "MatrixGenerators.h"
+#include "MatrixChain.h"
+#include "MatrixLayout.h"
+#include "OutOfCore.h"
+#include "BigMatrix.h"
+#include "Spectrum.h"
+#include "MatrixBulk.h"
+#include "ModularMatrix.h"
+#include "Profiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+
+/************************************
+ * Structure declarations
+ ************************************/
+// State shared by all commands of script
+struct BatchContext {
+    MatrixRegistry *registry;
+    ResultCache *cache;
+    FILE *output;
+};
+typedef struct BatchContext BatchContext;
+
+// Function executing command; arguments[0] is name of command. Returns NULL on success (result, if any, is
+// written to buffer "result") or error message
+typedef const char* (*BatchHandler)( BatchContext *context, char **arguments, int count, char *result );
+
+// Command available in scripts
+struct BatchCommand {
+    const char *name;
+    int minArguments, maxArguments;             // Allowed number of arguments (not counting name of command)
+    BatchHandler handler;
+};
+typedef struct BatchCommand BatchCommand;
+
+/*
+ * Function <private>:  _parseLong
+ * --------------------
+ *      converts whole string to number from range <minValue, maxValue>
+ *
+ *      returns: 0 on success, -1 if string isn't valid number or it's out of range
+ *
+ */
+static int _parseLong( const char *string, long minValue, long maxValue, long *value )
+{
+    char *end;
+
+    errno = 0;
+    *value = strtol( string, &end, 10 );
+    if( errno != 0 || end == string || *end != 0 || *value < minValue || *value > maxValue )
+        return -1;
+    return 0;
+}
+
+/*
+ * Function <private>:  _findDense
+ * --------------------
+ *      finds dense matrix identified by id or name
+ *
+ *      returns: NULL on success, error message otherwise
+ *
+ */
+static const char* _findDense( BatchContext *context, const char *idOrName, Matrix **matrix )
+{
+    RegistryEntry *entry = registryFind( context->registry, idOrName );
+    if( entry == NULL )
+        return "No such matrix";
+    if( entry->dense == NULL )
+        return "Matrix is stored as sparse";
+    *matrix = entry->dense;
+    return NULL;
+}
+
+/*
+ * Function <private>:  _storeMatrix
+ * --------------------
+ *      registers matrix under given name, replacing matrix already registered under it; on error matrix is deleted
+ *
+ *      returns: NULL on success, error message otherwise
+ *
+ */
+static const char* _storeMatrix( BatchContext *context, const char *name, Matrix *matrix, char *result )
+{
+    int id;
+    RegistryEntry *entry = registryFindByName( context->registry, name );
+
+    if( entry != NULL )
+    {
+        registryReplace( context->registry, entry, matrix, NULL );
+        id = entry->id;
+    } else
+    {
+        int errorCode = registryAdd( context->registry, name, matrix, NULL, &id );
+        if( errorCode != 0 )
+        {
+            deleteSquareMatrix( matrix );
+            return errorCode == -1 ? "Out of memory" : "Invalid name";
+        }
+    }
+    snprintf( result, MAX_BATCH_MESSAGE, "#%d %dx%d", id, matrix->size, matrix->size );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandCreate
+ * --------------------
+ *      handles command "create NAME SIZE"
+ *
+ */
+static const char* _commandCreate( BatchContext *context, char **arguments, int count, char *result )
+{
+    long size;
+    Matrix *matrix;
+
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+    if( _parseLong( arguments[2], 0, INT_MAX, &size ) != 0 )
+        return "Invalid size";
+    if( createSquareMatrix( ( int )size, &matrix ) != 0 )
+        return "Out of memory";
+    return _storeMatrix( context, arguments[1], matrix, result );
+}
+
+/*
+ * Function <private>:  _commandGenerate
+ * --------------------
+ *      handles command "generate NAME SIZE PATTERN [SEED [MIN MAX [LOWER UPPER]]]"
+ *
+ */
+static const char* _commandGenerate( BatchContext *context, char **arguments, int count, char *result )
+{
+    static const char *patterns[] = { "random", "identity", "diagonal", "banded", "toeplitz", "hilbert" };
+    GeneratorOptions options = { -1, 0, MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE, 1, 1 };
+    long size, seed = 0, lowerBandwidth = 1, upperBandwidth = 1;
+    Matrix *matrix;
+
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+    if( _parseLong( arguments[2], 0, INT_MAX, &size ) != 0 )
+        return "Invalid size";
+    for( int i = 0; i < ( int )( sizeof( patterns ) / sizeof( patterns[0] ) ); i++ )
+        if( strcmp( arguments[3], patterns[i] ) == 0 )
+            options.pattern = i;
+    if( options.pattern == -1 )
+        return "Unknown pattern";
+    if( ( count > 4 && _parseLong( arguments[4], LONG_MIN, LONG_MAX, &seed ) != 0 )
+        || ( count > 5 && ( count < 7 || _parseLong( arguments[5], LONG_MIN, LONG_MAX, &options.minValue ) != 0
+                            || _parseLong( arguments[6], options.minValue, LONG_MAX, &options.maxValue ) != 0 ) )
+        || ( count > 7 && ( count < 9 || _parseLong( arguments[7], 0, INT_MAX, &lowerBandwidth ) != 0
+                            || _parseLong( arguments[8], 0, INT_MAX, &upperBandwidth ) != 0 ) ) )
+        return "Invalid parameters of pattern";
+    options.seed = ( unsigned long )seed;
+    options.lowerBandwidth = ( int )lowerBandwidth;
+    options.upperBandwidth = ( int )upperBandwidth;
+
+    if( createSquareMatrix( ( int )size, &matrix ) != 0 )
+        return "Out of memory";
+    int errorCode = generateMatrix( matrix, &options );
+    if( errorCode != 0 )
+    {
+        deleteSquareMatrix( matrix );
+        return errorCode == -1 ? "Out of memory" : "Elements of Hilbert matrix don't fit in long integer";
+    }
+    return _storeMatrix( context, arguments[1], matrix, result );
+}
+
+/*
+ * Function <private>:  _commandFill
+ * --------------------
+ *      handles command "fill NAME V1 V2 ..."; matrix isn't modified if any value is invalid
+ *
+ */
+static const char* _commandFill( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+    const char *error = _findDense( context, arguments[1], &matrix );
+    if( error != NULL )
+        return error;
+    if( ( long )( count - 2 ) != ( long )matrix->size * matrix->size )
+        return "Number of values must be equal to number of elements";
+
+    long *values = malloc( ( size_t )( count - 2 ) * sizeof( long ) + 1 );    // + 1 - matrix can be empty
+    if( values == NULL )
+        return "Out of memory";
+    for( int i = 0; i < count - 2; i++ )
+        if( _parseLong( arguments[i + 2], MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE, &values[i] ) != 0 )
+        {
+            free( values );
+            return "Values must be integers in range <-65536, 65536>";
+        }
+
+    if( prepareMatrixForWrite( matrix ) != 0 )
+    {
+        free( values );
+        return "Out of memory";
+    }
+    for( int row = 0; row < matrix->size; row++ )
+        memcpy( matrix->elements[row], values + ( long )row * matrix->size, ( size_t )matrix->size * sizeof( long ) );
+    markMatrixModified( matrix );
+    free( values );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandLoad
+ * --------------------
+ *      handles command "load NAME PATH"
+ *
+ */
+static const char* _commandLoad( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+    switch( loadMatrixFromFile( arguments[2], &matrix ) )
+    {
+        case 0:
+            return _storeMatrix( context, arguments[1], matrix, result );
+        case -1:
+            return "Out of memory";
+        case -2:
+            return "Can't open file";
+        default:
+            return "File doesn't contain valid matrix";
+    }
+}
+
+/*
+ * Function <private>:  _commandSave
+ * --------------------
+ *      handles command "save MATRIX PATH"
+ *
+ */
+static const char* _commandSave( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+    const char *error = _findDense( context, arguments[1], &matrix );
+    if( error != NULL )
+        return error;
+
+    switch( saveMatrixToFile( matrix, arguments[2] ) )
+    {
+        case 0:
+            return NULL;
+        case -1:
+            return "Out of memory";
+        default:
+            return "Can't write to file";
+    }
+}
+
+/*
+ * Function <private>:  _commandMultiplyFiles
+ * --------------------
+ *      handles command "mulfile OUTPUT PATH1 PATH2 [BUDGET]"; result reports tile size and share of time spent on
+ *      waiting for disk
+ *
+ */
+static const char* _commandMultiplyFiles( BatchContext *context, char **arguments, int count, char *result )
+{
+    long budget = OUT_OF_CORE_DEFAULT_BUDGET;
+    OutOfCoreStats stats;
+
+    if( count > 4 && _parseLong( arguments[4], 1, LONG_MAX >> 20, &budget ) != 0 )
+        return "Invalid memory budget";
+
+    switch( multiplyMatrixFiles( arguments[2], arguments[3], arguments[1], ( size_t )budget << 20, NULL, &stats ) )
+    {
+        case 0:
+            snprintf( result, MAX_BATCH_MESSAGE, "tile %dx%d, %ld tiles read, waiting for disk %.1f%%", stats.tileSize,
+                      stats.tileSize, stats.tilesRead,
+                      stats.elapsedSeconds > 0 ? 100.0 * stats.stallSeconds / stats.elapsedSeconds : 0.0 );
+            return NULL;
+        case -1:
+            return "Out of memory";
+        case -2:
+            return "Can't read or write file";
+        case -3:
+            return "Files don't contain valid matrices of the same size";
+        default:
+            return "Overflow";
+    }
+}
+
+/*
+ * Function <private>:  _commandArithmetic
+ * --------------------
+ *      handles commands "add|sub|mul NAME M1 M2"; results are cached in the same way as in interactive mode
+ *
+ */
+static const char* _commandArithmetic( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *operands[2], *product;
+    const char *error;
+    int errorCode = 0;
+
+    if( ( error = _findDense( context, arguments[2], &operands[0] ) ) != NULL
+        || ( error = _findDense( context, arguments[3], &operands[1] ) ) != NULL )
+        return error;
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+
+    const int operation = strcmp( arguments[0], "add" ) == 0 ? CACHED_SUM
+                          : strcmp( arguments[0], "sub" ) == 0 ? CACHED_SUB : CACHED_MULTIPLY;
+    CacheKey key = makeCacheKey( operation, operands[0], operands[1], 0, 0 );
+    if( !cacheLookupMatrix( context->cache, key, &product ) )
+    {
+        if( operation == CACHED_SUM )
+            errorCode = sumSquareMatrix( operands[0], operands[1], &product );
+        else if( operation == CACHED_SUB )
+            errorCode = subSquareMatrix( operands[0], operands[1], &product );
+        else
+            errorCode = multiplySquareMatrix( operands[0], operands[1], &product );
+        if( errorCode == 0 )
+            cacheStoreMatrix( context->cache, key, product );
+    }
+
+    if( errorCode == -1 )
+        return "Out of memory";
+    else if( errorCode == -2 )
+        return "Matrices must have the same size";
+    else if( errorCode == -3 )
+        return "Result doesn't fit in long integer";
+    return _storeMatrix( context, arguments[1], product, result );
+}
+
+/*
+ * Function <private>:  _commandDeterminant
+ * --------------------
+ *      handles command "det MATRIX"
+ *
+ */
+static const char* _commandDeterminant( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+    long determinant;
+    int errorCode = 0;
+    const char *error = _findDense( context, arguments[1], &matrix );
+    if( error != NULL )
+        return error;
+
+    CacheKey key = makeCacheKey( CACHED_DETERMINANT, matrix, NULL, 0, 0 );
+    if( !cacheLookupScalar( context->cache, key, &determinant ) )
+    {
+        errorCode = detSquareMatrix( matrix, &determinant );
+        if( errorCode == 0 )
+            cacheStoreScalar( context->cache, key, determinant );
+    }
+
+    if( errorCode == -1 )
+        return "Out of memory";
+    else if( errorCode == -2 )
+        return "Result doesn't fit in long integer";
+    snprintf( result, MAX_BATCH_MESSAGE, "%ld", determinant );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandInverse
+ * --------------------
+ *      handles command "inverse NAME MATRIX"; adjugate is stored under NAME and result reports determinant
+ *
+ */
+static const char* _commandInverse( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix, *adjugate;
+    long determinant;
+    const char *error = _findDense( context, arguments[2], &matrix );
+    if( error != NULL )
+        return error;
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+
+    const int errorCode = inverseSquareMatrix( matrix, &adjugate, &determinant );
+    if( errorCode == -1 )
+        return "Out of memory";
+    else if( errorCode == -2 )
+        return "Result doesn't fit in long integer";
+    else if( errorCode == -3 )
+        return "Matrix is singular";
+    if( ( error = _storeMatrix( context, arguments[1], adjugate, result ) ) != NULL )
+        return error;
+
+    const size_t length = strlen( result );
+    snprintf( result + length, MAX_BATCH_MESSAGE - length, ", det %ld", determinant );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandPower
+ * --------------------
+ *      handles command "power NAME MATRIX EXP [MOD]"
+ *
+ */
+static const char* _commandPower( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix, *power;
+    long exponent, modulus = 0;
+    int errorCode = 0;
+    const char *error = _findDense( context, arguments[2], &matrix );
+    if( error != NULL )
+        return error;
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+    if( _parseLong( arguments[3], 0, LONG_MAX, &exponent ) != 0 )
+        return "Invalid exponent";
+    if( count == 5 && _parseLong( arguments[4], 1, LONG_MAX, &modulus ) != 0 )
+        return "Invalid modulus";
+
+    CacheKey key = makeCacheKey( modulus == 0 ? CACHED_POWER : CACHED_POWER_MOD, matrix, NULL, exponent, modulus );
+    if( !cacheLookupMatrix( context->cache, key, &power ) )
+    {
+        if( modulus == 0 )
+            errorCode = powerSquareMatrix( matrix, ( unsigned long )exponent, &power );
+        else
+            errorCode = powerSquareMatrixMod( matrix, ( unsigned long )exponent, modulus, &power );
+        if( errorCode == 0 )
+            cacheStoreMatrix( context->cache, key, power );
+    }
+
+    if( errorCode == -1 )
+        return "Out of memory";
+    else if( errorCode != 0 )
+        return "Result doesn't fit in long integer";
+    return _storeMatrix( context, arguments[1], power, result );
+}
+
+/*
+ * Function <private>:  _commandChain
+ * --------------------
+ *      handles command "chain NAME M1 M2 ..."; result reports estimated FLOPs of chosen and left-to-right order
+ *
+ */
+static const char* _commandChain( BatchContext *context, char **arguments, int count, char *result )
+{
+    ChainOperand *factors = malloc( sizeof( ChainOperand ) * ( size_t )( count - 2 ) ), product;
+    ChainPlan *plan = NULL;
+    WorkspacePool *pool = NULL;
+    const char *error = NULL;
+    int errorCode = 0;
+
+    if( factors == NULL )
+        return "Out of memory";
+    for( int i = 0; i < count - 2 && error == NULL; i++ )
+    {
+        factors[i].sparse = NULL;
+        error = _findDense( context, arguments[i + 2], &factors[i].dense );
+    }
+    if( error == NULL && !isValidMatrixName( arguments[1] ) )
+        error = "Invalid name";
+    if( error == NULL && ( errorCode = planMatrixChain( factors, count - 2, &plan ) ) == 0
+        && ( errorCode = createWorkspacePool( plan->size, &pool ) ) == 0 )
+        errorCode = multiplyMatrixChain( factors, plan, pool, &product );
+    free( factors );
+    deleteWorkspacePool( pool );
+
+    if( error == NULL && errorCode == -1 )
+        error = "Out of memory";
+    else if( error == NULL && errorCode == -2 )
+        error = "Matrices must have the same size";
+    else if( error == NULL && errorCode == -3 )
+        error = "Result doesn't fit in long integer";
+    if( error == NULL && ( error = _storeMatrix( context, arguments[1], product.dense, result ) ) == NULL )
+    {
+        const size_t used = strlen( result );
+        snprintf( result + used, MAX_BATCH_MESSAGE - used, " %.0f flops (left to right %.0f)", 2 * plan->cost[count - 3],
+                  2 * plan->sequentialCost );
+    }
+    deleteChainPlan( plan );
+    return error;
+}
+
+/*
+ * Function <private>:  _commandTranspose
+ * --------------------
+ *      handles command "transpose NAME MATRIX"
+ *
+ */
+static const char* _commandTranspose( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix, *transposition;
+    const char *error;
+
+    if( ( error = _findDense( context, arguments[2], &matrix ) ) != NULL )
+        return error;
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+    if( transposeSquareMatrix( matrix, &transposition ) != 0 )
+        return "Out of memory";
+    return _storeMatrix( context, arguments[1], transposition, result );
+}
+
+/*
+ * Function <private>:  _printBigIntegers
+ * --------------------
+ *      prints line starting with label and followed by given numbers, all separated by tabs
+ *
+ *      returns: length of the longest number, -1 on out of memory
+ *
+ */
+static int _printBigIntegers( FILE *output, const char *label, BigInteger *numbers, int count, LimbArena *scratch )
+{
+    int longest = 0;
+
+    fputs( label, output );
+    for( int i = 0; i < count; i++ )
+    {
+        char *text = malloc( bigIntegerDecimalLength( &numbers[i] ) );
+        const int length = text == NULL ? -1 : bigIntegerToString( &numbers[i], text, scratch );
+        if( length < 0 )
+        {
+            free( text );
+            fputc( '\n', output );
+            return -1;
+        }
+        fprintf( output, "\t%s", text );
+        longest = length > longest ? length : longest;
+        free( text );
+    }
+    fputc( '\n', output );
+    return longest;
+}
+
+/*
+ * Function <private>:  _commandExact
+ * --------------------
+ *      handles commands "exact add|sub|mul M1 M2", "exact power MATRIX EXP" and "exact det MATRIX"; result reports
+ *      number of digits of the longest printed number
+ *
+ */
+static const char* _commandExact( BatchContext *context, char **arguments, int count, char *result )
+{
+    const char *operation = arguments[1], *error = NULL;
+    const int binary = strcmp( operation, "add" ) == 0 || strcmp( operation, "sub" ) == 0 || strcmp( operation, "mul" ) == 0;
+    BigMatrix *operands[2] = { NULL, NULL }, *output = NULL;
+    Matrix *matrices[2] = { NULL, NULL };
+    long exponent = 0;
+    int errorCode = 0, longest = 0;
+    LimbArena scratch;
+
+    if( !binary && strcmp( operation, "power" ) != 0 && strcmp( operation, "det" ) != 0 )
+        return "Unknown operation";
+    if( count != ( strcmp( operation, "det" ) == 0 ? 3 : 4 ) )
+        return "Wrong number of arguments";
+    if( ( error = _findDense( context, arguments[2], &matrices[0] ) ) != NULL
+        || ( binary && ( error = _findDense( context, arguments[3], &matrices[1] ) ) != NULL ) )
+        return error;
+    if( strcmp( operation, "power" ) == 0 && _parseLong( arguments[3], 0, LONG_MAX, &exponent ) != 0 )
+        return "Invalid exponent";
+
+    initLimbArena( &scratch );
+    for( int i = 0; i < 2 && errorCode == 0; i++ )
+        if( matrices[i] != NULL )
+            errorCode = bigMatrixFromMatrix( matrices[i], &operands[i] );
+
+    if( errorCode == 0 && strcmp( operation, "det" ) == 0 )
+    {
+        BigInteger determinant = { 0 };
+        if( ( errorCode = detBigMatrix( operands[0], &determinant, &scratch ) ) == 0 )
+            errorCode = ( longest = _printBigIntegers( context->output, "value", &determinant, 1, &scratch ) ) < 0 ? -1 : 0;
+    } else if( errorCode == 0 )
+    {
+        if( strcmp( operation, "add" ) == 0 )
+            errorCode = sumBigMatrix( operands[0], operands[1], &output );
+        else if( strcmp( operation, "sub" ) == 0 )
+            errorCode = subBigMatrix( operands[0], operands[1], &output );
+        else if( strcmp( operation, "mul" ) == 0 )
+            errorCode = multiplyBigMatrix( operands[0], operands[1], &output );
+        else
+            errorCode = powerBigMatrix( operands[0], ( unsigned long )exponent, &output );
+
+        for( int row = 0; errorCode == 0 && row < output->size; row++ )
+        {
+            const int length = _printBigIntegers( context->output, "row", output->elements[row], output->size, &scratch );
+            errorCode = length < 0 ? -1 : 0;
+            longest = length > longest ? length : longest;
+        }
+    }
+
+    if( errorCode == 0 )
+        snprintf( result, MAX_BATCH_MESSAGE, "longest number has %d characters", longest );
+    deleteBigMatrix( operands[0] );
+    deleteBigMatrix( operands[1] );
+    deleteBigMatrix( output );
+    freeLimbArena( &scratch );
+    return errorCode == 0 ? NULL : errorCode == -2 ? "Matrices have different sizes" : "Out of memory";
+}
+
+/*
+ * Function <private>:  _commandCharacteristicPolynomial
+ * --------------------
+ *      handles command "charpoly MATRIX"
+ *
+ */
+static const char* _commandCharacteristicPolynomial( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+    LimbArena arena;
+    const char *error = _findDense( context, arguments[1], &matrix );
+    if( error != NULL )
+        return error;
+
+    BigInteger *coefficients = calloc( ( size_t )matrix->size + 1, sizeof( BigInteger ) );
+    initLimbArena( &arena );
+    if( coefficients == NULL || characteristicPolynomial( matrix, coefficients, &arena ) != 0
+        || _printBigIntegers( context->output, "coefficients", coefficients, matrix->size + 1, &arena ) < 0 )
+        error = "Out of memory";
+    else
+        snprintf( result, MAX_BATCH_MESSAGE, "degree %d", matrix->size );
+    freeLimbArena( &arena );
+    free( coefficients );
+    return error;
+}
+
+/*
+ * Function <private>:  _commandEigenvalues
+ * --------------------
+ *      handles command "eigen MATRIX"; result reports number of real eigenvalues
+ *
+ */
+static const char* _commandEigenvalues( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+    const char *error = _findDense( context, arguments[1], &matrix );
+    int errorCode, realCount = 0;
+    if( error != NULL )
+        return error;
+
+    double *real = malloc( sizeof( double ) * ( ( size_t )matrix->size + 1 ) );
+    double *imaginary = malloc( sizeof( double ) * ( ( size_t )matrix->size + 1 ) );
+    errorCode = real == NULL || imaginary == NULL ? -1 : eigenvaluesSquareMatrix( matrix, real, imaginary );
+    if( errorCode == 0 )
+    {
+        for( int i = 0; i < matrix->size; i++ )
+        {
+            fprintf( context->output, "eigenvalue\t%.17g\t%.17g\n", real[i], imaginary[i] );
+            realCount += imaginary[i] == 0.0;
+        }
+        snprintf( result, MAX_BATCH_MESSAGE, "%d real, %d complex", realCount, matrix->size - realCount );
+    }
+    free( real );
+    free( imaginary );
+    return errorCode == 0 ? NULL : errorCode == -2 ? "QR algorithm didn't converge" : "Out of memory";
+}
+
+/*
+ * Function <private>:  _createBulk
+ * --------------------
+ *      selects matrices for bulk operation; size argument (optional, may be NULL) limits them to one size
+ *
+ */
+static const char* _createBulk( BatchContext *context, const char *sizeArgument, BulkOperation **operation )
+{
+    long size = -1;
+
+    if( sizeArgument != NULL && _parseLong( sizeArgument, 0, INT_MAX, &size ) != 0 )
+        return "Invalid size";
+    if( createBulkOperation( context->registry, ( int )size, operation ) != 0 )
+        return "Out of memory";
+    return NULL;
+}
+
+/*
+ * Function <private>:  _printBulkItem
+ * --------------------
+ *      prints line "item", id and name (or '-') of matrix and result of operation on it, all separated by tabs
+ *
+ */
+static void _printBulkItem( BatchContext *context, BulkItem *item, const char *value )
+{
+    fprintf( context->output, "item\t%d\t%s\t%s\n", item->entry->id, item->entry->name[0] != 0 ? item->entry->name : "-",
+             value );
+}
+
+/*
+ * Function <private>:  _commandDeterminantAll
+ * --------------------
+ *      handles command "detall [SIZE]"
+ *
+ */
+static const char* _commandDeterminantAll( BatchContext *context, char **arguments, int count, char *result )
+{
+    BulkOperation *operation;
+    LimbArena scratch;
+    const char *error = _createBulk( context, count == 2 ? arguments[1] : NULL, &operation );
+    if( error != NULL )
+        return error;
+
+    bulkDeterminants( operation );
+    initLimbArena( &scratch );
+    for( int i = 0; i < operation->count; i++ )
+    {
+        BulkItem *item = &operation->items[i];
+        char *text = item->errorCode != 0 ? NULL : malloc( bigIntegerDecimalLength( &item->determinant ) );
+        if( text == NULL || bigIntegerToString( &item->determinant, text, &scratch ) < 0 )
+            _printBulkItem( context, item, "Out of memory" );
+        else
+            _printBulkItem( context, item, text );
+        free( text );
+    }
+    snprintf( result, MAX_BATCH_MESSAGE, "%d matrices, %d threads", operation->count, operation->threads );
+    freeLimbArena( &scratch );
+    deleteBulkOperation( operation );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandMultiplyAll
+ * --------------------
+ *      handles command "mulall MATRIX"
+ *
+ */
+static const char* _commandMultiplyAll( BatchContext *context, char **arguments, int count, char *result )
+{
+    BulkOperation *operation;
+    Matrix *factor;
+    const char *error = _findDense( context, arguments[1], &factor );
+    if( error != NULL || ( error = _createBulk( context, NULL, &operation ) ) != NULL )
+        return error;
+
+    bulkMultiply( operation, factor );                      // All products are ready before any of them is stored
+
+    int stored = 0;
+    for( int i = 0; i < operation->count; i++ )
+    {
+        BulkItem *item = &operation->items[i];
+        char value[MAX_BATCH_MESSAGE];
+        int id;
+        if( item->errorCode == 0 && registryAdd( context->registry, NULL, item->product, NULL, &id ) != 0 )
+            item->errorCode = -1;
+        if( item->errorCode == 0 )
+        {
+            item->product = NULL;                           // Owned by registry now
+            snprintf( value, sizeof( value ), "#%d", id );
+            stored++;
+        } else
+            snprintf( value, sizeof( value ), "%s", item->errorCode == -1 ? "Out of memory" : item->errorCode == -2
+                      ? "Matrices must have the same size" : "Result doesn't fit in long integer" );
+        _printBulkItem( context, item, value );
+    }
+    snprintf( result, MAX_BATCH_MESSAGE, "%d of %d matrices, %d threads", stored, operation->count, operation->threads );
+    deleteBulkOperation( operation );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandSumAll
+ * --------------------
+ *      handles command "sumall NAME [SIZE]"
+ *
+ */
+static const char* _commandSumAll( BatchContext *context, char **arguments, int count, char *result )
+{
+    BulkOperation *operation;
+    Matrix *sum;
+    const char *error = _createBulk( context, count == 3 ? arguments[2] : NULL, &operation );
+    if( error != NULL )
+        return error;
+    if( !isValidMatrixName( arguments[1] ) )
+    {
+        deleteBulkOperation( operation );
+        return "Invalid name";
+    }
+
+    const int errorCode = bulkSum( operation, &sum );
+    const int summed = operation->count, threads = operation->threads;
+    deleteBulkOperation( operation );                       // Registry can be modified now
+    if( errorCode == -1 )
+        return "Out of memory";
+    else if( errorCode == -2 )
+        return summed == 0 ? "No matrices" : "Matrices must have the same size";
+    else if( errorCode == -3 )
+        return "Result doesn't fit in long integer";
+    if( ( error = _storeMatrix( context, arguments[1], sum, result ) ) == NULL )
+    {
+        const size_t used = strlen( result );
+        snprintf( result + used, MAX_BATCH_MESSAGE - used, " sum of %d matrices, %d threads", summed, threads );
+    }
+    return error;
+}
+
+/*
+ * Function <private>:  _parseModulus
+ * --------------------
+ *      converts argument to prime modulus of GF(p)
+ *
+ *      returns: 0 on success, -1 if argument isn't valid modulus
+ *
+ */
+static int _parseModulus( const char *string, long *modulus )
+{
+    return _parseLong( string, 2, MODULAR_MAX_MODULUS, modulus ) == 0 && isValidModulus( *modulus ) ? 0 : -1;
+}
+
+/*
+ * Function <private>:  _commandModularRank
+ * --------------------
+ *      handles command "modrank MATRIX P" (matrix can be stored as dense or sparse one)
+ *
+ */
+static const char* _commandModularRank( BatchContext *context, char **arguments, int count, char *result )
+{
+    RegistryEntry *entry = registryFind( context->registry, arguments[1] );
+    long modulus;
+    int rank;
+
+    if( entry == NULL )
+        return "No such matrix";
+    if( _parseModulus( arguments[2], &modulus ) != 0 )
+        return "Modulus must be prime not greater than 2^31 - 1";
+    if( ( entry->dense != NULL ? rankModular( entry->dense, modulus, &rank )
+                               : rankSparseModular( entry->sparse, modulus, &rank ) ) != 0 )
+        return "Out of memory";
+    snprintf( result, MAX_BATCH_MESSAGE, "rank %d", rank );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandModular
+ * --------------------
+ *      handles commands "modrref NAME MATRIX P", "modnull NAME MATRIX P" and "modsolve NAME A B P"
+ *
+ */
+static const char* _commandModular( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *a, *b = NULL, *output;
+    const char *error;
+    long modulus;
+    int value = 0, errorCode;
+
+    if( count != ( strcmp( arguments[0], "modsolve" ) == 0 ? 5 : 4 ) )
+        return "Wrong number of arguments";
+    if( ( error = _findDense( context, arguments[2], &a ) ) != NULL
+        || ( count == 5 && ( error = _findDense( context, arguments[3], &b ) ) != NULL ) )
+        return error;
+    if( _parseModulus( arguments[count - 1], &modulus ) != 0 )
+        return "Modulus must be prime not greater than 2^31 - 1";
+    if( !isValidMatrixName( arguments[1] ) )
+        return "Invalid name";
+
+    if( strcmp( arguments[0], "modrref" ) == 0 )
+        errorCode = reducedEchelonModular( a, modulus, &output, &value );
+    else if( strcmp( arguments[0], "modnull" ) == 0 )
+        errorCode = nullSpaceModular( a, modulus, &output, &value );
+    else
+        errorCode = solveModular( a, b, modulus, &output );
+
+    if( errorCode == -1 )
+        return "Out of memory";
+    else if( errorCode == -2 )
+        return "Matrices must have the same size";
+    else if( errorCode == MODULAR_NO_SOLUTION )
+        return "System has no solution";
+    if( ( error = _storeMatrix( context, arguments[1], output, result ) ) == NULL && count == 4 )
+    {
+        const size_t used = strlen( result );
+        snprintf( result + used, MAX_BATCH_MESSAGE - used, strcmp( arguments[0], "modrref" ) == 0 ? " rank %d"
+                  : " nullity %d", value );
+    }
+    return error;
+}
+
+/*
+ * Function <private>:  _commandPrint
+ * --------------------
+ *      handles command "print MATRIX"
+ *
+ */
+static const char* _commandPrint( BatchContext *context, char **arguments, int count, char *result )
+{
+    Matrix *matrix;
+    const char *error = _findDense( context, arguments[1], &matrix );
+    if( error != NULL )
+        return error;
+
+    for( int row = 0; row < matrix->size; row++ )
+    {
+        fputs( "row", context->output );
+        for( int col = 0; col < matrix->size; col++ )
+            fprintf( context->output, "\t%ld", matrix->elements[row][col] );
+        fputc( '\n', context->output );
+    }
+    snprintf( result, MAX_BATCH_MESSAGE, "%dx%d", matrix->size, matrix->size );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandDelete
+ * --------------------
+ *      handles command "delete MATRIX"
+ *
+ */
+static const char* _commandDelete( BatchContext *context, char **arguments, int count, char *result )
+{
+    RegistryEntry *entry = registryFind( context->registry, arguments[1] );
+    if( entry == NULL )
+        return "No such matrix";
+    registryRemove( context->registry, entry->id );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _commandStatistics
+ * --------------------
+ *      stats [PATH] - writes statistics of operations as JSON to file PATH or, without path, as one line "stats",
+ *      then JSON object
+ *
+ */
+static const char* _commandStatistics( BatchContext *context, char **arguments, int count, char *result )
+{
+    if( count == 1 )
+    {
+        fputs( "stats\t", context->output );
+        writeProfileJson( context->output );
+        fputc( '\n', context->output );
+        return NULL;
+    }
+
+    FILE *file = fopen( arguments[1], "w" );
+    if( file == NULL )
+        return "Can't write to file";
+    writeProfileJson( file );
+    fputc( '\n', file );
+    return fclose( file ) == 0 ? NULL : "Can't write to file";
+}
+
+/*
+ * Function <private>:  _commandProfile
+ * --------------------
+ *      profile on|off|reset|counters|nocounters - enables|disables measuring of operations, clears their statistics
+ *      or enables|disables hardware counters
+ *
+ */
+static const char* _commandProfile( BatchContext *context, char **arguments, int count, char *result )
+{
+    if( strcmp( arguments[1], "on" ) == 0 || strcmp( arguments[1], "off" ) == 0 )
+        enableProfiling( strcmp( arguments[1], "on" ) == 0 );
+    else if( strcmp( arguments[1], "reset" ) == 0 )
+        resetProfiler();
+    else if( strcmp( arguments[1], "counters" ) == 0 )
+    {
+        if( enableHardwareCounters( 1 ) != 0 )
+            return "Hardware counters aren't available";
+    } else if( strcmp( arguments[1], "nocounters" ) == 0 )
+        enableHardwareCounters( 0 );
+    else
+        return "Unknown profiler action";
+    return NULL;
+}
+
+// All commands available in scripts
+static const BatchCommand batchCommands[] = {
+    { "create", 2, 2, _commandCreate },
+    { "generate", 3, 8, _commandGenerate },
+    { "fill", 1, -1, _commandFill },                // Number of values is checked by handler
+    { "load", 2, 2, _commandLoad },
+    { "save", 2, 2, _commandSave },
+    { "mulfile", 3, 4, _commandMultiplyFiles },
+    { "add", 3, 3, _commandArithmetic },
+    { "sub", 3, 3, _commandArithmetic },
+    { "mul", 3, 3, _commandArithmetic },
+    { "det", 1, 1, _commandDeterminant },
+    { "inverse", 2, 2, _commandInverse },
+    { "power", 3, 4, _commandPower },
+    { "chain", 3, -1, _commandChain },
+    { "transpose", 2, 2, _commandTranspose },
+    { "exact", 2, 3, _commandExact },               // Number of arguments depends on operation
+    { "charpoly", 1, 1, _commandCharacteristicPolynomial },
+    { "eigen", 1, 1, _commandEigenvalues },
+    { "detall", 0, 1, _commandDeterminantAll },
+    { "mulall", 1, 1, _commandMultiplyAll },
+    { "sumall", 1, 2, _commandSumAll },
+    { "modrank", 2, 2, _commandModularRank },
+    { "modrref", 3, 3, _commandModular },
+    { "modnull", 3, 3, _commandModular },
+    { "modsolve", 4, 4, _commandModular },
+    { "stats", 0, 1, _commandStatistics },
+    { "profile", 1, 1, _commandProfile },
+    { "print", 1, 1, _commandPrint },
+    { "delete", 1, 1, _commandDelete },
+};
+
+/*
+ * Function <private>:  _splitLine
+ * --------------------
+ *      splits line (in place) into words separated by white characters; array of words is enlarged if needed
+ *
+ *      words:    pointer to array of pointers to words (can point to NULL at the beginning)
+ *      capacity: pointer to length of array of words
+ *
+ *      returns: number of words, -1 on out of memory
+ *
+ */
+static int _splitLine( char *line, char ***words, int *capacity )
+{
+    int count = 0;
+    char *state;
+
+    for( char *word = strtok_r( line, " \t\r\n", &state ); word != NULL; word = strtok_r( NULL, " \t\r\n", &state ) )
+    {
+        if( count == *capacity )
+        {
+            int newCapacity = *capacity == 0 ? MAX_BATCH_ARGUMENTS : *capacity * 2;
+            char **enlarged = realloc( *words, ( size_t )newCapacity * sizeof( char* ) );
+            if( enlarged == NULL )
+                return -1;
+            *words = enlarged;
+            *capacity = newCapacity;
+        }
+        ( *words )[count++] = word;
+    }
+    return count;
+}
+
+/*
+ * Function <private>:  _elapsedMilliseconds
+ * --------------------
+ *      returns time elapsed since "start" (read from monotonic clock) in milliseconds
+ *
+ */
+static double _elapsedMilliseconds( const struct timespec *start )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( double )( now.tv_sec - start->tv_sec ) * 1e3 + ( double )( now.tv_nsec - start->tv_nsec ) / 1e6;
+}
+
+/*
+ * Function:  runBatchScript
+ * --------------------
+ *      executes all commands read from script (see description of this file); error in one command doesn't stop
+ *      execution of the following ones
+ *
+ *      script:   stream containing commands
+ *      output:   stream to which results are written
+ *      registry: registry in which matrices are stored
+ *      cache:    cache of results of operations
+ *
+ *      returns: 0 if all commands succeeded, -1 if any of them failed, -2 if script couldn't be read (out of
+ *               memory)
+ *
+ */
+int runBatchScript( FILE *script, FILE *output, MatrixRegistry *registry, ResultCache *cache )
+{
+    BatchContext context = { registry, cache, output };
+    char *line = NULL, **words = NULL;
+    size_t lineCapacity = 0;
+    int wordsCapacity = 0, lineNumber = 0, failed = 0;
+
+    while( getline( &line, &lineCapacity, script ) != -1 )
+    {
+        char result[MAX_BATCH_MESSAGE] = "";
+        const char *error = "Unknown command";
+        struct timespec start;
+
+        lineNumber++;
+        int count = _splitLine( line, &words, &wordsCapacity );
+        if( count == -1 )
+        {
+            free( line );
+            free( words );
+            return -2;
+        }
+        if( count == 0 || words[0][0] == '#' )      // Empty line or comment
+            continue;
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+        for( size_t i = 0; i < sizeof( batchCommands ) / sizeof( batchCommands[0] ); i++ )
+        {
+            const BatchCommand *command = &batchCommands[i];
+            if( strcmp( command->name, words[0] ) != 0 )
+                continue;
+            if( count - 1 < command->minArguments || ( command->maxArguments != -1 && count - 1 > command->maxArguments ) )
+                error = "Wrong number of arguments";
+            else
+                error = command->handler( &context, words, count, result );
+            break;
+        }
+
+        fprintf( output, "%s\t%d\t%s\t%.3f\t%s\n", error == NULL ? "ok" : "error", lineNumber, words[0],
+                 _elapsedMilliseconds( &start ), error == NULL ? result : error );
+        failed |= error != NULL;
+    }
+
+    free( line );
+    free( words );
+    return failed ? -1 : 0;
+}
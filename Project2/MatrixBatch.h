@@ -0,0 +1,26 @@
+/*
+ * File: MatrixBatch.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixBatch.c
+ */
+
+#ifndef PROJEKT2_MATRIXBATCH_H
+#define PROJEKT2_MATRIXBATCH_H
+
+#include <stdio.h>
+#include "MatrixRegistry.h"
+#include "ResultCache.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define MAX_BATCH_ARGUMENTS     16              // Initial length of array of words of line (grows for longer lines)
+#define MAX_BATCH_MESSAGE       128             // Maximal length of result or error message of command
+
+/************************************
+ * Function declarations
+ ************************************/
+int runBatchScript( FILE *script, FILE *output, MatrixRegistry *registry, ResultCache *cache );
+
+#endif //PROJEKT2_MATRIXBATCH_H
@@ -0,0 +1,509 @@
+/*
+ * File: MatrixBench.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Benchmark of operations on matrices (separate program, built and run with "make bench")
+ *
+ * Usage: MatrixBench [MAX_SIZE [SECONDS]]
+ * Every kernel (sum, product and determinant of every element type and every variant of implementation) is measured
+ * for sizes 2, 3, 4, 5, 6 (the biggest matrix edited interactively, where cost of call matters more than arithmetic),
+ * then 8, 16, ... up to MAX_SIZE (BENCHMARK_MAX_SIZE by default) or the biggest size kernel is practical for. After
+ * warmup calls, kernel is called until at least SECONDS (BENCHMARK_SECONDS by default) were spent, but at least
+ * BENCHMARK_MIN_REPETITIONS times; every call is timed separately, except calls shorter than
+ * BENCHMARK_MIN_SAMPLE_NS - reading clock would cost as much as the call, so consecutive calls are timed together
+ * and time of call is average of such sample. Threads are pinned to processors.
+ *
+ * Results are written to standard output as CSV, one line per kernel and size:
+ *      operation,element_type,variant,size,threads,warmups,repetitions,median_ns,p99_ns,gflops,gbps
+ * GFLOP/s is computed from nominal number of arithmetic operations of algorithm and GB/s from compulsory memory
+ * traffic (every element of inputs read and of output written once), both for median time.
+ */
+
+#include "SquareMatrix.h"
+#include "SmallMatrix.h"
+#include "SparseMatrix.h"
+#include "BigMatrix.h"
+#include "MatrixGenerators.h"
+#include "Parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define BENCHMARK_MAX_SIZE          4096        // Default size of the biggest benchmarked matrices
+#define BENCHMARK_SECONDS           0.2         // Default minimal time spent on measured calls of every case
+#define BENCHMARK_WARMUPS           2           // Calls before measurement (only one if call takes over SECONDS)
+#define BENCHMARK_MIN_REPETITIONS   3           // Minimal number of measured calls
+#define BENCHMARK_MAX_REPETITIONS   100000      // Maximal number of measured samples
+#define BENCHMARK_MIN_SAMPLE_NS     2000        // Shorter calls are timed in samples of consecutive calls...
+#define BENCHMARK_MAX_SAMPLE_CALLS  4096        // ...of at most so many calls
+#define BENCHMARK_VALUE_RANGE       9           // Elements of inputs are random from <-RANGE, RANGE>
+#define BENCHMARK_BANDWIDTH         2           // Diagonals on each side of main one in sparse inputs
+#define BENCHMARK_MODULUS           1000000007L // Modulus of modular product
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Formulas of work of kernels (n - size of matrices)
+enum BenchmarkCost {
+    COST_ELEMENTWISE,       // n^2 operations, two inputs and output of n^2 elements
+    COST_PRODUCT,           // 2n^3 operations, two inputs and output of n^2 elements
+    COST_SPARSE,            // Operations and traffic counted from non-zero elements
+    COST_LAPLACE,           // Operations of Laplace expansion, one input of n^2 elements
+    COST_ELIMINATION        // 2n^3/3 operations (multiplications and subtractions of elimination), one input
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Inputs of one size shared by all kernels
+struct BenchmarkInputs {
+    int size;
+    Matrix *a, *b;                              // Dense inputs
+    Matrix *output;                             // Preallocated output of kernels writing into existing matrix
+    SparseMatrix *sparseA, *sparseB;            // Banded inputs
+    BigMatrix *bigA, *bigB;                     // The same elements as a and b as integers of arbitrary size
+    LimbArena arena;                            // Limbs of big determinants
+    long sparseOperations;                      // Operations of sparse product (2 per pair of multiplied elements)
+    long sparseOutputNonZeros;                  // Non-zero elements of the last sparse result
+};
+typedef struct BenchmarkInputs BenchmarkInputs;
+
+// Benchmarked kernel; run returns 0 on success or error code of kernel
+struct BenchmarkKernel {
+    const char *operation;
+    const char *elementType;
+    const char *variant;
+    int maxSize;                                // The biggest size worth measuring (kernel is too slow above it)
+    int cost;                                   // One of BenchmarkCost values
+    int ( *run )( BenchmarkInputs *inputs );
+};
+typedef struct BenchmarkKernel BenchmarkKernel;
+
+/*
+ * Functions <private>:  _run*
+ * --------------------
+ *      call benchmarked function once and free its result
+ *
+ */
+static int _runSum( BenchmarkInputs *inputs )
+{
+    Matrix *output;
+    const int errorCode = sumSquareMatrix( inputs->a, inputs->b, &output );
+    if( errorCode == 0 )
+        deleteSquareMatrix( output );
+    return errorCode;
+}
+
+static int _runSumSmall( BenchmarkInputs *inputs )
+{
+    const int errorCode = sumSmallMatrix( inputs->a, inputs->b, inputs->output );
+    return errorCode == -3 ? 0 : errorCode;                 // Overflow only means output wrapped around
+}
+
+static int _runSumUnchecked( BenchmarkInputs *inputs )
+{
+    Matrix *output;
+    const int errorCode = sumSquareMatrixUnchecked( inputs->a, inputs->b, &output );
+    if( errorCode == 0 )
+        deleteSquareMatrix( output );
+    return errorCode;
+}
+
+static int _runSumSparse( BenchmarkInputs *inputs )
+{
+    SparseMatrix *output;
+    const int errorCode = sumSparseMatrix( inputs->sparseA, inputs->sparseB, &output );
+    if( errorCode == 0 )
+    {
+        inputs->sparseOutputNonZeros = output->nonZeros;
+        deleteSparseMatrix( output );
+    }
+    return errorCode;
+}
+
+static int _runSumBig( BenchmarkInputs *inputs )
+{
+    BigMatrix *output;
+    const int errorCode = sumBigMatrix( inputs->bigA, inputs->bigB, &output );
+    if( errorCode == 0 )
+        deleteBigMatrix( output );
+    return errorCode;
+}
+
+static int _runProduct( BenchmarkInputs *inputs )
+{
+    Matrix *output;
+    const int errorCode = multiplySquareMatrix( inputs->a, inputs->b, &output );
+    if( errorCode == 0 )
+        deleteSquareMatrix( output );
+    return errorCode;
+}
+
+static int _runProductInto( BenchmarkInputs *inputs )
+{
+    return multiplySquareMatrixInto( inputs->a, inputs->b, inputs->output );
+}
+
+static int _runProductUnchecked( BenchmarkInputs *inputs )
+{
+    Matrix *output;
+    const int errorCode = multiplySquareMatrixUnchecked( inputs->a, inputs->b, &output );
+    if( errorCode == 0 )
+        deleteSquareMatrix( output );
+    return errorCode;
+}
+
+static int _runProductModular( BenchmarkInputs *inputs )
+{
+    return multiplySquareMatrixModInto( inputs->a, inputs->b, BENCHMARK_MODULUS, inputs->output );
+}
+
+static int _runProductSparse( BenchmarkInputs *inputs )
+{
+    SparseMatrix *output;
+    const int errorCode = multiplySparseMatrix( inputs->sparseA, inputs->sparseB, &output );
+    if( errorCode == 0 )
+    {
+        inputs->sparseOutputNonZeros = output->nonZeros;
+        deleteSparseMatrix( output );
+    }
+    return errorCode;
+}
+
+static int _runProductBig( BenchmarkInputs *inputs )
+{
+    BigMatrix *output;
+    const int errorCode = multiplyBigMatrix( inputs->bigA, inputs->bigB, &output );
+    if( errorCode == 0 )
+        deleteBigMatrix( output );
+    return errorCode;
+}
+
+static int _runDeterminant( BenchmarkInputs *inputs )
+{
+    long determinant;
+    return detSquareMatrix( inputs->a, &determinant );
+}
+
+static int _runDeterminantSmall( BenchmarkInputs *inputs )
+{
+    long determinant;
+    return detSmallMatrix( inputs->a, &determinant );
+}
+
+static int _runInverse( BenchmarkInputs *inputs )
+{
+    Matrix *adjugate;
+    long determinant;
+    const int errorCode = inverseSquareMatrix( inputs->a, &adjugate, &determinant );
+    if( errorCode == 0 )
+        deleteSquareMatrix( adjugate );
+    return errorCode == -3 ? 0 : errorCode;                 // Singular input is valid measurement as well
+}
+
+static int _runDeterminantBig( BenchmarkInputs *inputs )
+{
+    const LimbArenaMark mark = markLimbArena( &inputs->arena );
+    BigInteger determinant = { 0 };
+    const int errorCode = detBigMatrix( inputs->bigA, &determinant, &inputs->arena );
+    releaseLimbArena( &inputs->arena, mark );
+    return errorCode;
+}
+
+// All benchmarked kernels
+static const BenchmarkKernel benchmarkKernels[] = {
+    { "sum", "long", "checked", 4096, COST_ELEMENTWISE, _runSum },
+    { "sum", "long", "wrapping", 4096, COST_ELEMENTWISE, _runSumUnchecked },
+    { "sum", "long", "small-into", SMALL_MATRIX_MAX_SIZE, COST_ELEMENTWISE, _runSumSmall },
+    { "sum", "sparse", "csr", 4096, COST_SPARSE, _runSumSparse },
+    { "sum", "big", "exact", 1024, COST_ELEMENTWISE, _runSumBig },
+    { "product", "long", "tiled", 4096, COST_PRODUCT, _runProduct },
+    { "product", "long", "tiled-into", 1024, COST_PRODUCT, _runProductInto },
+    { "product", "long", "wrapping", 2048, COST_PRODUCT, _runProductUnchecked },
+    { "product", "mod", "tiled-into", 1024, COST_PRODUCT, _runProductModular },
+    { "product", "sparse", "csr", 4096, COST_SPARSE, _runProductSparse },
+    { "product", "big", "exact", 256, COST_PRODUCT, _runProductBig },
+    { "determinant", "long", "laplace", 9, COST_LAPLACE, _runDeterminant },
+    { "determinant", "long", "small", SMALL_MATRIX_MAX_SIZE, COST_LAPLACE, _runDeterminantSmall },
+    { "determinant", "big", "bareiss", 256, COST_ELIMINATION, _runDeterminantBig },
+    { "inverse", "long", "adjugate", 8, COST_LAPLACE, _runInverse },
+};
+
+/*
+ * Function <private>:  _deleteInputs
+ * --------------------
+ *      frees all inputs (some of them may be NULL)
+ *
+ */
+static void _deleteInputs( BenchmarkInputs *inputs )
+{
+    deleteSquareMatrix( inputs->a );
+    deleteSquareMatrix( inputs->b );
+    deleteSquareMatrix( inputs->output );
+    deleteSparseMatrix( inputs->sparseA );
+    deleteSparseMatrix( inputs->sparseB );
+    deleteBigMatrix( inputs->bigA );
+    deleteBigMatrix( inputs->bigB );
+    freeLimbArena( &inputs->arena );
+}
+
+/*
+ * Function <private>:  _createInputs
+ * --------------------
+ *      creates random inputs of given size (the same for every run of benchmark); inputs of big integers are
+ *      created only if some kernel of this element type is measured for this size
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _createInputs( int size, int maxBigSize, BenchmarkInputs *inputs )
+{
+    GeneratorOptions options = { GENERATE_RANDOM, 1, -BENCHMARK_VALUE_RANGE, BENCHMARK_VALUE_RANGE,
+                                 BENCHMARK_BANDWIDTH, BENCHMARK_BANDWIDTH };
+    Matrix *banded = NULL;
+
+    memset( inputs, 0, sizeof( BenchmarkInputs ) );
+    inputs->size = size;
+    initLimbArena( &inputs->arena );
+    if( createSquareMatrix( size, &inputs->a ) != 0 || createSquareMatrix( size, &inputs->b ) != 0 ||
+        createSquareMatrix( size, &inputs->output ) != 0 || createSquareMatrix( size, &banded ) != 0 )
+    {
+        deleteSquareMatrix( banded );
+        return -1;
+    }
+    generateMatrix( inputs->a, &options );
+    options.seed = 2;
+    generateMatrix( inputs->b, &options );
+    options.pattern = GENERATE_BANDED;
+    generateMatrix( banded, &options );
+
+    int errorCode = denseToSparseMatrix( banded, &inputs->sparseA ) != 0 ||
+                    denseToSparseMatrix( banded, &inputs->sparseB ) != 0 ? -1 : 0;
+    deleteSquareMatrix( banded );
+    if( errorCode == 0 && size <= maxBigSize )
+        errorCode = bigMatrixFromMatrix( inputs->a, &inputs->bigA ) != 0 ||
+                    bigMatrixFromMatrix( inputs->b, &inputs->bigB ) != 0 ? -1 : 0;
+    if( errorCode != 0 )
+        return -1;
+
+    // Every element a(r, k) is multiplied by all elements of row k of b
+    const SparseMatrix *a = inputs->sparseA, *b = inputs->sparseB;
+    for( long i = 0; i < a->nonZeros; i++ )
+        inputs->sparseOperations += 2 * ( b->rowOffsets[a->columns[i] + 1] - b->rowOffsets[a->columns[i]] );
+    return 0;
+}
+
+/*
+ * Function <private>:  _laplaceOperations
+ * --------------------
+ *      returns number of multiplications and additions of Laplace expansion of matrix of given size
+ *
+ */
+static double _laplaceOperations( int size )
+{
+    double operations = 0;
+    for( int minorSize = 2; minorSize <= size; minorSize++ )
+        operations = ( operations + 2 ) * minorSize;
+    return operations;
+}
+
+/*
+ * Function <private>:  _costOfKernel
+ * --------------------
+ *      computes nominal number of arithmetic operations and compulsory memory traffic (in bytes) of one call
+ *
+ */
+static void _costOfKernel( const BenchmarkKernel *kernel, const BenchmarkInputs *inputs, double *operations,
+                           double *bytes )
+{
+    const double n = inputs->size, elements = n * n, element = sizeof( long );
+    const double sparseElement = sizeof( long ) + sizeof( int );               // Value and column
+    const double sparseInputs = ( double )( inputs->sparseA->nonZeros + inputs->sparseB->nonZeros );
+
+    switch( kernel->cost )
+    {
+        case COST_ELEMENTWISE:
+            *operations = elements;
+            *bytes = 3 * elements * element;
+            break;
+        case COST_PRODUCT:
+            *operations = 2 * elements * n;
+            *bytes = 3 * elements * element;
+            break;
+        case COST_SPARSE:
+            *operations = kernel->run == _runSumSparse ? sparseInputs : ( double )inputs->sparseOperations;
+            *bytes = ( sparseInputs + ( double )inputs->sparseOutputNonZeros ) * sparseElement;
+            break;
+        case COST_LAPLACE:
+            *operations = _laplaceOperations( inputs->size );
+            *bytes = elements * element;
+            break;
+        default:
+            *operations = 2 * elements * n / 3;
+            *bytes = elements * element;
+            break;
+    }
+}
+
+/*
+ * Function <private>:  _elapsedNanoseconds
+ * --------------------
+ *      returns time elapsed since "start" (read from monotonic clock) in nanoseconds
+ *
+ */
+static double _elapsedNanoseconds( const struct timespec *start )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( double )( now.tv_sec - start->tv_sec ) * 1e9 + ( double )( now.tv_nsec - start->tv_nsec );
+}
+
+/*
+ * Function <private>:  _compareDoubles
+ * --------------------
+ *      orders numbers ascending (for qsort)
+ *
+ */
+static int _compareDoubles( const void *a, const void *b )
+{
+    const double first = *( const double* )a, second = *( const double* )b;
+    return first < second ? -1 : first > second;
+}
+
+/*
+ * Function <private>:  _timeSample
+ * --------------------
+ *      calls kernel given number of times in a row
+ *
+ *      returns: 0 on success, error code of kernel otherwise; time of all calls (in nanoseconds) is stored in time
+ *
+ */
+static int _timeSample( const BenchmarkKernel *kernel, BenchmarkInputs *inputs, int calls, double *time )
+{
+    struct timespec start;
+    int errorCode = 0;
+
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    for( int call = 0; call < calls && errorCode == 0; call++ )
+        errorCode = kernel->run( inputs );
+    *time = _elapsedNanoseconds( &start );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _measureKernel
+ * --------------------
+ *      measures kernel on given inputs and prints line of CSV
+ *
+ *      seconds: minimal time spent on measured calls
+ *
+ *      returns: 0 on success, error code of kernel (or -1 on out of memory) otherwise
+ *
+ */
+static int _measureKernel( const BenchmarkKernel *kernel, BenchmarkInputs *inputs, double seconds )
+{
+    double last = 0, operations, bytes;
+    int warmups = 0, calls = 1, errorCode;
+
+    while( warmups < BENCHMARK_WARMUPS && ( warmups == 0 || last < seconds * 1e9 ) )
+    {
+        if( ( errorCode = _timeSample( kernel, inputs, 1, &last ) ) != 0 )
+            return errorCode;
+        warmups++;
+    }
+    while( last < BENCHMARK_MIN_SAMPLE_NS && calls < BENCHMARK_MAX_SAMPLE_CALLS )     // Find length of sample
+    {
+        calls *= 2;
+        if( ( errorCode = _timeSample( kernel, inputs, calls, &last ) ) != 0 )
+            return errorCode;
+    }
+
+    double estimated = seconds * 1e9 / ( last > 1 ? last : 1 );
+    const int repetitions = estimated < BENCHMARK_MIN_REPETITIONS ? BENCHMARK_MIN_REPETITIONS :
+                            estimated > BENCHMARK_MAX_REPETITIONS ? BENCHMARK_MAX_REPETITIONS : ( int )estimated;
+    double *times = malloc( sizeof( double ) * ( size_t )repetitions );
+    if( times == NULL )
+        return -1;
+    for( int repetition = 0; repetition < repetitions; repetition++ )
+    {
+        if( ( errorCode = _timeSample( kernel, inputs, calls, &times[repetition] ) ) != 0 )
+        {
+            free( times );
+            return errorCode;
+        }
+        times[repetition] /= calls;
+    }
+
+    qsort( times, ( size_t )repetitions, sizeof( double ), _compareDoubles );
+    const double median = times[( repetitions - 1 ) / 2];
+    const double p99 = times[( repetitions * 99 + 99 ) / 100 - 1];            // Nearest rank: ceil(0.99 * count)
+    _costOfKernel( kernel, inputs, &operations, &bytes );
+    printf( "%s,%s,%s,%d,%d,%d,%d,%.0f,%.0f,%.4f,%.4f\n", kernel->operation, kernel->elementType, kernel->variant,
+            inputs->size, availableThreads(), warmups, repetitions, median, p99, operations / median,
+            bytes / median );
+    fflush( stdout );
+    free( times );
+    return 0;
+}
+
+/*
+ * Function:  main
+ * --------------------
+ *      parses arguments and measures all kernels for all sizes
+ *
+ *      returns: 0 on success, 1 if some kernel failed, 2 on wrong arguments
+ *
+ */
+int main( int argc, char **argv )
+{
+    const int numberOfKernels = sizeof( benchmarkKernels ) / sizeof( benchmarkKernels[0] );
+    char *end = NULL;
+    long maxSize = BENCHMARK_MAX_SIZE;
+    double seconds = BENCHMARK_SECONDS;
+    int failed = 0, maxBigSize = 0;
+
+    if( argc > 1 )
+        maxSize = strtol( argv[1], &end, 10 );
+    if( argc > 3 || ( end != NULL && *end != '\0' ) || maxSize < 2 || maxSize > BENCHMARK_MAX_SIZE ||
+        ( argc > 2 && ( seconds = strtod( argv[2], &end ), *end != '\0' || seconds <= 0 ) ) )
+    {
+        fprintf( stderr, "Usage: %s [MAX_SIZE (2-%d) [SECONDS]]\n", argv[0], BENCHMARK_MAX_SIZE );
+        return 2;
+    }
+    if( pinParallelThreads( 1 ) != 0 )
+        fputs( "Can't pin threads to processors - results may be less stable\n", stderr );
+    for( int kernel = 0; kernel < numberOfKernels; kernel++ )
+        if( strcmp( benchmarkKernels[kernel].elementType, "big" ) == 0 && benchmarkKernels[kernel].maxSize > maxBigSize )
+            maxBigSize = benchmarkKernels[kernel].maxSize;
+
+    puts( "operation,element_type,variant,size,threads,warmups,repetitions,median_ns,p99_ns,gflops,gbps" );
+    for( int size = 2; size <= maxSize; size = size < 6 ? size + 1 : size == 6 ? 8 : size * 2 )
+    {
+        BenchmarkInputs inputs;
+        if( _createInputs( size, maxBigSize, &inputs ) != 0 )
+        {
+            fprintf( stderr, "Out of memory while creating inputs of size %d\n", size );
+            _deleteInputs( &inputs );
+            return 1;
+        }
+        for( int kernel = 0; kernel < numberOfKernels; kernel++ )
+        {
+            const BenchmarkKernel *measured = &benchmarkKernels[kernel];
+            if( size > measured->maxSize )
+                continue;
+            const int errorCode = _measureKernel( measured, &inputs, seconds );
+            if( errorCode != 0 )
+            {
+                fprintf( stderr, "%s %s %s of size %d failed with error code %d\n", measured->operation,
+                         measured->elementType, measured->variant, size, errorCode );
+                failed = 1;
+            }
+        }
+        _deleteInputs( &inputs );
+    }
+    return failed;
+}
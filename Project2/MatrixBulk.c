@@ -0,0 +1,295 @@
+/*
+ * File: MatrixBulk.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Operations on all stored matrices at once - matrices are independent, so every thread takes next
+ *              matrix when it finishes previous one (the biggest matrices go first, so no thread is left with one
+ *              big matrix at the end); aggregates are computed with tree reduction
+ */
+
+#include "MatrixBulk.h"
+#include "BigMatrix.h"
+#include <stdlib.h>
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Context of visitor collecting matrices from registry
+struct BulkCollector {
+    BulkItem *items;
+    int count;
+};
+typedef struct BulkCollector BulkCollector;
+
+// Item sorted by size of its matrix (comparator needs no other state, so sorting is reentrant)
+struct SizedItem {
+    int size;                                   // Size of matrix of item
+    int index;                                  // Index of item
+};
+typedef struct SizedItem SizedItem;
+
+// Context of one round of tree reduction
+struct SumRound {
+    Matrix **partial;                           // Partial sums - partial[i] is sum of items <i, i + step)
+    int *owned;                                 // Non-zero if partial sum was computed (and has to be freed)
+    int count;                                  // Number of items
+    int step;                                   // Number of items summed in every partial sum before round
+    int errorCode;                              // Error code of the first failed sum
+};
+typedef struct SumRound SumRound;
+
+/*
+ * Function <private>:  _collectEntry
+ * --------------------
+ *      adds entry of registry to collected items
+ *
+ */
+static void _collectEntry( RegistryEntry *entry, void *context )
+{
+    BulkCollector *collector = context;
+    collector->items[collector->count++].entry = entry;
+}
+
+/*
+ * Function <private>:  _compareItemSizes
+ * --------------------
+ *      orders sized items from the biggest matrix (ties by index)
+ *
+ */
+static int _compareItemSizes( const void *a, const void *b )
+{
+    const SizedItem *first = a, *second = b;
+
+    if( first->size != second->size )
+        return first->size > second->size ? -1 : 1;
+    return first->index - second->index;
+}
+
+/*
+ * Function:  createBulkOperation
+ * --------------------
+ *      selects all dense matrices of registry (optionally only of given size) for bulk operation; sparse matrices
+ *      are skipped. Registry mustn't be modified until operation is deleted
+ *
+ *      registry: registry of saved matrices
+ *      size:     size of selected matrices, -1 selects matrices of all sizes
+ *      output:   pointer to memory where pointer to operation should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createBulkOperation( MatrixRegistry *registry, int size, BulkOperation **output )
+{
+    RegistryFilter filter = registryAcceptAll();
+    BulkCollector collector = { NULL, 0 };
+
+    filter.storage = REGISTRY_DENSE_STORAGE;
+    if( size >= 0 )
+        filter.minSize = filter.maxSize = size;
+
+    BulkOperation *operation = calloc( 1, sizeof( BulkOperation ) );
+    const int count = registryForEach( registry, &filter, NULL, NULL );
+    if( operation == NULL )
+        return -1;
+    operation->items = calloc( ( size_t )count + 1, sizeof( BulkItem ) );
+    operation->order = malloc( sizeof( int ) * ( ( size_t )count + 1 ) );
+    SizedItem *sorted = malloc( sizeof( SizedItem ) * ( ( size_t )count + 1 ) );
+    if( operation->items == NULL || operation->order == NULL || sorted == NULL )
+    {
+        free( operation->items );
+        free( operation->order );
+        free( operation );
+        free( sorted );
+        return -1;
+    }
+
+    collector.items = operation->items;
+    registryForEach( registry, &filter, _collectEntry, &collector );
+    operation->count = count;
+    for( int i = 0; i < count; i++ )
+    {
+        sorted[i].size = operation->items[i].entry->dense->size;
+        sorted[i].index = i;
+    }
+    qsort( sorted, ( size_t )count, sizeof( SizedItem ), _compareItemSizes );
+    for( int i = 0; i < count; i++ )
+        operation->order[i] = sorted[i].index;
+    free( sorted );
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+        initLimbArena( &operation->arenas[worker] );
+
+    *output = operation;
+    return 0;
+}
+
+/*
+ * Function:  deleteBulkOperation
+ * --------------------
+ *      frees operation together with results which weren't taken by caller
+ *
+ */
+void deleteBulkOperation( BulkOperation *operation )
+{
+    if( operation == NULL )
+        return;
+    for( int i = 0; i < operation->count; i++ )
+        deleteSquareMatrix( operation->items[i].product );
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+        freeLimbArena( &operation->arenas[worker] );
+    free( operation->items );
+    free( operation->order );
+    free( operation );
+}
+
+/*
+ * Function <private>:  _determinantOfItem
+ * --------------------
+ *      computes exact determinant of one matrix (limbs are taken from arena of worker)
+ *
+ */
+static void _determinantOfItem( long begin, long end, int worker, void *context )
+{
+    BulkOperation *operation = context;
+    BulkItem *item = &operation->items[operation->order[begin]];
+    BigMatrix *matrix;
+
+    item->errorCode = bigMatrixFromMatrix( item->entry->dense, &matrix );
+    if( item->errorCode == 0 )
+    {
+        item->errorCode = detBigMatrix( matrix, &item->determinant, &operation->arenas[worker] );
+        deleteBigMatrix( matrix );
+    }
+}
+
+/*
+ * Function:  bulkDeterminants
+ * --------------------
+ *      computes determinants of all selected matrices; determinants are exact (fraction-free Bareiss algorithm on
+ *      integers of arbitrary size), so the only possible error of item is -1 (out of memory)
+ *
+ */
+void bulkDeterminants( BulkOperation *operation )
+{
+    operation->threads = operation->count < availableThreads() ? operation->count : availableThreads();
+    parallelForDynamic( operation->count, _determinantOfItem, operation );
+}
+
+/*
+ * Function <private>:  _multiplyItem
+ * --------------------
+ *      multiplies one matrix by factor
+ *
+ */
+static void _multiplyItem( long begin, long end, int worker, void *context )
+{
+    void **arguments = context;                             // Operation and factor
+    BulkOperation *operation = arguments[0];
+    BulkItem *item = &operation->items[operation->order[begin]];
+
+    item->errorCode = multiplySquareMatrix( item->entry->dense, arguments[1], &item->product );
+    if( item->errorCode != 0 )
+        item->product = NULL;
+}
+
+/*
+ * Function:  bulkMultiply
+ * --------------------
+ *      multiplies every selected matrix by factor (matrix * factor); error codes of items are the same as of
+ *      multiplySquareMatrix (-1 out of memory, -2 different sizes, -3 overflow)
+ *
+ */
+void bulkMultiply( BulkOperation *operation, Matrix *factor )
+{
+    void *arguments[2] = { operation, factor };
+
+    operation->threads = operation->count < availableThreads() ? operation->count : availableThreads();
+    parallelForDynamic( operation->count, _multiplyItem, arguments );
+}
+
+/*
+ * Function <private>:  _sumPairs
+ * --------------------
+ *      adds pairs of neighbouring partial sums: partial[i] += partial[i + step] for i = 2 * step * pair
+ *
+ */
+static void _sumPairs( long begin, long end, int worker, void *context )
+{
+    SumRound *round = context;
+
+    for( long pair = begin; pair < end; pair++ )
+    {
+        const int left = ( int )( pair * 2 * round->step ), right = left + round->step;
+        Matrix *sum;
+        const int errorCode = sumSquareMatrix( round->partial[left], round->partial[right], &sum );
+        if( errorCode != 0 )
+        {
+            __atomic_store_n( &round->errorCode, errorCode, __ATOMIC_RELAXED );
+            continue;
+        }
+        if( round->owned[left] )
+            deleteSquareMatrix( round->partial[left] );
+        if( round->owned[right] )
+            deleteSquareMatrix( round->partial[right] );
+        round->partial[left] = sum;
+        round->owned[left] = 1;
+        round->owned[right] = 0;
+    }
+}
+
+/*
+ * Function:  bulkSum
+ * --------------------
+ *      computes sum of all selected matrices with tree reduction: in every round neighbouring partial sums are
+ *      added in parallel, so there are only log2(count) rounds of count / 2, count / 4, ... independent sums
+ *
+ *      output:  pointer to memory where pointer to sum should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if there are no matrices or they have different sizes,
+ *               -3 on long integer overflow
+ *
+ */
+int bulkSum( BulkOperation *operation, Matrix **output )
+{
+    const int count = operation->count;
+    SumRound round = { NULL, NULL, count, 1, 0 };
+
+    if( count == 0 )
+        return -2;
+    for( int i = 1; i < count; i++ )
+        if( operation->items[i].entry->dense->size != operation->items[0].entry->dense->size )
+            return -2;
+    round.partial = malloc( sizeof( Matrix* ) * ( size_t )count );
+    round.owned = calloc( ( size_t )count, sizeof( int ) );
+    if( round.partial == NULL || round.owned == NULL )
+    {
+        free( round.partial );
+        free( round.owned );
+        return -1;
+    }
+    for( int i = 0; i < count; i++ )
+        round.partial[i] = operation->items[i].entry->dense;
+
+    operation->threads = 1;
+    for( ; round.step < count && round.errorCode == 0; round.step *= 2 )
+    {
+        const long pairs = ( count - round.step + 2 * round.step - 1 ) / ( 2 * round.step );
+        if( pairs > operation->threads )
+            operation->threads = pairs < availableThreads() ? ( int )pairs : availableThreads();
+        parallelFor( pairs, 1, _sumPairs, &round );
+    }
+
+    int errorCode = round.errorCode;
+    if( errorCode == 0 && round.owned[0] )
+    {
+        *output = round.partial[0];
+        round.owned[0] = 0;
+    } else if( errorCode == 0 )                             // Only one matrix - result is its copy
+        errorCode = snapshotSquareMatrix( round.partial[0], output );
+
+    for( int i = 0; i < count; i++ )
+        if( round.owned[i] )
+            deleteSquareMatrix( round.partial[i] );
+    free( round.partial );
+    free( round.owned );
+    return errorCode;
+}
@@ -0,0 +1,46 @@
+/*
+ * File: MatrixBulk.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixBulk.c
+ */
+
+#ifndef PROJEKT2_MATRIXBULK_H
+#define PROJEKT2_MATRIXBULK_H
+
+#include "MatrixRegistry.h"
+#include "BigInteger.h"
+#include "Parallel.h"
+
+/************************************
+ * Structure declarations
+ ************************************/
+// One matrix processed by bulk operation and result of operation on it
+struct BulkItem {
+    RegistryEntry *entry;                       // Processed matrix (always stored as dense one)
+    int errorCode;                              // Error code of operation on this matrix (0 on success)
+    BigInteger determinant;                     // Result of bulkDeterminants
+    Matrix *product;                            // Result of bulkMultiply (NULL on error or if it was taken)
+};
+typedef struct BulkItem BulkItem;
+
+// Matrices selected from registry for bulk operation
+struct BulkOperation {
+    BulkItem *items;                            // Selected matrices in order of ids
+    int count;                                  // Number of selected matrices
+    int *order;                                 // Indexes of items from the biggest matrix - order of processing
+    LimbArena arenas[MAX_NUMBER_OF_THREADS];    // Limbs of determinants computed by each worker
+    int threads;                                // Number of threads used by the last operation
+};
+typedef struct BulkOperation BulkOperation;
+
+/************************************
+ * Function declarations
+ ************************************/
+int createBulkOperation( MatrixRegistry *registry, int size, BulkOperation **output );
+void deleteBulkOperation( BulkOperation *operation );
+void bulkDeterminants( BulkOperation *operation );
+void bulkMultiply( BulkOperation *operation, Matrix *factor );
+int bulkSum( BulkOperation *operation, Matrix **output );
+
+#endif //PROJEKT2_MATRIXBULK_H
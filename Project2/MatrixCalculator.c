@@ -7,294 +7,1588 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/select.h>
 #include "SquareMatrix.h"
+#include "SparseMatrix.h"
 #include "MatrixGUI.h"
+#include "MatrixFile.h"
+#include "ResultCache.h"
+#include "MatrixRegistry.h"
+#include "MatrixBatch.h"
+#include "MatrixGenerators.h"
+#include "BackgroundJob.h"
+#include "MatrixChain.h"
+#include "MatrixLayout.h"
+#include "OutOfCore.h"
+#include "BigMatrix.h"
+#include "Spectrum.h"
+#include "MatrixBulk.h"
+#include "ModularMatrix.h"
+#include "Profiler.h"
+#include "MatrixServer.h"
 
 /************************************
  * Macros definitions
  ************************************/
-// Maximum number of matrices program is able to store
-#define MAX_NUMBER_OF_MATRICES 30
+// Number of matrices listed before every operation (all of them can be seen with "List matrices")
+#define MAX_LISTED_MATRICES 20
 
 // Codes used by function operationOnMatrix to distinguish operations
 #define MATRICES_ADD        1
 #define MATRICES_SUB        2
 #define MATRICES_MULT       3
 
+// Maximum length of file path entered by user
+#define MAX_PATH_LENGTH     1024
+
+// Maximal number of matrices multiplied by "Multiply chain of matrices"
+#define MAX_CHAIN_LENGTH    64
+
+// Maximal amount of memory used by cached results of operations (in bytes)
+#define RESULT_CACHE_BUDGET ( 64 * 1024 * 1024 )
+
+// Time (in milliseconds) for which menu waits for result of heavy operation before leaving it on background
+#define JOB_FOREGROUND_WAIT 200
+
+// Interval (in milliseconds) of refreshing progress of watched job
+#define JOB_REFRESH_INTERVAL 200
+
 /************************************
  * Enums definitions
  ************************************/
 // Enum containing "programmer friendly" names of menus
 enum AvailableOptions {
     QUIT, CREATE_MATRIX, EDIT_MATRIX, PRINT_MATRIX, DELETE_MATRIX, ADD_MATRICES, SUB_MATRICES, MULTIPLY_MATRICES,
-    DETERMINANT, HELP
+    DETERMINANT, POWER_MATRIX, VERIFY_PRODUCT, SAVE_MATRIX, LOAD_MATRIX, IMPORT_MATRIX, EXPORT_MATRIX,
+    CONVERT_STORAGE, DUPLICATE_MATRIX, LIST_MATRICES, GENERATE_MATRIX, CHAIN_MULTIPLY,
+    TRANSPOSE_MATRIX, MULTIPLY_FILES, EXACT_ARITHMETIC, CHARACTERISTIC_POLYNOMIAL, EIGENVALUES, ALL_MATRICES, MODULAR_ARITHMETIC, STATISTICS,
+    JOBS, HELP
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// State of listing matrices shared between calls of printEntrySummary
+struct ListingState {
+    int printed;                    // Number of entries printed so far
+    int limit;                      // Maximal number of printed entries
+};
+typedef struct ListingState ListingState;
+
+// Operation left running on background; its result is shown before one of next commands
+struct PendingJob {
+    int number;                     // Number of job shown to user
+    BackgroundJob *job;
+    CacheKey key;                   // Key under which result will be cached
+    char description[64];           // Ex. "Determinant of matrix #3"
+    struct PendingJob *next;
 };
+typedef struct PendingJob PendingJob;
+
+// Operations running on background, in order of starting them
+struct JobList {
+    PendingJob *first;
+    int nextNumber;                 // Number of next started job
+};
+typedef struct JobList JobList;
 
 /************************************
  * Program functions
  ************************************/
 
 /*
- * Function:  printExistingMatrices
+ * Function:  entrySize
+ * --------------------
+ *      returns number of rows|cols of registered matrix
+ *
+ */
+int entrySize( RegistryEntry *entry )
+{
+    return entry->dense != NULL ? entry->dense->size : entry->sparse->size;
+}
+
+/*
+ * Function:  printEntrySummary
+ * --------------------
+ *      prints id, name, size and storage of registered matrix in one word (used as RegistryVisitor); only first
+ *      state->limit entries are printed
+ *
+ *      context: pointer to ListingState
+ *
+ */
+void printEntrySummary( RegistryEntry *entry, void *context )
+{
+    ListingState *state = context;
+
+    if( state->printed++ >= state->limit )
+        return;
+    printf( " %d", entry->id );
+    if( entry->name[0] != 0 )
+        printf( "(%s)", entry->name );
+    if( entry->dense != NULL )
+        printf( "[%dx%d dense]", entry->dense->size, entry->dense->size );
+    else
+        printf( "[%dx%d csr, %ld nnz]", entry->sparse->size, entry->sparse->size, entry->sparse->nonZeros );
+}
+
+/*
+ * Function:  printExistingMatrices
+ * --------------------
+ *      prints string "Existing matrices: " followed by ids, names, sizes and storage of first MAX_LISTED_MATRICES
+ *      created matrices
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void printExistingMatrices( MatrixRegistry* registry )
+{
+    ListingState state = { 0, MAX_LISTED_MATRICES };
+
+    printf( "Existing matrices:" );
+    registryForEach( registry, NULL, printEntrySummary, &state );
+    if( state.printed > state.limit )
+        printf( " ... and %d more", state.printed - state.limit );
+    printf( "\n" );                                                                      // Remember to put \n at the end!
+}
+
+/*
+ * Function:  promptExistingMatrix
+ * --------------------
+ *      asks user for id or name of matrix and checks if such matrix exists
+ *
+ *      registry: registry of saved matrices
+ *      prompt: message for user
+ *
+ *      returns: entry of matrix, NULL if it doesn't exist (error message is already printed then)
+ *
+ */
+RegistryEntry* promptExistingMatrix( MatrixRegistry* registry, char *prompt )
+{
+    char idOrName[MAX_MATRIX_NAME_LENGTH + 1];
+
+    safeStringPrompt( prompt, idOrName, sizeof( idOrName ) );
+    RegistryEntry *entry = registryFind( registry, idOrName );
+    if( entry == NULL )
+        puts( FONT_RED_COLOR "There's no matrix with such index or name!" DEFAULT_DISPLAY );
+    return entry;
+}
+
+/*
+ * Function:  promptDenseMatrix
+ * --------------------
+ *      asks user for id or name of matrix, which has to exist and be stored as dense matrix
+ *
+ *      registry: registry of saved matrices
+ *      prompt: message for user
+ *      matrixIndex: pointer to int where id of matrix should be stored (can be NULL)
+ *
+ *      returns: pointer to selected matrix, NULL if it doesn't exist or is sparse (error message is already printed)
+ *
+ */
+Matrix* promptDenseMatrix( MatrixRegistry* registry, char *prompt, int *matrixIndex )
+{
+    RegistryEntry *entry = promptExistingMatrix( registry, prompt );
+    if( entry == NULL )
+        return NULL;
+    if( entry->dense == NULL )
+    {
+        puts( FONT_RED_COLOR "This matrix is stored as sparse - convert it to dense first!" DEFAULT_DISPLAY );
+        return NULL;
+    }
+    if( matrixIndex != NULL )
+        *matrixIndex = entry->id;
+    return entry->dense;
+}
+
+/*
+ * Function:  storeResult
+ * --------------------
+ *      saves result of operation (dense or sparse - other pointer should be NULL) at first free id; if there's
+ *      no memory to register it, result is deleted
+ *
+ *      registry: registry of saved matrices
+ *
+ *      returns: id of result, -1 if it wasn't saved
+ *
+ */
+int storeResult( MatrixRegistry* registry, Matrix *dense, SparseMatrix *sparse )
+{
+    int resultMatrixIndex;
+
+    if( registryAdd( registry, NULL, dense, sparse, &resultMatrixIndex ) != 0 ) // Register result under first free id
+    {
+        puts( FONT_RED_COLOR "There's no memory to save result" DEFAULT_DISPLAY );
+        deleteSquareMatrix( dense );
+        deleteSparseMatrix( sparse );
+        return -1;
+    }
+    printf( "Result was saved at index #%d.\n", resultMatrixIndex );
+    return resultMatrixIndex;
+}
+
+/*
+ * Function:  printEntry
+ * --------------------
+ *      prints registered matrix as table; sparse matrices are temporarily converted to dense ones
+ *
+ */
+void printEntry( RegistryEntry *entry )
+{
+    Matrix *dense = entry->dense;
+
+    if( dense == NULL && sparseToDenseMatrix( entry->sparse, &dense ) != 0 )
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        return;
+    }
+    printMatrixAsTable( dense );
+    if( dense != entry->dense )
+        deleteSquareMatrix( dense );
+}
+
+/*
+ * Function:  reportJobResult
+ * --------------------
+ *      prints result (or error) of finished background operation; result is cached and matrix result is saved in
+ *      registry
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      pending: finished job
+ *
+ */
+void reportJobResult( MatrixRegistry* registry, ResultCache* cache, PendingJob *pending )
+{
+    BackgroundJob *job = pending->job;
+
+    if( job->errorCode == OPERATION_CANCELLED )
+        printf( "%s was cancelled.\n", pending->description );
+    else if( job->errorCode == -1 )                             // Out of memory
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( job->operation == JOB_MULTIPLY && job->errorCode == -2 )
+        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+    else if( job->operation == JOB_POWER && job->errorCode != 0 )
+        puts( FONT_RED_COLOR "Result is bigger than MAX_LONG! Try computing it modulo some number." DEFAULT_DISPLAY );
+    else if( job->errorCode != 0 )                              // Some element of result doesn't fit in long integer
+        puts( FONT_RED_COLOR "Result is bigger than MAX_LONG!" DEFAULT_DISPLAY );
+    else if( job->operation == JOB_DETERMINANT )
+    {
+        cacheStoreScalar( cache, pending->key, job->scalar );
+        printf( "%s = %ld\n", pending->description, job->scalar );
+    } else if( job->operation == JOB_CHARACTERISTIC_POLYNOMIAL )  // Polynomials aren't cached
+    {
+        printf( "%s: ", pending->description );
+        if( printPolynomial( job->polynomial, job->degree ) != 0 )
+            puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    } else
+    {
+        cacheStoreMatrix( cache, pending->key, job->result );
+        printf( "%s is: \n", pending->description );
+        printMatrixAsTable( job->result );
+        storeResult( registry, job->result, NULL );
+        job->result = NULL;                                     // Result is owned by registry now
+    }
+}
+
+/*
+ * Function:  runJob
+ * --------------------
+ *      waits JOB_FOREGROUND_WAIT milliseconds for result of started operation; if it isn't ready by then, operation
+ *      is left running on background and its result is reported before one of next commands
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *      job: started operation (owned by this function)
+ *      key: key under which result should be cached (if results of operation are cached)
+ *      description: name of operation used in messages
+ *
+ */
+void runJob( MatrixRegistry* registry, ResultCache* cache, JobList* jobs, BackgroundJob *job, CacheKey key,
+             const char *description )
+{
+    PendingJob pending = { jobs->nextNumber, job, key, "", NULL };
+    snprintf( pending.description, sizeof( pending.description ), "%s", description );
+
+    PendingJob *queued = NULL;
+    if( !waitForBackgroundJob( job, JOB_FOREGROUND_WAIT ) && ( queued = malloc( sizeof( PendingJob ) ) ) != NULL )
+    {
+        *queued = pending;
+        PendingJob **last = &jobs->first;
+        while( *last != NULL )
+            last = &( *last )->next;
+        *last = queued;
+        jobs->nextNumber++;
+        printf( "Operation is running on background as job #%d (see \"Jobs\" to watch or cancel it).\n",
+                queued->number );
+        return;
+    }
+
+    waitForBackgroundJob( job, -1 );                            // No memory to queue job - wait for it
+    reportJobResult( registry, cache, &pending );
+    deleteBackgroundJob( job );
+}
+
+/*
+ * Function:  collectFinishedJobs
+ * --------------------
+ *      reports results of background operations which are already finished and prints progress of remaining ones
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *
+ */
+void collectFinishedJobs( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    PendingJob **link = &jobs->first;
+
+    while( *link != NULL )
+    {
+        PendingJob *pending = *link;
+        if( !isBackgroundJobFinished( pending->job ) )
+        {
+            link = &pending->next;
+            continue;
+        }
+        printf( "Job #%d finished:\n", pending->number );
+        reportJobResult( registry, cache, pending );
+        *link = pending->next;
+        deleteBackgroundJob( pending->job );
+        free( pending );
+    }
+
+    if( jobs->first == NULL )
+        return;
+    printf( "Running jobs:" );
+    for( PendingJob *pending = jobs->first; pending != NULL; pending = pending->next )
+        printf( " #%d (%.1f%%)", pending->number, 100.0 * backgroundJobProgress( pending->job ) );
+    printf( "\n" );
+}
+
+/*
+ * Function:  deleteJobs
+ * --------------------
+ *      cancels all background operations and frees memory used by them
+ *
+ */
+void deleteJobs( JobList* jobs )
+{
+    while( jobs->first != NULL )
+    {
+        PendingJob *pending = jobs->first;
+        jobs->first = pending->next;
+        deleteBackgroundJob( pending->job );
+        free( pending );
+    }
+}
+
+/*
+ * Function:  menuCreateMatrix
+ * --------------------
+ *      displays and handles menu for creating new matrix
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuCreateMatrix( MatrixRegistry* registry )
+{
+    char name[MAX_MATRIX_NAME_LENGTH + 1];
+    int matrixIndex, matrixSize, errorCode;
+    Matrix *matrix;
+
+    printExistingMatrices( registry );
+
+    safeStringPrompt( "Name of new matrix (- for none): ", name, sizeof( name ) );
+    if( strcmp( name, "-" ) == 0 )
+        name[0] = 0;
+    // While user doesn't provide free and valid name, ask again
+    while( name[0] != 0 && ( !isValidMatrixName( name ) || registryFindByName( registry, name ) != NULL ) )
+    {
+        safeStringPrompt( FONT_RED_COLOR "Name must be free and consist of letters, digits and _ (not at the "
+                          "beginning). Try again: " DEFAULT_DISPLAY, name, sizeof( name ) );
+        if( strcmp( name, "-" ) == 0 )
+            name[0] = 0;
+    }
+
+    matrixSize = ( int )safeNumPrompt( "Number of cols (=rows): ", 0, MAX_NUMBER_OF_ROWS );
+
+    if( createSquareMatrix( matrixSize, &matrix ) != 0 )
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        return;
+    }
+    errorCode = registryAdd( registry, name, matrix, NULL, &matrixIndex );
+    if( errorCode != 0 )                                        // Name was checked before, so it's out of memory
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        deleteSquareMatrix( matrix );
+        return;
+    }
+    printf( "Matrix was created at index #%d.\n", matrixIndex );
+    editMatrixPrompt( matrix );
+}
+
+/*
+ * Function:  menuCreateMatrix
+ * --------------------
+ *      displays and handles menu for creating editing existing matrix
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuEditMatrix( MatrixRegistry* registry )
+{
+    printExistingMatrices( registry );
+
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix to be edited: ", NULL );
+    if( matrix == NULL )                                                                 // Check if matrix exists
+        return;
+    editMatrixPrompt( matrix );
+}
+
+/*
+ * Function:  menuPrintMatrix
+ * --------------------
+ *      displays and handles menu for printing existing matrix
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuPrintMatrix( MatrixRegistry* registry )
+{
+    printExistingMatrices( registry );
+
+    RegistryEntry *entry = promptExistingMatrix( registry, "Index or name of matrix to be printed: " );
+    if( entry == NULL )                                                                  // Check if matrix exists
+        return;
+    printEntry( entry );
+}
+
+/*
+ * Function:  menuDeleteMatrix
+ * --------------------
+ *      displays and handles menu for deleting existing matrix
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuDeleteMatrix( MatrixRegistry* registry )
+{
+    printExistingMatrices( registry );
+
+    RegistryEntry *entry = promptExistingMatrix( registry, "Index or name of matrix to be deleted: " );
+    if( entry == NULL )                                                                  // Check if matrix exists
+        return;
+
+    registryRemove( registry, entry->id );                                               // Delete matrix and free id
+}
+
+/*
+ * Function:  operationOnMatrices
+ * --------------------
+ *      displays and handles menu for operation on matrix; if both matrices are sparse, result is computed in sparse
+ *      form, otherwise sparse operand is temporarily converted to dense one
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of dense operations
+ *      jobs: list of background operations (dense multiplication is run on background)
+ *      operation: one of the following values: (MATRICES_ADD | MATRICES_DIFF | MATRICES_MULT)
+ *
+ */
+void operationOnMatrices( MatrixRegistry* registry, ResultCache* cache, JobList* jobs, int operation )
+{
+    Matrix* result = NULL;                          // Result of operation (if it is dense)
+    SparseMatrix* sparseResult = NULL;              // Result of operation (if it is sparse)
+    Matrix* operands[2] = { NULL, NULL };           // Dense forms of operands
+    RegistryEntry *first, *second;                  // Entries of first and second matrix
+    BackgroundJob* job = NULL;                      // Multiplication running on background
+    CacheKey key;
+    int errorCode = 0;                              // Error code returned by functions called
+
+    printExistingMatrices( registry );
+
+    first = promptExistingMatrix( registry, "Index or name of first matrix: " );
+    if( first == NULL )                             // Matrix does not exist
+        return;
+
+    second = promptExistingMatrix( registry, "Index or name of second matrix: " );
+    if( second == NULL )                            // Matrix does not exist
+        return;
+
+    printf( "Matrix #%d:\n", first->id );
+    printEntry( first );
+    printf( "Matrix #%d:\n", second->id );
+    printEntry( second );
+
+    if( first->sparse != NULL && second->sparse != NULL )               // Both sparse - keep result sparse
+    {
+        if( operation == MATRICES_ADD )
+            errorCode = sumSparseMatrix( first->sparse, second->sparse, &sparseResult );
+        else if( operation == MATRICES_SUB )
+            errorCode = subSparseMatrix( first->sparse, second->sparse, &sparseResult );
+        else
+            errorCode = multiplySparseMatrix( first->sparse, second->sparse, &sparseResult );
+    } else
+    {
+        operands[0] = first->dense;
+        operands[1] = second->dense;
+        const int cachedOperation = operation == MATRICES_ADD ? CACHED_SUM
+                                    : operation == MATRICES_SUB ? CACHED_SUB : CACHED_MULTIPLY;
+        if( ( operands[0] == NULL && sparseToDenseMatrix( first->sparse, &operands[0] ) != 0 )
+            || ( operands[1] == NULL && sparseToDenseMatrix( second->sparse, &operands[1] ) != 0 ) )
+            errorCode = -1;
+        else
+        {
+            key = makeCacheKey( cachedOperation, operands[0], operands[1], 0, 0 );
+            if( cacheLookupMatrix( cache, key, &result ) )              // The same operation was done before
+                puts( "(Result taken from cache)" );
+            else if( operation == MATRICES_MULT )       // Multiply matrices on background (works on snapshots)
+                errorCode = startBackgroundJob( JOB_MULTIPLY, operands[0], operands[1], 0, 0, &job ) == 0 ? 0 : -1;
+            else
+            {
+                if( operation == MATRICES_ADD )         // Add matrices
+                    errorCode = sumSquareMatrix( operands[0], operands[1], &result );
+                else                                    // Subtract matrices
+                    errorCode = subSquareMatrix( operands[0], operands[1], &result );
+                if( errorCode == 0 )
+                    cacheStoreMatrix( cache, key, result );
+            }
+        }
+
+        if( operands[0] != NULL && operands[0] != first->dense )    // Delete temporary dense forms
+            deleteSquareMatrix( operands[0] );
+        if( operands[1] != NULL && operands[1] != second->dense )
+            deleteSquareMatrix( operands[1] );
+    }
+
+    if( job != NULL )
+    {
+        char description[64];
+        snprintf( description, sizeof( description ), "Multiplication of matrix #%d and #%d", first->id, second->id );
+        runJob( registry, cache, jobs, job, key, description );
+        return;
+    }
+
+    if( errorCode == -1 )                           // Function returned out-of-memory error
+    {
+        puts( FONT_RED_COLOR "Out of memory occurred!" DEFAULT_DISPLAY );
+        return;
+    }else if( errorCode == -2 )                     // Function returned, because matrices does not have the same size
+    {
+        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+        return;
+    }else if( errorCode == -3 )                     // Some element of result doesn't fit in long integer
+    {
+        puts( FONT_RED_COLOR "Result is bigger than MAX_LONG!" DEFAULT_DISPLAY );
+        return;
+    }
+
+    if( operation == MATRICES_ADD )
+        printf("Sum of matrix #%d and #%d is: \n", first->id, second->id);
+    else if( operation == MATRICES_SUB )
+        printf("Differential of matrix #%d and #%d is: \n", first->id, second->id);
+    else
+        printf("Multiplication of matrix #%d and #%d is: \n", first->id, second->id);
+
+    RegistryEntry resultEntry = { .dense = result, .sparse = sparseResult };
+    printEntry( &resultEntry );
+    storeResult( registry, result, sparseResult );
+}
+
+/*
+ * Functions:  menu(Add | Sub | Multiply)Matrices
+ * --------------------
+ *      does operation specified in function name by calling operationOnMatrices function with appropriate parameter
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *
+ */
+void menuAddMatrices( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    operationOnMatrices( registry, cache, jobs, MATRICES_ADD );
+}
+
+void menuSubMatrices( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    operationOnMatrices( registry, cache, jobs, MATRICES_SUB );
+}
+
+void menuMultiplyMatrices( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    operationOnMatrices( registry, cache, jobs, MATRICES_MULT );
+}
+
+/*
+ * Function:  menuDeterminant
+ * --------------------
+ *      displays and handles menu for calculating matrix determinant (computed on background if it takes long)
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *
+ */
+void menuDeterminant( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    long result = 0;
+    int matrixIndex;
+    char description[64];
+    BackgroundJob* job;
+
+    printExistingMatrices( registry );
+
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix: ", &matrixIndex );
+    if( matrix == NULL )                                        // If matrix does not exist, error is already printed
+        return;
+
+    printMatrixAsTable( matrix );
+    snprintf( description, sizeof( description ), "Determinant of matrix #%d", matrixIndex );
+    CacheKey key = makeCacheKey( CACHED_DETERMINANT, matrix, NULL, 0, 0 );
+    if( cacheLookupScalar( cache, key, &result ) )              // Compute determinant only if it wasn't cached
+        printf( "%s = %ld\n", description, result );
+    else if( startBackgroundJob( JOB_DETERMINANT, matrix, NULL, 0, 0, &job ) != 0 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else
+        runJob( registry, cache, jobs, job, key, description );
+}
+
+/*
+ * Function:  menuPowerMatrix
+ * --------------------
+ *      displays and handles menu for raising matrix to the power; result is computed either exactly (with overflow
+ *      check) or modulo number provided by user (on background if it takes long)
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *
+ */
+void menuPowerMatrix( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    Matrix* result;
+    int matrixIndex;
+    long exponent, modulus;
+    char description[64];
+    BackgroundJob* job;
+
+    printExistingMatrices( registry );
+
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix: ", &matrixIndex );
+    if( matrix == NULL )                                        // If matrix does not exist, error is already printed
+        return;
+    exponent = safeNumPrompt( "Exponent: ", 0, LONG_MAX );
+    modulus = safeNumPrompt( "Modulus (0 for exact result): ", 0, LONG_MAX );
+
+    printMatrixAsTable( matrix );
+    if( modulus == 0 )
+        snprintf( description, sizeof( description ), "Matrix #%d to the power of %ld", matrixIndex, exponent );
+    else
+        snprintf( description, sizeof( description ), "Matrix #%d to the power of %ld modulo %ld",
+                  matrixIndex, exponent, modulus );
+
+    CacheKey key = makeCacheKey( modulus == 0 ? CACHED_POWER : CACHED_POWER_MOD, matrix, NULL, exponent, modulus );
+    if( cacheLookupMatrix( cache, key, &result ) )
+    {
+        puts( "(Result taken from cache)" );
+        printf( "%s is: \n", description );
+        printMatrixAsTable( result );
+        storeResult( registry, result, NULL );
+    } else if( startBackgroundJob( JOB_POWER, matrix, NULL, ( unsigned long )exponent, modulus, &job ) != 0 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else
+        runJob( registry, cache, jobs, job, key, description );
+}
+
+/*
+ * Function:  menuVerifyProduct
+ * --------------------
+ *      displays and handles menu for checking (with Freivalds' algorithm) if one matrix is product of two others
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuVerifyProduct( MatrixRegistry* registry )
+{
+    int indexes[3];
+    Matrix *matrices[3];
+    const char *prompts[3] = { "Index or name of first factor: ", "Index or name of second factor: ", "Index or name of product: " };
+    int rounds, isCorrect = 0;
+    int errorCode = 0;
+
+    printExistingMatrices( registry );
+
+    for( int i = 0; i < 3; i++ )
+    {
+        matrices[i] = promptDenseMatrix( registry, ( char* )prompts[i], &indexes[i] );
+        if( matrices[i] == NULL )                               // Matrix does not exist
+            return;
+    }
+    rounds = ( int )safeNumPrompt( "Accepted error probability is 2^-k. k = ", 1, 63 );
+
+    errorCode = verifyProductSquareMatrix( matrices[0], matrices[1], matrices[2], 1.0 / ( double )( 1UL << rounds ),
+                                           &isCorrect );
+    if( errorCode == -1 )
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        return;
+    } else if( errorCode == -2 )
+    {
+        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+        return;
+    }
+
+    if( isCorrect )
+        printf( "Matrix #%d = #%d * #%d (probability of mistake <= 2^-%d)\n", indexes[2], indexes[0], indexes[1], rounds );
+    else
+        printf( FONT_RED_COLOR "Matrix #%d != #%d * #%d" DEFAULT_DISPLAY "\n", indexes[2], indexes[0], indexes[1] );
+}
+
+/*
+ * Function:  menuSaveMatrix
+ * --------------------
+ *      displays and handles menu for saving existing matrix to binary file
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuSaveMatrix( MatrixRegistry* registry )
+{
+    char path[MAX_PATH_LENGTH];
+    int matrixIndex;
+
+    printExistingMatrices( registry );
+
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix to be saved: ", &matrixIndex );
+    if( matrix == NULL )                                                                 // Check if matrix exists
+        return;
+    safeStringPrompt( "Path of file: ", path, MAX_PATH_LENGTH );
+
+    int errorCode = saveMatrixToFile( matrix, path );
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Can't write to this file!" DEFAULT_DISPLAY );
+    else
+        printf( "Matrix #%d was saved to %s.\n", matrixIndex, path );
+}
+
+/*
+ * Function:  menuLoadMatrix
+ * --------------------
+ *      displays and handles menu for loading matrix from binary file into first free index
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuLoadMatrix( MatrixRegistry* registry )
+{
+    char path[MAX_PATH_LENGTH];
+    Matrix *loaded;
+    int matrixIndex;
+
+    safeStringPrompt( "Path of file: ", path, MAX_PATH_LENGTH );
+
+    int errorCode = loadMatrixFromFile( path, &loaded );
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Can't open this file!" DEFAULT_DISPLAY );
+    else if( errorCode == -3 )
+        puts( FONT_RED_COLOR "This file doesn't contain valid matrix!" DEFAULT_DISPLAY );
+    else if( registryAdd( registry, NULL, loaded, NULL, &matrixIndex ) != 0 )        // Register under first free id
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        deleteSquareMatrix( loaded );
+    } else
+        printf( "Matrix %dx%d was loaded at index #%d.\n", loaded->size, loaded->size, matrixIndex );
+}
+
+/*
+ * Function:  menuImportMatrix
  * --------------------
- *      prints string "Existing matrices: " followed by ids and sizes of every created matrix
+ *      displays and handles menu for reading matrix from text (CSV) file into first free index
  *
- *      matricesMemory: pointer to list of saved matrices
+ *      registry: registry of saved matrices
  *
  */
-void printExistingMatrices( Matrix** matricesMemory )
+void menuImportMatrix( MatrixRegistry* registry )
 {
-    printf( "Existing matrices:" );
-    for( int i = 0; i < MAX_NUMBER_OF_MATRICES; i++ )
-        if( matricesMemory[i] != NULL )                                                  // If matrix exists
-            printf( " %d[%dx%d]", i, matricesMemory[i]->size, matricesMemory[i]->size ); // Print its id and size
-    printf( "\n" );                                                                      // Remember to put \n at the end!
+    char path[MAX_PATH_LENGTH];
+    Matrix *imported;
+    int matrixIndex;
+
+    safeStringPrompt( "Path of text file: ", path, MAX_PATH_LENGTH );
+
+    int errorCode = importMatrixFromText( path, &imported );
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Can't open this file!" DEFAULT_DISPLAY );
+    else if( errorCode == -3 )
+        puts( FONT_RED_COLOR "File must contain square matrix of integers, one row per line!" DEFAULT_DISPLAY );
+    else if( errorCode == -4 )
+        printf( FONT_RED_COLOR "Values must be in range <%d, %d>!" DEFAULT_DISPLAY "\n",
+                MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE );
+    else if( registryAdd( registry, NULL, imported, NULL, &matrixIndex ) != 0 )        // Register under first free id
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        deleteSquareMatrix( imported );
+    } else
+        printf( "Matrix %dx%d was imported at index #%d.\n", imported->size, imported->size, matrixIndex );
 }
 
 /*
- * Function:  findFirstFreeMatrixIndex
+ * Function:  menuExportMatrix
  * --------------------
- *      finds first free id for matrix
- *
- *      matricesMemory: pointer to list of saved matrices
+ *      displays and handles menu for writing existing matrix to text file
  *
- *      returns: -1 if no free ids left; number in range (0, MAX_NUMBER_OF_MATRICES) being free matrix id
+ *      registry: registry of saved matrices
  *
  */
-int findFirstFreeMatrixIndex( Matrix** matricesMemory )
+void menuExportMatrix( MatrixRegistry* registry )
 {
-   for( int i = 0; i < MAX_NUMBER_OF_MATRICES; i++ )
-       if( matricesMemory[i] == NULL )                                                   // Is it free?
-           return i;                                                                     // Yep, return it
-   return -1;                                                                            // No free ids found
+    char path[MAX_PATH_LENGTH];
+    int matrixIndex;
+
+    printExistingMatrices( registry );
+
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix to be exported: ", &matrixIndex );
+    if( matrix == NULL )                                                                 // Check if matrix exists
+        return;
+    safeStringPrompt( "Path of text file: ", path, MAX_PATH_LENGTH );
+    int separator = ( int )safeNumPrompt( "Separator (1 - comma, 2 - space): ", 1, 2 );
+
+    int errorCode = exportMatrixToText( matrix, path, separator == 1 ? ',' : ' ' );
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Can't write to this file!" DEFAULT_DISPLAY );
+    else
+        printf( "Matrix #%d was exported to %s.\n", matrixIndex, path );
 }
 
 /*
- * Function:  menuCreateMatrix
+ * Function:  menuConvertStorage
  * --------------------
- *      displays and handles menu for creating new matrix
+ *      displays and handles menu for switching storage of matrix between dense and sparse (CSR) form
  *
- *      matricesMemory: pointer to list of saved matrices
+ *      registry: registry of saved matrices
  *
  */
-void menuCreateMatrix( Matrix** matricesMemory )
+void menuConvertStorage( MatrixRegistry* registry )
 {
-    int matrixIndex, matrixSize;
-
-    printExistingMatrices( matricesMemory );
+    int errorCode = 0;
+    Matrix *dense = NULL;
+    SparseMatrix *sparse = NULL;
 
-    if( findFirstFreeMatrixIndex( matricesMemory ) == -1)                                // No free index left
-        puts(FONT_RED_COLOR "There is no free space for new matrix. " DEFAULT_DISPLAY);
+    printExistingMatrices( registry );
 
-    matrixIndex = ( int )safeNumPrompt( "Index of new matrix: ", 0, MAX_NUMBER_OF_MATRICES );
-    while( matricesMemory[matrixIndex] != 0 )                                            // While user doesn't provide free id, ask again
-        matrixIndex = ( int )safeNumPrompt( FONT_RED_COLOR "This index is already taken. Try again: " DEFAULT_DISPLAY, 0, MAX_NUMBER_OF_MATRICES );
+    RegistryEntry *entry = promptExistingMatrix( registry, "Index or name of matrix to be converted: " );
+    if( entry == NULL )                                                                  // Check if matrix exists
+        return;
 
-    matrixSize = ( int )safeNumPrompt( "Number of cols (=rows): ", 0, MAX_NUMBER_OF_ROWS );
+    if( entry->dense != NULL )
+        errorCode = denseToSparseMatrix( entry->dense, &sparse );
+    else
+        errorCode = sparseToDenseMatrix( entry->sparse, &dense );
 
-    createSquareMatrix( matrixSize, &matricesMemory[matrixIndex] );
-    editMatrixPrompt( matricesMemory[matrixIndex] );
+    if( errorCode != 0 )
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        return;
+    }
+    registryReplace( registry, entry, dense, sparse );
+    printf( "Matrix #%d is now stored as %s.\n", entry->id, entry->dense != NULL ? "dense" : "sparse (CSR)" );
 }
 
 /*
- * Function:  menuCreateMatrix
+ * Function:  menuDuplicateMatrix
  * --------------------
- *      displays and handles menu for creating editing existing matrix
+ *      displays and handles menu for creating snapshot of existing dense matrix at first free index; snapshot
+ *      shares elements with original until one of them is modified, so it is cheap even for big matrices
  *
- *      matricesMemory: pointer to list of saved matrices
+ *      registry: registry of saved matrices
  *
  */
-void menuEditMatrix( Matrix** matricesMemory )
+void menuDuplicateMatrix( MatrixRegistry* registry )
 {
-    printExistingMatrices( matricesMemory );
+    Matrix *snapshot;
+    int matrixIndex;
+
+    printExistingMatrices( registry );
 
-    int matrixIndex = ( int )safeNumPrompt( "Index of matrix to be edited: ", 0, MAX_NUMBER_OF_MATRICES );
-    if( matricesMemory[matrixIndex] == NULL )                                            // Check if matrix exists
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix to be duplicated: ", &matrixIndex );
+    if( matrix == NULL )                                                                 // Check if matrix exists
+        return;
+
+    if( snapshotSquareMatrix( matrix, &snapshot ) != 0 )
     {
-        puts( FONT_RED_COLOR "There's no matrix with such index!" DEFAULT_DISPLAY );
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
         return;
     }
-    editMatrixPrompt( matricesMemory[matrixIndex] );
+    printf( "Snapshot of matrix #%d created. ", matrixIndex );
+    storeResult( registry, snapshot, NULL );
 }
 
 /*
- * Function:  menuPrintMatrix
+ * Function:  printEntryDetails
  * --------------------
- *      displays and handles menu for printing existing matrix
- *
- *      matricesMemory: pointer to list of saved matrices
+ *      prints id, name, size, storage and memory of registered matrix in separate line (used as RegistryVisitor)
  *
  */
-void menuPrintMatrix( Matrix** matricesMemory )
+void printEntryDetails( RegistryEntry *entry, void *context )
 {
-    printExistingMatrices( matricesMemory );
-
-    int matrixIndex = ( int )safeNumPrompt( "Index of matrix to be printed: ", 0, MAX_NUMBER_OF_MATRICES );
-    if( matricesMemory[matrixIndex] == NULL )                                            // Check if matrix exists
-    {
-        puts( FONT_RED_COLOR "There's no matrix with such index!" DEFAULT_DISPLAY );
-        return;
-    }
-    printMatrixAsTable( matricesMemory[matrixIndex] );
+    ( void )context;
+    printf( "#%-8d %-*s %6dx%-6d %-6s %12zu B\n", entry->id, MAX_MATRIX_NAME_LENGTH - 1,
+            entry->name[0] != 0 ? entry->name : "-", entrySize( entry ), entrySize( entry ),
+            entry->dense != NULL ? "dense" : "csr", entry->bytes );
 }
 
 /*
- * Function:  menuDeleteMatrix
+ * Function:  menuListMatrices
  * --------------------
- *      displays and handles menu for deleting existing matrix
+ *      displays and handles menu for listing all matrices meeting criteria given by user, together with memory
+ *      they occupy
  *
- *      matricesMemory: pointer to list of saved matrices
+ *      registry: registry of saved matrices
  *
  */
-void menuDeleteMatrix( Matrix** matricesMemory )
+void menuListMatrices( MatrixRegistry* registry )
 {
-    printExistingMatrices( matricesMemory );
+    char namePrefix[MAX_MATRIX_NAME_LENGTH + 1];
+    RegistryFilter filter = registryAcceptAll();
 
-    int matrixIndex = ( int )safeNumPrompt( "Index of matrix to be deleted: ", 0, MAX_NUMBER_OF_MATRICES );
-    if( matricesMemory[matrixIndex] == NULL )                                            // Check if matrix exists
-    {
-        puts( FONT_RED_COLOR "There's no matrix with such index!" DEFAULT_DISPLAY );
-        return;
-    }
+    filter.storage = ( int )safeNumPrompt( "Storage (0 - any, 1 - dense, 2 - sparse): ", 0, 2 );
+    filter.minSize = ( int )safeNumPrompt( "Minimal size: ", 0, INT_MAX );
+    filter.maxSize = ( int )safeNumPrompt( "Maximal size: ", filter.minSize, INT_MAX );
+    safeStringPrompt( "Prefix of name (- for any): ", namePrefix, sizeof( namePrefix ) );
+    if( strcmp( namePrefix, "-" ) != 0 )
+        filter.namePrefix = namePrefix;
 
-    deleteSquareMatrix( matricesMemory[matrixIndex] );                                   // Delete matrix structure
-    matricesMemory[matrixIndex] = NULL;                                                  // Set pointer to NULL
+    int listed = registryForEach( registry, &filter, printEntryDetails, NULL );
+    printf( "%d of %d matrices listed, all matrices occupy %zu bytes.\n", listed, registry->count,
+            registry->totalBytes );
 }
 
 /*
- * Function:  operationOnMatrices
+ * Function:  menuGenerateMatrix
  * --------------------
- *      displays and handles menu for operation on matrix
+ *      displays and handles menu for creating matrix of any size filled with one of patterns (see
+ *      MatrixGenerators.h); matrix is saved at first free index
  *
- *      matricesMemory: pointer to list of saved matrices
- *      operation: one of the following values: (MATRICES_ADD | MATRICES_DIFF | MATRICES_MULT)
+ *      registry: registry of saved matrices
  *
  */
-void operationOnMatrices(  Matrix** matricesMemory, int operation )
+void menuGenerateMatrix( MatrixRegistry* registry )
 {
-    Matrix* result;                                 // Result of operation
-    int firstMatrix, secondMatrix;                  // Indexes of first and second matrix
-    int resultMatrixIndex = 0;                      // Index of matrix containing result
-    int errorCode = 0;                              // Error code returned by functions called
+    GeneratorOptions options = { GENERATE_RANDOM, 0, MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE, 0, 0 };
+    Matrix *matrix;
 
-    printExistingMatrices( matricesMemory );
+    int matrixSize = ( int )safeNumPrompt( "Number of cols (=rows): ", 0, INT_MAX );
+    options.pattern = ( int )safeNumPrompt( "Pattern (0 - random, 1 - identity, 2 - diagonal, 3 - banded, "
+                                            "4 - Toeplitz, 5 - Hilbert): ", GENERATE_RANDOM, GENERATE_HILBERT );
+    if( options.pattern != GENERATE_IDENTITY && options.pattern != GENERATE_HILBERT )
+    {
+        options.seed = ( unsigned long )safeNumPrompt( "Seed: ", 0, LONG_MAX );
+        options.minValue = safeNumPrompt( "Minimal value: ", MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE );
+        options.maxValue = safeNumPrompt( "Maximal value: ", options.minValue, MAX_MATRIX_FIELD_VALUE );
+    }
+    if( options.pattern == GENERATE_BANDED )
+    {
+        options.lowerBandwidth = ( int )safeNumPrompt( "Diagonals below main one: ", 0, INT_MAX );
+        options.upperBandwidth = ( int )safeNumPrompt( "Diagonals above main one: ", 0, INT_MAX );
+    }
 
-    firstMatrix = ( int )safeNumPrompt( "Index of first matrix: ", 0, MAX_NUMBER_OF_MATRICES );
-    if( matricesMemory[firstMatrix] == NULL )       // Matrix does not exist
+    if( createSquareMatrix( matrixSize, &matrix ) != 0 )
     {
-        puts( FONT_RED_COLOR "There's no matrix with such index!" DEFAULT_DISPLAY );
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
         return;
     }
-
-    secondMatrix = ( int )safeNumPrompt( "Index of second matrix: ", 0, MAX_NUMBER_OF_MATRICES );
-    if( matricesMemory[secondMatrix] == NULL )      // Matrix does not exist
+    int errorCode = generateMatrix( matrix, &options );
+    if( errorCode != 0 )
     {
-        puts( FONT_RED_COLOR "There's no matrix with such index!" DEFAULT_DISPLAY );
+        if( errorCode == -1 )
+            puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        else
+            puts( FONT_RED_COLOR "Elements of Hilbert matrix of this size are bigger than MAX_LONG!" DEFAULT_DISPLAY );
+        deleteSquareMatrix( matrix );
         return;
     }
+    printf( "Matrix %dx%d generated. ", matrixSize, matrixSize );
+    storeResult( registry, matrix, NULL );
+}
 
-    printf( "Matrix #%d:\n",firstMatrix  );
-    printMatrixAsTable( matricesMemory[firstMatrix] );
-    printf( "Matrix #%d:\n",secondMatrix  );
-    printMatrixAsTable( matricesMemory[secondMatrix] );
+/*
+ * Function:  menuChainMultiply
+ * --------------------
+ *      displays and handles menu for multiplying chain of matrices in the cheapest order (see MatrixChain.c);
+ *      estimated costs of this order and of left-to-right order are shown before product is computed
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuChainMultiply( MatrixRegistry* registry )
+{
+    ChainOperand factors[MAX_CHAIN_LENGTH], product;
+    char labels[MAX_CHAIN_LENGTH][MAX_MATRIX_NAME_LENGTH + 1];
+    const char *labelPointers[MAX_CHAIN_LENGTH];
+    char prompt[64], order[MAX_CHAIN_LENGTH * ( MAX_MATRIX_NAME_LENGTH + 6 )];
+    ChainPlan *plan;
+    WorkspacePool *pool;
 
-    if( operation == MATRICES_ADD )                 // Add matrices
+    printExistingMatrices( registry );
+    const int count = ( int )safeNumPrompt( "Number of matrices in chain: ", 2, MAX_CHAIN_LENGTH );
+    for( int i = 0; i < count; i++ )
     {
-        errorCode = sumSquareMatrix(matricesMemory[firstMatrix], matricesMemory[secondMatrix], &result);
-        printf("Sum of matrix #%d and #%d is: \n", firstMatrix, secondMatrix);
-    } else if( operation == MATRICES_SUB )         // Subtract matrices
+        snprintf( prompt, sizeof( prompt ), "Index or name of matrix %d: ", i + 1 );
+        RegistryEntry *entry = promptExistingMatrix( registry, prompt );
+        if( entry == NULL )                                     // Matrix does not exist
+            return;
+        factors[i].dense = entry->dense;
+        factors[i].sparse = entry->sparse;
+        if( entry->name[0] != 0 )
+            snprintf( labels[i], sizeof( labels[i] ), "%s", entry->name );
+        else
+            snprintf( labels[i], sizeof( labels[i] ), "#%d", entry->id );
+        labelPointers[i] = labels[i];
+    }
+
+    int errorCode = planMatrixChain( factors, count, &plan );
+    if( errorCode == -2 )
     {
-        errorCode = subSquareMatrix(matricesMemory[firstMatrix], matricesMemory[secondMatrix], &result);
-        printf("Differential of matrix #%d and #%d is: \n", firstMatrix, secondMatrix);
-    } else                                          // Multiply matrices
+        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+        return;
+    } else if( errorCode != 0 || createWorkspacePool( plan->size, &pool ) != 0 )
     {
-        errorCode = multiplySquareMatrix(matricesMemory[firstMatrix], matricesMemory[secondMatrix], &result);
-        printf("Multiplication of matrix #%d and #%d is: \n", firstMatrix, secondMatrix);
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        deleteChainPlan( plan );
+        return;
     }
 
-    if( errorCode == -1 )                           // Function returned out-of-memory error
+    const double cost = plan->cost[count - 1], sequentialCost = plan->sequentialCost;
+    formatChainOrder( plan, labelPointers, order, sizeof( order ) );
+    printf( "Cheapest order: %s\n", order );
+    printf( "Estimated cost: %.0f FLOPs (left to right: %.0f FLOPs, %.1f%% saved)\n", 2 * cost, 2 * sequentialCost,
+            sequentialCost > 0 ? 100.0 * ( sequentialCost - cost ) / sequentialCost : 0.0 );
+
+    errorCode = multiplyMatrixChain( factors, plan, pool, &product );
+    if( errorCode == 0 )
+        printf( "Dense products used %d workspace(s) for %d multiplication(s).\n", pool->created, pool->acquired );
+    deleteWorkspacePool( pool );
+    deleteChainPlan( plan );
+
+    if( errorCode == -1 )
     {
-        puts( FONT_RED_COLOR "Out of memory occurred!" DEFAULT_DISPLAY );
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
         return;
-    }else if( errorCode == -2 )                     // Function returned, because matrices does not have the same size
+    } else if( errorCode == -3 )
     {
-        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+        puts( FONT_RED_COLOR "Result is bigger than MAX_LONG!" DEFAULT_DISPLAY );
         return;
     }
 
-    printMatrixAsTable( result );
+    RegistryEntry resultEntry = { .dense = product.dense, .sparse = product.sparse };
+    puts( "Product of chain is: " );
+    printEntry( &resultEntry );
+    storeResult( registry, product.dense, product.sparse );
+}
+
+/*
+ * Function:  menuTransposeMatrix
+ * --------------------
+ *      displays and handles menu for transposing matrix in place
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuTransposeMatrix( MatrixRegistry* registry )
+{
+    int matrixIndex;
+
+    printExistingMatrices( registry );
 
-    resultMatrixIndex = findFirstFreeMatrixIndex( matricesMemory ); // Find first free index for matrix storing our result
-    if( resultMatrixIndex == -1 )                   // If there is not free index, show error
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix to be transposed: ", &matrixIndex );
+    if( matrix == NULL )                                        // If matrix does not exist, error is already printed
+        return;
+    if( transposeSquareMatrixInPlace( matrix ) != 0 )
     {
-        puts( FONT_RED_COLOR "There's no space to save result" DEFAULT_DISPLAY );
-        deleteSquareMatrix( result );
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
         return;
     }
-    printf( "Result was saved at index #%d.\n", resultMatrixIndex);
-    matricesMemory[resultMatrixIndex] = result;     // Save matrix with result
+    printf( "Matrix #%d was transposed:\n", matrixIndex );
+    printMatrixAsTable( matrix );
 }
 
 /*
- * Functions:  menu(Add | Sub | Multiply)Matrices
+ * Function:  menuMultiplyFiles
  * --------------------
- *      does operation specified in function name by calling operationOnMatrices function with appropriate parameter
+ *      displays and handles menu for multiplying matrices stored in binary files, which may not fit in memory;
+ *      result is written to another file
+ *
+ */
+void menuMultiplyFiles( void )
+{
+    char paths[3][MAX_PATH_LENGTH];
+    const char *prompts[3] = { "Path of file of first factor: ", "Path of file of second factor: ", "Path of file of result: " };
+    OutOfCoreStats stats;
+
+    for( int i = 0; i < 3; i++ )
+        safeStringPrompt( ( char* )prompts[i], paths[i], MAX_PATH_LENGTH );
+    const long budget = safeNumPrompt( "Memory budget (in megabytes): ", 1, LONG_MAX >> 20 );
+
+    int errorCode = multiplyMatrixFiles( paths[0], paths[1], paths[2], ( size_t )budget << 20, NULL, &stats );
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Can't read or write file!" DEFAULT_DISPLAY );
+    else if( errorCode == -3 )
+        puts( FONT_RED_COLOR "Files must contain valid matrices of the same size!" DEFAULT_DISPLAY );
+    else if( errorCode == OUT_OF_CORE_OVERFLOW )
+        puts( FONT_RED_COLOR "Result is out of range!" DEFAULT_DISPLAY );
+    else
+        printf( "Product was saved to %s (tiles %dx%d, %ld tiles read, %.3f s, waiting for disk %.1f%% of time).\n",
+                paths[2], stats.tileSize, stats.tileSize, stats.tilesRead, stats.elapsedSeconds,
+                stats.elapsedSeconds > 0 ? 100.0 * stats.stallSeconds / stats.elapsedSeconds : 0.0 );
+}
+
+/*
+ * Function:  menuExactArithmetic
+ * --------------------
+ *      displays and handles menu for operations on integers of arbitrary size (sum, difference, product, power or
+ *      determinant), whose results are exact regardless of their magnitude; resulting matrix is also stored if all
+ *      its elements fit in long integer
  *
- *      matricesMemory: pointer to list of saved matrices
+ *      registry: registry of saved matrices
  *
  */
-void menuAddMatrices( Matrix** matricesMemory )
+void menuExactArithmetic( MatrixRegistry* registry )
 {
-    operationOnMatrices( matricesMemory, MATRICES_ADD );
+    const char *names[5] = { "Sum", "Difference", "Product", "Power", "Determinant" };
+    Matrix *matrices[2] = { NULL, NULL };
+    BigMatrix *operands[2] = { NULL, NULL }, *result = NULL;
+    int indexes[2];
+    long exponent = 0;
+    int errorCode = 0;
+
+    printExistingMatrices( registry );
+    for( int i = 0; i < 5; i++ )
+        printf( "%d.\t%s\n", i + 1, names[i] );
+    const int operation = ( int )safeNumPrompt( "Operation: ", 1, 5 );
+
+    matrices[0] = promptDenseMatrix( registry, operation <= 3 ? "Index or name of first matrix: " : "Index or name of matrix: ",
+                                     &indexes[0] );
+    if( matrices[0] == NULL )                                   // If matrix does not exist, error is already printed
+        return;
+    if( operation <= 3 && ( matrices[1] = promptDenseMatrix( registry, "Index or name of second matrix: ", &indexes[1] ) ) == NULL )
+        return;
+    if( operation == 4 )
+        exponent = safeNumPrompt( "Exponent: ", 0, LONG_MAX );
+
+    for( int i = 0; i < 2 && errorCode == 0; i++ )
+        if( matrices[i] != NULL )
+            errorCode = bigMatrixFromMatrix( matrices[i], &operands[i] );
+
+    if( errorCode == 0 && operation == 5 )
+    {
+        BigInteger determinant = { 0 };
+        LimbArena arena;
+        initLimbArena( &arena );
+        char *text = NULL;
+        if( ( errorCode = detBigMatrix( operands[0], &determinant, &arena ) ) == 0
+            && ( ( text = malloc( bigIntegerDecimalLength( &determinant ) ) ) == NULL
+                 || bigIntegerToString( &determinant, text, &arena ) < 0 ) )
+            errorCode = -1;
+        if( errorCode == 0 )
+            printf( "Determinant of matrix #%d = %s\n", indexes[0], text );
+        free( text );
+        freeLimbArena( &arena );
+    } else if( errorCode == 0 )
+    {
+        if( operation == 1 )
+            errorCode = sumBigMatrix( operands[0], operands[1], &result );
+        else if( operation == 2 )
+            errorCode = subBigMatrix( operands[0], operands[1], &result );
+        else if( operation == 3 )
+            errorCode = multiplyBigMatrix( operands[0], operands[1], &result );
+        else
+            errorCode = powerBigMatrix( operands[0], ( unsigned long )exponent, &result );
+    }
+
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+    else if( result != NULL )
+    {
+        Matrix *dense;
+        printf( "%s is: \n", names[operation - 1] );
+        if( printBigMatrixAsTable( result ) != 0 )
+            puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        errorCode = bigMatrixToMatrix( result, &dense );
+        if( errorCode == 0 )
+            storeResult( registry, dense, NULL );
+        else if( errorCode == -2 )
+            puts( "Result isn't stored, because some of its elements are bigger than MAX_LONG." );
+        else
+            puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    }
+
+    deleteBigMatrix( operands[0] );
+    deleteBigMatrix( operands[1] );
+    deleteBigMatrix( result );
 }
 
-void menuSubMatrices( Matrix** matricesMemory )
+/*
+ * Function:  menuCharacteristicPolynomial
+ * --------------------
+ *      displays exact characteristic polynomial det(xI - A) of matrix (computed on background if it takes long -
+ *      with small elements matrix 200x200 takes about a second and 500x500 half a minute on one core)
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *
+ */
+void menuCharacteristicPolynomial( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
 {
-    operationOnMatrices( matricesMemory, MATRICES_SUB );
+    int index;
+    char description[64];
+    BackgroundJob* job;
+    CacheKey key = { 0 };                                       // Polynomials aren't cached
+
+    printExistingMatrices( registry );
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix: ", &index );
+    if( matrix == NULL )                                        // If matrix does not exist, error is already printed
+        return;
+
+    snprintf( description, sizeof( description ), "Characteristic polynomial of matrix #%d", index );
+    if( startBackgroundJob( JOB_CHARACTERISTIC_POLYNOMIAL, matrix, NULL, 0, 0, &job ) != 0 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else
+        runJob( registry, cache, jobs, job, key, description );
 }
 
-void menuMultiplyMatrices( Matrix** matricesMemory )
+/*
+ * Function:  menuEigenvalues
+ * --------------------
+ *      displays all (also complex) eigenvalues of matrix
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuEigenvalues( MatrixRegistry* registry )
 {
-    operationOnMatrices( matricesMemory, MATRICES_MULT );
+    int index;
+
+    printExistingMatrices( registry );
+    Matrix *matrix = promptDenseMatrix( registry, "Index or name of matrix: ", &index );
+    if( matrix == NULL )                                        // If matrix does not exist, error is already printed
+        return;
+
+    double *real = malloc( sizeof( double ) * ( ( size_t )matrix->size + 1 ) );
+    double *imaginary = malloc( sizeof( double ) * ( ( size_t )matrix->size + 1 ) );
+    const int errorCode = real == NULL || imaginary == NULL ? -1 : eigenvaluesSquareMatrix( matrix, real, imaginary );
+    if( errorCode == -1 )
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Eigenvalues could not be found (QR algorithm didn't converge)!" DEFAULT_DISPLAY );
+    else
+    {
+        printf( "Eigenvalues of matrix #%d:\n", index );
+        for( int i = 0; i < matrix->size; i++ )
+            if( imaginary[i] == 0.0 )
+                printf( "%d.\t%.10g\n", i + 1, real[i] );
+            else
+                printf( "%d.\t%.10g %c %.10gi\n", i + 1, real[i], imaginary[i] < 0 ? '-' : '+', fabs( imaginary[i] ) );
+    }
+    free( real );
+    free( imaginary );
 }
 
 /*
- * Function:  menuDeterminant
+ * Function:  menuAllMatrices
  * --------------------
- *      displays and handles menu for calculating matrix determinant
+ *      displays and handles menu for operations on all stored dense matrices at once (determinant of every
+ *      matrix, product of every matrix and selected one or sum of all matrices of given size); matrices are
+ *      processed concurrently and results are printed as table
  *
- *      matricesMemory: pointer to list of saved matrices
+ *      registry: registry of saved matrices
  *
  */
-void menuDeterminant( Matrix** matricesMemory )
+void menuAllMatrices( MatrixRegistry* registry )
 {
-    long result = 0;
-    int matrixIndex;
-    int errorCode = 0;
+    BulkOperation *operation;
+    Matrix *factor = NULL, *sum;
+    LimbArena scratch;
+    int size = -1, factorIndex = 0;
+
+    puts( "1.	Determinant of every matrix" );
+    puts( "2.	Multiply every matrix by selected one" );
+    puts( "3.	Sum of all matrices of given size" );
+    const int choice = ( int )safeNumPrompt( "Operation: ", 1, 3 );
+    if( choice == 2 )
+    {
+        printExistingMatrices( registry );
+        if( ( factor = promptDenseMatrix( registry, "Index or name of matrix: ", &factorIndex ) ) == NULL )
+            return;                                             // If matrix does not exist, error is already printed
+    } else if( choice == 3 )
+        size = ( int )safeNumPrompt( "Number of cols (=rows): ", 0, INT_MAX );
 
-    printExistingMatrices( matricesMemory );
+    if( createBulkOperation( registry, size, &operation ) != 0 )
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        return;
+    }
 
-    matrixIndex = ( int )safeNumPrompt( "Index of matrix: ", 0, MAX_NUMBER_OF_MATRICES);
-    if( matricesMemory[matrixIndex] == NULL)                    // If matrix does not exist, print error
+    if( choice == 3 )
     {
-        puts( FONT_RED_COLOR "There's no matrix with such index!" DEFAULT_DISPLAY );
+        const int errorCode = bulkSum( operation, &sum );
+        printf( "Sum of %d matrices (%d threads):\n", operation->count, operation->threads );
+        deleteBulkOperation( operation );
+        if( errorCode == -1 )
+            puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        else if( errorCode == -2 )
+            puts( FONT_RED_COLOR "There are no matrices of this size!" DEFAULT_DISPLAY );
+        else if( errorCode == -3 )
+            puts( FONT_RED_COLOR "Result is out of range!" DEFAULT_DISPLAY );
+        else
+        {
+            printMatrixAsTable( sum );
+            storeResult( registry, sum, NULL );
+        }
         return;
     }
 
-    errorCode = detSquareMatrix( matricesMemory[matrixIndex], &result );
+    if( choice == 1 )
+        bulkDeterminants( operation );
+    else
+        bulkMultiply( operation, factor );
+    printf( "%d matrices (%d threads):\n", operation->count, operation->threads );
+    printf( "Index\t%-*s\tSize\t%s\n", MAX_MATRIX_NAME_LENGTH - 1, "Name",
+            choice == 1 ? "Determinant" : "Product" );
+
+    initLimbArena( &scratch );
+    for( int i = 0; i < operation->count; i++ )                 // Products are stored after all are computed
+    {
+        BulkItem *item = &operation->items[i];
+        int id;
+        printf( "#%d\t%-*s\t%d\t", item->entry->id, MAX_MATRIX_NAME_LENGTH - 1, item->entry->name,
+                item->entry->dense->size );
+        if( choice == 2 && item->errorCode == 0 && registryAdd( registry, NULL, item->product, NULL, &id ) != 0 )
+            item->errorCode = -1;
+
+        if( item->errorCode == -1 )
+            puts( FONT_RED_COLOR "Out of memory" DEFAULT_DISPLAY );
+        else if( item->errorCode == -2 )
+            puts( FONT_RED_COLOR "Different size" DEFAULT_DISPLAY );
+        else if( item->errorCode == -3 )
+            puts( FONT_RED_COLOR "Out of range" DEFAULT_DISPLAY );
+        else if( choice == 2 )
+        {
+            item->product = NULL;                               // Owned by registry now
+            printf( "saved at index #%d\n", id );
+        } else
+        {
+            char *text = malloc( bigIntegerDecimalLength( &item->determinant ) );
+            if( text == NULL || bigIntegerToString( &item->determinant, text, &scratch ) < 0 )
+                puts( FONT_RED_COLOR "Out of memory" DEFAULT_DISPLAY );
+            else
+                puts( text );
+            free( text );
+        }
+    }
+    freeLimbArena( &scratch );
+    deleteBulkOperation( operation );
+}
+
+/*
+ * Function:  menuModularArithmetic
+ * --------------------
+ *      displays and handles menu for row reduction over prime field GF(p) (rank, reduced row echelon form, basis
+ *      of null space or solution of system AX = B); resulting matrix is stored
+ *
+ *      registry: registry of saved matrices
+ *
+ */
+void menuModularArithmetic( MatrixRegistry* registry )
+{
+    const char *names[4] = { "Rank", "Reduced row echelon form", "Null space", "Solve AX = B" };
+    Matrix *a, *b = NULL, *result = NULL;
+    int index, value = 0, errorCode;
 
-    if( errorCode == -1 ) // If detSquareMatrix returned -1, we are out-of-memory
+    printExistingMatrices( registry );
+    for( int i = 0; i < 4; i++ )
+        printf( "%d.\t%s\n", i + 1, names[i] );
+    const int choice = ( int )safeNumPrompt( "Operation: ", 1, 4 );
+    const long modulus = safeNumPrompt( "Prime modulus p: ", 2, MODULAR_MAX_MODULUS );
+    if( !isValidModulus( modulus ) )
     {
+        puts( FONT_RED_COLOR "Modulus must be prime!" DEFAULT_DISPLAY );
+        return;
+    }
+    if( ( a = promptDenseMatrix( registry, choice == 4 ? "Index or name of matrix A: " : "Index or name of matrix: ",
+                                 &index ) ) == NULL )
+        return;                                                 // If matrix does not exist, error is already printed
+    if( choice == 4 && ( b = promptDenseMatrix( registry, "Index or name of matrix B: ", NULL ) ) == NULL )
+        return;
+
+    if( choice == 1 )
+        errorCode = rankModular( a, modulus, &value );
+    else if( choice == 2 )
+        errorCode = reducedEchelonModular( a, modulus, &result, &value );
+    else if( choice == 3 )
+        errorCode = nullSpaceModular( a, modulus, &result, &value );
+    else
+        errorCode = solveModular( a, b, modulus, &result );
+
+    if( errorCode == -1 )
         puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+    else if( errorCode == -2 )
+        puts( FONT_RED_COLOR "Matrices must have the same size!" DEFAULT_DISPLAY );
+    else if( errorCode == MODULAR_NO_SOLUTION )
+        puts( FONT_RED_COLOR "System has no solution!" DEFAULT_DISPLAY );
+    else
+    {
+        if( choice <= 2 )
+            printf( "Rank of matrix #%d over GF(%ld) = %d\n", index, modulus, value );
+        else if( choice == 3 )
+            printf( "Null space of matrix #%d over GF(%ld) has dimension %d (basis vectors are the first rows):\n",
+                    index, modulus, value );
+        if( result != NULL )
+        {
+            printMatrixAsTable( result );
+            storeResult( registry, result, NULL );
+        }
+    }
+}
+
+/*
+ * Function:  menuStatistics
+ * --------------------
+ *      prints totals of measured operations (wall time, arithmetic operations per second, memory of matrices
+ *      allocated and freed, hardware counters) and lets user reset them, switch hardware counters or profiling
+ *      itself (disabled at start) or save statistics as JSON
+ *
+ */
+void menuStatistics( void )
+{
+    OperationProfile profiles[NUMBER_OF_PROFILED_OPERATIONS];
+    char path[MAX_PATH_LENGTH];
+
+    getOperationProfiles( profiles );
+    printf( "%-12s %8s %12s %10s %14s %14s %8s", "Operation", "Calls", "Time [ms]", "MFLOP/s", "Allocated [kB]",
+            "Freed [kB]", "Allocs" );
+    printf( hardwareCountersEnabled() ? " %14s %12s\n" : "\n", "Cycles", "LLC misses" );
+    for( int operation = 0; operation < NUMBER_OF_PROFILED_OPERATIONS; operation++ )
+    {
+        const OperationProfile *profile = &profiles[operation];
+        printf( "%-12s %8ld %12.3f %10.1f %14.1f %14.1f %8ld", profiledOperationName( operation ), profile->calls,
+                profile->nanoseconds / 1e6, profile->nanoseconds > 0 ? profile->flops * 1e3 / profile->nanoseconds : 0.0,
+                profile->bytesAllocated / 1024.0, profile->bytesFreed / 1024.0, profile->allocations );
+        if( hardwareCountersEnabled() )
+            printf( " %14ld %12ld", profile->cycles, profile->cacheMisses );
+        printf( "\n" );
+    }
+
+    if( !profilingEnabled() )
+        puts( "Profiling is disabled - operations aren't measured until it is enabled." );
+
+    puts( "1.\tReset statistics" );
+    printf( "2.\t%s hardware counters (cycles, last level cache misses)\n",
+            hardwareCountersEnabled() ? "Disable" : "Enable" );
+    puts( "3.\tSave statistics as JSON" );
+    printf( "4.\t%s profiling\n", profilingEnabled() ? "Disable" : "Enable" );
+    puts( "0.\tReturn" );
+    const int choice = ( int )safeNumPrompt( "> ", 0, 4 );
+
+    if( choice == 1 )
+        resetProfiler();
+    else if( choice == 2 && enableHardwareCounters( !hardwareCountersEnabled() ) != 0 )
+        puts( FONT_RED_COLOR "Hardware counters aren't available (see /proc/sys/kernel/perf_event_paranoid)!"
+              DEFAULT_DISPLAY );
+    else if( choice == 4 )
+        enableProfiling( !profilingEnabled() );
+    else if( choice == 3 )
+    {
+        safeStringPrompt( "Path of file: ", path, MAX_PATH_LENGTH );
+        FILE *file = fopen( path, "w" );
+        if( file == NULL )
+        {
+            puts( FONT_RED_COLOR "Can't open file!" DEFAULT_DISPLAY );
+            return;
+        }
+        writeProfileJson( file );
+        fputc( '\n', file );
+        if( fclose( file ) != 0 )
+            puts( FONT_RED_COLOR "Can't write file!" DEFAULT_DISPLAY );
+        else
+            printf( "Statistics were saved to %s.\n", path );
+    }
+}
+
+/*
+ * Function:  menuJobs
+ * --------------------
+ *      lists operations running on background and shows progress of selected one until it finishes; while
+ *      watching, key 'c' cancels operation and 'q' returns to menu leaving it running
+ *
+ *      registry: registry of saved matrices
+ *      cache: cache of results of operations
+ *      jobs: list of background operations
+ *
+ */
+void menuJobs( MatrixRegistry* registry, ResultCache* cache, JobList* jobs )
+{
+    PendingJob *watched = NULL;
+    int key = 0;
+
+    collectFinishedJobs( registry, cache, jobs );
+    if( jobs->first == NULL )
+    {
+        puts( "There are no running jobs." );
         return;
-    } else if( errorCode == -2 ) // If detSquareMatrix returned -2, integer overflow occurred
+    }
+    for( PendingJob *pending = jobs->first; pending != NULL; pending = pending->next )
+        printf( "#%d\t%5.1f%%\t%s\n", pending->number, 100.0 * backgroundJobProgress( pending->job ),
+                pending->description );
+
+    const int number = ( int )safeNumPrompt( "Number of job to watch (0 to return): ", 0, INT_MAX );
+    for( watched = jobs->first; watched != NULL && watched->number != number; watched = watched->next );
+    if( watched == NULL )
     {
-        puts( FONT_RED_COLOR "Result is bigger than MAX_LONG!" DEFAULT_DISPLAY );
+        if( number != 0 )
+            puts( FONT_RED_COLOR "There's no job with such number!" DEFAULT_DISPLAY );
         return;
     }
 
-    printMatrixAsTable( matricesMemory[matrixIndex] );
-    printf( "Determinant of matrix #%d = %ld\n", matrixIndex, result );
+    switchTerminalToNonBufferingMode();
+    while( !isBackgroundJobFinished( watched->job ) && key != 'q' && key != EOF )
+    {
+        printf( "\r" CLEAR_CURRENT_LINE "Job #%d: %5.1f%% (c - cancel, q - return to menu)", watched->number,
+                100.0 * backgroundJobProgress( watched->job ) );
+        fflush( stdout );
+
+        fd_set input;
+        struct timeval timeout = { 0, JOB_REFRESH_INTERVAL * 1000 };
+        FD_ZERO( &input );
+        FD_SET( STDIN_FILENO, &input );
+        if( select( STDIN_FILENO + 1, &input, NULL, NULL, &timeout ) > 0 )  // Key pressed before refresh
+        {
+            key = getchar();
+            if( key == 'c' )                                    // Operation stops after current row (or minor)
+                cancelBackgroundJob( watched->job );
+        }
+    }
+    switchTerminalToDefaultMode();
+    printf( "\n" );
+    collectFinishedJobs( registry, cache, jobs );
 }
 
 /*
@@ -315,62 +1609,212 @@ void printHelp( void )
     puts( "6.\tSubtract matrices" );
     puts( "7.\tMultiply matrices" );
     puts( "8.\tDeterminant" );
-    puts( "9.\tHelp" );
+    puts( "9.\tPower of matrix" );
+    puts( "10.\tVerify product" );
+    puts( "11.\tSave matrix to file" );
+    puts( "12.\tLoad matrix from file" );
+    puts( "13.\tImport matrix from text file" );
+    puts( "14.\tExport matrix to text file" );
+    puts( "15.\tConvert storage (dense <-> sparse)" );
+    puts( "16.\tDuplicate matrix" );
+    puts( "17.\tList matrices" );
+    puts( "18.\tGenerate matrix" );
+    puts( "19.\tMultiply chain of matrices" );
+    puts( "20.\tTranspose matrix" );
+    puts( "21.\tMultiply matrix files (out of core)" );
+    puts( "22.\tExact arithmetic (integers of any size)" );
+    puts( "23.\tCharacteristic polynomial" );
+    puts( "24.\tEigenvalues" );
+    puts( "25.\tOperations on all matrices (determinants, products, sum)" );
+    puts( "26.\tModular arithmetic (rank, echelon form, null space, solving over GF(p))" );
+    puts( "27.\tStatistics (time, operations and memory of operations)" );
+    puts( "28.\tJobs (progress and cancelling of background operations)" );
+    puts( "29.\tHelp" );
     puts( "0.\tQuit" );
     puts( "Type a number of a command to execute it" );
 }
 
+/*
+ * Function:  runBatchMode
+ * --------------------
+ *      executes script of commands (see MatrixBatch.c) without any prompts and control sequences
+ *
+ *      path: path of script, "-" for standard input
+ *
+ *      returns: exit code of program - 0 if all commands succeeded, 1 otherwise
+ *
+ */
+int runBatchMode( const char *path, MatrixRegistry* registry, ResultCache* cache )
+{
+    FILE *script = strcmp( path, "-" ) == 0 ? stdin : fopen( path, "r" );
+    if( script == NULL )
+    {
+        fprintf( stderr, "Can't open script %s\n", path );
+        return 1;
+    }
+
+    int errorCode = runBatchScript( script, stdout, registry, cache );
+    if( errorCode == -2 )
+        fputs( "Out of memory while reading script\n", stderr );
+    if( script != stdin )
+        fclose( script );
+    return errorCode == 0 ? 0 : 1;
+}
+
+/*
+ * Function:  runServerMode
+ * --------------------
+ *      serves requests of other processes (see MatrixServer.c) until program receives SIGINT or SIGTERM
+ *
+ *      socketPath:     path of Unix domain socket
+ *      stateDirectory: directory where matrices are persisted between runs (NULL - they aren't)
+ *
+ *      returns: exit code of program - 0 on success, 1 otherwise
+ *
+ */
+int runServerMode( const char *socketPath, const char *stateDirectory, MatrixRegistry* registry, ResultCache* cache )
+{
+    const int errorCode = runMatrixServer( socketPath, stateDirectory, registry, cache );
+    if( errorCode == -1 )
+        fputs( "Out of memory\n", stderr );
+    else if( errorCode == -2 )
+        fprintf( stderr, "Can't listen on socket %s (is another server using it?)\n", socketPath );
+    else if( errorCode == -3 )
+        fprintf( stderr, "Can't load or save matrices in directory %s\n", stateDirectory );
+    return errorCode == 0 ? 0 : 1;
+}
+
 /*
  * Function:  main
  * --------------------
- *      main program logic
+ *      main program logic; with arguments "-b [script]" program runs in batch mode, reading script from file (or
+ *      from standard input if path is omitted or equal to "-"); with arguments "-s socket [directory]" it runs as
+ *      server, keeping matrices in directory between runs
  *
  *      returns: 0 on success, other on error
  *
  */
-int main() {
+int main( int argc, char **argv ) {
     int quitRequested = 0;                                                  // Flag set if user wants to exit program
     enum AvailableOptions command_selected = 0;
-    Matrix** matricesMemory;
+    MatrixRegistry* registry = NULL;
+    ResultCache* cache;
+    JobList jobs = { NULL, 1 };                                             // Operations running on background
 
-    matricesMemory = calloc( MAX_NUMBER_OF_MATRICES, sizeof( Matrix* ) );   // Allocate memory for matrices array
-    if( matricesMemory == NULL )                                            // If we are unable to do this, exit with error
+    // Create registry of matrices and cache; if we are unable to do this, exit with error
+    if( createMatrixRegistry( &registry ) != 0 || createResultCache( RESULT_CACHE_BUDGET, &cache ) != 0 )
     {
         puts( FONT_RED_COLOR "Can't allocate memory." DEFAULT_DISPLAY );
+        deleteMatrixRegistry( registry );
         return 1;
     }
 
+    if( argc > 1 )                                                          // Non-interactive mode requested
+    {
+        int exitCode = 2;
+        if( strcmp( argv[1], "-b" ) == 0 && argc <= 3 )
+            exitCode = runBatchMode( argc == 3 ? argv[2] : "-", registry, cache );
+        else if( strcmp( argv[1], "-s" ) == 0 && ( argc == 3 || argc == 4 ) )
+            exitCode = runServerMode( argv[2], argc == 4 ? argv[3] : NULL, registry, cache );
+        else
+            fprintf( stderr, "Usage: %s [-b [script] | -s socket [directory]]\n", argv[0] );
+        deleteMatrixRegistry( registry );
+        deleteResultCache( cache );
+        return exitCode;
+    }
+
     printHelp();                                                            // Show help
     while( !quitRequested )
     {
-        command_selected =  ( int )safeNumPrompt( "> ", 0,  9 );            // Get option from user
+        collectFinishedJobs( registry, cache, &jobs );                      // Show results ready meanwhile
+        command_selected =  ( int )safeNumPrompt( "> ", 0, HELP );            // Get option from user
         printf( "> %d\n", command_selected );                               // Print selected option
 
         switch( command_selected )
         {
             case CREATE_MATRIX:
-                menuCreateMatrix( matricesMemory );
+                menuCreateMatrix( registry );
                 break;
             case EDIT_MATRIX:
-                menuEditMatrix( matricesMemory );
+                menuEditMatrix( registry );
                 break;
             case PRINT_MATRIX:
-                menuPrintMatrix( matricesMemory );
+                menuPrintMatrix( registry );
                 break;
             case DELETE_MATRIX:
-                menuDeleteMatrix( matricesMemory );
+                menuDeleteMatrix( registry );
                 break;
             case ADD_MATRICES:
-                menuAddMatrices( matricesMemory );
+                menuAddMatrices( registry, cache, &jobs );
                 break;
             case SUB_MATRICES:
-                menuSubMatrices( matricesMemory );
+                menuSubMatrices( registry, cache, &jobs );
                 break;
             case MULTIPLY_MATRICES:
-                menuMultiplyMatrices( matricesMemory );
+                menuMultiplyMatrices( registry, cache, &jobs );
                 break;
             case DETERMINANT:
-                menuDeterminant( matricesMemory );
+                menuDeterminant( registry, cache, &jobs );
+                break;
+            case POWER_MATRIX:
+                menuPowerMatrix( registry, cache, &jobs );
+                break;
+            case VERIFY_PRODUCT:
+                menuVerifyProduct( registry );
+                break;
+            case SAVE_MATRIX:
+                menuSaveMatrix( registry );
+                break;
+            case LOAD_MATRIX:
+                menuLoadMatrix( registry );
+                break;
+            case IMPORT_MATRIX:
+                menuImportMatrix( registry );
+                break;
+            case EXPORT_MATRIX:
+                menuExportMatrix( registry );
+                break;
+            case CONVERT_STORAGE:
+                menuConvertStorage( registry );
+                break;
+            case DUPLICATE_MATRIX:
+                menuDuplicateMatrix( registry );
+                break;
+            case LIST_MATRICES:
+                menuListMatrices( registry );
+                break;
+            case GENERATE_MATRIX:
+                menuGenerateMatrix( registry );
+                break;
+            case CHAIN_MULTIPLY:
+                menuChainMultiply( registry );
+                break;
+            case TRANSPOSE_MATRIX:
+                menuTransposeMatrix( registry );
+                break;
+            case MULTIPLY_FILES:
+                menuMultiplyFiles();
+                break;
+            case EXACT_ARITHMETIC:
+                menuExactArithmetic( registry );
+                break;
+            case CHARACTERISTIC_POLYNOMIAL:
+                menuCharacteristicPolynomial( registry, cache, &jobs );
+                break;
+            case EIGENVALUES:
+                menuEigenvalues( registry );
+                break;
+            case ALL_MATRICES:
+                menuAllMatrices( registry );
+                break;
+            case MODULAR_ARITHMETIC:
+                menuModularArithmetic( registry );
+                break;
+            case STATISTICS:
+                menuStatistics();
+                break;
+            case JOBS:
+                menuJobs( registry, cache, &jobs );
                 break;
             case HELP:
                 printHelp();
@@ -384,12 +1828,9 @@ int main() {
         }
     }
 
-    // Free memory occupied by not deleted matrices
-    for( int i = 0; i < MAX_NUMBER_OF_MATRICES; i++ )
-        if( matricesMemory[i] != NULL )
-            deleteSquareMatrix( matricesMemory[i] );
-
-    free(matricesMemory);                                                   // Free memory used by matrices array
+    deleteJobs( &jobs );                                                    // Cancel operations still running
+    deleteMatrixRegistry( registry );                                       // Free memory occupied by not deleted matrices
+    deleteResultCache( cache );
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,418 @@
+/*
+ * File: MatrixChain.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Product of chain of matrices computed in the cheapest order
+ *
+ * All matrices of calculator are square and of the same size within a product, so for dense factors every
+ * order costs the same size^3 multiply-adds per multiplication. Order matters when some factors are sparse:
+ * product of sparse matrices costs about nonZeros1 * nonZeros2 / size operations and is usually much sparser
+ * than dense matrix, while any multiplication involving dense matrix costs size^3. Plan is chosen by classic
+ * O(count^3) dynamic programming over this cost model.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "MatrixChain.h"
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Intermediate result of chain product
+struct ChainValue {
+    Matrix *dense;                              // Exactly one of pointers is set (both are NULL after error)
+    SparseMatrix *sparse;
+    int owned;                                  // Set if value was computed (not one of factors)
+};
+typedef struct ChainValue ChainValue;
+
+/*
+ * Function:  createWorkspacePool
+ * --------------------
+ *      creates empty pool of workspaces for matrices of given size
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createWorkspacePool( int size, WorkspacePool **output )
+{
+    WorkspacePool *pool = calloc( 1, sizeof( WorkspacePool ) );
+    if( pool == NULL )
+        return -1;
+    pool->size = size;
+    *output = pool;
+    return 0;
+}
+
+/*
+ * Function:  deleteWorkspacePool
+ * --------------------
+ *      frees pool and all workspaces available in it (acquired ones belong to caller)
+ *
+ */
+void deleteWorkspacePool( WorkspacePool *pool )
+{
+    if( pool == NULL )
+        return;
+    for( int i = 0; i < pool->count; i++ )
+        deleteSquareMatrix( pool->available[i] );
+    free( pool->available );
+    free( pool );
+}
+
+/*
+ * Function:  acquireWorkspace
+ * --------------------
+ *      takes matrix of size of pool - released one if there is any, otherwise newly allocated one. Elements of
+ *      workspace are undefined
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int acquireWorkspace( WorkspacePool *pool, Matrix **output )
+{
+    pool->acquired++;
+    if( pool->count > 0 )
+    {
+        *output = pool->available[--pool->count];
+        return 0;
+    }
+    if( createSquareMatrix( pool->size, output ) != 0 )
+        return -1;
+    pool->created++;
+    return 0;
+}
+
+/*
+ * Function:  releaseWorkspace
+ * --------------------
+ *      gives matrix of size of pool back to it, so it can be acquired again; if there's no memory to keep it,
+ *      matrix is deleted
+ *
+ */
+void releaseWorkspace( WorkspacePool *pool, Matrix *workspace )
+{
+    if( workspace == NULL )
+        return;
+    if( workspace->size != pool->size )                 // Not a workspace of this pool
+    {
+        deleteSquareMatrix( workspace );
+        return;
+    }
+    if( pool->count == pool->capacity )
+    {
+        const int capacity = pool->capacity > 0 ? 2 * pool->capacity : 4;
+        Matrix **available = realloc( pool->available, sizeof( Matrix* ) * ( size_t )capacity );
+        if( available == NULL )
+        {
+            deleteSquareMatrix( workspace );
+            return;
+        }
+        pool->available = available;
+        pool->capacity = capacity;
+    }
+    pool->available[pool->count++] = workspace;
+}
+
+/*
+ * Function <private>:  _density
+ * --------------------
+ *      returns fraction of non-zero elements of factor (1 for dense matrix)
+ *
+ */
+static double _density( const ChainOperand *factor, int size )
+{
+    if( factor->sparse == NULL || size == 0 )
+        return 1.0;
+    return ( double )factor->sparse->nonZeros / ( ( double )size * size );
+}
+
+/*
+ * Function <private>:  _productCost
+ * --------------------
+ *      estimates multiply-adds of product of matrices with given densities and density of this product (every
+ *      element of result is a sum of "size" products, so its density is at most size * density1 * density2);
+ *      density 1 means that matrix is dense and dense kernel will be used
+ *
+ */
+static double _productCost( double density1, double density2, int size, double *productDensity )
+{
+    const double cube = ( double )size * size * size;
+
+    if( density1 >= 1.0 || density2 >= 1.0 )
+    {
+        *productDensity = 1.0;
+        return cube;
+    }
+    *productDensity = density1 * density2 * size;
+    if( *productDensity > 1.0 - 1e-9 )                  // Still sparse storage, but no longer cheaper
+        *productDensity = 1.0 - 1e-9;
+    return density1 * density2 * cube;
+}
+
+/*
+ * Function:  planMatrixChain
+ * --------------------
+ *      finds order of multiplications with the lowest estimated cost (see description of file)
+ *
+ *      factors: array of multiplied matrices
+ *      count:   number of factors (at least 2)
+ *      output:  pointer to memory where pointer to plan should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if factors don't have the same size or there are less than 2
+ *
+ */
+int planMatrixChain( const ChainOperand *factors, int count, ChainPlan **output )
+{
+    if( count < 2 )
+        return -2;
+    const int size = factors[0].dense != NULL ? factors[0].dense->size : factors[0].sparse->size;
+    for( int i = 1; i < count; i++ )
+        if( ( factors[i].dense != NULL ? factors[i].dense->size : factors[i].sparse->size ) != size )
+            return -2;
+
+    ChainPlan *plan = malloc( sizeof( ChainPlan ) );
+    const size_t cells = ( size_t )count * ( size_t )count;
+    if( plan == NULL )
+        return -1;
+    plan->count = count;
+    plan->size = size;
+    plan->split = calloc( cells, sizeof( int ) );
+    plan->cost = calloc( cells, sizeof( double ) );
+    plan->density = calloc( cells, sizeof( double ) );
+    if( plan->split == NULL || plan->cost == NULL || plan->density == NULL )
+    {
+        deleteChainPlan( plan );
+        return -1;
+    }
+
+    for( int i = 0; i < count; i++ )
+        plan->density[i * count + i] = _density( &factors[i], size );
+
+    for( int length = 2; length <= count; length++ )    // Products of "length" consecutive factors
+        for( int first = 0; first + length - 1 < count; first++ )
+        {
+            const int last = first + length - 1;
+            double *best = &plan->cost[first * count + last];
+            *best = -1;
+            // Splits are tried from the right end, so on ties (ex. all factors dense) left-to-right order wins
+            for( int split = last - 1; split >= first; split-- )
+            {
+                double density;
+                double cost = plan->cost[first * count + split] + plan->cost[( split + 1 ) * count + last]
+                              + _productCost( plan->density[first * count + split],
+                                              plan->density[( split + 1 ) * count + last], size, &density );
+                if( *best < 0 || cost < *best )
+                {
+                    *best = cost;
+                    plan->split[first * count + last] = split;
+                    plan->density[first * count + last] = density;
+                }
+            }
+        }
+
+    double density = plan->density[0];
+    plan->sequentialCost = 0;
+    for( int i = 1; i < count; i++ )
+        plan->sequentialCost += _productCost( density, plan->density[i * count + i], size, &density );
+
+    *output = plan;
+    return 0;
+}
+
+/*
+ * Function:  deleteChainPlan
+ * --------------------
+ *      frees memory used by plan
+ *
+ */
+void deleteChainPlan( ChainPlan *plan )
+{
+    if( plan == NULL )
+        return;
+    free( plan->split );
+    free( plan->cost );
+    free( plan->density );
+    free( plan );
+}
+
+/*
+ * Function <private>:  _appendText
+ * --------------------
+ *      appends text to buffer at given position and moves position after it; text exceeding buffer is counted,
+ *      but not written
+ *
+ */
+static void _appendText( char *buffer, size_t length, size_t *position, const char *text )
+{
+    const size_t offset = *position < length ? *position : length;
+    *position += ( size_t )snprintf( buffer + offset, length - offset, "%s", text );
+}
+
+/*
+ * Function <private>:  _appendOrder
+ * --------------------
+ *      appends product of factors first..last to buffer; every product except the whole chain is parenthesized
+ *
+ */
+static void _appendOrder( const ChainPlan *plan, const char **labels, int first, int last, char *buffer,
+                          size_t length, size_t *position )
+{
+    if( first == last )
+    {
+        _appendText( buffer, length, position, labels[first] );
+        return;
+    }
+
+    const int nested = first != 0 || last != plan->count - 1;
+    const int split = plan->split[first * plan->count + last];
+    if( nested )
+        _appendText( buffer, length, position, "(" );
+    _appendOrder( plan, labels, first, split, buffer, length, position );
+    _appendText( buffer, length, position, " * " );
+    _appendOrder( plan, labels, split + 1, last, buffer, length, position );
+    if( nested )
+        _appendText( buffer, length, position, ")" );
+}
+
+/*
+ * Function:  formatChainOrder
+ * --------------------
+ *      writes order of multiplications as parenthesized expression, ex. "(A * B) * C"
+ *
+ *      plan:   plan of chain product
+ *      labels: names of factors used in expression
+ *      buffer: place where expression should be written (it's always terminated with NULL if length > 0)
+ *      length: size of buffer
+ *
+ *      returns: length of whole expression (if it's not lower than "length", expression was truncated)
+ *
+ */
+int formatChainOrder( const ChainPlan *plan, const char **labels, char *buffer, size_t length )
+{
+    size_t position = 0;
+
+    if( length > 0 )
+        buffer[0] = 0;
+    _appendOrder( plan, labels, 0, plan->count - 1, buffer, length, &position );
+    return ( int )position;
+}
+
+/*
+ * Function <private>:  _releaseValue
+ * --------------------
+ *      frees intermediate result (factors of chain are left untouched); dense results go back to pool
+ *
+ */
+static void _releaseValue( WorkspacePool *pool, ChainValue *value )
+{
+    if( !value->owned )
+        return;
+    releaseWorkspace( pool, value->dense );
+    deleteSparseMatrix( value->sparse );
+}
+
+/*
+ * Function <private>:  _multiplyValues
+ * --------------------
+ *      multiplies intermediate results: sparse by sparse gives sparse matrix, other pairs are multiplied as dense
+ *      matrices into workspace from pool
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if sizes are different, -3 on long integer overflow
+ *
+ */
+static int _multiplyValues( WorkspacePool *pool, ChainValue *left, ChainValue *right, ChainValue *product )
+{
+    Matrix *operands[2] = { left->dense, right->dense };
+    int errorCode = 0;
+
+    product->dense = NULL;
+    product->sparse = NULL;
+    product->owned = 1;
+    if( left->sparse != NULL && right->sparse != NULL )
+        return multiplySparseMatrix( left->sparse, right->sparse, &product->sparse );
+
+    if( ( operands[0] == NULL && sparseToDenseMatrix( left->sparse, &operands[0] ) != 0 )
+        || ( operands[1] == NULL && sparseToDenseMatrix( right->sparse, &operands[1] ) != 0 )
+        || acquireWorkspace( pool, &product->dense ) != 0 )
+        errorCode = -1;
+    else
+        errorCode = multiplySquareMatrixInto( operands[0], operands[1], product->dense );
+
+    if( errorCode != 0 )
+    {
+        releaseWorkspace( pool, product->dense );
+        product->dense = NULL;
+    }
+    if( operands[0] != left->dense )                    // Dense forms of sparse factors become workspaces
+        releaseWorkspace( pool, operands[0] );
+    if( operands[1] != right->dense )
+        releaseWorkspace( pool, operands[1] );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _evaluate
+ * --------------------
+ *      computes product of factors first..last in order given by plan; intermediate results are released as soon
+ *      as they are used, so at most one workspace per level of plan is in use
+ *
+ *      returns: 0 on success, -1 on out of memory, -3 on long integer overflow
+ *
+ */
+static int _evaluate( const ChainOperand *factors, const ChainPlan *plan, WorkspacePool *pool, int first, int last,
+                      ChainValue *value )
+{
+    ChainValue left, right;
+
+    if( first == last )
+    {
+        value->dense = factors[first].dense;
+        value->sparse = factors[first].sparse;
+        value->owned = 0;
+        return 0;
+    }
+
+    const int split = plan->split[first * plan->count + last];
+    int errorCode = _evaluate( factors, plan, pool, first, split, &left );
+    if( errorCode != 0 )
+        return errorCode;
+    errorCode = _evaluate( factors, plan, pool, split + 1, last, &right );
+    if( errorCode == 0 )
+    {
+        errorCode = _multiplyValues( pool, &left, &right, value );
+        _releaseValue( pool, &right );
+    }
+    _releaseValue( pool, &left );
+    return errorCode;
+}
+
+/*
+ * Function:  multiplyMatrixChain
+ * --------------------
+ *      computes product of chain of matrices in order given by plan; dense intermediate results are stored in
+ *      workspaces of pool, which are reused after intermediate result is consumed
+ *
+ *      factors: array of multiplied matrices (the same as given to planMatrixChain)
+ *      plan:    plan returned by planMatrixChain
+ *      pool:    pool of workspaces of the same size as factors
+ *      result:  place where product should be stored - it is sparse only if all factors are sparse; caller owns it
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if pool has different size than factors,
+ *               -3 on long integer overflow
+ *
+ */
+int multiplyMatrixChain( const ChainOperand *factors, const ChainPlan *plan, WorkspacePool *pool,
+                         ChainOperand *result )
+{
+    ChainValue value;
+
+    if( pool->size != plan->size )
+        return -2;
+    int errorCode = _evaluate( factors, plan, pool, 0, plan->count - 1, &value );
+    if( errorCode != 0 )
+        return errorCode;
+    result->dense = value.dense;                        // Plan has at least 2 factors, so value is owned
+    result->sparse = value.sparse;
+    return 0;
+}
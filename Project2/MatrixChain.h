@@ -0,0 +1,59 @@
+/*
+ * File: MatrixChain.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixChain.c
+ */
+
+#ifndef PROJEKT2_MATRIXCHAIN_H
+#define PROJEKT2_MATRIXCHAIN_H
+
+#include <stddef.h>
+#include "SquareMatrix.h"
+#include "SparseMatrix.h"
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Factor of chain product - exactly one of pointers is set
+struct ChainOperand {
+    Matrix *dense;
+    SparseMatrix *sparse;
+};
+typedef struct ChainOperand ChainOperand;
+
+// Cheapest order of multiplying chain of matrices; tables are indexed by [first * count + last] factor of product
+struct ChainPlan {
+    int count;                                  // Number of factors
+    int size;                                   // Number of rows|cols of every factor
+    int *split;                                 // Product first..last is (first..split)(split + 1..last)
+    double *cost;                               // Estimated multiply-add operations of product
+    double *density;                            // Estimated fraction of non-zero elements of product (1 if dense)
+    double sequentialCost;                      // Estimated multiply-add operations of left-to-right order
+};
+typedef struct ChainPlan ChainPlan;
+
+// Dense matrices of one size reused for intermediate results
+struct WorkspacePool {
+    int size;                                   // Number of rows|cols of workspaces
+    Matrix **available;                         // Workspaces not used at the moment
+    int count, capacity;                        // Number of available workspaces and length of array
+    int created;                                // Number of workspaces allocated by pool
+    int acquired;                               // Number of requests for workspace
+};
+typedef struct WorkspacePool WorkspacePool;
+
+/************************************
+ * Function declarations
+ ************************************/
+int createWorkspacePool( int size, WorkspacePool **output );
+void deleteWorkspacePool( WorkspacePool *pool );
+int acquireWorkspace( WorkspacePool *pool, Matrix **output );
+void releaseWorkspace( WorkspacePool *pool, Matrix *workspace );
+int planMatrixChain( const ChainOperand *factors, int count, ChainPlan **output );
+void deleteChainPlan( ChainPlan *plan );
+int formatChainOrder( const ChainPlan *plan, const char **labels, char *buffer, size_t length );
+int multiplyMatrixChain( const ChainOperand *factors, const ChainPlan *plan, WorkspacePool *pool,
+                         ChainOperand *result );
+
+#endif //PROJEKT2_MATRIXCHAIN_H
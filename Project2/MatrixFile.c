@@ -0,0 +1,579 @@
+/*
+ * File: MatrixFile.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Saving matrices to files and loading them back
+ */
+
+#include "MatrixFile.h"
+#include "Parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * Function <private>:  _payloadOffset
+ * --------------------
+ *      returns offset of first row in file - header size rounded up to MATRIX_ALIGNMENT
+ *
+ */
+static size_t _payloadOffset( void )
+{
+    return ( sizeof( MatrixFileHeader ) + MATRIX_ALIGNMENT - 1 ) / MATRIX_ALIGNMENT * MATRIX_ALIGNMENT;
+}
+
+/*
+ * Function:  prepareMatrixFileHeader
+ * --------------------
+ *      fills header of file storing square matrix of given size with rows padded to MATRIX_ALIGNMENT
+ *
+ *      size:    number of rows and columns of matrix
+ *      header:  pointer to header to be filled
+ *
+ */
+void prepareMatrixFileHeader( int size, MatrixFileHeader *header )
+{
+    const long stride = alignedMatrixStride( size );
+    MatrixFileHeader prepared = { MATRIX_FILE_MAGIC, MATRIX_FILE_VERSION, MATRIX_FILE_BYTE_ORDER, MATRIX_ELEMENT_INT64,
+                                  sizeof( long ), ( uint64_t )size, ( uint64_t )size, ( uint64_t )stride,
+                                  _payloadOffset(), { 0 } };
+    *header = prepared;
+}
+
+/*
+ * Function:  readMatrixFileHeader
+ * --------------------
+ *      reads header of binary matrix file and checks if it describes square matrix of longs with aligned rows,
+ *      all of which fit in the file
+ *
+ *      file:       descriptor of file opened for reading
+ *      header:     pointer to memory where header should be stored
+ *      fileLength: pointer to memory where length of file should be stored (can be NULL)
+ *
+ *      returns: 0 on success, -2 on I/O error, -3 if file has invalid format
+ *
+ */
+int readMatrixFileHeader( int file, MatrixFileHeader *header, size_t *fileLength )
+{
+    struct stat fileInfo;
+
+    if( fstat( file, &fileInfo ) != 0 )
+        return -2;
+    if( pread( file, header, sizeof( *header ), 0 ) != sizeof( *header ) )  // File is too short to contain header
+        return -3;
+
+    // Validate header - matrix must be square and consist of longs, every row must be aligned
+    if( memcmp( header->magic, MATRIX_FILE_MAGIC, sizeof( MATRIX_FILE_MAGIC ) ) != 0
+        || header->version != MATRIX_FILE_VERSION || header->byteOrder != MATRIX_FILE_BYTE_ORDER
+        || header->elementType != MATRIX_ELEMENT_INT64 || header->elementSize != sizeof( long )
+        || header->rows != header->cols || header->rows > INT_MAX || header->stride < header->cols
+        || header->payloadOffset % MATRIX_ALIGNMENT != 0 || header->payloadOffset < sizeof( *header )
+        || header->stride * sizeof( long ) % MATRIX_ALIGNMENT != 0
+        || ( uint64_t )fileInfo.st_size < header->payloadOffset
+        || ( header->rows != 0                                      // Rows must fit in file (checked without overflow)
+             && header->stride > ( ( uint64_t )fileInfo.st_size - header->payloadOffset ) / sizeof( long ) / header->rows ) )
+        return -3;
+
+    if( fileLength != NULL )
+        *fileLength = ( size_t )fileInfo.st_size;
+    return 0;
+}
+
+/*
+ * Function:  mapMatrixFromDescriptor
+ * --------------------
+ *      maps binary matrix file (or any other object with its content, ex. shared memory) into memory and creates
+ *      matrix using mapped elements directly, so only the header is read - elements are read by kernel on first
+ *      access. Mapping is private: changes made to matrix are copy-on-write and never reach the file, but changes
+ *      made to the file by others can still reach elements not modified yet, and access to elements cut off by
+ *      truncating the file raises SIGBUS - files shared with other processes should be sealed (see MatrixServer.h).
+ *      Descriptor isn't needed by matrix and can be closed afterwards
+ *
+ *      file:    descriptor of file opened for reading
+ *      output:  pointer to memory where pointer to loaded matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if file can't be mapped, -3 if file has invalid format
+ *
+ */
+int mapMatrixFromDescriptor( int file, Matrix **output )
+{
+    MatrixFileHeader header;
+    size_t fileLength;
+    void *mapping;
+
+    int errorCode = readMatrixFileHeader( file, &header, &fileLength );
+    if( errorCode != 0 )
+        return errorCode;
+
+    // MAP_PRIVATE gives copy-on-write pages - matrix can be edited, but file stays untouched
+    mapping = mmap( NULL, fileLength, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 );
+    if( mapping == MAP_FAILED )
+        return -2;
+
+    if( createSquareMatrixFromStorage( ( int )header.rows, ( long )header.stride,
+                                       ( long* )( ( char* )mapping + header.payloadOffset ),
+                                       mapping, fileLength, output ) != 0 )
+    {
+        munmap( mapping, fileLength );
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Function:  loadMatrixFromFile
+ * --------------------
+ *      maps binary matrix file into memory (see mapMatrixFromDescriptor), so loading takes constant time
+ *
+ *      path:    path to file
+ *      output:  pointer to memory where pointer to loaded matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if file can't be opened or mapped, -3 if file has invalid format
+ *
+ */
+int loadMatrixFromFile( const char *path, Matrix **output )
+{
+    int file = open( path, O_RDONLY );
+    if( file < 0 )
+        return -2;
+
+    const int errorCode = mapMatrixFromDescriptor( file, output );
+    close( file );                                                  // Mapping stays valid after closing descriptor
+    return errorCode;
+}
+
+/*
+ * Function:  writeMatrixToDescriptor
+ * --------------------
+ *      writes matrix in format of binary matrix file to file opened for reading and writing (its previous content
+ *      is replaced); data is written through shared memory mapping and flushed with msync
+ *
+ *      matrix:  pointer to Matrix structure
+ *      file:    descriptor of file (ex. regular file or shared memory object)
+ *
+ *      returns: 0 on success, -2 on I/O error
+ *
+ */
+int writeMatrixToDescriptor( Matrix *matrix, int file )
+{
+    const long stride = alignedMatrixStride( matrix->size );
+    const size_t payloadOffset = _payloadOffset();
+    const size_t fileLength = payloadOffset + sizeof( long ) * ( size_t )stride * ( size_t )matrix->size;
+    MatrixFileHeader header;
+    int errorCode = 0;
+    char *mapping;
+
+    prepareMatrixFileHeader( matrix->size, &header );
+    if( ftruncate( file, 0 ) != 0 || ftruncate( file, ( off_t )fileLength ) != 0 )     // Padding is zeroed
+        return -2;
+
+    mapping = mmap( NULL, fileLength, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0 );
+    if( mapping == MAP_FAILED )
+        return -2;
+    memcpy( mapping, &header, sizeof( header ) );
+    for( int row = 0; row < matrix->size; row++ )
+        memcpy( mapping + payloadOffset + sizeof( long ) * ( size_t )stride * row, matrix->elements[row],
+                sizeof( long ) * matrix->size );
+    if( msync( mapping, fileLength, MS_SYNC ) != 0 )                // Wait until data reaches the file
+        errorCode = -2;
+    munmap( mapping, fileLength );
+    return errorCode;
+}
+
+/*
+ * Function:  saveMatrixToFile
+ * --------------------
+ *      writes matrix to binary matrix file (see writeMatrixToDescriptor). File is first created under temporary
+ *      name and then renamed, so existing file (which may be mapped by loaded matrix - even the one being saved) is
+ *      replaced atomically
+ *
+ *      matrix:  pointer to Matrix structure
+ *      path:    path to file
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on I/O error
+ *
+ */
+int saveMatrixToFile( Matrix *matrix, const char *path )
+{
+    char *temporaryPath = malloc( strlen( path ) + sizeof( ".tmp" ) );
+    if( temporaryPath == NULL )
+        return -1;
+    sprintf( temporaryPath, "%s.tmp", path );
+
+    int file = open( temporaryPath, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+    if( file < 0 )
+    {
+        free( temporaryPath );
+        return -2;
+    }
+
+    int errorCode = writeMatrixToDescriptor( matrix, file );
+    if( close( file ) != 0 )
+        errorCode = -2;
+    if( errorCode == 0 && rename( temporaryPath, path ) != 0 )
+        errorCode = -2;
+    if( errorCode != 0 )
+        unlink( temporaryPath );
+
+    free( temporaryPath );
+    return errorCode;
+}
+
+/************************************
+ * Text (CSV) files
+ ************************************/
+// Context shared by threads parsing text file
+struct TextImportContext {
+    const char *text;                               // Content of file
+    const char *textEnd;                            // First byte after content of file
+    const char **lines;                             // Beginnings of non-empty lines - one line per row of matrix
+    Matrix *matrix;                                 // Matrix being filled
+    int errors[MAX_NUMBER_OF_THREADS];              // Error code found by each worker
+};
+typedef struct TextImportContext TextImportContext;
+
+// Context shared by threads formatting text file
+struct TextExportContext {
+    Matrix *matrix;                                 // Matrix being exported
+    char separator;                                 // Character put between elements in row
+    char *buffers[MAX_NUMBER_OF_THREADS];           // Formatted rows of each worker
+    size_t lengths[MAX_NUMBER_OF_THREADS];          // Number of characters in each buffer
+    int errors[MAX_NUMBER_OF_THREADS];              // Error code found by each worker
+};
+typedef struct TextExportContext TextExportContext;
+
+/*
+ * Function <private>:  _isSeparator
+ * --------------------
+ *      returns non-zero if character can separate numbers in row of text file
+ *
+ */
+static int _isSeparator( char character )
+{
+    return character == ' ' || character == '\t' || character == ',' || character == ';' || character == '\r';
+}
+
+/*
+ * Function <private>:  _parseNumber
+ * --------------------
+ *      parses number starting at *cursor and moves cursor behind it; accepts integers with optional sign,
+ *      fractional part consisting of zeros only (ex. "12.00") and non-negative exponent (ex. "1e3" or "2.0E+2");
+ *      this replaces strtol, which would need copying each field to NULL-terminated buffer
+ *
+ *      cursor:  pointer to pointer to first character of number
+ *      end:     first character after number (separator or end of line)
+ *      value:   pointer to long integer where parsed value should be stored
+ *
+ *      returns: 0 on success, -3 if text isn't integral number, -4 if number is outside
+ *               <MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE>
+ *
+ */
+static int _parseNumber( const char **cursor, const char *end, long *value )
+{
+    const char *character = *cursor;
+    const unsigned long limit = 1000000000000000000UL;     // Above that value number is surely out of range
+    unsigned long magnitude = 0;
+    int negative = 0, digits = 0;
+
+    if( character < end && ( *character == '-' || *character == '+' ) )
+        negative = *character++ == '-';
+
+    for( ; character < end && *character >= '0' && *character <= '9'; character++, digits++ )
+        if( magnitude < limit )
+            magnitude = magnitude * 10 + ( unsigned long )( *character - '0' );
+
+    if( character < end && *character == '.' )                      // Fractional part - allowed only if it's zero
+        for( character++; character < end && *character >= '0' && *character <= '9'; character++ )
+            if( *character != '0' )
+                return -3;
+
+    if( character < end && ( *character == 'e' || *character == 'E' ) )
+    {
+        int exponent = 0, exponentDigits = 0;
+        if( ++character < end && *character == '+' )
+            character++;
+        for( ; character < end && *character >= '0' && *character <= '9'; character++, exponentDigits++ )
+            exponent = exponent < 100 ? exponent * 10 + ( *character - '0' ) : exponent;
+        if( exponentDigits == 0 )
+            return -3;
+        for( ; exponent > 0 && magnitude != 0 && magnitude < limit; exponent-- )
+            magnitude *= 10;
+    }
+
+    if( digits == 0 || ( character < end && !_isSeparator( *character ) ) )
+        return -3;
+
+    *cursor = character;
+    if( magnitude > ( unsigned long )( negative ? -( long )MIN_MATRIX_FIELD_VALUE : MAX_MATRIX_FIELD_VALUE ) )
+        return -4;
+    *value = negative ? -( long )magnitude : ( long )magnitude;
+    return 0;
+}
+
+/*
+ * Function <private>:  _parseRows
+ * --------------------
+ *      ParallelBody parsing rows <begin, end) of text file into matrix
+ *
+ */
+static void _parseRows( long begin, long end, int worker, void *argument )
+{
+    TextImportContext *context = argument;
+    const int size = context->matrix->size;
+
+    for( long row = begin; row < end && context->errors[worker] == 0; row++ )
+    {
+        const char *cursor = context->lines[row];
+        const char *lineEnd = memchr( cursor, '\n', ( size_t )( context->textEnd - cursor ) );
+        if( lineEnd == NULL )                                       // Last line without new line character
+            lineEnd = context->textEnd;
+
+        int col = 0;
+        while( context->errors[worker] == 0 )
+        {
+            while( cursor < lineEnd && _isSeparator( *cursor ) )
+                cursor++;
+            if( cursor == lineEnd )
+                break;
+            if( col == size )                                       // Too many numbers in row
+                context->errors[worker] = -3;
+            else
+                context->errors[worker] = _parseNumber( &cursor, lineEnd, &context->matrix->elements[row][col++] );
+        }
+        if( context->errors[worker] == 0 && col != size )           // Too few numbers in row
+            context->errors[worker] = -3;
+    }
+}
+
+/*
+ * Function <private>:  _countNumbers
+ * --------------------
+ *      returns number of fields (groups of characters between separators) in line starting at "line"
+ *
+ */
+static int _countNumbers( const char *line, const char *textEnd )
+{
+    int count = 0;
+    for( int inField = 0; line < textEnd && *line != '\n'; line++ )
+    {
+        if( !_isSeparator( *line ) && !inField )
+            count++;
+        inField = !_isSeparator( *line );
+    }
+    return count;
+}
+
+/*
+ * Function:  importMatrixFromText
+ * --------------------
+ *      reads matrix from text file (ex. CSV), in which every non-empty line contains one row; numbers can be
+ *      separated by commas, semicolons, spaces or tabs. Lines are found by single pass over the file, then ranges of
+ *      rows are parsed by separate threads directly into the matrix
+ *
+ *      path:    path to file
+ *      output:  pointer to memory where pointer to read matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if file can't be read, -3 if file has invalid format (text which
+ *               is not integral number, or matrix which is not square), -4 if some number is outside
+ *               <MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE>
+ *
+ */
+int importMatrixFromText( const char *path, Matrix **output )
+{
+    TextImportContext context = { 0 };
+    struct stat fileInfo;
+    int errorCode = 0;
+    long rows = 0;
+
+    int file = open( path, O_RDONLY );
+    if( file < 0 )
+        return -2;
+    if( fstat( file, &fileInfo ) != 0 )
+    {
+        close( file );
+        return -2;
+    }
+    if( fileInfo.st_size == 0 )
+    {
+        close( file );
+        return -3;
+    }
+
+    char *text = mmap( NULL, ( size_t )fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0 );
+    close( file );
+    if( text == MAP_FAILED )
+        return -2;
+    context.text = text;
+    context.textEnd = text + fileInfo.st_size;
+
+    // First pass - find beginnings of non-empty lines. Matrix is square, so it has as many rows as the first
+    // non-empty line has numbers; more lines than that is an error
+    int size = 0;
+    for( const char *line = text; line != NULL && line < context.textEnd && errorCode == 0; )
+    {
+        const char *content = line;
+        while( content < context.textEnd && _isSeparator( *content ) )
+            content++;
+        if( content < context.textEnd && *content != '\n' )       // Line is not empty
+        {
+            if( context.lines == NULL )                             // First row - now we know size of matrix
+            {
+                size = _countNumbers( line, context.textEnd );
+                context.lines = malloc( sizeof( char* ) * ( size_t )size );
+                if( context.lines == NULL )
+                {
+                    errorCode = -1;
+                    break;
+                }
+            }
+            if( rows == size )                                      // More rows than columns
+                errorCode = -3;
+            else
+                context.lines[rows++] = line;
+        }
+        line = memchr( content, '\n', ( size_t )( context.textEnd - content ) );
+        if( line != NULL )
+            line++;
+    }
+    if( errorCode == 0 && ( rows != size || size == 0 ) )
+        errorCode = -3;
+
+    if( errorCode == 0 && createSquareMatrix( size, &context.matrix ) != 0 )
+        errorCode = -1;
+
+    if( errorCode == 0 )
+    {
+        parallelFor( size, 64, _parseRows, &context );              // At least 64 rows per thread
+        for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+            if( context.errors[worker] != 0 )
+                errorCode = context.errors[worker];
+        if( errorCode != 0 )
+            deleteSquareMatrix( context.matrix );
+        else
+            *output = context.matrix;
+    }
+
+    free( context.lines );
+    munmap( text, ( size_t )fileInfo.st_size );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _formatNumber
+ * --------------------
+ *      writes decimal representation of value to output (without terminating NULL)
+ *
+ *      returns: number of characters written (at most 20)
+ *
+ */
+static size_t _formatNumber( long value, char *output )
+{
+    char digits[20];
+    size_t length = 0, written = 0;
+    unsigned long magnitude = value < 0 ? ( unsigned long )( -( value + 1 ) ) + 1 : ( unsigned long )value;
+
+    do {
+        digits[length++] = ( char )( '0' + magnitude % 10 );
+        magnitude /= 10;
+    } while( magnitude != 0 );
+
+    if( value < 0 )
+        output[written++] = '-';
+    while( length > 0 )
+        output[written++] = digits[--length];
+    return written;
+}
+
+/*
+ * Function <private>:  _formatRows
+ * --------------------
+ *      ParallelBody formatting rows <begin, end) of matrix into buffer of worker
+ *
+ */
+static void _formatRows( long begin, long end, int worker, void *argument )
+{
+    TextExportContext *context = argument;
+    const int size = context->matrix->size;
+    const size_t maxRowLength = ( size_t )size * 21 + 1;              // Up to 20 characters and separator per number
+    size_t capacity = maxRowLength * ( size_t )( end - begin < 16 ? end - begin : 16 );
+    char *buffer = malloc( capacity );
+    size_t length = 0;
+
+    for( long row = begin; row < end && buffer != NULL; row++ )
+    {
+        if( capacity - length < maxRowLength )                        // Make sure that the whole row will fit
+        {
+            char *bigger = realloc( buffer, capacity * 2 + maxRowLength );
+            if( bigger == NULL )
+            {
+                free( buffer );
+                buffer = NULL;
+                break;
+            }
+            buffer = bigger;
+            capacity = capacity * 2 + maxRowLength;
+        }
+        for( int col = 0; col < size; col++ )
+        {
+            length += _formatNumber( context->matrix->elements[row][col], buffer + length );
+            buffer[length++] = col == size - 1 ? '\n' : context->separator;
+        }
+    }
+
+    context->buffers[worker] = buffer;
+    context->lengths[worker] = length;
+    context->errors[worker] = buffer == NULL ? -1 : 0;
+}
+
+/*
+ * Function:  exportMatrixToText
+ * --------------------
+ *      writes matrix to text file, one row per line; ranges of rows are formatted by separate threads into their
+ *      own buffers, which are then written to the file in order
+ *
+ *      matrix:     pointer to Matrix structure
+ *      path:       path to file
+ *      separator:  character put between numbers in row (ex. ',' for CSV)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on I/O error
+ *
+ */
+int exportMatrixToText( Matrix *matrix, const char *path, char separator )
+{
+    TextExportContext context = { 0 };
+    int errorCode = 0;
+
+    context.matrix = matrix;
+    context.separator = separator;
+    parallelFor( matrix->size, 64, _formatRows, &context );
+
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+        if( context.errors[worker] != 0 )
+            errorCode = context.errors[worker];
+
+    int file = errorCode == 0 ? open( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 ) : -1;
+    if( errorCode == 0 && file < 0 )
+        errorCode = -2;
+
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+    {
+        for( size_t written = 0; errorCode == 0 && written < context.lengths[worker]; )
+        {
+            ssize_t result = write( file, context.buffers[worker] + written, context.lengths[worker] - written );
+            if( result < 0 )
+                errorCode = -2;
+            else
+                written += ( size_t )result;
+        }
+        free( context.buffers[worker] );
+    }
+
+    if( file >= 0 && close( file ) != 0 )
+        errorCode = -2;
+    return errorCode;
+}
@@ -0,0 +1,54 @@
+/*
+ * File: MatrixFile.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixFile.c
+ */
+
+#ifndef PROJEKT2_MATRIXFILE_H
+#define PROJEKT2_MATRIXFILE_H
+
+#include <stdint.h>
+#include "SquareMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define MATRIX_FILE_MAGIC       "PRIMTRX"       // First 8 bytes of file (with terminating NULL)
+#define MATRIX_FILE_VERSION     1               // Version of format written by this program
+#define MATRIX_FILE_BYTE_ORDER  0x01020304      // Stored in native byte order - detects files from other machines
+#define MATRIX_ELEMENT_INT64    1               // Elements are signed 64-bit integers (long)
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Header of binary matrix file; it is followed (at offset payloadOffset) by "rows" rows, each being "stride"
+// elements long, of which first "cols" are elements of matrix. Both payloadOffset and stride * element size are
+// multiples of MATRIX_ALIGNMENT, so every row is aligned when file is mapped into memory
+struct MatrixFileHeader {
+    char magic[8];                  // MATRIX_FILE_MAGIC
+    uint32_t version;               // MATRIX_FILE_VERSION
+    uint32_t byteOrder;             // MATRIX_FILE_BYTE_ORDER
+    uint32_t elementType;           // One of MATRIX_ELEMENT_* values
+    uint32_t elementSize;           // Size of one element in bytes
+    uint64_t rows;                  // Number of rows
+    uint64_t cols;                  // Number of columns
+    uint64_t stride;                // Distance (in elements) between beginnings of consecutive rows
+    uint64_t payloadOffset;         // Offset of first row from the beginning of file
+    uint8_t reserved[8];            // Zeros - pads header to 64 bytes
+};
+typedef struct MatrixFileHeader MatrixFileHeader;
+
+/************************************
+ * Function declarations
+ ************************************/
+void prepareMatrixFileHeader( int size, MatrixFileHeader *header );
+int readMatrixFileHeader( int file, MatrixFileHeader *header, size_t *fileLength );
+int mapMatrixFromDescriptor( int file, Matrix **output );
+int loadMatrixFromFile( const char *path, Matrix **output );
+int writeMatrixToDescriptor( Matrix *matrix, int file );
+int saveMatrixToFile( Matrix *matrix, const char *path );
+int importMatrixFromText( const char *path, Matrix **output );
+int exportMatrixToText( Matrix *matrix, const char *path, char separator );
+
+#endif //PROJEKT2_MATRIXFILE_H
@@ -6,11 +6,15 @@
  */
 
 #include "MatrixGUI.h"
+#include "Profiler.h"
 #include <stdio.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
 #include <termio.h>
 #include <unistd.h>
+#include <sys/ioctl.h>
 
 /*
  * Function:  printMatrixAsTableWithHighlight
@@ -26,6 +30,9 @@ void printMatrixAsTableWithHighlight( Matrix *matrix, int highlightedRow, int hi
 {
     const int fieldWidth = 12;                              // Width of field containing value of matrix cell
     const int allFieldWidth = fieldWidth * matrix->size;    // Width of all fields
+    ProfileScope scope;
+
+    profileBegin( &scope, PROFILE_RENDER );
 
     // Print top part of opening and closing bracket - "*" instructs printf to take value from parameter passed
     printf( BRACKET_TOP_LEFT "%-*s" BRACKET_TOP_RIGHT "\n", allFieldWidth, " " );
@@ -43,6 +50,7 @@ void printMatrixAsTableWithHighlight( Matrix *matrix, int highlightedRow, int hi
 
     // Print bottom part of opening and closing bracket
     printf( BRACKET_BOTTOM_LEFT "%-*s" BRACKET_BOTTOM_RIGHT "\n", allFieldWidth, " " );
+    profileEnd( &scope, 0 );
 }
 
 /*
@@ -77,6 +85,135 @@ void printMatrixAsTable( Matrix *matrix )
     printMatrixAsTableWithHighlight( matrix, -1, -1 );       // -1 prevents highlighting any cell
 }
 
+/*
+ * Function:  printBigMatrixAsTable
+ * --------------------
+ *      print matrix of integers of arbitrary size on screen; all columns are as wide as the longest element
+ *
+ *      matrix: matrix structure which data should be printed
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int printBigMatrixAsTable( BigMatrix *matrix )
+{
+    LimbArena scratch;
+    size_t bufferLength = 2, limbs = 0;
+    int errorCode = 0;
+    int fieldWidth = 12;                                    // At least as wide as fields of printMatrixAsTable
+
+    for( int i = 0; i < matrix->size * matrix->size; i++ )
+    {
+        if( bigIntegerDecimalLength( &matrix->data[i] ) > bufferLength )
+            bufferLength = bigIntegerDecimalLength( &matrix->data[i] );
+        if( ( size_t )abs( matrix->data[i].length ) > limbs )
+            limbs = ( size_t )abs( matrix->data[i].length );
+    }
+    char *buffer = malloc( bufferLength );
+    initLimbArena( &scratch );
+    if( buffer == NULL || reserveLimbArena( &scratch, limbs ) != 0 )  // Room for copy of any element
+    {
+        free( buffer );
+        freeLimbArena( &scratch );
+        return -1;
+    }
+
+    for( int i = 0; i < matrix->size * matrix->size && errorCode == 0; i++ )   // Find the longest element
+    {
+        const int length = bigIntegerToString( &matrix->data[i], buffer, &scratch );
+        if( length < 0 )
+            errorCode = -1;
+        else if( length + 1 > fieldWidth )
+            fieldWidth = length + 1;
+    }
+    if( errorCode != 0 )
+    {
+        freeLimbArena( &scratch );
+        free( buffer );
+        return errorCode;
+    }
+
+    printf( BRACKET_TOP_LEFT "%-*s" BRACKET_TOP_RIGHT "\n", fieldWidth * matrix->size, " " );
+    for( int row = 0; row < matrix->size; row++ )
+    {
+        printf( BRACKET_MIDDLE );
+        for( int col = 0; col < matrix->size; col++ )
+        {
+            if( bigIntegerToString( &matrix->elements[row][col], buffer, &scratch ) < 0 )
+            {
+                errorCode = -1;                             // Table is finished, but element is left empty
+                buffer[0] = 0;
+            }
+            printf( "%-*s", fieldWidth, buffer );
+        }
+        printf( BRACKET_MIDDLE "\n" );
+    }
+    printf( BRACKET_BOTTOM_LEFT "%-*s" BRACKET_BOTTOM_RIGHT "\n", fieldWidth * matrix->size, " " );
+
+    freeLimbArena( &scratch );
+    free( buffer );
+    return errorCode;
+}
+
+/*
+ * Function:  printPolynomial
+ * --------------------
+ *      prints polynomial with integer coefficients of arbitrary size in usual form (e.g. x^3 - 6x^2 + 11x - 6)
+ *
+ *      coefficients: coefficients from the highest power of x (degree + 1 numbers)
+ *      degree:       degree of polynomial
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int printPolynomial( BigInteger *coefficients, int degree )
+{
+    LimbArena scratch;
+    size_t bufferLength = 2;
+    int printed = 0;
+
+    for( int i = 0; i <= degree; i++ )
+        if( bigIntegerDecimalLength( &coefficients[i] ) > bufferLength )
+            bufferLength = bigIntegerDecimalLength( &coefficients[i] );
+    char *buffer = malloc( bufferLength );
+    initLimbArena( &scratch );
+    if( buffer == NULL )
+        return -1;
+
+    for( int i = 0; i <= degree; i++ )
+    {
+        BigInteger magnitude = coefficients[i];             // Shares limbs with coefficient, only sign is changed
+        const int power = degree - i;
+        if( magnitude.length == 0 )
+            continue;
+        if( magnitude.length < 0 )
+            magnitude.length = -magnitude.length;
+        if( bigIntegerToString( &magnitude, buffer, &scratch ) < 0 )
+        {
+            freeLimbArena( &scratch );
+            free( buffer );
+            return -1;
+        }
+
+        if( printed )
+            printf( coefficients[i].length < 0 ? " - " : " + " );
+        else if( coefficients[i].length < 0 )
+            printf( "-" );
+        if( power == 0 || strcmp( buffer, "1" ) != 0 )      // Coefficient 1 isn't written before x
+            printf( "%s", buffer );
+        if( power == 1 )
+            printf( "x" );
+        else if( power > 1 )
+            printf( "x^%d", power );
+        printed = 1;
+    }
+    printf( printed ? "\n" : "0\n" );
+
+    freeLimbArena( &scratch );
+    free( buffer );
+    return 0;
+}
+
 /*
  * Function:  clearLastLinePrinted
  * --------------------
@@ -203,78 +340,366 @@ long safeNumPrompt( char *prompt, long minValue, long maxValue )
     return enteredNumber;
 }
 
+/*
+ * Function:  safeStringPrompt
+ * --------------------
+ *      prints provided string and reads one line of input until non-empty line was provided by user; new line
+ *      character is not stored in buffer; too long lines are truncated
+ *
+ *      prompt: string containing message for user
+ *      buffer: memory where read line should be stored
+ *      bufferLength: size of buffer (including terminating NULL)
+ *
+ */
+void safeStringPrompt( char *prompt, char *buffer, int bufferLength )
+{
+    printf( "%s", prompt );
+
+    while( 1 )
+    {
+        if( !fgets( buffer, bufferLength, stdin ) )             // Reading error - return empty string
+        {
+            buffer[0] = 0;
+            break;
+        }
+        if( strchr( buffer, '\n' ) == NULL )                    // Line was too long - skip rest of it
+        {
+            int skipped;
+            while( ( skipped = getchar() ) != '\n' && skipped != EOF );
+        }
+        buffer[strcspn( buffer, "\n" )] = 0;                    // Remove new line character
+        if( buffer[0] != 0 )
+            break;
+
+        clearLastLinePrinted();
+        printf( FONT_RED_COLOR "%s" DEFAULT_DISPLAY ". Try again:", "Empty input" );
+    }
+
+    clearLastLinePrinted();                                     // Clear line containing prompt
+}
+
+/************************************
+ * Structure declarations
+ ************************************/
+// State of interactive editor: visible part of matrix (viewport) and what was drawn on screen by last frame, so
+// next frame contains only cells which changed. Frame is drawn relative to line with instructions, on which cursor
+// stays between frames
+struct EditorView {
+    Matrix *matrix;
+    int selectedRow, selectedCol;               // Highlighted cell
+    int firstRow, firstCol;                     // Cell shown in top-left corner of viewport
+    int visibleRows, visibleCols;               // Size of viewport (in cells)
+    int terminalCols;                           // Width of terminal - longer lines would wrap and break layout
+    int onScreen;                               // Set if viewport was already drawn
+    int drawnFirstRow, drawnFirstCol;           // Position of viewport when it was drawn
+    int drawnSelectedRow, drawnSelectedCol;     // Highlighted cell when it was drawn
+    long *drawnValues;                          // Values shown in cells of viewport (row after row)
+    char *frame;                                // Control sequences and text of frame being composed
+    size_t frameLength, frameCapacity;
+};
+typedef struct EditorView EditorView;
+
+/*
+ * Function <private>:  _appendToFrame
+ * --------------------
+ *      appends formatted text to frame being composed (frame is enlarged if needed)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _appendToFrame( EditorView *view, const char *format, ... )
+{
+    va_list arguments;
+
+    while( 1 )
+    {
+        size_t available = view->frameCapacity - view->frameLength;
+        va_start( arguments, format );
+        int length = vsnprintf( view->frame + view->frameLength, available, format, arguments );
+        va_end( arguments );
+        if( length < 0 )
+            return -1;
+        if( ( size_t )length < available )
+        {
+            view->frameLength += ( size_t )length;
+            return 0;
+        }
+
+        char *enlarged = realloc( view->frame, view->frameCapacity * 2 + ( size_t )length );
+        if( enlarged == NULL )
+            return -1;
+        view->frame = enlarged;
+        view->frameCapacity = view->frameCapacity * 2 + ( size_t )length;
+    }
+}
+
+/*
+ * Function <private>:  _flushFrame
+ * --------------------
+ *      sends composed frame to terminal with one write (text buffered by stdio is flushed first, so it appears
+ *      before frame) and starts new frame
+ *
+ */
+static void _flushFrame( EditorView *view )
+{
+    size_t written = 0;
+
+    fflush( stdout );
+    while( written < view->frameLength )
+    {
+        ssize_t result = write( STDOUT_FILENO, view->frame + written, view->frameLength - written );
+        if( result < 0 && errno != EINTR )
+            break;
+        if( result > 0 )
+            written += ( size_t )result;
+    }
+    view->frameLength = 0;
+}
+
+/*
+ * Function <private>:  _appendCell
+ * --------------------
+ *      appends text of one cell of viewport (highlighted if it is selected one) to frame and remembers drawn value;
+ *      values longer than cell are cut and marked with '~'
+ *
+ *      row, col: position of cell in viewport
+ *
+ */
+static void _appendCell( EditorView *view, int row, int col )
+{
+    const int matrixRow = view->firstRow + row, matrixCol = view->firstCol + col;
+    const long value = view->matrix->elements[matrixRow][matrixCol];
+    char text[24];
+
+    int length = snprintf( text, sizeof( text ), "%ld", value );
+    if( length >= EDITOR_FIELD_WIDTH )                      // Leave at least one space between cells
+    {
+        text[EDITOR_FIELD_WIDTH - 2] = '~';
+        text[EDITOR_FIELD_WIDTH - 1] = 0;
+    }
+    if( matrixRow == view->selectedRow && matrixCol == view->selectedCol )
+        _appendToFrame( view, REVERSE_COLOR "%-*s" DEFAULT_DISPLAY, EDITOR_FIELD_WIDTH, text );
+    else
+        _appendToFrame( view, "%-*s", EDITOR_FIELD_WIDTH, text );
+    view->drawnValues[row * view->visibleCols + col] = value;
+}
+
+/*
+ * Function <private>:  _appendViewport
+ * --------------------
+ *      appends whole viewport (borders, cells and instructions) to frame, overwriting previously drawn one
+ *
+ */
+static void _appendViewport( EditorView *view )
+{
+    const int width = view->visibleCols * EDITOR_FIELD_WIDTH;
+    char position[64];
+
+    if( view->onScreen )                                    // Move cursor from instructions to top border
+        _appendToFrame( view, MOVE_CURSOR_UP_N_ROWS, view->visibleRows + 2 );
+
+    // Top border shows which part of matrix is visible
+    snprintf( position, sizeof( position ), " rows %d-%d, cols %d-%d of %d ", view->firstRow + 1,
+              view->firstRow + view->visibleRows, view->firstCol + 1, view->firstCol + view->visibleCols,
+              view->matrix->size );
+    _appendToFrame( view, BRACKET_TOP_LEFT "%-*.*s" BRACKET_TOP_RIGHT CLEAR_TO_END_OF_LINE "\n", width, width, position );
+    for( int row = 0; row < view->visibleRows; row++ )
+    {
+        _appendToFrame( view, BRACKET_MIDDLE );
+        for( int col = 0; col < view->visibleCols; col++ )
+            _appendCell( view, row, col );
+        _appendToFrame( view, BRACKET_MIDDLE CLEAR_TO_END_OF_LINE "\n" );
+    }
+    _appendToFrame( view, BRACKET_BOTTOM_LEFT "%-*s" BRACKET_BOTTOM_RIGHT CLEAR_TO_END_OF_LINE "\n", width, "" );
+    _appendToFrame( view, CLEAR_CURRENT_LINE "%.*s\r", view->terminalCols - 1, EDITOR_INSTRUCTIONS );
+
+    view->onScreen = 1;
+    view->drawnFirstRow = view->firstRow;
+    view->drawnFirstCol = view->firstCol;
+}
+
+/*
+ * Function <private>:  _appendChangedCells
+ * --------------------
+ *      appends to frame only cells of viewport whose value or highlight changed since they were drawn; cursor is
+ *      moved from line with instructions to cell and back
+ *
+ */
+static void _appendChangedCells( EditorView *view )
+{
+    for( int row = 0; row < view->visibleRows; row++ )
+        for( int col = 0; col < view->visibleCols; col++ )
+        {
+            const int matrixRow = view->firstRow + row, matrixCol = view->firstCol + col;
+            const int selected = matrixRow == view->selectedRow && matrixCol == view->selectedCol;
+            const int wasSelected = matrixRow == view->drawnSelectedRow && matrixCol == view->drawnSelectedCol;
+            if( selected == wasSelected
+                && view->drawnValues[row * view->visibleCols + col] == view->matrix->elements[matrixRow][matrixCol] )
+                continue;
+
+            // Cell is in line (visibleRows - row + 1) above instructions, after left border
+            _appendToFrame( view, MOVE_CURSOR_UP_N_ROWS MOVE_CURSOR_TO_COLUMN_N, view->visibleRows - row + 1,
+                            2 + col * EDITOR_FIELD_WIDTH );
+            _appendCell( view, row, col );
+            _appendToFrame( view, MOVE_CURSOR_DOWN_N_ROWS, view->visibleRows - row + 1 );
+        }
+}
+
+/*
+ * Function <private>:  _renderEditor
+ * --------------------
+ *      scrolls viewport so selected cell is visible, then draws with one write either whole viewport (if it was
+ *      scrolled) or only changed cells; amount of work depends only on size of viewport, not of matrix
+ *
+ */
+static void _renderEditor( EditorView *view )
+{
+    if( view->selectedRow < view->firstRow )
+        view->firstRow = view->selectedRow;
+    else if( view->selectedRow >= view->firstRow + view->visibleRows )
+        view->firstRow = view->selectedRow - view->visibleRows + 1;
+    if( view->selectedCol < view->firstCol )
+        view->firstCol = view->selectedCol;
+    else if( view->selectedCol >= view->firstCol + view->visibleCols )
+        view->firstCol = view->selectedCol - view->visibleCols + 1;
+
+    if( !view->onScreen || view->firstRow != view->drawnFirstRow || view->firstCol != view->drawnFirstCol )
+        _appendViewport( view );
+    else
+        _appendChangedCells( view );
+    view->drawnSelectedRow = view->selectedRow;
+    view->drawnSelectedCol = view->selectedCol;
+    _flushFrame( view );
+}
+
+/*
+ * Function <private>:  _fitViewportToTerminal
+ * --------------------
+ *      sets size of viewport to the biggest one fitting in terminal (80x24 is assumed if size of terminal is
+ *      unknown); besides cells, borders, line with instructions and one spare line are needed
+ *
+ */
+static void _fitViewportToTerminal( EditorView *view )
+{
+    struct winsize window;
+    int terminalRows = 24, terminalCols = 80;
+
+    if( ioctl( STDOUT_FILENO, TIOCGWINSZ, &window ) == 0 && window.ws_row > 0 && window.ws_col > 0 )
+    {
+        terminalRows = window.ws_row;
+        terminalCols = window.ws_col;
+    }
+    view->terminalCols = terminalCols;
+    view->visibleRows = terminalRows - 4 < 1 ? 1 : terminalRows - 4;
+    view->visibleCols = ( terminalCols - 2 ) / EDITOR_FIELD_WIDTH < 1 ? 1 : ( terminalCols - 2 ) / EDITOR_FIELD_WIDTH;
+    if( view->visibleRows > view->matrix->size )
+        view->visibleRows = view->matrix->size;
+    if( view->visibleCols > view->matrix->size )
+        view->visibleCols = view->matrix->size;
+}
+
+/*
+ * Function <private>:  _moveSelection
+ * --------------------
+ *      handles escape sequence of key (arrows move by one cell wrapping around edges, page up|down move by height
+ *      of viewport); first character (escape) is already read
+ *
+ */
+static void _moveSelection( EditorView *view )
+{
+    const int size = view->matrix->size;
+
+    if( getchar() != '[' )                                  // Take next character and check if its next char of escape sequence
+        return;
+    switch( getchar() )                                     // Finally get last char and check which key it is
+    {
+        case 'A':                                           // Up arrow
+            view->selectedRow = view->selectedRow == 0 ? size - 1 : view->selectedRow - 1;
+            break;
+        case 'B':                                           // Down arrow
+            view->selectedRow = view->selectedRow == size - 1 ? 0 : view->selectedRow + 1;
+            break;
+        case 'C':                                           // Right arrow
+            view->selectedCol = view->selectedCol == size - 1 ? 0 : view->selectedCol + 1;
+            break;
+        case 'D':                                           // Left arrow
+            view->selectedCol = view->selectedCol == 0 ? size - 1 : view->selectedCol - 1;
+            break;
+        case '5':                                           // Page up ("\033[5~")
+            getchar();
+            view->selectedRow = view->selectedRow < view->visibleRows ? 0 : view->selectedRow - view->visibleRows;
+            break;
+        case '6':                                           // Page down ("\033[6~")
+            getchar();
+            view->selectedRow = view->selectedRow + view->visibleRows >= size ? size - 1
+                                                                              : view->selectedRow + view->visibleRows;
+            break;
+        default:
+            break;
+    }
+}
+
 /*
  * Function:  editMatrixPrompt
  * --------------------
- *      display interactive matrix form, get input from user and insert it in provided matrix structure
+ *      display interactive matrix form, get input from user and insert it in provided matrix structure; only part
+ *      of matrix fitting in terminal is shown and it scrolls with highlighted cell
  *
  *      matrix:             matrix structure which data should be printed
  *
  */
 void editMatrixPrompt( Matrix *matrix )
 {
-    int selectedRow = 0;                                    // Currently highlighted row in matrix
-    int selectedCol = 0;                                    // the same as above, but for column
+    EditorView view = { .matrix = matrix };
     int charFromInput = 0;                                  // Character read from input
     long valueRead = 0;                                     // Long integer read from prompt
     const int promptBufferLength = 100;
-    char prompt[promptBufferLength];                                       // Buffer used to create text for prompt message
+    char prompt[promptBufferLength];                        // Buffer used to create text for prompt message
 
-    printMatrixAsTableWithHighlight( matrix, selectedRow, selectedCol );
-    puts( "Use arrows to highlight cell. Press enter to change its value. Press q to continue" );
-    printf(MOVE_CURSOR_UP_N_ROWS, 1);
+    _fitViewportToTerminal( &view );
+    view.frameCapacity = 4096;
+    view.frame = malloc( view.frameCapacity );
+    view.drawnValues = malloc( sizeof( long ) * ( size_t )( view.visibleRows * view.visibleCols + 1 ) );
+    if( view.frame == NULL || view.drawnValues == NULL )
+    {
+        puts( FONT_RED_COLOR "Out of memory!" DEFAULT_DISPLAY );
+        free( view.frame );
+        free( view.drawnValues );
+        return;
+    }
+
+    _renderEditor( &view );
 
     switchTerminalToNonBufferingMode();                     // Disable buffering - we want direct input
-    while(charFromInput != 'q')                             // While user haven't pressed (q)uit key
+    while( charFromInput != 'q' && charFromInput != EOF )   // While user haven't pressed (q)uit key
     {
         charFromInput = getchar();                          // Get character
-        if( charFromInput == '\033' ) {                     // Check if it is escape sequence starter
-            if (getchar() == '[')                           // Take next character and check if its next char of escape sequence
-                switch (getchar()) {                        // Finally get last char and check which arrow it is
-                    case 'A':                               // Up arrow
-                        if (selectedRow == 0)
-                            selectedRow = matrix->size - 1; // We are at the beginning of rows - jump to the last
-                        else
-                            selectedRow--;
-                        break;                              // Down arrow
-                    case 'B':
-                        if (selectedRow == matrix->size - 1)
-                            selectedRow = 0;
-                        else
-                            selectedRow++;
-                        break;
-                    case 'C':                               // Right arrow
-                        if (selectedCol == matrix->size - 1)
-                            selectedCol = 0;
-                        else
-                            selectedCol++;
-                        break;
-                    case 'D':                               // Left arrow
-                        if (selectedCol == 0)
-                            selectedCol = matrix->size - 1;
-                        else
-                            selectedCol--;
-                        break;
-                    default:
-                        break;
-                }
-        }else if( charFromInput == '\n' )                   // If it is new line (enter)
+        if( matrix->size == 0 )                             // There are no cells to select
+            continue;
+        if( charFromInput == '\033' )                       // Check if it is escape sequence starter
+            _moveSelection( &view );
+        else if( charFromInput == '\n' )                    // If it is new line (enter)
         {
             switchTerminalToDefaultMode();                  // Switch terminal back to buffering mode - required for scanf used later
 
             // Prepare prompt message of form: "Value for field [x,y]: "
-            snprintf( prompt, promptBufferLength, CLEAR_CURRENT_LINE "Value for field [%d,%d]: ", selectedRow + 1, selectedCol + 1 );
+            snprintf( prompt, promptBufferLength, CLEAR_CURRENT_LINE "Value for field [%d,%d]: ", view.selectedRow + 1, view.selectedCol + 1 );
             valueRead = safeNumPrompt( prompt, MIN_MATRIX_FIELD_VALUE, MAX_MATRIX_FIELD_VALUE ); // Read value from user
             switchTerminalToNonBufferingMode();
 
-            matrix->elements[selectedRow][selectedCol] = valueRead; // Save value to matrix
-
-            puts( "Use arrows to highlight cell. Press enter to change its value. Press q to continue" );
-            printf( MOVE_CURSOR_UP_N_ROWS, 1 );              // Display instruction again and set cursor on it
+            // Save value to matrix (marks it modified and copies its rows if they are shared with snapshot);
+            // prompt left cursor at the beginning of cleared line with instructions
+            if( setMatrixElement( matrix, view.selectedRow, view.selectedCol, valueRead ) != 0 )
+                _appendToFrame( &view, FONT_RED_COLOR "%.*s" DEFAULT_DISPLAY "\r", view.terminalCols - 1,
+                                "Out of memory - value wasn't saved!" );
+            else
+                _appendToFrame( &view, "%.*s\r", view.terminalCols - 1, EDITOR_INSTRUCTIONS );
         }
-        reprintMatrixAsTableWithHighlight( matrix, selectedRow, selectedCol ); // Reprint matrix table with new cell highlighted
+        _renderEditor( &view );                             // Redraw cells which changed
     }
 
     printf( CLEAR_CURRENT_LINE );                            // Clear currently active line
     switchTerminalToDefaultMode();                           // Switch back to default console mode used by the rest of program
-}
\ No newline at end of file
+    free( view.frame );
+    free( view.drawnValues );
+}
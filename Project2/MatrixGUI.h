@@ -9,6 +9,7 @@
 #define PROJEKT2_MATRIXGUI_H
 
 #include "SquareMatrix.h"
+#include "BigMatrix.h"
 
 /************************************
  * Target system check
@@ -24,11 +25,18 @@
 // For more control sequences see: "man console_codes"
 // If _N_ is used in name, parameter with desired value must be passed to function parsing expression
 #define MOVE_CURSOR_UP_N_ROWS   "\033[%dF"
+#define MOVE_CURSOR_DOWN_N_ROWS "\033[%dE"
+#define MOVE_CURSOR_TO_COLUMN_N "\033[%dG"
+#define CLEAR_TO_END_OF_LINE    "\033[K"
 #define CLEAR_CURRENT_LINE      "\033[2K"
 #define REVERSE_COLOR           "\033[7m"
 #define DEFAULT_DISPLAY         "\033[0m"
 #define FONT_RED_COLOR          "\033[31m"
 
+// Width of cell of matrix shown by editor and help displayed below it
+#define EDITOR_FIELD_WIDTH      12
+#define EDITOR_INSTRUCTIONS     "Arrows, page up|down - highlight cell, enter - change its value, q - continue"
+
 // Characters used to print table border
 #define BRACKET_TOP_LEFT        "\u2554"
 #define BRACKET_TOP_RIGHT       "\u2557"
@@ -40,6 +48,8 @@
  * Functions definitions
  ************************************/
 void printMatrixAsTable( Matrix *matrix );
+int printBigMatrixAsTable( BigMatrix *matrix );
+int printPolynomial( BigInteger *coefficients, int degree );
 void reprintMatrixAsTableWithHighlight( Matrix *matrix, int highlightedRow, int highlightedColumn );
 void printMatrixAsTableWithHighlight( Matrix *matrix, int highlightedRow, int highlightedColumn );
 void clearLastLinePrinted( void );
@@ -47,6 +57,7 @@ void switchTerminalToNonBufferingMode( void );
 void switchTerminalToDefaultMode( void );
 int _safeInput( long *result );
 long safeNumPrompt( char *prompt, long minValue, long maxValue );
+void safeStringPrompt( char *prompt, char *buffer, int bufferLength );
 void editMatrixPrompt( Matrix *matrix );
 
 #endif //PROJEKT2_MATRIXGUI_H
@@ -0,0 +1,154 @@
+/*
+ * File: MatrixGenerators.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Parallel generators of big matrices with common patterns
+ */
+
+#include "MatrixGenerators.h"
+#include "Parallel.h"
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Arguments shared by threads filling rows of matrix
+struct GeneratorContext {
+    Matrix *matrix;
+    const GeneratorOptions *options;
+    unsigned long range;                    // Number of possible random values (0 means all 2^64 values)
+    long hilbertScale;                      // lcm(1, ..., 2 * size - 1) for Hilbert matrix
+};
+typedef struct GeneratorContext GeneratorContext;
+
+/*
+ * Function:  counterRandom
+ * --------------------
+ *      returns 64 pseudo-random bits being counter-th output of SplitMix64 generator seeded with seed; since
+ *      every output is computed independently, elements can be generated in any order by any thread
+ *
+ */
+unsigned long counterRandom( unsigned long seed, unsigned long counter )
+{
+    unsigned long z = seed + ( counter + 1 ) * 0x9E3779B97F4A7C15UL;
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9UL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBUL;
+    return z ^ ( z >> 31 );
+}
+
+/*
+ * Function <private>:  _randomValue
+ * --------------------
+ *      returns random value from range <minValue, maxValue> of options (multiply-high method - bias is below
+ *      range / 2^64)
+ *
+ */
+static long _randomValue( const GeneratorContext *context, unsigned long counter )
+{
+    unsigned long bits = counterRandom( context->options->seed, counter );
+    if( context->range == 0 )
+        return ( long )bits;
+    return context->options->minValue + ( long )( ( ( unsigned __int128 )bits * context->range ) >> 64 );
+}
+
+/*
+ * Function <private>:  _fillRows
+ * --------------------
+ *      fills rows <begin, end) of matrix according to pattern (used as ParallelBody)
+ *
+ */
+static void _fillRows( long begin, long end, int worker, void *context )
+{
+    const GeneratorContext *generator = context;
+    const GeneratorOptions *options = generator->options;
+    const long size = generator->matrix->size;
+
+    for( long row = begin; row < end; row++ )
+    {
+        long *elements = generator->matrix->elements[row];
+        switch( options->pattern )
+        {
+            case GENERATE_RANDOM:
+                for( long col = 0; col < size; col++ )
+                    elements[col] = _randomValue( generator, ( unsigned long )( row * size + col ) );
+                break;
+            case GENERATE_IDENTITY:
+            case GENERATE_DIAGONAL:
+                for( long col = 0; col < size; col++ )
+                    elements[col] = 0;
+                elements[row] = options->pattern == GENERATE_IDENTITY ? 1 : _randomValue( generator, ( unsigned long )row );
+                break;
+            case GENERATE_BANDED:
+                for( long col = 0; col < size; col++ )      // The same values as random matrix, zeros outside band
+                    elements[col] = col - row < -( long )options->lowerBandwidth || col - row > options->upperBandwidth
+                                    ? 0 : _randomValue( generator, ( unsigned long )( row * size + col ) );
+                break;
+            case GENERATE_TOEPLITZ:
+                for( long col = 0; col < size; col++ )      // Diagonals numbered from bottom-left corner
+                    elements[col] = _randomValue( generator, ( unsigned long )( col - row + size - 1 ) );
+                break;
+            case GENERATE_HILBERT:
+                for( long col = 0; col < size; col++ )
+                    elements[col] = generator->hilbertScale / ( row + col + 1 );
+                break;
+        }
+    }
+}
+
+/*
+ * Function <private>:  _hilbertScale
+ * --------------------
+ *      computes lcm(1, ..., 2 * size - 1) - the smallest number making all elements of Hilbert matrix integers
+ *
+ *      returns: 0 on success, -2 if it doesn't fit in long integer
+ *
+ */
+static int _hilbertScale( int size, long *scale )
+{
+    long lcm = 1;
+
+    for( long i = 2; i <= 2L * size - 1; i++ )
+    {
+        long a = lcm, b = i;
+        while( b != 0 )                                     // gcd(lcm, i)
+        {
+            long remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        if( __builtin_mul_overflow( lcm / a, i, &lcm ) )
+            return -2;
+    }
+    *scale = lcm;
+    return 0;
+}
+
+/*
+ * Function:  generateMatrix
+ * --------------------
+ *      fills whole matrix according to options, writing rows directly in its storage by all available threads
+ *
+ *      matrix:  matrix to be filled (its size is kept)
+ *      options: pattern and its parameters
+ *
+ *      returns: 0 on success
+ *               -1 on out of memory (when rows shared with snapshot can't be copied)
+ *               -2 if options are invalid (minValue > maxValue, negative bandwidth) or elements of Hilbert matrix
+ *                  don't fit in long integer
+ *
+ */
+int generateMatrix( Matrix *matrix, const GeneratorOptions *options )
+{
+    GeneratorContext context = { matrix, options, 0, 0 };
+
+    if( options->minValue > options->maxValue || options->lowerBandwidth < 0 || options->upperBandwidth < 0 )
+        return -2;
+    if( options->pattern == GENERATE_HILBERT && _hilbertScale( matrix->size, &context.hilbertScale ) != 0 )
+        return -2;
+    context.range = ( unsigned long )options->maxValue - ( unsigned long )options->minValue + 1;
+    if( prepareMatrixForWrite( matrix ) != 0 )
+        return -1;
+
+    parallelFor( matrix->size, 64, _fillRows, &context );  // At least 64 rows per thread
+    markMatrixModified( matrix );
+    return 0;
+}
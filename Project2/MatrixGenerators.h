@@ -0,0 +1,45 @@
+/*
+ * File: MatrixGenerators.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixGenerators.c
+ */
+
+#ifndef PROJEKT2_MATRIXGENERATORS_H
+#define PROJEKT2_MATRIXGENERATORS_H
+
+#include "SquareMatrix.h"
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Patterns of generated matrices
+enum GeneratorPattern {
+    GENERATE_RANDOM,        // All elements random
+    GENERATE_IDENTITY,      // Ones on diagonal
+    GENERATE_DIAGONAL,      // Random elements on diagonal
+    GENERATE_BANDED,        // Random elements on diagonals from -lowerBandwidth to upperBandwidth
+    GENERATE_TOEPLITZ,      // Every diagonal filled with one random value
+    GENERATE_HILBERT        // Hilbert matrix 1 / (row + col + 1) scaled by lcm(1, ..., 2 * size - 1) to integers
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Parameters of generated matrix; random values depend only on seed and position of element (not on number of
+// threads), so the same options always give the same matrix
+struct GeneratorOptions {
+    int pattern;                            // One of GeneratorPattern values
+    unsigned long seed;                     // Seed of random values
+    long minValue, maxValue;                // Range of random values
+    int lowerBandwidth, upperBandwidth;     // Number of diagonals below and above main one in banded matrix
+};
+typedef struct GeneratorOptions GeneratorOptions;
+
+/************************************
+ * Function declarations
+ ************************************/
+unsigned long counterRandom( unsigned long seed, unsigned long counter );
+int generateMatrix( Matrix *matrix, const GeneratorOptions *options );
+
+#endif //PROJEKT2_MATRIXGENERATORS_H
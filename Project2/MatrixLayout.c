@@ -0,0 +1,521 @@
+/*
+ * File: MatrixLayout.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Cache-oblivious transposition and conversions between layouts of elements
+ *
+ * Transposition splits the longer side of block in halves until block fits in TRANSPOSE_LEAF_SIZE, so at some level
+ * of recursion both source and target blocks fit in every level of cache, whatever its size is. Leaves are
+ * transposed in 4x4 register blocks. On x86-64 the AVX2 kernel (four 256-bit registers hold 4x4 longs) is always
+ * compiled, with function attribute target("avx2"), and chosen at run time for every leaf if processor supports it,
+ * so the default build (without -mavx2 or -march=native) uses it as well.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "MatrixLayout.h"
+#include "Parallel.h"
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#define TRANSPOSE_AVX2          1               // AVX2 kernel is compiled and dispatched at run time
+#endif
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define ALWAYS_INLINE           __attribute__(( always_inline )) inline
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Arguments shared by threads transposing strips of matrix
+struct TransposeContext {
+    long *const *source;                        // Row pointers of transposed matrix
+    long *const *target;                        // Row pointers of result
+    int size;
+};
+typedef struct TransposeContext TransposeContext;
+
+// Kernel transposing 4x4 block (see _transpose4x4Scalar)
+typedef void ( *Transpose4x4 )( long *const *source, int sourceCol, long *const *target, int targetCol );
+
+/*
+ * Functions <private>:  _transpose4x4Scalar, _transpose4x4Avx2
+ * --------------------
+ *      write transposition of 4x4 block starting at column sourceCol of rows source[0..3] to block starting at
+ *      column targetCol of rows target[0..3]; blocks must not overlap
+ *
+ */
+static ALWAYS_INLINE void _transpose4x4Scalar( long *const *source, int sourceCol, long *const *target,
+                                               int targetCol )
+{
+    const long *row0 = source[0] + sourceCol, *row1 = source[1] + sourceCol;
+    const long *row2 = source[2] + sourceCol, *row3 = source[3] + sourceCol;
+
+    for( int col = 0; col < 4; col++ )                          // Column of source block becomes row of target
+    {
+        const long a = row0[col], b = row1[col], c = row2[col], d = row3[col];
+        long *targetRow = target[col] + targetCol;
+        targetRow[0] = a;
+        targetRow[1] = b;
+        targetRow[2] = c;
+        targetRow[3] = d;
+    }
+}
+
+#ifdef TRANSPOSE_AVX2
+__attribute__(( target( "avx2" ) ))
+static ALWAYS_INLINE void _transpose4x4Avx2( long *const *source, int sourceCol, long *const *target, int targetCol )
+{
+    __m256i row0 = _mm256_loadu_si256( ( const __m256i* )( source[0] + sourceCol ) );
+    __m256i row1 = _mm256_loadu_si256( ( const __m256i* )( source[1] + sourceCol ) );
+    __m256i row2 = _mm256_loadu_si256( ( const __m256i* )( source[2] + sourceCol ) );
+    __m256i row3 = _mm256_loadu_si256( ( const __m256i* )( source[3] + sourceCol ) );
+    __m256i even01 = _mm256_unpacklo_epi64( row0, row1 );       // a0 b0 a2 b2
+    __m256i odd01 = _mm256_unpackhi_epi64( row0, row1 );        // a1 b1 a3 b3
+    __m256i even23 = _mm256_unpacklo_epi64( row2, row3 );       // c0 d0 c2 d2
+    __m256i odd23 = _mm256_unpackhi_epi64( row2, row3 );        // c1 d1 c3 d3
+    _mm256_storeu_si256( ( __m256i* )( target[0] + targetCol ), _mm256_permute2x128_si256( even01, even23, 0x20 ) );
+    _mm256_storeu_si256( ( __m256i* )( target[1] + targetCol ), _mm256_permute2x128_si256( odd01, odd23, 0x20 ) );
+    _mm256_storeu_si256( ( __m256i* )( target[2] + targetCol ), _mm256_permute2x128_si256( even01, even23, 0x31 ) );
+    _mm256_storeu_si256( ( __m256i* )( target[3] + targetCol ), _mm256_permute2x128_si256( odd01, odd23, 0x31 ) );
+}
+#endif
+
+/*
+ * Function <private>:  _hasAvx2
+ * --------------------
+ *      returns non-zero if AVX2 kernel is compiled and processor supports it
+ *
+ */
+static int _hasAvx2( void )
+{
+#ifdef TRANSPOSE_AVX2
+    return __builtin_cpu_supports( "avx2" );
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Function <private>:  _transposeLeafWith
+ * --------------------
+ *      writes target[col][row] = source[row][col] for rows <rowBegin, rowEnd) and cols <colBegin, colEnd) of
+ *      source; full 4x4 blocks are transposed by register kernel, remaining edges element by element. It's always
+ *      inlined, so kernel is inlined in variants of leaf for every instruction set
+ *
+ */
+static ALWAYS_INLINE void _transposeLeafWith( long *const *source, long *const *target, int rowBegin, int rowEnd,
+                                              int colBegin, int colEnd, Transpose4x4 kernel )
+{
+    int row = rowBegin;
+
+    for( ; row + 4 <= rowEnd; row += 4 )
+    {
+        int col = colBegin;
+        for( ; col + 4 <= colEnd; col += 4 )
+            kernel( source + row, col, target + col, row );
+        for( ; col < colEnd; col++ )                            // Right edge of rows
+            for( int i = row; i < row + 4; i++ )
+                target[col][i] = source[i][col];
+    }
+    for( ; row < rowEnd; row++ )                                // Bottom edge
+        for( int col = colBegin; col < colEnd; col++ )
+            target[col][row] = source[row][col];
+}
+
+/*
+ * Function <private>:  _swapLeafWith
+ * --------------------
+ *      swaps leaf block (rows <rowBegin, rowEnd), cols <colBegin, colEnd)) with transposition of block symmetric
+ *      to it (see _swapTransposed); always inlined like _transposeLeafWith
+ *
+ */
+static ALWAYS_INLINE void _swapLeafWith( long *const *rows, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                                         Transpose4x4 kernel )
+{
+    long buffer[16];
+    long *bufferRows[4] = { buffer, buffer + 4, buffer + 8, buffer + 12 };
+    int row = rowBegin;
+    for( ; row + 4 <= rowEnd; row += 4 )
+    {
+        int col = colBegin;
+        for( ; col + 4 <= colEnd; col += 4 )                    // Block A at (row, col), block B at (col, row):
+        {
+            kernel( rows + row, col, bufferRows, 0 );           // buffer = A^T
+            kernel( rows + col, row, rows + row, col );         // A = B^T
+            for( int i = 0; i < 4; i++ )                        // B = buffer
+                memcpy( rows[col + i] + row, bufferRows[i], 4 * sizeof( long ) );
+        }
+        for( ; col < colEnd; col++ )
+            for( int i = row; i < row + 4; i++ )
+            {
+                long swap = rows[i][col];
+                rows[i][col] = rows[col][i];
+                rows[col][i] = swap;
+            }
+    }
+    for( ; row < rowEnd; row++ )
+        for( int col = colBegin; col < colEnd; col++ )
+        {
+            long swap = rows[row][col];
+            rows[row][col] = rows[col][row];
+            rows[col][row] = swap;
+        }
+}
+
+/*
+ * Functions <private>:  _transposeLeafScalar, _transposeLeafAvx2, _swapLeafScalar, _swapLeafAvx2
+ * --------------------
+ *      variants of _transposeLeafWith and _swapLeafWith with scalar and AVX2 kernel
+ *
+ */
+static void _transposeLeafScalar( long *const *source, long *const *target, int rowBegin, int rowEnd, int colBegin,
+                                  int colEnd )
+{
+    _transposeLeafWith( source, target, rowBegin, rowEnd, colBegin, colEnd, _transpose4x4Scalar );
+}
+
+static void _swapLeafScalar( long *const *rows, int rowBegin, int rowEnd, int colBegin, int colEnd )
+{
+    _swapLeafWith( rows, rowBegin, rowEnd, colBegin, colEnd, _transpose4x4Scalar );
+}
+
+#ifdef TRANSPOSE_AVX2
+__attribute__(( target( "avx2" ) ))
+static void _transposeLeafAvx2( long *const *source, long *const *target, int rowBegin, int rowEnd, int colBegin,
+                                int colEnd )
+{
+    _transposeLeafWith( source, target, rowBegin, rowEnd, colBegin, colEnd, _transpose4x4Avx2 );
+}
+
+__attribute__(( target( "avx2" ) ))
+static void _swapLeafAvx2( long *const *rows, int rowBegin, int rowEnd, int colBegin, int colEnd )
+{
+    _swapLeafWith( rows, rowBegin, rowEnd, colBegin, colEnd, _transpose4x4Avx2 );
+}
+#endif
+
+/*
+ * Function <private>:  _transposeLeaf
+ * --------------------
+ *      transposes leaf block (see _transposeLeafWith) with the fastest kernel supported by processor
+ *
+ */
+static void _transposeLeaf( long *const *source, long *const *target, int rowBegin, int rowEnd, int colBegin,
+                            int colEnd )
+{
+#ifdef TRANSPOSE_AVX2
+    if( _hasAvx2() )
+    {
+        _transposeLeafAvx2( source, target, rowBegin, rowEnd, colBegin, colEnd );
+        return;
+    }
+#endif
+    _transposeLeafScalar( source, target, rowBegin, rowEnd, colBegin, colEnd );
+}
+
+/*
+ * Function <private>:  _swapLeaf
+ * --------------------
+ *      swaps leaf blocks (see _swapLeafWith) with the fastest kernel supported by processor
+ *
+ */
+static void _swapLeaf( long *const *rows, int rowBegin, int rowEnd, int colBegin, int colEnd )
+{
+#ifdef TRANSPOSE_AVX2
+    if( _hasAvx2() )
+    {
+        _swapLeafAvx2( rows, rowBegin, rowEnd, colBegin, colEnd );
+        return;
+    }
+#endif
+    _swapLeafScalar( rows, rowBegin, rowEnd, colBegin, colEnd );
+}
+
+/*
+ * Function <private>:  _half
+ * --------------------
+ *      returns middle of range <begin, end) rounded so that the first half has length divisible by 4 (then full
+ *      register blocks aren't cut)
+ *
+ */
+static int _half( int begin, int end )
+{
+    return begin + ( ( ( end - begin ) / 2 + 3 ) & ~3 );
+}
+
+/*
+ * Function <private>:  _transposeRectangle
+ * --------------------
+ *      cache-oblivious transposition of block of source (rows <rowBegin, rowEnd), cols <colBegin, colEnd)) into
+ *      target
+ *
+ */
+static void _transposeRectangle( long *const *source, long *const *target, int rowBegin, int rowEnd, int colBegin,
+                                 int colEnd )
+{
+    if( rowEnd - rowBegin <= TRANSPOSE_LEAF_SIZE && colEnd - colBegin <= TRANSPOSE_LEAF_SIZE )
+        _transposeLeaf( source, target, rowBegin, rowEnd, colBegin, colEnd );
+    else if( rowEnd - rowBegin >= colEnd - colBegin )           // Split longer side
+    {
+        const int middle = _half( rowBegin, rowEnd );
+        _transposeRectangle( source, target, rowBegin, middle, colBegin, colEnd );
+        _transposeRectangle( source, target, middle, rowEnd, colBegin, colEnd );
+    } else
+    {
+        const int middle = _half( colBegin, colEnd );
+        _transposeRectangle( source, target, rowBegin, rowEnd, colBegin, middle );
+        _transposeRectangle( source, target, rowBegin, rowEnd, middle, colEnd );
+    }
+}
+
+/*
+ * Function <private>:  _transposeStrip
+ * --------------------
+ *      fills rows <begin, end) of target with columns of source (used as ParallelBody)
+ *
+ */
+static void _transposeStrip( long begin, long end, int worker, void *context )
+{
+    const TransposeContext *transpose = context;
+    _transposeRectangle( transpose->source, transpose->target, 0, transpose->size, ( int )begin, ( int )end );
+}
+
+/*
+ * Function <private>:  _transposeRows
+ * --------------------
+ *      writes transposition of matrix given by row pointers source to rows target, using all available threads
+ *      (each thread writes separate strip of rows of target)
+ *
+ */
+static void _transposeRows( long *const *source, long *const *target, int size )
+{
+    TransposeContext context = { source, target, size };
+    parallelFor( size, 64, _transposeStrip, &context );         // At least 64 rows of result per thread
+}
+
+/*
+ * Function:  transposeSquareMatrix
+ * --------------------
+ *      creates transposition of matrix
+ *
+ *      input:   pointer to Matrix structure
+ *      output:  pointer to memory where pointer to transposed matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int transposeSquareMatrix( Matrix *input, Matrix **output )
+{
+    if( createSquareMatrix( input->size, output ) != 0 )
+        return -1;
+    _transposeRows( input->elements, ( *output )->elements, input->size );
+    return 0;
+}
+
+/*
+ * Function <private>:  _swapTransposed
+ * --------------------
+ *      swaps block (rows <rowBegin, rowEnd), cols <colBegin, colEnd)) with transposition of block symmetric to it
+ *      (the blocks must not overlap); recursion is the same as in _transposeRectangle
+ *
+ */
+static void _swapTransposed( long *const *rows, int rowBegin, int rowEnd, int colBegin, int colEnd )
+{
+    if( rowEnd - rowBegin > TRANSPOSE_LEAF_SIZE || colEnd - colBegin > TRANSPOSE_LEAF_SIZE )
+    {
+        if( rowEnd - rowBegin >= colEnd - colBegin )
+        {
+            const int middle = _half( rowBegin, rowEnd );
+            _swapTransposed( rows, rowBegin, middle, colBegin, colEnd );
+            _swapTransposed( rows, middle, rowEnd, colBegin, colEnd );
+        } else
+        {
+            const int middle = _half( colBegin, colEnd );
+            _swapTransposed( rows, rowBegin, rowEnd, colBegin, middle );
+            _swapTransposed( rows, rowBegin, rowEnd, middle, colEnd );
+        }
+        return;
+    }
+    _swapLeaf( rows, rowBegin, rowEnd, colBegin, colEnd );
+}
+
+/*
+ * Function <private>:  _transposeDiagonal
+ * --------------------
+ *      transposes in place square block <begin, end) x <begin, end) lying on main diagonal: both halves on
+ *      diagonal are transposed recursively and blocks outside diagonal are swapped with each other
+ *
+ */
+static void _transposeDiagonal( long *const *rows, int begin, int end )
+{
+    if( end - begin <= TRANSPOSE_LEAF_SIZE )
+    {
+        for( int row = begin; row < end; row++ )
+            for( int col = row + 1; col < end; col++ )
+            {
+                long swap = rows[row][col];
+                rows[row][col] = rows[col][row];
+                rows[col][row] = swap;
+            }
+        return;
+    }
+    const int middle = _half( begin, end );
+    _transposeDiagonal( rows, begin, middle );
+    _transposeDiagonal( rows, middle, end );
+    _swapTransposed( rows, begin, middle, middle, end );
+}
+
+/*
+ * Function:  transposeSquareMatrixInPlace
+ * --------------------
+ *      transposes matrix without allocating second matrix (only rows shared with snapshots are copied)
+ *
+ *      matrix:  pointer to Matrix structure
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int transposeSquareMatrixInPlace( Matrix *matrix )
+{
+    if( prepareMatrixForWrite( matrix ) != 0 )
+        return -1;
+    _transposeDiagonal( matrix->elements, 0, matrix->size );
+    markMatrixModified( matrix );
+    return 0;
+}
+
+/*
+ * Function:  layoutBufferLength
+ * --------------------
+ *      returns number of elements of buffer holding matrix of given size in given layout
+ *
+ */
+size_t layoutBufferLength( int size, int layout )
+{
+    if( layout == LAYOUT_TILED )
+    {
+        const size_t tiles = ( size_t )( size + LAYOUT_TILE_SIZE - 1 ) / LAYOUT_TILE_SIZE;
+        return tiles * tiles * LAYOUT_TILE_SIZE * LAYOUT_TILE_SIZE;
+    }
+    return ( size_t )size * ( size_t )size;
+}
+
+/*
+ * Function <private>:  _bufferRows
+ * --------------------
+ *      creates array of pointers to consecutive rows of length "size" of packed buffer
+ *
+ *      returns: array of pointers (to be freed by caller), NULL on out of memory
+ *
+ */
+static long** _bufferRows( long *buffer, int size )
+{
+    long **rows = malloc( sizeof( long* ) * ( size_t )( size > 0 ? size : 1 ) );
+    if( rows != NULL )
+        for( int row = 0; row < size; row++ )
+            rows[row] = buffer + ( size_t )row * ( size_t )size;
+    return rows;
+}
+
+/*
+ * Function <private>:  _copyTiles
+ * --------------------
+ *      copies matrix to tiled buffer (toTiles = 1) or back (toTiles = 0); every row of every tile is one memcpy
+ *
+ */
+static void _copyTiles( Matrix *matrix, long *buffer, int toTiles )
+{
+    const int size = matrix->size;
+    const int tiles = ( size + LAYOUT_TILE_SIZE - 1 ) / LAYOUT_TILE_SIZE;
+
+    for( int row = 0; row < size; row++ )
+        for( int tile = 0; tile < tiles; tile++ )
+        {
+            const int col = tile * LAYOUT_TILE_SIZE;
+            const int width = size - col < LAYOUT_TILE_SIZE ? size - col : LAYOUT_TILE_SIZE;
+            long *tileRow = buffer + ( ( size_t )( row / LAYOUT_TILE_SIZE ) * tiles + tile )
+                                     * LAYOUT_TILE_SIZE * LAYOUT_TILE_SIZE
+                                   + ( size_t )( row % LAYOUT_TILE_SIZE ) * LAYOUT_TILE_SIZE;
+            if( toTiles )
+            {
+                memcpy( tileRow, matrix->elements[row] + col, sizeof( long ) * ( size_t )width );
+                memset( tileRow + width, 0, sizeof( long ) * ( size_t )( LAYOUT_TILE_SIZE - width ) );
+            } else
+                memcpy( matrix->elements[row] + col, tileRow, sizeof( long ) * ( size_t )width );
+        }
+
+    if( toTiles && size % LAYOUT_TILE_SIZE != 0 )               // Padding rows of bottom tiles
+        for( int row = size; row < tiles * LAYOUT_TILE_SIZE; row++ )
+            for( int tile = 0; tile < tiles; tile++ )
+                memset( buffer + ( ( size_t )( row / LAYOUT_TILE_SIZE ) * tiles + tile )
+                                 * LAYOUT_TILE_SIZE * LAYOUT_TILE_SIZE
+                               + ( size_t )( row % LAYOUT_TILE_SIZE ) * LAYOUT_TILE_SIZE,
+                        0, sizeof( long ) * LAYOUT_TILE_SIZE );
+}
+
+/*
+ * Function:  exportMatrixLayout
+ * --------------------
+ *      writes elements of matrix to buffer in requested layout (in one pass over matrix)
+ *
+ *      matrix:  pointer to Matrix structure
+ *      layout:  one of MatrixLayout values
+ *      buffer:  array of layoutBufferLength( matrix->size, layout ) elements
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int exportMatrixLayout( Matrix *matrix, int layout, long *buffer )
+{
+    const int size = matrix->size;
+
+    if( layout == LAYOUT_ROW_MAJOR )
+        for( int row = 0; row < size; row++ )
+            memcpy( buffer + ( size_t )row * size, matrix->elements[row], sizeof( long ) * ( size_t )size );
+    else if( layout == LAYOUT_COLUMN_MAJOR )                    // Column-major matrix is transposed row-major one
+    {
+        long **rows = _bufferRows( buffer, size );
+        if( rows == NULL )
+            return -1;
+        _transposeRows( matrix->elements, rows, size );
+        free( rows );
+    } else
+        _copyTiles( matrix, buffer, 1 );
+    return 0;
+}
+
+/*
+ * Function:  importMatrixLayout
+ * --------------------
+ *      sets elements of matrix to ones stored in buffer in given layout (in one pass over matrix)
+ *
+ *      matrix:  pointer to Matrix structure
+ *      layout:  one of MatrixLayout values
+ *      buffer:  array of layoutBufferLength( matrix->size, layout ) elements
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int importMatrixLayout( Matrix *matrix, int layout, const long *buffer )
+{
+    const int size = matrix->size;
+
+    if( prepareMatrixForWrite( matrix ) != 0 )
+        return -1;
+    if( layout == LAYOUT_ROW_MAJOR )
+        for( int row = 0; row < size; row++ )
+            memcpy( matrix->elements[row], buffer + ( size_t )row * size, sizeof( long ) * ( size_t )size );
+    else if( layout == LAYOUT_COLUMN_MAJOR )
+    {
+        long **rows = _bufferRows( ( long* )buffer, size );    // Rows are only read
+        if( rows == NULL )
+            return -1;
+        _transposeRows( rows, matrix->elements, size );
+        free( rows );
+    } else
+        _copyTiles( matrix, ( long* )buffer, 0 );
+    markMatrixModified( matrix );
+    return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * File: MatrixLayout.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixLayout.c
+ */
+
+#ifndef PROJEKT2_MATRIXLAYOUT_H
+#define PROJEKT2_MATRIXLAYOUT_H
+
+#include <stddef.h>
+#include "SquareMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define TRANSPOSE_LEAF_SIZE     16              // Blocks up to this size are transposed without further recursion
+#define LAYOUT_TILE_SIZE        32              // Number of rows|cols of tile of LAYOUT_TILED (32 * 32 longs = 8 KB)
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Orders of elements in packed buffer (without padding between rows, unlike Matrix)
+enum MatrixLayout {
+    LAYOUT_ROW_MAJOR,                           // buffer[row * size + col]
+    LAYOUT_COLUMN_MAJOR,                        // buffer[col * size + row]
+    LAYOUT_TILED                                // Tiles in row-major order, elements row-major within tile; tiles on
+                                                // right and bottom edge are padded with zeros to full size
+};
+
+/************************************
+ * Function declarations
+ ************************************/
+int transposeSquareMatrix( Matrix *input, Matrix **output );
+int transposeSquareMatrixInPlace( Matrix *matrix );
+size_t layoutBufferLength( int size, int layout );
+int exportMatrixLayout( Matrix *matrix, int layout, long *buffer );
+int importMatrixLayout( Matrix *matrix, int layout, const long *buffer );
+
+#endif //PROJEKT2_MATRIXLAYOUT_H
@@ -0,0 +1,297 @@
+/*
+ * File: MatrixPool.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Allocators of memory of matrices - pool keeping free lists of aligned blocks of power-of-two size
+ *              classes (so creating and deleting small matrices doesn't go to malloc at all) and arena for
+ *              temporaries of one operation, freed all at once; big blocks may be backed by transparent huge pages
+ */
+
+#define _DEFAULT_SOURCE                         // MAP_ANONYMOUS and MADV_HUGEPAGE
+
+#include "MatrixPool.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+
+/************************************
+ * Global variables
+ ************************************/
+// Pool used by matrices created without allocator
+static MatrixAllocator _defaultAllocator = { ALLOCATOR_POOL, ALLOCATOR_HUGE_PAGES, PTHREAD_MUTEX_INITIALIZER };
+
+/*
+ * Function:  createMatrixPool
+ * --------------------
+ *      creates pool allocator; blocks up to 2^(POOL_MIN_CLASS_SHIFT + POOL_SIZE_CLASSES - 1) bytes are rounded up to
+ *      power of two and reused after release, bigger ones are allocated and freed directly
+ *
+ *      flags:   ALLOCATOR_HUGE_PAGES if blocks of at least HUGE_PAGE_SIZE bytes should be mapped with huge pages
+ *      output:  pointer to memory where pointer to allocator should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createMatrixPool( int flags, MatrixAllocator **output )
+{
+    MatrixAllocator *pool = calloc( 1, sizeof( MatrixAllocator ) );
+    if( pool == NULL )
+        return -1;
+    if( pthread_mutex_init( &pool->lock, NULL ) != 0 )
+    {
+        free( pool );
+        return -1;
+    }
+    pool->kind = ALLOCATOR_POOL;
+    pool->flags = flags;
+    *output = pool;
+    return 0;
+}
+
+/*
+ * Function:  createMatrixArena
+ * --------------------
+ *      creates arena allocator - releasing single block does nothing, all blocks are freed with releaseMatrixArena
+ *      or deleteMatrixAllocator, so matrices allocated from it mustn't be used after that
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createMatrixArena( MatrixAllocator **output )
+{
+    MatrixAllocator *arena = calloc( 1, sizeof( MatrixAllocator ) );
+    if( arena == NULL )
+        return -1;
+    arena->kind = ALLOCATOR_ARENA;
+    *output = arena;
+    return 0;
+}
+
+/*
+ * Function:  deleteMatrixAllocator
+ * --------------------
+ *      frees allocator and all memory it keeps (all blocks of arena, free blocks of pool); blocks of pool which
+ *      are still in use must have been released before
+ *
+ */
+void deleteMatrixAllocator( MatrixAllocator *allocator )
+{
+    if( allocator == NULL || allocator == &_defaultAllocator )
+        return;
+
+    if( allocator->kind == ALLOCATOR_ARENA )
+    {
+        MatrixArenaMark empty = { NULL, 0 };
+        releaseMatrixArena( allocator, empty );
+    } else
+    {
+        for( int sizeClass = 0; sizeClass < POOL_SIZE_CLASSES; sizeClass++ )
+            while( allocator->freeBlocks[sizeClass] != NULL )
+            {
+                void *block = allocator->freeBlocks[sizeClass];
+                allocator->freeBlocks[sizeClass] = *( void** )block;
+                free( block );
+            }
+        pthread_mutex_destroy( &allocator->lock );
+    }
+    free( allocator );
+}
+
+/*
+ * Function:  defaultMatrixAllocator
+ * --------------------
+ *      returns pool shared by the whole program (used for matrices created without allocator); it uses huge pages
+ *      for big blocks
+ *
+ */
+MatrixAllocator* defaultMatrixAllocator( void )
+{
+    return &_defaultAllocator;
+}
+
+/*
+ * Function <private>:  _sizeClass
+ * --------------------
+ *      returns size class of block of given size, or -1 if block is too big to be pooled
+ *
+ */
+static int _sizeClass( size_t bytes )
+{
+    int sizeClass = 0;
+
+    while( sizeClass < POOL_SIZE_CLASSES && ( ( size_t )1 << ( POOL_MIN_CLASS_SHIFT + sizeClass ) ) < bytes )
+        sizeClass++;
+    return sizeClass < POOL_SIZE_CLASSES ? sizeClass : -1;
+}
+
+/*
+ * Function <private>:  _usesHugePages
+ * --------------------
+ *      returns non-zero if block of given size is mapped with huge pages by allocator
+ *
+ */
+static int _usesHugePages( MatrixAllocator *allocator, size_t bytes )
+{
+    return ( allocator->flags & ALLOCATOR_HUGE_PAGES ) && bytes >= HUGE_PAGE_SIZE;
+}
+
+/*
+ * Function <private>:  _allocateDirectly
+ * --------------------
+ *      allocates block which isn't pooled - with mmap (and advice to use huge pages) or from heap
+ *
+ */
+static void* _allocateDirectly( MatrixAllocator *allocator, size_t bytes )
+{
+    void *memory = NULL;
+
+    if( _usesHugePages( allocator, bytes ) )
+    {
+        memory = mmap( NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if( memory == MAP_FAILED )
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        madvise( memory, bytes, MADV_HUGEPAGE );        // Only advice - memory is usable even if it's ignored
+#endif
+        return memory;
+    }
+    return posix_memalign( &memory, POOL_ALIGNMENT, bytes ) == 0 ? memory : NULL;
+}
+
+/*
+ * Function <private>:  _allocateFromArena
+ * --------------------
+ *      takes block from the newest chunk of arena; new chunk is allocated if it doesn't fit
+ *
+ */
+static void* _allocateFromArena( MatrixAllocator *arena, size_t bytes )
+{
+    const size_t header = ( sizeof( ArenaChunk ) + POOL_ALIGNMENT - 1 ) / POOL_ALIGNMENT * POOL_ALIGNMENT;
+    ArenaChunk *chunk = arena->chunk;
+
+    bytes = ( bytes + POOL_ALIGNMENT - 1 ) / POOL_ALIGNMENT * POOL_ALIGNMENT;      // Keep next block aligned
+    if( chunk == NULL || chunk->capacity - chunk->used < bytes )
+    {
+        const size_t capacity = bytes > ARENA_CHUNK_SIZE ? bytes : ARENA_CHUNK_SIZE;
+        void *memory;
+        if( posix_memalign( &memory, POOL_ALIGNMENT, header + capacity ) != 0 )
+            return NULL;
+        chunk = memory;
+        chunk->previous = arena->chunk;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        arena->chunk = chunk;
+    }
+
+    void *block = ( char* )chunk + header + chunk->used;
+    chunk->used += bytes;
+    return block;
+}
+
+/*
+ * Function:  allocateMatrixMemory
+ * --------------------
+ *      allocates block aligned to POOL_ALIGNMENT bytes (content is undefined)
+ *
+ *      allocator: allocator of block (NULL - default pool)
+ *      bytes:     size of block
+ *
+ *      returns: pointer to block, NULL on out of memory
+ *
+ */
+void* allocateMatrixMemory( MatrixAllocator *allocator, size_t bytes )
+{
+    if( allocator == NULL )
+        allocator = &_defaultAllocator;
+    if( bytes == 0 )
+        bytes = 1;
+    if( allocator->kind == ALLOCATOR_ARENA )
+        return _allocateFromArena( allocator, bytes );
+
+    const int sizeClass = _sizeClass( bytes );
+    if( sizeClass == -1 )
+        return _allocateDirectly( allocator, bytes );
+
+    pthread_mutex_lock( &allocator->lock );
+    void *block = allocator->freeBlocks[sizeClass];
+    if( block != NULL )                                 // Reuse released block of the same class
+    {
+        allocator->freeBlocks[sizeClass] = *( void** )block;
+        allocator->freeCounts[sizeClass]--;
+    }
+    pthread_mutex_unlock( &allocator->lock );
+
+    if( block == NULL && posix_memalign( &block, POOL_ALIGNMENT, ( size_t )1 << ( POOL_MIN_CLASS_SHIFT + sizeClass ) ) != 0 )
+        return NULL;
+    return block;
+}
+
+/*
+ * Function:  releaseMatrixMemory
+ * --------------------
+ *      gives block back to allocator it was taken from; it may be reused by next allocation of the same class
+ *
+ *      allocator: allocator of block (NULL - default pool)
+ *      memory:    block returned by allocateMatrixMemory (can be NULL)
+ *      bytes:     size passed to allocateMatrixMemory
+ *
+ */
+void releaseMatrixMemory( MatrixAllocator *allocator, void *memory, size_t bytes )
+{
+    if( allocator == NULL )
+        allocator = &_defaultAllocator;
+    if( memory == NULL || allocator->kind == ALLOCATOR_ARENA )      // Arena frees everything at once
+        return;
+    if( bytes == 0 )
+        bytes = 1;
+
+    const int sizeClass = _sizeClass( bytes );
+    if( sizeClass == -1 )
+    {
+        if( _usesHugePages( allocator, bytes ) )
+            munmap( memory, bytes );
+        else
+            free( memory );
+        return;
+    }
+
+    pthread_mutex_lock( &allocator->lock );
+    if( allocator->freeCounts[sizeClass] < POOL_MAX_FREE_BLOCKS )
+    {
+        *( void** )memory = allocator->freeBlocks[sizeClass];
+        allocator->freeBlocks[sizeClass] = memory;
+        allocator->freeCounts[sizeClass]++;
+        memory = NULL;
+    }
+    pthread_mutex_unlock( &allocator->lock );
+    free( memory );                                     // Free list is full - give block back to heap
+}
+
+/*
+ * Function:  markMatrixArena
+ * --------------------
+ *      returns current state of arena - blocks allocated later can be freed at once with releaseMatrixArena
+ *
+ */
+MatrixArenaMark markMatrixArena( MatrixAllocator *arena )
+{
+    MatrixArenaMark mark = { arena->chunk, arena->chunk == NULL ? 0 : arena->chunk->used };
+    return mark;
+}
+
+/*
+ * Function:  releaseMatrixArena
+ * --------------------
+ *      frees all blocks allocated after mark was taken (matrices using them can't be used any more)
+ *
+ */
+void releaseMatrixArena( MatrixAllocator *arena, MatrixArenaMark mark )
+{
+    while( arena->chunk != mark.chunk )
+    {
+        ArenaChunk *previous = arena->chunk->previous;
+        free( arena->chunk );
+        arena->chunk = previous;
+    }
+    if( arena->chunk != NULL )
+        arena->chunk->used = mark.used;
+}
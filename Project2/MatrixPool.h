@@ -0,0 +1,76 @@
+/*
+ * File: MatrixPool.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixPool.c
+ */
+
+#ifndef PROJEKT2_MATRIXPOOL_H
+#define PROJEKT2_MATRIXPOOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define POOL_ALIGNMENT          64                  // Alignment of every block (the same as MATRIX_ALIGNMENT)
+#define POOL_MIN_CLASS_SHIFT    6                   // The smallest size class has 2^6 = 64 bytes...
+#define POOL_SIZE_CLASSES       13                  // ...and the biggest 2^18 = 256 kB (bigger blocks aren't pooled)
+#define POOL_MAX_FREE_BLOCKS    64                  // Free blocks kept in every class (the rest goes back to heap)
+#define ARENA_CHUNK_SIZE        ( 64 * 1024 )       // Minimal size of chunk allocated by arena
+#define HUGE_PAGE_SIZE          ( 2 * 1024 * 1024 ) // Blocks at least that big may be backed by huge pages
+#define ALLOCATOR_HUGE_PAGES    1                   // Flag of pool: map big blocks with transparent huge pages
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Kinds of allocators
+enum AllocatorKind {
+    ALLOCATOR_POOL,         // Blocks are returned to free list of their size class and reused
+    ALLOCATOR_ARENA         // Blocks are taken from chunks and freed all at once (releaseMatrixArena or delete)
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Chunk of memory of arena - blocks are taken from its beginning
+struct ArenaChunk {
+    struct ArenaChunk *previous;                    // Chunk allocated before this one (NULL for the first one)
+    size_t capacity;                                // Number of bytes of chunk available for blocks
+    size_t used;                                    // Number of bytes already taken
+};
+typedef struct ArenaChunk ArenaChunk;
+
+// Allocator of memory of matrices (structures, arrays of rows and elements); pools are thread-safe, arenas are
+// meant for temporaries of one operation and must be used by one thread at a time
+struct MatrixAllocator {
+    int kind;                                       // One of AllocatorKind values
+    int flags;                                      // ALLOCATOR_HUGE_PAGES or 0
+    pthread_mutex_t lock;                           // Protects free lists of pool
+    void *freeBlocks[POOL_SIZE_CLASSES];            // Free blocks of each class, linked through their first word
+    int freeCounts[POOL_SIZE_CLASSES];              // Number of blocks on each free list
+    ArenaChunk *chunk;                              // The newest chunk of arena
+};
+typedef struct MatrixAllocator MatrixAllocator;
+
+// State of arena returned by markMatrixArena
+struct MatrixArenaMark {
+    ArenaChunk *chunk;
+    size_t used;
+};
+typedef struct MatrixArenaMark MatrixArenaMark;
+
+/************************************
+ * Function declarations
+ ************************************/
+int createMatrixPool( int flags, MatrixAllocator **output );
+int createMatrixArena( MatrixAllocator **output );
+void deleteMatrixAllocator( MatrixAllocator *allocator );
+MatrixAllocator* defaultMatrixAllocator( void );
+void* allocateMatrixMemory( MatrixAllocator *allocator, size_t bytes );
+void releaseMatrixMemory( MatrixAllocator *allocator, void *memory, size_t bytes );
+MatrixArenaMark markMatrixArena( MatrixAllocator *arena );
+void releaseMatrixArena( MatrixAllocator *arena, MatrixArenaMark mark );
+
+#endif //PROJEKT2_MATRIXPOOL_H
@@ -0,0 +1,458 @@
+/*
+ * File: MatrixRegistry.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Registry of matrices identified by id or name
+ */
+
+#include "MatrixRegistry.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/*
+ * Function:  createMatrixRegistry
+ * --------------------
+ *      creates empty registry
+ *
+ *      output: pointer to memory where pointer to created registry should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createMatrixRegistry( MatrixRegistry **output )
+{
+    MatrixRegistry *registry = calloc( 1, sizeof( MatrixRegistry ) );
+    if( registry == NULL )
+        return -1;
+
+    registry->entries = calloc( REGISTRY_INITIAL_CAPACITY, sizeof( RegistryEntry* ) );
+    registry->freeIds = malloc( REGISTRY_INITIAL_CAPACITY * sizeof( int ) );
+    registry->names = malloc( REGISTRY_INITIAL_CAPACITY * sizeof( int ) );
+    if( registry->entries == NULL || registry->freeIds == NULL || registry->names == NULL )
+    {
+        deleteMatrixRegistry( registry );
+        return -1;
+    }
+    for( int i = 0; i < REGISTRY_INITIAL_CAPACITY; i++ )
+        registry->names[i] = REGISTRY_EMPTY;
+    registry->capacity = REGISTRY_INITIAL_CAPACITY;
+    registry->namesCapacity = REGISTRY_INITIAL_CAPACITY;
+
+    *output = registry;
+    return 0;
+}
+
+/*
+ * Function <private>:  _clearEntry
+ * --------------------
+ *      deletes matrix stored in entry (if any)
+ *
+ */
+static void _clearEntry( RegistryEntry *entry )
+{
+    deleteSquareMatrix( entry->dense );
+    deleteSparseMatrix( entry->sparse );
+    entry->dense = NULL;
+    entry->sparse = NULL;
+}
+
+/*
+ * Function:  deleteMatrixRegistry
+ * --------------------
+ *      frees memory occupied by registry and all registered matrices
+ *
+ */
+void deleteMatrixRegistry( MatrixRegistry *registry )
+{
+    if( registry == NULL )
+        return;
+
+    for( int id = 0; registry->entries != NULL && id < registry->nextId; id++ )
+        if( registry->entries[id] != NULL )
+        {
+            _clearEntry( registry->entries[id] );
+            free( registry->entries[id] );
+        }
+    free( registry->entries );
+    free( registry->freeIds );
+    free( registry->names );
+    free( registry );
+}
+
+/*
+ * Function:  isValidMatrixName
+ * --------------------
+ *      checks if string can be used as name of matrix: it has to start with letter or '_', contain only letters,
+ *      digits and '_' and be shorter than MAX_MATRIX_NAME_LENGTH; thanks to that, names never look like ids
+ *
+ *      returns: 1 if name is valid, 0 otherwise
+ *
+ */
+int isValidMatrixName( const char *name )
+{
+    size_t length = 0;
+
+    if( !( ( name[0] >= 'a' && name[0] <= 'z' ) || ( name[0] >= 'A' && name[0] <= 'Z' ) || name[0] == '_' ) )
+        return 0;
+    for( ; name[length] != 0; length++ )
+        if( !( ( name[length] >= 'a' && name[length] <= 'z' ) || ( name[length] >= 'A' && name[length] <= 'Z' )
+               || ( name[length] >= '0' && name[length] <= '9' ) || name[length] == '_' ) )
+            return 0;
+    return length < MAX_MATRIX_NAME_LENGTH;
+}
+
+/*
+ * Function <private>:  _hashName
+ * --------------------
+ *      returns FNV-1a hash of name
+ *
+ */
+static unsigned long _hashName( const char *name )
+{
+    unsigned long hash = 0xCBF29CE484222325UL;
+    for( ; *name != 0; name++ )
+        hash = ( hash ^ ( unsigned char )*name ) * 0x100000001B3UL;
+    return hash ^ ( hash >> 32 );
+}
+
+/*
+ * Function <private>:  _findNameSlot
+ * --------------------
+ *      finds slot of name table containing id of entry with given name
+ *
+ *      returns: index of slot, -1 if there's no entry with such name
+ *
+ */
+static int _findNameSlot( MatrixRegistry *registry, const char *name )
+{
+    const int mask = registry->namesCapacity - 1;
+
+    for( int slot = ( int )( _hashName( name ) & ( unsigned long )mask );; slot = ( slot + 1 ) & mask )
+    {
+        int id = registry->names[slot];
+        if( id == REGISTRY_EMPTY )                                  // End of probing sequence - name not found
+            return -1;
+        if( id != REGISTRY_REMOVED && strcmp( registry->entries[id]->name, name ) == 0 )
+            return slot;
+    }
+}
+
+/*
+ * Function <private>:  _insertName
+ * --------------------
+ *      puts id of named entry into first empty or removed slot of its probing sequence (name can't be present
+ *      in table and table has to contain at least one empty slot)
+ *
+ */
+static void _insertName( MatrixRegistry *registry, int id )
+{
+    const int mask = registry->namesCapacity - 1;
+    int slot = ( int )( _hashName( registry->entries[id]->name ) & ( unsigned long )mask );
+
+    while( registry->names[slot] >= 0 )
+        slot = ( slot + 1 ) & mask;
+    if( registry->names[slot] == REGISTRY_EMPTY )
+        registry->namesUsed++;
+    registry->names[slot] = id;
+}
+
+/*
+ * Function <private>:  _reserveNameSlot
+ * --------------------
+ *      makes sure name table stays at most 3/4 full after inserting one more name; table is rebuilt (which also
+ *      drops removed markers) and doubled if live names take at least half of it
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _reserveNameSlot( MatrixRegistry *registry )
+{
+    int liveNames = 0, newCapacity = registry->namesCapacity;
+    int *oldNames = registry->names, oldCapacity = registry->namesCapacity;
+
+    if( ( long )( registry->namesUsed + 1 ) * 4 <= ( long )registry->namesCapacity * 3 )
+        return 0;
+
+    for( int slot = 0; slot < oldCapacity; slot++ )
+        liveNames += oldNames[slot] >= 0;
+    while( ( long )( liveNames + 1 ) * 2 > newCapacity )
+    {
+        if( newCapacity > INT_MAX / 2 )
+            return -1;
+        newCapacity *= 2;
+    }
+
+    int *names = malloc( ( size_t )newCapacity * sizeof( int ) );
+    if( names == NULL )
+        return -1;
+    for( int slot = 0; slot < newCapacity; slot++ )
+        names[slot] = REGISTRY_EMPTY;
+
+    registry->names = names;
+    registry->namesCapacity = newCapacity;
+    registry->namesUsed = 0;
+    for( int slot = 0; slot < oldCapacity; slot++ )                 // Rehash all live names
+        if( oldNames[slot] >= 0 )
+            _insertName( registry, oldNames[slot] );
+    free( oldNames );
+    return 0;
+}
+
+/*
+ * Function <private>:  _allocateId
+ * --------------------
+ *      takes id from stack of released ids or, if it's empty, first never used id (arrays of registry are
+ *      doubled when they are full)
+ *
+ *      returns: allocated id, -1 on out of memory
+ *
+ */
+static int _allocateId( MatrixRegistry *registry )
+{
+    if( registry->freeCount > 0 )
+        return registry->freeIds[--registry->freeCount];
+
+    if( registry->nextId == registry->capacity )
+    {
+        if( registry->capacity > INT_MAX / 2 )
+            return -1;
+        int newCapacity = registry->capacity * 2;
+
+        RegistryEntry **entries = realloc( registry->entries, ( size_t )newCapacity * sizeof( RegistryEntry* ) );
+        if( entries == NULL )
+            return -1;
+        registry->entries = entries;
+        int *freeIds = realloc( registry->freeIds, ( size_t )newCapacity * sizeof( int ) );
+        if( freeIds == NULL )
+            return -1;
+        registry->freeIds = freeIds;
+        memset( entries + registry->capacity, 0, ( size_t )( newCapacity - registry->capacity ) * sizeof( RegistryEntry* ) );
+        registry->capacity = newCapacity;
+    }
+    return registry->nextId++;
+}
+
+/*
+ * Function <private>:  _matrixBytes
+ * --------------------
+ *      returns memory occupied by matrix stored in one of forms (the other pointer should be NULL); rows of
+ *      dense matrix shared with its snapshots are counted for every snapshot
+ *
+ */
+static size_t _matrixBytes( Matrix *dense, SparseMatrix *sparse )
+{
+    if( dense != NULL )
+        return sizeof( Matrix ) + ( size_t )dense->size * ( sizeof( long* ) + ( size_t )dense->stride * sizeof( long ) );
+    return sizeof( SparseMatrix ) + ( size_t )( sparse->size + 1 ) * sizeof( long )
+           + ( size_t )sparse->nonZeros * ( sizeof( int ) + sizeof( long ) );
+}
+
+/*
+ * Function:  registryAdd
+ * --------------------
+ *      registers matrix stored in one of forms (the other pointer should be NULL) under first free id; registry
+ *      takes ownership of matrix only on success
+ *
+ *      name: name of matrix (NULL or empty string if matrix shouldn't have name)
+ *      id:   pointer to int where id of matrix should be stored (can be NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if name is already taken, -3 if name isn't valid
+ *
+ */
+int registryAdd( MatrixRegistry *registry, const char *name, Matrix *dense, SparseMatrix *sparse, int *id )
+{
+    const int named = name != NULL && name[0] != 0;
+
+    if( named && !isValidMatrixName( name ) )
+        return -3;
+    if( named && _findNameSlot( registry, name ) != -1 )
+        return -2;
+
+    RegistryEntry *entry = calloc( 1, sizeof( RegistryEntry ) );
+    if( entry == NULL || ( named && _reserveNameSlot( registry ) != 0 ) )
+    {
+        free( entry );
+        return -1;
+    }
+    entry->id = _allocateId( registry );
+    if( entry->id == -1 )
+    {
+        free( entry );
+        return -1;
+    }
+
+    if( named )
+        strcpy( entry->name, name );
+    entry->dense = dense;
+    entry->sparse = sparse;
+    entry->bytes = _matrixBytes( dense, sparse );
+    registry->entries[entry->id] = entry;
+    if( named )
+        _insertName( registry, entry->id );
+    registry->count++;
+    registry->totalBytes += entry->bytes;
+
+    if( id != NULL )
+        *id = entry->id;
+    return 0;
+}
+
+/*
+ * Function:  registryReplace
+ * --------------------
+ *      deletes matrix stored in entry and puts other matrix (ex. converted to other form) in its place; entry
+ *      keeps its id and name
+ *
+ */
+void registryReplace( MatrixRegistry *registry, RegistryEntry *entry, Matrix *dense, SparseMatrix *sparse )
+{
+    _clearEntry( entry );
+    registry->totalBytes -= entry->bytes;
+    entry->dense = dense;
+    entry->sparse = sparse;
+    entry->bytes = _matrixBytes( dense, sparse );
+    registry->totalBytes += entry->bytes;
+}
+
+/*
+ * Function:  registryRemove
+ * --------------------
+ *      deletes matrix with given id and releases its id and name
+ *
+ *      returns: 0 on success, -2 if there's no matrix with such id
+ *
+ */
+int registryRemove( MatrixRegistry *registry, int id )
+{
+    RegistryEntry *entry = registryFindById( registry, id );
+    if( entry == NULL )
+        return -2;
+
+    if( entry->name[0] != 0 )
+        registry->names[_findNameSlot( registry, entry->name )] = REGISTRY_REMOVED;
+    registry->freeIds[registry->freeCount++] = id;                  // Stack can't overflow - it's as long as "entries"
+    registry->entries[id] = NULL;
+    registry->count--;
+    registry->totalBytes -= entry->bytes;
+
+    _clearEntry( entry );
+    free( entry );
+    return 0;
+}
+
+/*
+ * Function:  registryFindById
+ * --------------------
+ *      returns entry of matrix with given id, NULL if there's no such matrix
+ *
+ */
+RegistryEntry* registryFindById( MatrixRegistry *registry, int id )
+{
+    if( id < 0 || id >= registry->nextId )
+        return NULL;
+    return registry->entries[id];
+}
+
+/*
+ * Function:  registryFindByName
+ * --------------------
+ *      returns entry of matrix with given name, NULL if there's no such matrix
+ *
+ */
+RegistryEntry* registryFindByName( MatrixRegistry *registry, const char *name )
+{
+    if( name[0] == 0 )                                              // Unnamed matrices can't be found by name
+        return NULL;
+    int slot = _findNameSlot( registry, name );
+    return slot == -1 ? NULL : registry->entries[registry->names[slot]];
+}
+
+/*
+ * Function:  registryFind
+ * --------------------
+ *      returns entry of matrix identified by string being either its id (optionally preceded by '#') or name
+ *
+ *      returns: pointer to entry, NULL if there's no such matrix
+ *
+ */
+RegistryEntry* registryFind( MatrixRegistry *registry, const char *idOrName )
+{
+    const char *digits = idOrName[0] == '#' ? idOrName + 1 : idOrName;
+    long id = 0;
+
+    if( digits[0] < '0' || digits[0] > '9' )
+        return registryFindByName( registry, idOrName );
+
+    for( ; *digits != 0; digits++ )
+    {
+        if( *digits < '0' || *digits > '9' )
+            return NULL;
+        id = id * 10 + ( *digits - '0' );
+        if( id > INT_MAX )
+            return NULL;
+    }
+    return registryFindById( registry, ( int )id );
+}
+
+/*
+ * Function:  registryAcceptAll
+ * --------------------
+ *      returns filter accepting every matrix
+ *
+ */
+RegistryFilter registryAcceptAll( void )
+{
+    RegistryFilter filter = { REGISTRY_ANY_STORAGE, 0, INT_MAX, NULL };
+    return filter;
+}
+
+/*
+ * Function:  registryMatches
+ * --------------------
+ *      checks if entry meets all criteria of filter
+ *
+ *      returns: 1 if entry is accepted, 0 otherwise
+ *
+ */
+int registryMatches( const RegistryEntry *entry, const RegistryFilter *filter )
+{
+    const int size = entry->dense != NULL ? entry->dense->size : entry->sparse->size;
+
+    if( ( filter->storage == REGISTRY_DENSE_STORAGE && entry->dense == NULL )
+        || ( filter->storage == REGISTRY_SPARSE_STORAGE && entry->sparse == NULL ) )
+        return 0;
+    if( size < filter->minSize || size > filter->maxSize )
+        return 0;
+    if( filter->namePrefix != NULL && strncmp( entry->name, filter->namePrefix, strlen( filter->namePrefix ) ) != 0 )
+        return 0;
+    return 1;
+}
+
+/*
+ * Function:  registryForEach
+ * --------------------
+ *      calls visitor for every entry accepted by filter, in order of ids; visitor mustn't add or remove matrices
+ *
+ *      filter:  criteria of selected entries (NULL accepts all)
+ *      visitor: function called for selected entries (can be NULL if only number of them is needed)
+ *      context: pointer passed to visitor
+ *
+ *      returns: number of selected entries
+ *
+ */
+int registryForEach( MatrixRegistry *registry, const RegistryFilter *filter, RegistryVisitor visitor, void *context )
+{
+    int selected = 0;
+
+    for( int id = 0; id < registry->nextId; id++ )
+    {
+        RegistryEntry *entry = registry->entries[id];
+        if( entry == NULL || ( filter != NULL && !registryMatches( entry, filter ) ) )
+            continue;
+        if( visitor != NULL )
+            visitor( entry, context );
+        selected++;
+    }
+    return selected;
+}
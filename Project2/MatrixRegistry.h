@@ -0,0 +1,85 @@
+/*
+ * File: MatrixRegistry.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixRegistry.c
+ */
+
+#ifndef PROJEKT2_MATRIXREGISTRY_H
+#define PROJEKT2_MATRIXREGISTRY_H
+
+#include <stddef.h>
+#include "SquareMatrix.h"
+#include "SparseMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define MAX_MATRIX_NAME_LENGTH  32              // Maximal length of name of matrix (including terminating NULL)
+#define REGISTRY_INITIAL_CAPACITY 32            // Initial number of ids and name table slots (power of two)
+
+// Markers of slots of name table not containing id of entry
+#define REGISTRY_EMPTY          -1              // Slot was never used - ends probing
+#define REGISTRY_REMOVED        -2              // Entry was removed - probing has to continue
+
+// Values of field "storage" of RegistryFilter
+#define REGISTRY_ANY_STORAGE    0
+#define REGISTRY_DENSE_STORAGE  1
+#define REGISTRY_SPARSE_STORAGE 2
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Registered matrix - exactly one of pointers "dense" and "sparse" is set
+struct RegistryEntry {
+    int id;                                     // Number identifying matrix, reused after matrix is removed
+    char name[MAX_MATRIX_NAME_LENGTH];          // Optional name of matrix (empty string if matrix has no name)
+    Matrix *dense;                              // Matrix stored as 2D array of all elements
+    SparseMatrix *sparse;                       // Matrix stored in compressed sparse row format
+    size_t bytes;                               // Memory occupied by matrix
+};
+typedef struct RegistryEntry RegistryEntry;
+
+// Set of matrices available by id (direct index) or name (open addressing hash table with linear probing)
+struct MatrixRegistry {
+    RegistryEntry **entries;                    // Entries indexed by id (NULL if id is free)
+    int capacity;                               // Length of array "entries"
+    int nextId;                                 // Ids >= nextId were never used
+    int *freeIds;                               // Stack of released ids lower than nextId
+    int freeCount;                              // Number of ids on stack "freeIds"
+    int *names;                                 // Name table - ids of named entries, REGISTRY_EMPTY or REGISTRY_REMOVED
+    int namesCapacity;                          // Length of array "names" (power of two)
+    int namesUsed;                              // Slots of name table which are not empty (including removed)
+    int count;                                  // Number of registered matrices
+    size_t totalBytes;                          // Memory occupied by all registered matrices
+};
+typedef struct MatrixRegistry MatrixRegistry;
+
+// Criteria used to select entries while listing registry
+struct RegistryFilter {
+    int storage;                                // One of REGISTRY_*_STORAGE values
+    int minSize, maxSize;                       // Range of accepted sizes of matrices
+    const char *namePrefix;                     // Accepted prefix of name (NULL accepts also unnamed matrices)
+};
+typedef struct RegistryFilter RegistryFilter;
+
+// Function called for every entry accepted by filter
+typedef void (*RegistryVisitor)( RegistryEntry *entry, void *context );
+
+/************************************
+ * Function declarations
+ ************************************/
+int createMatrixRegistry( MatrixRegistry **output );
+void deleteMatrixRegistry( MatrixRegistry *registry );
+int isValidMatrixName( const char *name );
+int registryAdd( MatrixRegistry *registry, const char *name, Matrix *dense, SparseMatrix *sparse, int *id );
+void registryReplace( MatrixRegistry *registry, RegistryEntry *entry, Matrix *dense, SparseMatrix *sparse );
+int registryRemove( MatrixRegistry *registry, int id );
+RegistryEntry* registryFindById( MatrixRegistry *registry, int id );
+RegistryEntry* registryFindByName( MatrixRegistry *registry, const char *name );
+RegistryEntry* registryFind( MatrixRegistry *registry, const char *idOrName );
+RegistryFilter registryAcceptAll( void );
+int registryMatches( const RegistryEntry *entry, const RegistryFilter *filter );
+int registryForEach( MatrixRegistry *registry, const RegistryFilter *filter, RegistryVisitor visitor, void *context );
+
+#endif //PROJEKT2_MATRIXREGISTRY_H
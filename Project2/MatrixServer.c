@@ -0,0 +1,1015 @@
+/*
+ * File: MatrixServer.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Server sharing one registry of matrices and cache of results between processes of the same machine.
+ *              Clients connect to Unix domain socket and send binary requests (see MatrixServer.h): load matrix,
+ *              compute operation, fetch matrix. Big matrices are passed in memfd, so they are mapped instead of
+ *              being copied through socket.
+ *
+ * Server is single-threaded loop: it waits until some clients send complete requests, then executes requests of all
+ * of them at once - loads first, then operations, then fetches. Operations which aren't cached are computed in one
+ * parallelForDynamic call, each in one thread (requests sent while previous batch was computed form the next one), so
+ * many clients sending requests keep all processors busy instead of waiting one for another. Every client has at
+ * most one request executed in one batch, so requests of one client are executed in order. Responses are sent
+ * without blocking - the rest of response is sent when socket becomes writable, and client which stops reading is
+ * disconnected after SERVER_SEND_TIMEOUT seconds. On SIGINT or SIGTERM server finishes current batch, saves all
+ * matrices to state directory and exits; matrices saved there are loaded (mapped) on the next start.
+ */
+
+#define _GNU_SOURCE                             // memfd_create, ppoll and SCM_RIGHTS
+
+#include "MatrixServer.h"
+#include "MatrixFile.h"
+#include "BigMatrix.h"
+#include "SmallMatrix.h"
+#include "Parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/************************************
+ * Macros definitions
+ ************************************/
+// Seals which memfd of request SERVER_LOAD must have - matrix is mapped from it, so client mustn't be able to change
+// it after it was stored (results cached for it would become stale) or to truncate it (access to mapped elements
+// beyond the end of file would kill server with SIGBUS)
+#define SERVER_REQUIRED_SEALS   ( F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE )
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Connected client, its request being received and response to it
+struct ServerClient {
+    int socket;                                 // Descriptor of connection (-1 - slot is free)
+    ServerRequest request;
+    size_t received;                            // Bytes of request and payload received so far
+    char *payload;                              // Inline payload of request (NULL if there is none)
+    int sharedFile;                             // memfd received with request (-1 if there is none)
+    int ready;                                  // Request is complete and waits for execution
+    ServerResponse response;
+    char *output;                               // Response followed by inline payload (NULL - only field "response")
+    size_t outputLength, outputSent;            // Bytes of response (with inline payload) to send and sent so far
+    int outputFile;                             // memfd passed with first byte of response (-1 if none or passed)
+    int sending;                                // Response is being sent - next request isn't received until then
+    time_t lastProgress;                        // Monotonic time (in seconds) when part of response was last sent
+    Matrix *operands[2];                        // Operands of SERVER_OP...
+    Matrix *result;                             // ...and its matrix result (NULL for determinant or on error)
+    CacheKey key;                               // Key of result in cache
+};
+typedef struct ServerClient ServerClient;
+
+// State of running server
+struct MatrixServer {
+    int listener;                               // Descriptor of listening socket
+    ServerClient clients[SERVER_MAX_CLIENTS];
+    MatrixRegistry *registry;
+    ResultCache *cache;
+    ServerClient *batch[SERVER_MAX_CLIENTS];    // Clients whose operations are computed in current batch
+    int batchCount;
+};
+typedef struct MatrixServer MatrixServer;
+
+// State of saving registry by _saveEntry
+struct StateWriter {
+    const char *directory;
+    FILE *index;
+    int errorCode;
+};
+typedef struct StateWriter StateWriter;
+
+/************************************
+ * Global variables
+ ************************************/
+static volatile sig_atomic_t _stopRequested;    // Set by SIGINT and SIGTERM
+
+/*
+ * Function <private>:  _requestStop
+ * --------------------
+ *      handler of SIGINT and SIGTERM - server stops after current batch
+ *
+ */
+static void _requestStop( int signalNumber )
+{
+    ( void )signalNumber;
+    _stopRequested = 1;
+}
+
+/*
+ * Function <private>:  _statePath
+ * --------------------
+ *      returns newly allocated path of file in state directory: directory/name extension (NULL on out of memory)
+ *
+ */
+static char* _statePath( const char *directory, const char *name, const char *extension )
+{
+    char *path = malloc( strlen( directory ) + strlen( name ) + strlen( extension ) + 2 );
+    if( path != NULL )
+        sprintf( path, "%s/%s%s", directory, name, extension );
+    return path;
+}
+
+/*
+ * Function <private>:  _loadState
+ * --------------------
+ *      adds to registry all matrices listed in index of state directory; missing index means empty state
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if some matrix can't be loaded
+ *
+ */
+static int _loadState( MatrixRegistry *registry, const char *directory )
+{
+    char name[MAX_MATRIX_NAME_LENGTH + 2];          // Name, new line and NULL
+    Matrix *matrix;
+    int errorCode = 0, id;
+
+    char *indexPath = _statePath( directory, SERVER_STATE_INDEX, "" );
+    if( indexPath == NULL )
+        return -1;
+    FILE *index = fopen( indexPath, "r" );
+    free( indexPath );
+    if( index == NULL )
+        return errno == ENOENT ? 0 : -2;
+
+    while( errorCode == 0 && fgets( name, sizeof( name ), index ) != NULL )
+    {
+        name[strcspn( name, "\n" )] = 0;
+        if( !isValidMatrixName( name ) || registryFindByName( registry, name ) != NULL )
+        {
+            errorCode = -2;
+            break;
+        }
+
+        char *path = _statePath( directory, name, SERVER_STATE_EXTENSION );
+        if( path == NULL )
+            errorCode = -1;
+        else if( loadMatrixFromFile( path, &matrix ) != 0 )
+            errorCode = -2;
+        else if( ( errorCode = registryAdd( registry, name, matrix, NULL, &id ) ) != 0 )
+            deleteSquareMatrix( matrix );
+        free( path );
+    }
+    fclose( index );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _saveEntry
+ * --------------------
+ *      saves matrix to state directory and adds its name to index (visitor of registryForEach)
+ *
+ */
+static void _saveEntry( RegistryEntry *entry, void *context )
+{
+    StateWriter *writer = context;
+
+    if( writer->errorCode != 0 || entry->dense == NULL || entry->name[0] == 0 )    // Server stores only named dense
+        return;
+    char *path = _statePath( writer->directory, entry->name, SERVER_STATE_EXTENSION );
+    if( path == NULL )
+        writer->errorCode = -1;
+    else if( ( writer->errorCode = saveMatrixToFile( entry->dense, path ) ) == 0 )
+        fprintf( writer->index, "%s\n", entry->name );
+    free( path );
+}
+
+/*
+ * Function <private>:  _saveState
+ * --------------------
+ *      saves all matrices of registry to state directory; index is replaced atomically after all matrices were
+ *      saved, so interrupted saving never leaves index listing missing files
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on I/O error
+ *
+ */
+static int _saveState( MatrixRegistry *registry, const char *directory )
+{
+    const RegistryFilter filter = registryAcceptAll();
+    StateWriter writer = { directory, NULL, 0 };
+
+    char *indexPath = _statePath( directory, SERVER_STATE_INDEX, "" );
+    char *temporaryPath = _statePath( directory, SERVER_STATE_INDEX, ".tmp" );
+    if( indexPath == NULL || temporaryPath == NULL )
+        writer.errorCode = -1;
+    else if( ( writer.index = fopen( temporaryPath, "w" ) ) == NULL )
+        writer.errorCode = -2;
+    else
+    {
+        registryForEach( registry, &filter, _saveEntry, &writer );
+        if( fclose( writer.index ) != 0 && writer.errorCode == 0 )
+            writer.errorCode = -2;
+        if( writer.errorCode == 0 && rename( temporaryPath, indexPath ) != 0 )
+            writer.errorCode = -2;
+        if( writer.errorCode != 0 )
+            unlink( temporaryPath );
+    }
+
+    free( indexPath );
+    free( temporaryPath );
+    return writer.errorCode;
+}
+
+/*
+ * Function <private>:  _openListener
+ * --------------------
+ *      creates non-blocking socket listening at given path; stale socket left by server which didn't exit cleanly
+ *      is removed, but socket of running server isn't
+ *
+ *      returns: descriptor of socket, -1 on error
+ *
+ */
+static int _openListener( const char *path )
+{
+    struct sockaddr_un address;
+
+    memset( &address, 0, sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    if( strlen( path ) >= sizeof( address.sun_path ) )
+        return -1;
+    strcpy( address.sun_path, path );
+
+    int listener = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if( listener < 0 )
+        return -1;
+    if( connect( listener, ( struct sockaddr* )&address, sizeof( address ) ) == 0 )    // Another server is running
+    {
+        close( listener );
+        return -1;
+    }
+    close( listener );
+    unlink( path );
+
+    listener = socket( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+    if( listener < 0 )
+        return -1;
+    if( bind( listener, ( struct sockaddr* )&address, sizeof( address ) ) != 0 || listen( listener, SOMAXCONN ) != 0 )
+    {
+        close( listener );
+        return -1;
+    }
+    return listener;
+}
+
+/*
+ * Function <private>:  _resetRequest
+ * --------------------
+ *      frees request of client and response sent to it, so next request can be received
+ *
+ */
+static void _resetRequest( ServerClient *client )
+{
+    free( client->payload );
+    free( client->output );
+    if( client->sharedFile != -1 )
+        close( client->sharedFile );
+    if( client->outputFile != -1 )
+        close( client->outputFile );
+    client->payload = client->output = NULL;
+    client->sharedFile = client->outputFile = -1;
+    client->received = 0;
+    client->ready = 0;
+    client->sending = 0;
+    client->result = NULL;
+    memset( &client->response, 0, sizeof( client->response ) );
+    client->response.magic = SERVER_MAGIC;
+}
+
+/*
+ * Function <private>:  _closeClient
+ * --------------------
+ *      closes connection and frees its slot
+ *
+ */
+static void _closeClient( ServerClient *client )
+{
+    _resetRequest( client );
+    close( client->socket );
+    client->socket = -1;
+}
+
+/*
+ * Function <private>:  _acceptClients
+ * --------------------
+ *      accepts all waiting connections; connections over SERVER_MAX_CLIENTS are closed at once
+ *
+ */
+static void _acceptClients( MatrixServer *server )
+{
+    int socket;
+
+    while( ( socket = accept4( server->listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC ) ) >= 0 )
+    {
+        int slot = 0;
+        while( slot < SERVER_MAX_CLIENTS && server->clients[slot].socket != -1 )
+            slot++;
+        if( slot == SERVER_MAX_CLIENTS )
+        {
+            close( socket );
+            continue;
+        }
+        server->clients[slot].socket = socket;
+        _resetRequest( &server->clients[slot] );
+    }
+}
+
+/*
+ * Function <private>:  _receiveRequest
+ * --------------------
+ *      reads available part of request of client (without blocking); descriptor passed with request is kept in
+ *      field "sharedFile"
+ *
+ *      returns: 0 if connection is still usable (request may be still incomplete), -1 if it was closed by client
+ *               or client broke protocol
+ *
+ */
+static int _receiveRequest( ServerClient *client )
+{
+    char control[CMSG_SPACE( sizeof( int ) )];
+
+    while( !client->ready )
+    {
+        const int header = client->received < sizeof( ServerRequest );
+        struct iovec buffer;
+        struct msghdr message;
+        ssize_t length;
+
+        if( header )
+        {
+            buffer.iov_base = ( char* )&client->request + client->received;
+            buffer.iov_len = sizeof( ServerRequest ) - client->received;
+        } else
+        {
+            buffer.iov_base = client->payload + ( client->received - sizeof( ServerRequest ) );
+            buffer.iov_len = sizeof( ServerRequest ) + client->request.payloadLength - client->received;
+        }
+        memset( &message, 0, sizeof( message ) );
+        message.msg_iov = &buffer;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof( control );
+
+        length = recvmsg( client->socket, &message, MSG_CMSG_CLOEXEC );
+        if( length < 0 )
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+        if( length == 0 )
+            return -1;
+
+        for( struct cmsghdr *part = CMSG_FIRSTHDR( &message ); part != NULL; part = CMSG_NXTHDR( &message, part ) )
+            if( part->cmsg_level == SOL_SOCKET && part->cmsg_type == SCM_RIGHTS )
+            {
+                int file;
+                memcpy( &file, CMSG_DATA( part ), sizeof( file ) );
+                if( client->sharedFile != -1 )                  // Only one descriptor is accepted per request
+                    close( file );
+                else
+                    client->sharedFile = file;
+            }
+        if( message.msg_flags & MSG_CTRUNC )
+            return -1;
+        client->received += ( size_t )length;
+
+        if( header && client->received == sizeof( ServerRequest ) )
+        {
+            if( client->request.magic != SERVER_MAGIC || client->request.payloadLength > SERVER_INLINE_LIMIT )
+                return -1;                                      // Rest of stream can't be interpreted
+            if( client->request.payloadLength > 0
+                && ( client->payload = malloc( client->request.payloadLength ) ) == NULL )
+                return -1;
+        }
+        if( client->received == sizeof( ServerRequest ) + client->request.payloadLength )
+            client->ready = 1;
+    }
+    return 0;
+}
+
+/*
+ * Function <private>:  _monotonicSeconds
+ * --------------------
+ *      returns seconds of monotonic clock (used to find clients which stopped reading responses)
+ *
+ */
+static time_t _monotonicSeconds( void )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec;
+}
+
+/*
+ * Function <private>:  _flushResponse
+ * --------------------
+ *      sends as much of pending response as socket accepts without blocking; descriptor (if any) is passed with
+ *      the first byte. When whole response was sent, request is reset, so next one can be received
+ *
+ *      returns: 0 if connection is still usable (response may be still incomplete), -1 if it is broken
+ *
+ */
+static int _flushResponse( ServerClient *client )
+{
+    const char *data = client->output != NULL ? client->output : ( const char* )&client->response;
+    char control[CMSG_SPACE( sizeof( int ) )];
+
+    while( client->outputSent < client->outputLength )
+    {
+        struct iovec buffer = { ( void* )( data + client->outputSent ), client->outputLength - client->outputSent };
+        struct msghdr message;
+
+        memset( &message, 0, sizeof( message ) );
+        message.msg_iov = &buffer;
+        message.msg_iovlen = 1;
+        if( client->outputFile != -1 )
+        {
+            memset( control, 0, sizeof( control ) );
+            message.msg_control = control;
+            message.msg_controllen = sizeof( control );
+            struct cmsghdr *part = CMSG_FIRSTHDR( &message );
+            part->cmsg_level = SOL_SOCKET;
+            part->cmsg_type = SCM_RIGHTS;
+            part->cmsg_len = CMSG_LEN( sizeof( int ) );
+            memcpy( CMSG_DATA( part ), &client->outputFile, sizeof( int ) );
+        }
+
+        const ssize_t sent = sendmsg( client->socket, &message, MSG_NOSIGNAL | MSG_DONTWAIT );
+        if( sent < 0 )
+        {
+            if( errno == EAGAIN || errno == EWOULDBLOCK )
+                return 0;                                       // Rest is sent when socket becomes writable
+            if( errno != EINTR )
+                return -1;
+            continue;
+        }
+        client->outputSent += ( size_t )sent;
+        client->lastProgress = _monotonicSeconds();
+        if( client->outputFile != -1 )                          // Client has its own descriptor now
+        {
+            close( client->outputFile );
+            client->outputFile = -1;
+        }
+    }
+    _resetRequest( client );
+    return 0;
+}
+
+/*
+ * Function <private>:  _sendResponse
+ * --------------------
+ *      starts sending response of client; whatever socket doesn't accept at once is sent by _serve when socket
+ *      becomes writable, so one client which doesn't read responses can't stall the others. Connection is closed
+ *      if it fails
+ *
+ *      output:     NULL if response has no inline payload, otherwise buffer of sizeof( ServerResponse ) bytes
+ *                  followed by payload (response is copied to its beginning); buffer is freed by client
+ *      sharedFile: memfd passed with response (-1 if none); it's closed by client
+ *
+ */
+static void _sendResponse( ServerClient *client, char *output, int sharedFile )
+{
+    client->output = output;
+    client->outputFile = sharedFile;
+    client->outputLength = sizeof( ServerResponse ) + ( output != NULL ? client->response.payloadLength : 0 );
+    client->outputSent = 0;
+    client->lastProgress = _monotonicSeconds();
+    client->ready = 0;
+    client->sending = 1;
+    if( output != NULL )
+        memcpy( output, &client->response, sizeof( ServerResponse ) );
+    if( _flushResponse( client ) != 0 )
+        _closeClient( client );
+}
+
+/*
+ * Function <private>:  _storeResult
+ * --------------------
+ *      stores matrix in registry under given name (existing matrix is replaced) and fills response with its id;
+ *      matrix is deleted on error
+ *
+ */
+static void _storeResult( MatrixServer *server, ServerClient *client, const char *name, Matrix *matrix )
+{
+    RegistryEntry *entry = registryFindByName( server->registry, name );
+    int errorCode = 0, id;
+
+    if( entry != NULL )
+    {
+        registryReplace( server->registry, entry, matrix, NULL );
+        id = entry->id;
+    } else if( ( errorCode = registryAdd( server->registry, name, matrix, NULL, &id ) ) != 0 )
+    {
+        deleteSquareMatrix( matrix );
+        client->response.status = errorCode == -1 ? SERVER_NO_MEMORY : SERVER_BAD_REQUEST;
+        return;
+    }
+    client->response.id = id;
+    client->response.size = matrix->size;
+}
+
+/*
+ * Function <private>:  _hasValidName
+ * --------------------
+ *      returns non-zero if name received from client is terminated and valid
+ *
+ */
+static int _hasValidName( const char *name )
+{
+    return memchr( name, 0, MAX_MATRIX_NAME_LENGTH ) != NULL && isValidMatrixName( name );
+}
+
+/*
+ * Function <private>:  _findDense
+ * --------------------
+ *      finds dense matrix with name received from client
+ *
+ *      returns: SERVER_OK or SERVER_NOT_FOUND
+ *
+ */
+static int _findDense( MatrixServer *server, const char *name, Matrix **matrix )
+{
+    if( !_hasValidName( name ) )
+        return SERVER_NOT_FOUND;
+    RegistryEntry *entry = registryFindByName( server->registry, name );
+    if( entry == NULL || entry->dense == NULL )
+        return SERVER_NOT_FOUND;
+    *matrix = entry->dense;
+    return SERVER_OK;
+}
+
+/*
+ * Function <private>:  _hasRequiredSeals
+ * --------------------
+ *      returns non-zero if file is memfd sealed with all SERVER_REQUIRED_SEALS (so its content can't change any more)
+ *
+ */
+static int _hasRequiredSeals( int file )
+{
+    const int seals = fcntl( file, F_GET_SEALS );           // Fails for files which can't be sealed
+    return seals != -1 && ( seals & SERVER_REQUIRED_SEALS ) == SERVER_REQUIRED_SEALS;
+}
+
+/*
+ * Function <private>:  _executeLoad
+ * --------------------
+ *      creates matrix from payload of request SERVER_LOAD (memfd is mapped, not copied) and stores it
+ *
+ */
+static void _executeLoad( MatrixServer *server, ServerClient *client )
+{
+    const ServerRequest *request = &client->request;
+    Matrix *matrix = NULL;
+    int errorCode;
+
+    if( !_hasValidName( request->name ) )
+    {
+        client->response.status = SERVER_BAD_REQUEST;
+        return;
+    }
+
+    if( request->flags & SERVER_PAYLOAD_SHARED )
+    {
+        errorCode = client->sharedFile == -1 || !_hasRequiredSeals( client->sharedFile )
+                    ? -3 : mapMatrixFromDescriptor( client->sharedFile, &matrix );
+        if( errorCode != 0 )
+        {
+            client->response.status = errorCode == -1 ? SERVER_NO_MEMORY : SERVER_BAD_REQUEST;
+            return;
+        }
+    } else
+    {
+        if( request->size <= 0
+            || request->payloadLength != sizeof( long ) * ( uint64_t )request->size * ( uint64_t )request->size )
+        {
+            client->response.status = SERVER_SIZE_MISMATCH;
+            return;
+        }
+        if( createSquareMatrix( request->size, &matrix ) != 0 )
+        {
+            client->response.status = SERVER_NO_MEMORY;
+            return;
+        }
+        for( int row = 0; row < matrix->size; row++ )
+            memcpy( matrix->elements[row], client->payload + sizeof( long ) * ( size_t )matrix->size * row,
+                    sizeof( long ) * matrix->size );
+        markMatrixModified( matrix );
+    }
+    _storeResult( server, client, request->name, matrix );
+}
+
+/*
+ * Function <private>:  _prepareOperation
+ * --------------------
+ *      validates request SERVER_OP and finds its operands; if result isn't cached, client is added to batch
+ *
+ */
+static void _prepareOperation( MatrixServer *server, ServerClient *client )
+{
+    const ServerRequest *request = &client->request;
+    const int operation = ( int )request->operation;
+    int status;
+
+    if( operation < SERVER_ADD || operation > SERVER_POWER
+        || ( operation != SERVER_DET && !_hasValidName( request->name ) )
+        || ( operation == SERVER_POWER && request->argument < 0 ) )
+    {
+        client->response.status = SERVER_BAD_REQUEST;
+        return;
+    }
+    status = _findDense( server, request->operands[0], &client->operands[0] );
+    if( status == SERVER_OK && operation <= SERVER_MUL )
+        status = _findDense( server, request->operands[1], &client->operands[1] );
+    if( status != SERVER_OK )
+    {
+        client->response.status = status;
+        return;
+    }
+
+    if( operation == SERVER_DET )
+    {
+        long determinant;
+        client->key = makeCacheKey( CACHED_DETERMINANT, client->operands[0], NULL, 0, 0 );
+        if( cacheLookupScalar( server->cache, client->key, &determinant ) )
+        {
+            client->response.scalar = determinant;
+            return;
+        }
+    } else
+    {
+        const int cached[] = { CACHED_SUM, CACHED_SUB, CACHED_MULTIPLY, CACHED_DETERMINANT, CACHED_POWER };
+        client->key = makeCacheKey( cached[operation], client->operands[0],
+                                    operation <= SERVER_MUL ? client->operands[1] : NULL,
+                                    operation == SERVER_POWER ? request->argument : 0, 0 );
+        if( cacheLookupMatrix( server->cache, client->key, &client->result ) )
+            return;
+    }
+    server->batch[server->batchCount++] = client;
+}
+
+/*
+ * Function <private>:  _exactDeterminant
+ * --------------------
+ *      calculates determinant with fraction-free Bareiss algorithm on integers of arbitrary size (Laplace expansion
+ *      of detSquareMatrix is factorial in size, so one big determinant would stall the whole batch)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if determinant doesn't fit in long integer
+ *
+ */
+static int _exactDeterminant( Matrix *matrix, long *result )
+{
+    BigMatrix *bigMatrix;
+    BigInteger determinant;
+    LimbArena arena;
+    int errorCode = bigMatrixFromMatrix( matrix, &bigMatrix );
+
+    if( errorCode != 0 )
+        return errorCode;
+    initLimbArena( &arena );
+    errorCode = detBigMatrix( bigMatrix, &determinant, &arena );
+    if( errorCode == 0 )
+        errorCode = bigIntegerToLong( &determinant, result );
+    freeLimbArena( &arena );
+    deleteBigMatrix( bigMatrix );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _computeOperation
+ * --------------------
+ *      computes operation of client; response status is set to error code of operation
+ *
+ */
+static void _computeOperation( ServerClient *client )
+{
+    Matrix **operands = client->operands;
+    long determinant;
+    int errorCode;
+
+    switch( client->request.operation )
+    {
+        case SERVER_ADD:
+            errorCode = sumSquareMatrix( operands[0], operands[1], &client->result );
+            break;
+        case SERVER_SUB:
+            errorCode = subSquareMatrix( operands[0], operands[1], &client->result );
+            break;
+        case SERVER_MUL:
+            errorCode = multiplySquareMatrix( operands[0], operands[1], &client->result );
+            break;
+        case SERVER_DET:
+            if( hasSmallMatrixKernels( operands[0]->size ) )
+                errorCode = detSquareMatrix( operands[0], &determinant );
+            else
+                errorCode = _exactDeterminant( operands[0], &determinant );
+            if( errorCode == 0 )
+                client->response.scalar = determinant;
+            else if( errorCode == -2 )                          // Determinant reports overflow as -2
+                errorCode = SERVER_OVERFLOW;
+            break;
+        default:
+            errorCode = powerSquareMatrix( operands[0], ( unsigned long )client->request.argument, &client->result );
+            if( errorCode != 0 && errorCode != -1 )
+                errorCode = SERVER_OVERFLOW;
+    }
+    if( errorCode != 0 )
+        client->result = NULL;
+    client->response.status = errorCode;
+}
+
+/*
+ * Function <private>:  _computeBatchItem
+ * --------------------
+ *      computes one operation of batch (body of parallelForDynamic)
+ *
+ */
+static void _computeBatchItem( long begin, long end, int worker, void *context )
+{
+    MatrixServer *server = context;
+    ( void )end;
+    ( void )worker;
+    _computeOperation( server->batch[begin] );
+}
+
+/*
+ * Function <private>:  _compareOperandSizes
+ * --------------------
+ *      orders clients of batch from the biggest first operand (for qsort)
+ *
+ */
+static int _compareOperandSizes( const void *a, const void *b )
+{
+    const int first = ( *( ServerClient* const* )a )->operands[0]->size;
+    const int second = ( *( ServerClient* const* )b )->operands[0]->size;
+
+    return first == second ? 0 : ( first > second ? -1 : 1 );
+}
+
+/*
+ * Function <private>:  _computeBatch
+ * --------------------
+ *      computes all operations of batch concurrently, each in one thread; the biggest ones are started first, so
+ *      the small ones fill remaining threads instead of leaving one long operation at the end
+ *
+ */
+static void _computeBatch( MatrixServer *server )
+{
+    if( server->batchCount == 0 )
+        return;
+    qsort( server->batch, ( size_t )server->batchCount, sizeof( ServerClient* ), _compareOperandSizes );
+    parallelForDynamic( server->batchCount, _computeBatchItem, server );
+}
+
+/*
+ * Function <private>:  _finishOperation
+ * --------------------
+ *      caches result of computed operation and stores its matrix result in registry
+ *
+ */
+static void _finishOperation( MatrixServer *server, ServerClient *client, int computed )
+{
+    if( client->response.status != SERVER_OK )
+        return;
+    if( client->request.operation == SERVER_DET )
+    {
+        if( computed )
+            cacheStoreScalar( server->cache, client->key, client->response.scalar );
+        return;
+    }
+    if( computed )
+        cacheStoreMatrix( server->cache, client->key, client->result );
+    _storeResult( server, client, client->request.name, client->result );
+    client->result = NULL;                                      // Owned by registry now
+}
+
+/*
+ * Function <private>:  _executeFetch
+ * --------------------
+ *      sends matrix requested with SERVER_FETCH - inline (row after row) or as binary matrix file in memfd
+ *
+ */
+static void _executeFetch( MatrixServer *server, ServerClient *client )
+{
+    RegistryEntry *entry = NULL;
+    Matrix *matrix;
+    char *output = NULL;
+    int sharedFile = -1;
+
+    client->response.status = _findDense( server, client->request.name, &matrix );
+    if( client->response.status == SERVER_OK )
+    {
+        entry = registryFindByName( server->registry, client->request.name );
+        const size_t length = sizeof( long ) * ( size_t )matrix->size * ( size_t )matrix->size;
+        client->response.id = entry->id;
+        client->response.size = matrix->size;
+
+        if( ( client->request.flags & SERVER_PAYLOAD_SHARED ) || length > SERVER_INLINE_LIMIT )
+        {
+            sharedFile = memfd_create( "matrix", MFD_CLOEXEC | MFD_ALLOW_SEALING );
+            if( sharedFile < 0 || writeMatrixToDescriptor( matrix, sharedFile ) != 0
+                || fcntl( sharedFile, F_ADD_SEALS, SERVER_REQUIRED_SEALS | F_SEAL_SEAL ) != 0 )
+                client->response.status = SERVER_NO_MEMORY;
+            else
+                client->response.flags = SERVER_PAYLOAD_SHARED;
+        } else if( ( output = malloc( sizeof( ServerResponse ) + length ) ) == NULL )
+            client->response.status = SERVER_NO_MEMORY;
+        else
+        {
+            char *payload = output + sizeof( ServerResponse );      // Response is copied before payload
+            for( int row = 0; row < matrix->size; row++ )
+                memcpy( payload + sizeof( long ) * ( size_t )matrix->size * row, matrix->elements[row],
+                        sizeof( long ) * matrix->size );
+            client->response.payloadLength = length;
+        }
+    }
+
+    if( client->response.status != SERVER_OK )
+    {
+        client->response.flags = 0;
+        client->response.payloadLength = 0;
+        free( output );
+        output = NULL;
+        if( sharedFile >= 0 )
+            close( sharedFile );
+        sharedFile = -1;
+    }
+    _sendResponse( client, output, sharedFile );
+}
+
+/*
+ * Function <private>:  _executeRequests
+ * --------------------
+ *      executes all complete requests: loads, then operations (uncached ones computed as one batch), then fetches;
+ *      sending of responses starts after all requests were executed
+ *
+ */
+static void _executeRequests( MatrixServer *server )
+{
+    ServerClient *clients = server->clients;
+
+    for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+        if( clients[slot].ready && clients[slot].request.opcode == SERVER_LOAD )
+            _executeLoad( server, &clients[slot] );
+
+    server->batchCount = 0;
+    for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+        if( clients[slot].ready && clients[slot].request.opcode == SERVER_OP )
+            _prepareOperation( server, &clients[slot] );
+    _computeBatch( server );
+    for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+        if( clients[slot].ready && clients[slot].request.opcode == SERVER_OP )
+        {
+            int computed = 0;
+            for( int item = 0; item < server->batchCount && !computed; item++ )
+                computed = server->batch[item] == &clients[slot];
+            _finishOperation( server, &clients[slot], computed );
+        }
+
+    for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+        if( clients[slot].ready )
+        {
+            if( clients[slot].request.opcode == SERVER_FETCH )
+                _executeFetch( server, &clients[slot] );
+            else
+            {
+                if( clients[slot].request.opcode != SERVER_LOAD && clients[slot].request.opcode != SERVER_OP )
+                    clients[slot].response.status = SERVER_BAD_REQUEST;
+                _sendResponse( &clients[slot], NULL, -1 );
+            }
+        }
+}
+
+/*
+ * Function <private>:  _serve
+ * --------------------
+ *      main loop of server - receives requests and executes them in batches until stop is requested
+ *
+ *      waitMask: signal mask used while waiting (SIGINT and SIGTERM unblocked)
+ *
+ */
+static void _serve( MatrixServer *server, const sigset_t *waitMask )
+{
+    const struct timespec checkInterval = { 1, 0 };            // How often clients which don't read are checked
+    struct pollfd descriptors[SERVER_MAX_CLIENTS + 1];
+    int slots[SERVER_MAX_CLIENTS + 1];
+
+    while( !_stopRequested )
+    {
+        nfds_t count = 1;
+        int sending = 0;
+        descriptors[0].fd = server->listener;
+        descriptors[0].events = POLLIN;
+        for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+            if( server->clients[slot].socket != -1 )
+            {
+                descriptors[count].fd = server->clients[slot].socket;
+                descriptors[count].events = server->clients[slot].sending ? POLLOUT : POLLIN;
+                sending |= server->clients[slot].sending;
+                slots[count++] = slot;
+            }
+
+        // Signals are delivered only while waiting, so stop request can't be missed between check and wait
+        if( ppoll( descriptors, count, sending ? &checkInterval : NULL, waitMask ) < 0 )
+            continue;
+
+        int ready = 0;
+        const time_t now = _monotonicSeconds();
+        for( nfds_t descriptor = 1; descriptor < count; descriptor++ )
+        {
+            ServerClient *client = &server->clients[slots[descriptor]];
+            if( client->sending )
+            {
+                if( ( descriptors[descriptor].revents != 0 && _flushResponse( client ) != 0 )
+                    || ( client->sending && now - client->lastProgress >= SERVER_SEND_TIMEOUT ) )
+                    _closeClient( client );                     // Broken connection or client stopped reading
+            } else if( descriptors[descriptor].revents != 0 && _receiveRequest( client ) != 0 )
+                _closeClient( client );
+            else
+                ready |= client->ready;
+        }
+        if( descriptors[0].revents & POLLIN )
+            _acceptClients( server );
+        if( ready )
+            _executeRequests( server );
+    }
+}
+
+/*
+ * Function:  runMatrixServer
+ * --------------------
+ *      serves requests of clients connecting to Unix domain socket (see MatrixServer.h) until SIGINT or SIGTERM
+ *      is received. Matrices persisted in state directory are loaded at start and all matrices are saved there
+ *      at exit
+ *
+ *      socketPath:     path of socket (stale socket is replaced, socket is removed at exit)
+ *      stateDirectory: existing directory with persisted matrices (NULL - matrices aren't persisted)
+ *      registry:       registry of matrices shared by clients
+ *      cache:          cache of results shared by clients
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if socket can't be created (or another server uses it),
+ *               -3 if state can't be loaded or saved
+ *
+ */
+int runMatrixServer( const char *socketPath, const char *stateDirectory, MatrixRegistry *registry,
+                     ResultCache *cache )
+{
+    struct sigaction action, oldInterrupt, oldTerminate;
+    sigset_t blocked, oldMask;
+    int errorCode;
+
+    if( stateDirectory != NULL && ( errorCode = _loadState( registry, stateDirectory ) ) != 0 )
+        return errorCode == -1 ? -1 : -3;
+
+    MatrixServer *server = calloc( 1, sizeof( MatrixServer ) );
+    if( server == NULL )
+        return -1;
+    server->registry = registry;
+    server->cache = cache;
+    for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+    {
+        server->clients[slot].socket = -1;
+        server->clients[slot].sharedFile = -1;
+        server->clients[slot].outputFile = -1;
+    }
+    if( ( server->listener = _openListener( socketPath ) ) < 0 )
+    {
+        free( server );
+        return -2;
+    }
+
+    // Block stop signals outside of ppoll, so they can interrupt only waiting
+    sigemptyset( &blocked );
+    sigaddset( &blocked, SIGINT );
+    sigaddset( &blocked, SIGTERM );
+    sigprocmask( SIG_BLOCK, &blocked, &oldMask );
+    memset( &action, 0, sizeof( action ) );
+    action.sa_handler = _requestStop;
+    sigemptyset( &action.sa_mask );
+    sigaction( SIGINT, &action, &oldInterrupt );
+    sigaction( SIGTERM, &action, &oldTerminate );
+    _stopRequested = 0;
+
+    sigset_t waitMask = oldMask;
+    sigdelset( &waitMask, SIGINT );
+    sigdelset( &waitMask, SIGTERM );
+    _serve( server, &waitMask );
+
+    for( int slot = 0; slot < SERVER_MAX_CLIENTS; slot++ )
+        if( server->clients[slot].socket != -1 )
+            _closeClient( &server->clients[slot] );
+    close( server->listener );
+    unlink( socketPath );
+    free( server );
+
+    sigaction( SIGINT, &oldInterrupt, NULL );
+    sigaction( SIGTERM, &oldTerminate, NULL );
+    sigprocmask( SIG_SETMASK, &oldMask, NULL );
+
+    if( stateDirectory != NULL && ( errorCode = _saveState( registry, stateDirectory ) ) != 0 )
+        return errorCode == -1 ? -1 : -3;
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * File: MatrixServer.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file MatrixServer.c
+ */
+
+#ifndef PROJEKT2_MATRIXSERVER_H
+#define PROJEKT2_MATRIXSERVER_H
+
+#include <stdint.h>
+#include "MatrixRegistry.h"
+#include "ResultCache.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define SERVER_MAGIC            0x50524953      // First field of every request and response ("PRIS")
+#define SERVER_MAX_CLIENTS      64              // Maximal number of connected clients
+#define SERVER_INLINE_LIMIT     ( 1024 * 1024 ) // Maximal payload (in bytes) sent through socket - bigger goes in memfd
+#define SERVER_SEND_TIMEOUT     10              // Client which doesn't read its response for so many seconds is dropped
+#define SERVER_STATE_INDEX      "registry.txt"  // Names of persisted matrices (one per line) in state directory
+#define SERVER_STATE_EXTENSION  ".mat"          // Matrix NAME is persisted in binary matrix file NAME.mat
+
+// Flags of requests and responses
+#define SERVER_PAYLOAD_SHARED   1               // Payload is binary matrix file in memfd passed with message
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Requests served by server
+enum ServerOpcode {
+    SERVER_LOAD = 1,        // Stores matrix from payload under "name"
+    SERVER_OP,              // Computes "operation" on matrices "operands", matrix results are stored under "name"
+    SERVER_FETCH            // Returns matrix "name" as payload
+};
+
+// Operations of request SERVER_OP
+enum ServerOperation {
+    SERVER_ADD, SERVER_SUB, SERVER_MUL,     // Two operands
+    SERVER_DET,                             // One operand, result is returned in field "scalar"
+    SERVER_POWER                            // One operand raised to power "argument"
+};
+
+// Statuses of responses - error codes of operations or errors of server
+enum ServerStatus {
+    SERVER_OK = 0,
+    SERVER_NO_MEMORY = -1,
+    SERVER_SIZE_MISMATCH = -2,              // Invalid size or operands of different sizes
+    SERVER_OVERFLOW = -3,                   // Result doesn't fit in long integer
+    SERVER_BAD_REQUEST = -5,                // Malformed request, invalid name or payload
+    SERVER_NOT_FOUND = -6                   // Operand doesn't exist (or isn't dense matrix)
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Request sent by client; it is followed by "payloadLength" bytes of payload: SERVER_LOAD without flag
+// SERVER_PAYLOAD_SHARED carries size * size elements (long) row after row, with the flag payload is empty and
+// memfd containing binary matrix file (see MatrixFile.h) is passed as SCM_RIGHTS of the same message. Server maps
+// memfd instead of copying it, so it must be created with MFD_ALLOW_SEALING and sealed (fcntl F_ADD_SEALS, after
+// writable mappings of it were unmapped) with F_SEAL_SHRINK, F_SEAL_GROW and F_SEAL_WRITE - otherwise request fails
+// with SERVER_BAD_REQUEST. All fields are in native byte order (peers are on the same machine); strings are
+// terminated with NULL
+struct ServerRequest {
+    uint32_t magic;                             // SERVER_MAGIC
+    uint32_t opcode;                            // One of ServerOpcode values
+    uint32_t operation;                         // One of ServerOperation values (SERVER_OP)
+    uint32_t flags;                             // SERVER_PAYLOAD_SHARED: send (SERVER_LOAD) or receive (SERVER_FETCH)
+    int32_t size;                               // Size of matrix (SERVER_LOAD)
+    int32_t reserved;                           // Zero
+    int64_t argument;                           // Exponent (SERVER_POWER)
+    uint64_t payloadLength;                     // Number of bytes following request
+    char name[MAX_MATRIX_NAME_LENGTH];          // Stored or fetched matrix
+    char operands[2][MAX_MATRIX_NAME_LENGTH];   // Names of operands (SERVER_OP)
+};
+typedef struct ServerRequest ServerRequest;
+
+// Response sent by server; payload of SERVER_FETCH is encoded in the same way as of SERVER_LOAD (memfd is used
+// if client asked for it or payload is longer than SERVER_INLINE_LIMIT, and it is sealed in the same way)
+struct ServerResponse {
+    uint32_t magic;                             // SERVER_MAGIC
+    int32_t status;                             // One of ServerStatus values
+    uint32_t flags;                             // SERVER_PAYLOAD_SHARED if memfd is passed with response
+    int32_t id;                                 // Id of stored or fetched matrix
+    int32_t size;                               // Size of stored or fetched matrix
+    int32_t reserved;                           // Zero
+    int64_t scalar;                             // Result of SERVER_DET
+    uint64_t payloadLength;                     // Number of bytes following response
+};
+typedef struct ServerResponse ServerResponse;
+
+/************************************
+ * Function declarations
+ ************************************/
+int runMatrixServer( const char *socketPath, const char *stateDirectory, MatrixRegistry *registry,
+                     ResultCache *cache );
+
+#endif //PROJEKT2_MATRIXSERVER_H
@@ -0,0 +1,895 @@
+/*
+ * File: ModularMatrix.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Row reduction of matrices over prime fields GF(p) - rank, reduced row echelon form, basis of null
+ *              space, solving of linear systems and characteristic polynomial. Rows of GF(p) matrices are updated
+ *              with Barrett reduction (multiplier's quotient is precomputed, so inner loop has only 32-bit
+ *              multiplications and vectorizes);
+ *              GF(2) matrices are packed 64 columns per word and reduced with Four Russians method
+ */
+
+#include "ModularMatrix.h"
+#include "MatrixGenerators.h"
+#include "Parallel.h"
+#include <stdlib.h>
+#include <string.h>
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Arguments shared by threads eliminating column of GF(p) matrix
+struct ModEliminationContext {
+    ModMatrix *matrix;
+    int pivotRow;                               // Row with 1 in pivot column
+    int col;                                    // Pivot column
+    int firstRow;                               // Rows <firstRow, rows) except pivot one are eliminated
+};
+typedef struct ModEliminationContext ModEliminationContext;
+
+// Arguments shared by threads eliminating group of pivot columns of GF(2) matrix
+struct BitEliminationContext {
+    BitMatrix *matrix;
+    const unsigned long *table;                 // Sums of all subsets of pivot rows of group (from startWord)
+    int startWord;                              // Words before it are 0 in all pivot rows of group
+    const int *pivotColumns;                    // Pivot columns of group
+    int pivots;                                 // Number of pivots in group
+    int groupRow;                               // First pivot row of group
+    int firstRow;                               // Rows <firstRow, rows) except pivot ones are eliminated
+};
+typedef struct BitEliminationContext BitEliminationContext;
+
+// Arguments shared by threads generating random GF(2) matrix
+struct RandomBitsContext {
+    BitMatrix *matrix;
+    unsigned long seed;
+};
+typedef struct RandomBitsContext RandomBitsContext;
+
+/************************************
+ * Arithmetic in GF(p)
+ ************************************/
+/*
+ * Function:  isValidModulus
+ * --------------------
+ *      checks if number is prime not greater than MODULAR_MAX_MODULUS (trial division)
+ *
+ *      returns: 1 if number can be used as modulus, 0 otherwise
+ *
+ */
+int isValidModulus( long modulus )
+{
+    if( modulus < 2 || modulus > MODULAR_MAX_MODULUS )
+        return 0;
+    for( long divisor = 2; divisor * divisor <= modulus; divisor++ )
+        if( modulus % divisor == 0 )
+            return 0;
+    return 1;
+}
+
+/*
+ * Function <private>:  _reduce
+ * --------------------
+ *      returns x mod p with Barrett reduction: quotient is estimated as high half of x * floor(2^64 / p), which is
+ *      less than true quotient at most by 2
+ *
+ */
+static unsigned int _reduce( const ModMatrix *matrix, unsigned long x )
+{
+    const unsigned long modulus = ( unsigned long )matrix->modulus;
+    const unsigned long quotient = ( unsigned long )( ( ( unsigned __int128 )x * matrix->barrett ) >> 64 );
+    unsigned long remainder = x - quotient * modulus;
+
+    while( remainder >= modulus )
+        remainder -= modulus;
+    return ( unsigned int )remainder;
+}
+
+/*
+ * Function <private>:  _reduceLong
+ * --------------------
+ *      returns residue of (also negative) long integer
+ *
+ */
+static unsigned int _reduceLong( const ModMatrix *matrix, long value )
+{
+    const unsigned int residue = _reduce( matrix, value < 0 ? -( unsigned long )value : ( unsigned long )value );
+    return value < 0 && residue != 0 ? ( unsigned int )matrix->modulus - residue : residue;
+}
+
+/*
+ * Function <private>:  _inverse
+ * --------------------
+ *      returns inverse of non-zero residue (extended Euclidean algorithm)
+ *
+ */
+static unsigned int _inverse( unsigned int value, long modulus )
+{
+    long a = value, b = modulus, x = 1, y = 0;
+
+    while( b != 0 )
+    {
+        const long quotient = a / b, remainder = a % b, previous = x - quotient * y;
+        a = b;
+        b = remainder;
+        x = y;
+        y = previous;
+    }
+    return ( unsigned int )( x < 0 ? x + modulus : x );
+}
+
+/*
+ * Function <private>:  _subtractMultiple
+ * --------------------
+ *      target -= factor * source (element-wise, modulo p). Product is reduced with quotient floor(factor * 2^32 / p)
+ *      computed once for whole row: estimated quotient of factor * x is high half of quotient * x, remainder is then
+ *      in range <0, 2p) and fits in 32 bits (p < 2^31)
+ *
+ */
+static void _subtractMultiple( unsigned int *target, const unsigned int *source, int length, unsigned int factor,
+                               unsigned int modulus )
+{
+    const unsigned int quotient = ( unsigned int )( ( ( unsigned long )factor << 32 ) / modulus );
+
+    for( int i = 0; i < length; i++ )
+    {
+        const unsigned int estimate = ( unsigned int )( ( ( unsigned long )quotient * source[i] ) >> 32 );
+        unsigned int product = factor * source[i] - estimate * modulus;    // Computed modulo 2^32
+        product = product >= modulus ? product - modulus : product;
+        const int difference = ( int )target[i] - ( int )product;
+        target[i] = ( unsigned int )( difference < 0 ? difference + ( int )modulus : difference );
+    }
+}
+
+/*
+ * Function <private>:  _scaleRow
+ * --------------------
+ *      row *= factor (element-wise, modulo p), with the same reduction as _subtractMultiple
+ *
+ */
+static void _scaleRow( unsigned int *row, int length, unsigned int factor, unsigned int modulus )
+{
+    const unsigned int quotient = ( unsigned int )( ( ( unsigned long )factor << 32 ) / modulus );
+
+    for( int i = 0; i < length; i++ )
+    {
+        const unsigned int estimate = ( unsigned int )( ( ( unsigned long )quotient * row[i] ) >> 32 );
+        const unsigned int product = factor * row[i] - estimate * modulus;
+        row[i] = product >= modulus ? product - modulus : product;
+    }
+}
+
+/************************************
+ * Matrices over GF(p)
+ ************************************/
+/*
+ * Function:  createModMatrix
+ * --------------------
+ *      creates matrix over GF(modulus) filled with zeros
+ *
+ *      rows, cols: dimensions of matrix
+ *      modulus:    prime modulus (see isValidModulus)
+ *      output:     pointer to memory where pointer to structure should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createModMatrix( int rows, int cols, long modulus, ModMatrix **output )
+{
+    ModMatrix *matrix = malloc( sizeof( ModMatrix ) );
+    if( matrix == NULL )
+        return -1;
+
+    matrix->rows = rows;
+    matrix->cols = cols;
+    matrix->modulus = modulus;
+    matrix->barrett = ~0UL / ( unsigned long )modulus;      // floor(2^64 / p) (one less for p = 2)
+    matrix->elements = malloc( sizeof( unsigned int* ) * ( ( size_t )rows + 1 ) );
+    matrix->data = calloc( ( size_t )rows * ( size_t )cols + 1, sizeof( unsigned int ) );
+    if( matrix->elements == NULL || matrix->data == NULL )
+    {
+        deleteModMatrix( matrix );
+        return -1;
+    }
+    for( int row = 0; row < rows; row++ )
+        matrix->elements[row] = matrix->data + ( size_t )row * ( size_t )cols;
+
+    *output = matrix;
+    return 0;
+}
+
+/*
+ * Function:  deleteModMatrix
+ * --------------------
+ *      frees all memory of matrix
+ *
+ */
+void deleteModMatrix( ModMatrix *matrix )
+{
+    if( matrix == NULL )
+        return;
+    free( matrix->elements );
+    free( matrix->data );
+    free( matrix );
+}
+
+/*
+ * Function <private>:  _eliminateModRows
+ * --------------------
+ *      subtracts multiples of pivot row from rows <begin, end) (counted from firstRow), so that they have 0 in
+ *      pivot column (used as ParallelBody)
+ *
+ */
+static void _eliminateModRows( long begin, long end, int worker, void *context )
+{
+    const ModEliminationContext *elimination = context;
+    const ModMatrix *matrix = elimination->matrix;
+    const unsigned int *pivot = matrix->elements[elimination->pivotRow] + elimination->col;
+    const int length = matrix->cols - elimination->col;
+
+    for( long index = begin; index < end; index++ )
+    {
+        const int row = elimination->firstRow + ( int )index;
+        unsigned int *target = matrix->elements[row] + elimination->col;
+        if( row != elimination->pivotRow && target[0] != 0 )
+            _subtractMultiple( target, pivot, length, target[0], ( unsigned int )matrix->modulus );
+    }
+}
+
+/*
+ * Function:  modMatrixEchelon
+ * --------------------
+ *      transforms matrix (in place) to row echelon form with pivots equal to 1 by Gaussian elimination; rows are
+ *      eliminated in parallel for every pivot
+ *
+ *      matrix:       matrix over GF(p)
+ *      reduced:      if non-zero, elements above pivots are also eliminated (reduced row echelon form)
+ *      pivotColumns: array for column of every pivot (at least min(rows, cols) elements, can be NULL)
+ *
+ *      returns: rank of matrix
+ *
+ */
+int modMatrixEchelon( ModMatrix *matrix, int reduced, int *pivotColumns )
+{
+    int rank = 0;
+
+    for( int col = 0; col < matrix->cols && rank < matrix->rows; col++ )
+    {
+        int pivotRow = rank;
+        while( pivotRow < matrix->rows && matrix->elements[pivotRow][col] == 0 )
+            pivotRow++;
+        if( pivotRow == matrix->rows )                      // No pivot in this column
+            continue;
+
+        unsigned int *swapped = matrix->elements[rank];
+        matrix->elements[rank] = matrix->elements[pivotRow];
+        matrix->elements[pivotRow] = swapped;
+        _scaleRow( matrix->elements[rank] + col, matrix->cols - col, _inverse( matrix->elements[rank][col], matrix->modulus ),
+                   ( unsigned int )matrix->modulus );
+
+        ModEliminationContext context = { matrix, rank, col, reduced ? 0 : rank + 1 };
+        const long minChunk = 1 + 65536 / ( matrix->cols - col );   // Enough work to be worth starting thread
+        parallelFor( matrix->rows - context.firstRow, minChunk, _eliminateModRows, &context );
+        if( pivotColumns != NULL )
+            pivotColumns[rank] = col;
+        rank++;
+    }
+    return rank;
+}
+
+/************************************
+ * Matrices over GF(2)
+ ************************************/
+/*
+ * Function:  createBitMatrix
+ * --------------------
+ *      creates matrix over GF(2) filled with zeros
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createBitMatrix( int rows, int cols, BitMatrix **output )
+{
+    BitMatrix *matrix = malloc( sizeof( BitMatrix ) );
+    if( matrix == NULL )
+        return -1;
+
+    matrix->rows = rows;
+    matrix->cols = cols;
+    matrix->words = ( cols + BIT_MATRIX_WORD_BITS - 1 ) / BIT_MATRIX_WORD_BITS;
+    matrix->elements = malloc( sizeof( unsigned long* ) * ( ( size_t )rows + 1 ) );
+    matrix->data = calloc( ( size_t )rows * ( size_t )matrix->words + 1, sizeof( unsigned long ) );
+    if( matrix->elements == NULL || matrix->data == NULL )
+    {
+        deleteBitMatrix( matrix );
+        return -1;
+    }
+    for( int row = 0; row < rows; row++ )
+        matrix->elements[row] = matrix->data + ( size_t )row * ( size_t )matrix->words;
+
+    *output = matrix;
+    return 0;
+}
+
+/*
+ * Function <private>:  _fillRandomBits
+ * --------------------
+ *      fills rows <begin, end) of random GF(2) matrix (used as ParallelBody)
+ *
+ */
+static void _fillRandomBits( long begin, long end, int worker, void *context )
+{
+    const RandomBitsContext *random = context;
+    const long size = random->matrix->cols;
+
+    for( long row = begin; row < end; row++ )
+        for( long col = 0; col < size; col++ )
+            random->matrix->elements[row][col / BIT_MATRIX_WORD_BITS] |=
+                ( counterRandom( random->seed, ( unsigned long )( row * size + col ) ) >> 63 ) << ( col % BIT_MATRIX_WORD_BITS );
+}
+
+/*
+ * Function:  randomBitMatrix
+ * --------------------
+ *      creates square GF(2) matrix with random elements - the same as random matrix generated with given seed and
+ *      range <0, 1> (see generateMatrix), but without storing every element as long integer
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int randomBitMatrix( int size, unsigned long seed, BitMatrix **output )
+{
+    RandomBitsContext context = { NULL, seed };
+
+    if( createBitMatrix( size, size, &context.matrix ) != 0 )
+        return -1;
+    parallelFor( size, 64, _fillRandomBits, &context );     // At least 64 rows per thread
+    *output = context.matrix;
+    return 0;
+}
+
+/*
+ * Function:  deleteBitMatrix
+ * --------------------
+ *      frees all memory of matrix
+ *
+ */
+void deleteBitMatrix( BitMatrix *matrix )
+{
+    if( matrix == NULL )
+        return;
+    free( matrix->elements );
+    free( matrix->data );
+    free( matrix );
+}
+
+/*
+ * Function <private>:  _bit
+ * --------------------
+ *      returns element of row of GF(2) matrix
+ *
+ */
+static inline unsigned long _bit( const unsigned long *row, int col )
+{
+    return ( row[col / BIT_MATRIX_WORD_BITS] >> ( col % BIT_MATRIX_WORD_BITS ) ) & 1;
+}
+
+/*
+ * Function <private>:  _xorWords
+ * --------------------
+ *      target ^= source for "count" words
+ *
+ */
+static inline void _xorWords( unsigned long *restrict target, const unsigned long *restrict source, int count )
+{
+    for( int i = 0; i < count; i++ )
+        target[i] ^= source[i];
+}
+
+/*
+ * Function <private>:  _eliminateBitRows
+ * --------------------
+ *      clears pivot columns of group in rows <begin, end) (counted from firstRow) - bits of row in pivot columns
+ *      select subset of pivot rows, whose sum is read from table and added at once (used as ParallelBody)
+ *
+ */
+static void _eliminateBitRows( long begin, long end, int worker, void *context )
+{
+    const BitEliminationContext *elimination = context;
+    const BitMatrix *matrix = elimination->matrix;
+    const int length = matrix->words - elimination->startWord;
+
+    for( long index = begin; index < end; index++ )
+    {
+        const int row = elimination->firstRow + ( int )index;
+        unsigned long *target = matrix->elements[row];
+        unsigned long subset = 0;
+        if( row >= elimination->groupRow && row < elimination->groupRow + elimination->pivots )
+            continue;
+        for( int pivot = 0; pivot < elimination->pivots; pivot++ )
+            subset |= _bit( target, elimination->pivotColumns[pivot] ) << pivot;
+        if( subset != 0 )
+            _xorWords( target + elimination->startWord, elimination->table + subset * ( size_t )length, length );
+    }
+}
+
+/*
+ * Function:  bitMatrixEchelon
+ * --------------------
+ *      transforms GF(2) matrix (in place) to row echelon form with Four Russians method: up to FOUR_RUSSIANS_BITS
+ *      pivots are found at once (rows searched for them are brought up to date only with pivots found so far),
+ *      then table of all 2^k sums of these pivot rows is built and every other row is eliminated with single
+ *      addition of row from table, so every word of matrix is read once per k pivots instead of once per pivot
+ *
+ *      matrix:       matrix over GF(2)
+ *      reduced:      if non-zero, elements above pivots are also eliminated (reduced row echelon form)
+ *      pivotColumns: array for column of every pivot (at least min(rows, cols) elements, can be NULL)
+ *
+ *      returns: rank of matrix, -1 on out of memory
+ *
+ */
+int bitMatrixEchelon( BitMatrix *matrix, int reduced, int *pivotColumns )
+{
+    unsigned long *table = malloc( sizeof( unsigned long ) * ( ( size_t )matrix->words << FOUR_RUSSIANS_BITS ) + 1 );
+    int *updated = malloc( sizeof( int ) * ( ( size_t )matrix->rows + 1 ) );   // Pivots of group added to row
+    int rank = 0, col = 0;
+
+    if( table == NULL || updated == NULL )
+    {
+        free( table );
+        free( updated );
+        return -1;
+    }
+
+    while( rank < matrix->rows && col < matrix->cols )
+    {
+        int groupColumns[FOUR_RUSSIANS_BITS], pivots = 0;
+        const int startWord = col / BIT_MATRIX_WORD_BITS, length = matrix->words - startWord;
+        unsigned long **rows = matrix->elements;
+
+        for( int row = rank; row < matrix->rows; row++ )
+            updated[row] = 0;
+        for( ; col < matrix->cols && pivots < FOUR_RUSSIANS_BITS && rank + pivots < matrix->rows; col++ )
+        {
+            int pivotRow = rank + pivots;
+            for( ; pivotRow < matrix->rows; pivotRow++ )
+            {
+                for( ; updated[pivotRow] < pivots; updated[pivotRow]++ )  // Add pivots found since last search
+                    if( _bit( rows[pivotRow], groupColumns[updated[pivotRow]] ) )
+                        _xorWords( rows[pivotRow] + startWord, rows[rank + updated[pivotRow]] + startWord, length );
+                if( _bit( rows[pivotRow], col ) )
+                    break;
+            }
+            if( pivotRow == matrix->rows )                  // No pivot in this column
+                continue;
+
+            unsigned long *swapped = rows[rank + pivots];
+            const int swappedUpdated = updated[rank + pivots];
+            rows[rank + pivots] = rows[pivotRow];
+            updated[rank + pivots] = updated[pivotRow];
+            rows[pivotRow] = swapped;
+            updated[pivotRow] = swappedUpdated;
+            for( int pivot = 0; pivot < pivots; pivot++ )    // Pivot rows of group are reduced among themselves
+                if( _bit( rows[rank + pivot], col ) )
+                    _xorWords( rows[rank + pivot] + startWord, rows[rank + pivots] + startWord, length );
+            groupColumns[pivots++] = col;
+        }
+        if( pivots == 0 )
+            break;
+
+        memset( table, 0, sizeof( unsigned long ) * ( size_t )length );
+        for( unsigned long subset = 1; subset < ( 1UL << pivots ); subset++ )     // Every sum from smaller one
+        {
+            const int lowest = __builtin_ctzl( subset );
+            memcpy( table + subset * ( size_t )length, table + ( subset & ( subset - 1 ) ) * ( size_t )length,
+                    sizeof( unsigned long ) * ( size_t )length );
+            _xorWords( table + subset * ( size_t )length, rows[rank + lowest] + startWord, length );
+        }
+
+        BitEliminationContext context = { matrix, table, startWord, groupColumns, pivots, rank, reduced ? 0 : rank };
+        parallelFor( matrix->rows - context.firstRow, 64, _eliminateBitRows, &context );    // At least 64 rows per thread
+        for( int pivot = 0; pivot < pivots && pivotColumns != NULL; pivot++ )
+            pivotColumns[rank + pivot] = groupColumns[pivot];
+        rank += pivots;
+    }
+
+    free( table );
+    free( updated );
+    return rank;
+}
+
+/************************************
+ * Operations on matrices of long integers
+ ************************************/
+/*
+ * Function <private>:  _rowReduce
+ * --------------------
+ *      creates matrix [left | right] over GF(modulus) and transforms it to (reduced) row echelon form; GF(2)
+ *      matrices are reduced packed and unpacked at the end
+ *
+ *      left:     square matrix
+ *      right:    square matrix of the same size appended on the right (can be NULL)
+ *      reduced:  if non-zero, reduced row echelon form is computed (and stored in output)
+ *      output:   pointer to memory where pointer to result should be stored (can be NULL if only rank is needed)
+ *      pivotColumns: array for columns of pivots (at least left->size elements, can be NULL)
+ *      rank:     pointer to int where rank should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS>
+ *
+ */
+static int _rowReduce( Matrix *left, Matrix *right, long modulus, int reduced, ModMatrix **output, int *pivotColumns,
+                       int *rank )
+{
+    const int size = left->size, cols = size + ( right != NULL ? size : 0 );
+    ModMatrix *result = NULL;
+
+    if( !isValidModulus( modulus ) )
+        return -2;
+    if( output != NULL && createModMatrix( size, cols, modulus, &result ) != 0 )
+        return -1;
+
+    if( modulus == 2 )
+    {
+        BitMatrix *bits;
+        if( createBitMatrix( size, cols, &bits ) != 0 )
+        {
+            deleteModMatrix( result );
+            return -1;
+        }
+        for( int row = 0; row < size; row++ )
+            for( int col = 0; col < cols; col++ )
+            {
+                const long value = col < size ? left->elements[row][col] : right->elements[row][col - size];
+                bits->elements[row][col / BIT_MATRIX_WORD_BITS] |= ( unsigned long )( value & 1 ) << ( col % BIT_MATRIX_WORD_BITS );
+            }
+        *rank = bitMatrixEchelon( bits, reduced, pivotColumns );
+        for( int row = 0; row < size && result != NULL && *rank >= 0; row++ )
+            for( int col = 0; col < cols; col++ )
+                result->elements[row][col] = ( unsigned int )_bit( bits->elements[row], col );
+        deleteBitMatrix( bits );
+        if( *rank < 0 )
+        {
+            deleteModMatrix( result );
+            return -1;
+        }
+    } else
+    {
+        if( result == NULL && createModMatrix( size, cols, modulus, &result ) != 0 )
+            return -1;
+        for( int row = 0; row < size; row++ )
+            for( int col = 0; col < cols; col++ )
+                result->elements[row][col] = _reduceLong( result, col < size ? left->elements[row][col]
+                                                                             : right->elements[row][col - size] );
+        *rank = modMatrixEchelon( result, reduced, pivotColumns );
+        if( output == NULL )
+        {
+            deleteModMatrix( result );
+            result = NULL;
+        }
+    }
+
+    if( output != NULL )
+        *output = result;
+    return 0;
+}
+
+/*
+ * Function:  rankModular
+ * --------------------
+ *      computes rank of matrix over GF(modulus)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS>
+ *
+ */
+int rankModular( Matrix *matrix, long modulus, int *rank )
+{
+    return _rowReduce( matrix, NULL, modulus, 0, NULL, NULL, rank );
+}
+
+/*
+ * Function:  rankSparseModular
+ * --------------------
+ *      computes rank of sparse matrix over GF(modulus); matrix is never stored as array of long integers, so
+ *      GF(2) matrices of size of tens of thousands take only size^2 / 8 bytes
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS>
+ *
+ */
+int rankSparseModular( SparseMatrix *matrix, long modulus, int *rank )
+{
+    const int size = matrix->size;
+
+    if( !isValidModulus( modulus ) )
+        return -2;
+    if( modulus == 2 )
+    {
+        BitMatrix *bits;
+        if( createBitMatrix( size, size, &bits ) != 0 )
+            return -1;
+        for( int row = 0; row < size; row++ )
+            for( long i = matrix->rowOffsets[row]; i < matrix->rowOffsets[row + 1]; i++ )
+                bits->elements[row][matrix->columns[i] / BIT_MATRIX_WORD_BITS] |=
+                    ( unsigned long )( matrix->values[i] & 1 ) << ( matrix->columns[i] % BIT_MATRIX_WORD_BITS );
+        *rank = bitMatrixEchelon( bits, 0, NULL );
+        deleteBitMatrix( bits );
+    } else
+    {
+        ModMatrix *residues;
+        if( createModMatrix( size, size, modulus, &residues ) != 0 )
+            return -1;
+        for( int row = 0; row < size; row++ )
+            for( long i = matrix->rowOffsets[row]; i < matrix->rowOffsets[row + 1]; i++ )
+                residues->elements[row][matrix->columns[i]] = _reduceLong( residues, matrix->values[i] );
+        *rank = modMatrixEchelon( residues, 0, NULL );
+        deleteModMatrix( residues );
+    }
+    return *rank < 0 ? -1 : 0;
+}
+
+/*
+ * Function:  reducedEchelonModular
+ * --------------------
+ *      creates reduced row echelon form of matrix over GF(modulus) (elements are in range <0, modulus))
+ *
+ *      output:  pointer to memory where pointer to result should be stored
+ *      rank:    pointer to int where rank of matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS>
+ *
+ */
+int reducedEchelonModular( Matrix *matrix, long modulus, Matrix **output, int *rank )
+{
+    ModMatrix *reduced;
+    int errorCode = _rowReduce( matrix, NULL, modulus, 1, &reduced, NULL, rank );
+    if( errorCode != 0 )
+        return errorCode;
+
+    if( createSquareMatrix( matrix->size, output ) != 0 )
+        errorCode = -1;
+    for( int row = 0; row < matrix->size && errorCode == 0; row++ )
+        for( int col = 0; col < matrix->size; col++ )
+            ( *output )->elements[row][col] = reduced->elements[row][col];
+    if( errorCode == 0 )
+        markMatrixModified( *output );
+    deleteModMatrix( reduced );
+    return errorCode;
+}
+
+/*
+ * Function:  nullSpaceModular
+ * --------------------
+ *      computes basis of null space {x : Ax = 0} of matrix over GF(modulus) - one vector for every column without
+ *      pivot in reduced row echelon form (1 in this column, minus column of echelon form in pivot positions)
+ *
+ *      output:  pointer to memory where pointer to basis should be stored - square matrix, whose first "nullity"
+ *               rows are basis vectors and other rows are zero
+ *      nullity: pointer to int where dimension of null space should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS>
+ *
+ */
+int nullSpaceModular( Matrix *matrix, long modulus, Matrix **output, int *nullity )
+{
+    const int size = matrix->size;
+    int *pivotColumns = malloc( sizeof( int ) * ( ( size_t )size + 1 ) );
+    char *isPivot = calloc( ( size_t )size + 1, 1 );
+    ModMatrix *reduced = NULL;
+    int rank, errorCode = pivotColumns == NULL || isPivot == NULL ? -1 : 0;
+
+    if( errorCode == 0 )
+        errorCode = _rowReduce( matrix, NULL, modulus, 1, &reduced, pivotColumns, &rank );
+    if( errorCode == 0 && createSquareMatrix( size, output ) != 0 )
+        errorCode = -1;
+
+    if( errorCode == 0 )
+    {
+        int vector = 0;
+        for( int i = 0; i < rank; i++ )
+            isPivot[pivotColumns[i]] = 1;
+        for( int column = 0; column < size; column++ )     // Columns without pivot are free variables
+        {
+            if( isPivot[column] )
+                continue;
+            ( *output )->elements[vector][column] = 1;
+            for( int i = 0; i < rank; i++ )                 // x[pivot] = -R[i][column]
+            {
+                const unsigned int element = reduced->elements[i][column];
+                ( *output )->elements[vector][pivotColumns[i]] = element == 0 ? 0 : modulus - element;
+            }
+            vector++;
+        }
+        *nullity = vector;
+        markMatrixModified( *output );
+    }
+
+    deleteModMatrix( reduced );
+    free( pivotColumns );
+    free( isPivot );
+    return errorCode;
+}
+
+/*
+ * Function:  solveModular
+ * --------------------
+ *      solves system AX = B over GF(modulus) by reducing matrix [A | B] to reduced row echelon form; if A is
+ *      singular, free variables are set to 0
+ *
+ *      a, b:    square matrices of the same size (every column of B is right side of one system)
+ *      output:  pointer to memory where pointer to solution X should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS> or
+ *               matrices have different sizes, MODULAR_NO_SOLUTION if system is inconsistent
+ *
+ */
+int solveModular( Matrix *a, Matrix *b, long modulus, Matrix **output )
+{
+    const int size = a->size;
+    int *pivotColumns = malloc( sizeof( int ) * ( 2 * ( size_t )size + 1 ) );
+    ModMatrix *reduced = NULL;
+    int rank, errorCode = pivotColumns == NULL ? -1 : 0;
+
+    if( a->size != b->size )
+        errorCode = -2;
+    if( errorCode == 0 )
+        errorCode = _rowReduce( a, b, modulus, 1, &reduced, pivotColumns, &rank );
+    if( errorCode == 0 && rank > 0 && pivotColumns[rank - 1] >= size )     // Row [0 ... 0 | non-zero]
+        errorCode = MODULAR_NO_SOLUTION;
+    if( errorCode == 0 && createSquareMatrix( size, output ) != 0 )
+        errorCode = -1;
+
+    for( int i = 0; i < rank && errorCode == 0; i++ )       // x[pivot] = right side of row of pivot
+        for( int col = 0; col < size; col++ )
+            ( *output )->elements[pivotColumns[i]][col] = reduced->elements[i][size + col];
+    if( errorCode == 0 )
+        markMatrixModified( *output );
+
+    deleteModMatrix( reduced );
+    free( pivotColumns );
+    return errorCode;
+}
+
+/************************************
+ * Characteristic polynomial over GF(p)
+ ************************************/
+/*
+ * Function <private>:  _reduceToHessenbergModular
+ * --------------------
+ *      transforms matrix (in place) to similar upper Hessenberg matrix: for every column k rows below subdiagonal
+ *      are eliminated with multiples of row k + 1 (L^-1 A) and then the same multiples of their columns are added
+ *      to column k + 1 (L^-1 A L), so characteristic polynomial doesn't change. Zero pivot is replaced by swapping
+ *      rows and the same columns
+ *
+ *      multipliers: array of 2 * matrix->rows elements for temporary use
+ *
+ */
+static void _reduceToHessenbergModular( ModMatrix *matrix, unsigned int *multipliers )
+{
+    unsigned int *quotients = multipliers + matrix->rows;
+    const int size = matrix->rows;
+    const unsigned int modulus = ( unsigned int )matrix->modulus;
+    unsigned int **rows = matrix->elements;
+
+    for( int k = 0; k + 2 < size; k++ )
+    {
+        int pivotRow = k + 1;
+        while( pivotRow < size && rows[pivotRow][k] == 0 )
+            pivotRow++;
+        if( pivotRow == size )                              // Column is already reduced
+            continue;
+        if( pivotRow != k + 1 )                             // Swap rows and columns - similarity transformation
+        {
+            unsigned int *swap = rows[pivotRow];
+            rows[pivotRow] = rows[k + 1];
+            rows[k + 1] = swap;
+            for( int row = 0; row < size; row++ )
+            {
+                const unsigned int element = rows[row][pivotRow];
+                rows[row][pivotRow] = rows[row][k + 1];
+                rows[row][k + 1] = element;
+            }
+        }
+
+        const unsigned int inverse = _inverse( rows[k + 1][k], modulus );
+        int eliminated = 0;
+        for( int row = k + 2; row < size; row++ )           // Rows: row -= m * pivot row
+        {
+            multipliers[row] = ( unsigned int )( ( unsigned long )rows[row][k] * inverse % modulus );
+            if( multipliers[row] != 0 )
+            {
+                _subtractMultiple( rows[row] + k, rows[k + 1] + k, size - k, multipliers[row], modulus );
+                eliminated = 1;
+            }
+        }
+        if( !eliminated )
+            continue;
+
+        for( int col = k + 2; col < size; col++ )           // Quotients of multipliers (as in _subtractMultiple)
+            quotients[col] = ( unsigned int )( ( ( unsigned long )multipliers[col] << 32 ) / modulus );
+        for( int row = 0; row < size; row++ )               // Columns: column k + 1 += sum of m * column
+        {
+            const unsigned int *elements = rows[row];
+            unsigned long sum = elements[k + 1];            // Products are below 2p < 2^32 - no overflow for any size
+            for( int col = k + 2; col < size; col++ )
+            {
+                const unsigned long product = ( unsigned long )quotients[col] * elements[col];
+                sum += multipliers[col] * elements[col] - ( unsigned int )( product >> 32 ) * modulus;
+            }
+            rows[row][k + 1] = ( unsigned int )( sum % modulus );
+        }
+    }
+}
+
+/*
+ * Function:  characteristicPolynomialModular
+ * --------------------
+ *      computes coefficients of det(xI - A) over GF(modulus) in O(n^3) operations: matrix is reduced to similar
+ *      upper Hessenberg matrix H, then polynomials of its leading submatrices are computed by expansion along their
+ *      last column: p_m(x) = (x - h[m][m]) p_(m-1)(x) - sum over i < m of h[i][m] * h[i+1][i] * ... * h[m][m-1] *
+ *      p_(i-1)(x) (counting from 1, p_0 = 1)
+ *
+ *      matrix:       square matrix
+ *      modulus:      prime modulus (see isValidModulus)
+ *      coefficients: array of size + 1 residues - coefficient of x^(size - k) is stored at index k
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if modulus isn't prime in range <2, MODULAR_MAX_MODULUS>
+ *
+ */
+int characteristicPolynomialModular( Matrix *matrix, long modulus, unsigned int *coefficients )
+{
+    const int size = matrix->size;
+    ModMatrix *hessenberg;
+
+    if( !isValidModulus( modulus ) )
+        return -2;
+    if( createModMatrix( size, size, modulus, &hessenberg ) != 0 )
+        return -1;
+    // Polynomial p_m has m + 1 coefficients (from x^0), stored from index m * (m + 1) / 2
+    unsigned int *polynomials = malloc( sizeof( unsigned int ) * ( ( size_t )( size + 1 ) * ( size + 2 ) / 2 ) );
+    unsigned int *multipliers = malloc( sizeof( unsigned int ) * ( ( size_t )size * 2 + 1 ) );
+    if( polynomials == NULL || multipliers == NULL )
+    {
+        deleteModMatrix( hessenberg );
+        free( polynomials );
+        free( multipliers );
+        return -1;
+    }
+
+    const unsigned int p = ( unsigned int )modulus;
+    unsigned int **h = hessenberg->elements;
+    for( int row = 0; row < size; row++ )
+        for( int col = 0; col < size; col++ )
+            h[row][col] = _reduceLong( hessenberg, matrix->elements[row][col] );
+    _reduceToHessenbergModular( hessenberg, multipliers );
+
+    polynomials[0] = 1;
+    for( int m = 1; m <= size; m++ )
+    {
+        unsigned int *current = polynomials + ( size_t )m * ( m + 1 ) / 2;
+        const unsigned int *previous = polynomials + ( size_t )( m - 1 ) * m / 2;
+
+        current[0] = 0;                                     // x * p_(m-1)
+        memcpy( current + 1, previous, sizeof( unsigned int ) * ( size_t )m );
+        if( h[m - 1][m - 1] != 0 )
+            _subtractMultiple( current, previous, m, h[m - 1][m - 1], p );
+
+        unsigned long subdiagonal = 1;                      // h[i+1][i] * ... * h[m][m-1] (counting from 1)
+        for( int i = m - 1; i >= 1; i-- )
+        {
+            subdiagonal = subdiagonal * h[i][i - 1] % p;
+            if( subdiagonal == 0 )                          // All next terms contain this factor
+                break;
+            const unsigned int factor = ( unsigned int )( subdiagonal * h[i - 1][m - 1] % p );
+            if( factor != 0 )
+                _subtractMultiple( current, polynomials + ( size_t )( i - 1 ) * i / 2, i, factor, p );
+        }
+    }
+
+    const unsigned int *polynomial = polynomials + ( size_t )size * ( size + 1 ) / 2;
+    for( int k = 0; k <= size; k++ )
+        coefficients[k] = polynomial[size - k];
+
+    deleteModMatrix( hessenberg );
+    free( polynomials );
+    free( multipliers );
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * File: ModularMatrix.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file ModularMatrix.c
+ */
+
+#ifndef PROJEKT2_MODULARMATRIX_H
+#define PROJEKT2_MODULARMATRIX_H
+
+#include "SquareMatrix.h"
+#include "SparseMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define MODULAR_MAX_MODULUS     2147483647L     // Moduli are below 2^31, so difference of residues fits in int
+#define FOUR_RUSSIANS_BITS      8               // Pivot rows combined into one table of Four Russians method
+#define BIT_MATRIX_WORD_BITS    64              // Elements of GF(2) matrix packed in one word
+#define MODULAR_NO_SOLUTION     -3              // Error code of solveModular for inconsistent system
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Matrix over GF(p) - every element is residue in range <0, modulus)
+struct ModMatrix {
+    int rows, cols;
+    long modulus;
+    unsigned long barrett;                      // floor(2^64 / modulus) - factor of Barrett reduction
+    unsigned int **elements;                    // Pointers to rows (swapped instead of rows themselves)
+    unsigned int *data;                         // All elements, row after row
+};
+typedef struct ModMatrix ModMatrix;
+
+// Matrix over GF(2) - element (row, col) is bit col % 64 of word elements[row][col / 64]
+struct BitMatrix {
+    int rows, cols;
+    int words;                                  // Number of words of every row
+    unsigned long **elements;                   // Pointers to rows (swapped instead of rows themselves)
+    unsigned long *data;                        // All words, row after row (bits after the last column are 0)
+};
+typedef struct BitMatrix BitMatrix;
+
+/************************************
+ * Function declarations
+ ************************************/
+int isValidModulus( long modulus );
+int createModMatrix( int rows, int cols, long modulus, ModMatrix **output );
+void deleteModMatrix( ModMatrix *matrix );
+int modMatrixEchelon( ModMatrix *matrix, int reduced, int *pivotColumns );
+int createBitMatrix( int rows, int cols, BitMatrix **output );
+int randomBitMatrix( int size, unsigned long seed, BitMatrix **output );
+void deleteBitMatrix( BitMatrix *matrix );
+int bitMatrixEchelon( BitMatrix *matrix, int reduced, int *pivotColumns );
+int rankModular( Matrix *matrix, long modulus, int *rank );
+int rankSparseModular( SparseMatrix *matrix, long modulus, int *rank );
+int reducedEchelonModular( Matrix *matrix, long modulus, Matrix **output, int *rank );
+int nullSpaceModular( Matrix *matrix, long modulus, Matrix **output, int *nullity );
+int solveModular( Matrix *a, Matrix *b, long modulus, Matrix **output );
+int characteristicPolynomialModular( Matrix *matrix, long modulus, unsigned int *coefficients );
+
+#endif //PROJEKT2_MODULARMATRIX_H
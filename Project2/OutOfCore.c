@@ -0,0 +1,474 @@
+/*
+ * File: OutOfCore.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Multiplication of matrices stored in binary files, which don't have to fit in memory. Result
+ *              C = A * B is computed tile by tile: C(I, J) = sum over K of A(I, K) * B(K, J). Only a few tiles are
+ *              kept in memory - their size is chosen from memory budget. Separate I/O thread reads tiles of the
+ *              following steps (pread) while current ones are multiplied and writes finished tiles of result in
+ *              tile order, so multiplication waits for disk only if disk is slower than computation
+ */
+
+#include "OutOfCore.h"
+#include "MatrixFile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Pair of input tiles of one step - A(I, K) and B(K, J)
+struct TileSlot {
+    Matrix *tiles[2];
+    long step;                                      // Step whose tiles are loaded, -1 if slot is free
+};
+typedef struct TileSlot TileSlot;
+
+// State shared by computing thread and I/O thread
+struct OutOfCoreContext {
+    int inputs[2];                                  // Descriptors of files of factors
+    MatrixFileHeader headers[2];
+    int output;                                     // Descriptor of file of result
+    MatrixFileHeader outputHeader;
+    int size;                                       // Size of multiplied matrices
+    int tileSize;
+    int tilesPerRow;
+    long steps;                                     // Number of tile multiplications (tilesPerRow ^ 3)
+    long nextStep;                                  // First step not read yet by I/O thread
+    long tilesWritten;                              // Number of tiles of result already written
+    TileSlot slots[OUT_OF_CORE_PREFETCH_DEPTH];
+    Matrix *results[2];                             // Result tile being computed and the one being written
+    long pendingTiles[2];                           // Index of result tile waiting for write, -1 if buffer is free
+    Matrix *product;                                // Workspace for product of one pair of tiles
+    int errorCode;                                  // First error found by any thread
+    long tilesRead;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;                         // Broadcasted on every change of slots, tiles or errorCode
+};
+typedef struct OutOfCoreContext OutOfCoreContext;
+
+/*
+ * Function <private>:  _secondsSince
+ * --------------------
+ *      returns time elapsed since "start" (read from monotonic clock) in seconds
+ *
+ */
+static double _secondsSince( const struct timespec *start )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( double )( now.tv_sec - start->tv_sec ) + ( double )( now.tv_nsec - start->tv_nsec ) / 1e9;
+}
+
+/*
+ * Function:  outOfCoreTileSize
+ * --------------------
+ *      chooses size of tile, so that all tile buffers (OUT_OF_CORE_TILE_BUFFERS of them) fit in memory budget;
+ *      it's multiple of OUT_OF_CORE_MIN_TILE (rows of tiles stay aligned) not bigger than needed for whole matrix
+ *      (size rounded up to OUT_OF_CORE_MIN_TILE)
+ *
+ *      size:         size of multiplied matrices
+ *      memoryBudget: number of bytes which may be used by tiles
+ *
+ *      returns: size of tile
+ *
+ */
+int outOfCoreTileSize( int size, size_t memoryBudget )
+{
+    const size_t tileBudget = memoryBudget / OUT_OF_CORE_TILE_BUFFERS / sizeof( long );
+    const long maxTile = ( size + OUT_OF_CORE_MIN_TILE - 1L ) / OUT_OF_CORE_MIN_TILE * OUT_OF_CORE_MIN_TILE;
+    long tile = OUT_OF_CORE_MIN_TILE;
+
+    for( ;; )
+    {
+        // Bigger tiles are multiples of MULTIPLY_TILE_WIDTH - multiplication kernel doesn't compute narrow strips then
+        const long next = tile < MULTIPLY_TILE_WIDTH ? tile + OUT_OF_CORE_MIN_TILE
+                                                     : tile / MULTIPLY_TILE_WIDTH * MULTIPLY_TILE_WIDTH + MULTIPLY_TILE_WIDTH;
+        if( tile >= maxTile || ( size_t )next * ( size_t )next > tileBudget )
+            return ( int )tile;
+        tile = next < maxTile ? next : maxTile;
+    }
+}
+
+/*
+ * Function <private>:  _transferFully
+ * --------------------
+ *      reads (or writes, if "write" is non-zero) "length" bytes at given offset of file, repeating pread/pwrite
+ *      after partial transfers and interrupts
+ *
+ *      returns: 0 on success, -2 on I/O error or unexpected end of file
+ *
+ */
+static int _transferFully( int file, void *buffer, size_t length, off_t offset, int write )
+{
+    char *cursor = buffer;
+
+    while( length > 0 )
+    {
+        ssize_t done = write ? pwrite( file, cursor, length, offset ) : pread( file, cursor, length, offset );
+        if( done < 0 && errno == EINTR )
+            continue;
+        if( done <= 0 )
+            return -2;
+        cursor += done;
+        length -= ( size_t )done;
+        offset += done;
+    }
+    return 0;
+}
+
+/*
+ * Function <private>:  _transferTile
+ * --------------------
+ *      reads tile (tileRow, tileCol) of matrix stored in file into "tile", filling part outside of matrix with
+ *      zeros, or writes part of "tile" lying inside matrix to the file (if "write" is non-zero)
+ *
+ *      returns: 0 on success, -2 on I/O error
+ *
+ */
+static int _transferTile( const OutOfCoreContext *context, int file, const MatrixFileHeader *header,
+                          long tileRow, long tileCol, Matrix *tile, int write )
+{
+    const long firstRow = tileRow * context->tileSize, firstCol = tileCol * context->tileSize;
+    const long cols = context->size - firstCol < context->tileSize ? context->size - firstCol : context->tileSize;
+
+    for( long row = 0; row < context->tileSize; row++ )
+    {
+        long *elements = tile->elements[row];
+        if( firstRow + row >= context->size )
+        {
+            if( write )
+                break;
+            memset( elements, 0, sizeof( long ) * ( size_t )context->tileSize );
+            continue;
+        }
+        const off_t offset = ( off_t )( header->payloadOffset
+                                        + sizeof( long ) * ( ( uint64_t )( firstRow + row ) * header->stride + ( uint64_t )firstCol ) );
+        if( _transferFully( file, elements, sizeof( long ) * ( size_t )cols, offset, write ) != 0 )
+            return -2;
+        if( !write )
+            memset( elements + cols, 0, sizeof( long ) * ( size_t )( context->tileSize - cols ) );
+    }
+    return 0;
+}
+
+/*
+ * Function <private>:  _runIO
+ * --------------------
+ *      body of I/O thread: reads tiles of consecutive steps into free slots and writes finished tiles of result
+ *      (lower index first); finishes after writing last tile or when any thread reports an error
+ *
+ */
+static void* _runIO( void *argument )
+{
+    OutOfCoreContext *context = argument;
+    const long resultTiles = ( long )context->tilesPerRow * context->tilesPerRow;
+
+    pthread_mutex_lock( &context->lock );
+    while( context->errorCode == 0 && context->tilesWritten < resultTiles )
+    {
+        int buffer = -1;                                    // Result tile waiting for write
+        for( int i = 0; i < 2; i++ )
+            if( context->pendingTiles[i] != -1 && ( buffer == -1 || context->pendingTiles[i] < context->pendingTiles[buffer] ) )
+                buffer = i;
+
+        if( buffer != -1 )                                  // Writes go first - they free buffer for computation
+        {
+            const long tile = context->pendingTiles[buffer];
+            pthread_mutex_unlock( &context->lock );
+            int errorCode = _transferTile( context, context->output, &context->outputHeader, tile / context->tilesPerRow,
+                                           tile % context->tilesPerRow, context->results[buffer], 1 );
+            pthread_mutex_lock( &context->lock );
+            context->pendingTiles[buffer] = -1;
+            context->tilesWritten++;
+            if( errorCode != 0 && context->errorCode == 0 )
+                context->errorCode = errorCode;
+            pthread_cond_broadcast( &context->changed );
+        } else if( context->nextStep < context->steps
+                   && context->slots[context->nextStep % OUT_OF_CORE_PREFETCH_DEPTH].step == -1 )
+        {
+            const long step = context->nextStep++;
+            const long tile = step / context->tilesPerRow, k = step % context->tilesPerRow;
+            TileSlot *slot = &context->slots[step % OUT_OF_CORE_PREFETCH_DEPTH];
+            pthread_mutex_unlock( &context->lock );
+            int errorCode = _transferTile( context, context->inputs[0], &context->headers[0], tile / context->tilesPerRow,
+                                           k, slot->tiles[0], 0 );
+            if( errorCode == 0 )
+                errorCode = _transferTile( context, context->inputs[1], &context->headers[1], k,
+                                           tile % context->tilesPerRow, slot->tiles[1], 0 );
+            pthread_mutex_lock( &context->lock );
+            slot->step = step;
+            context->tilesRead += 2;
+            if( errorCode != 0 && context->errorCode == 0 )
+                context->errorCode = errorCode;
+            pthread_cond_broadcast( &context->changed );
+        } else
+            pthread_cond_wait( &context->changed, &context->lock );
+    }
+    pthread_mutex_unlock( &context->lock );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _accumulateTile
+ * --------------------
+ *      adds product of tiles to result tile
+ *
+ *      returns: 0 on success, OUT_OF_CORE_OVERFLOW on long integer overflow
+ *
+ */
+static int _accumulateTile( Matrix *result, Matrix *product )
+{
+    int overflow = 0;
+
+    for( int row = 0; row < result->size; row++ )
+    {
+        long *resultRow = result->elements[row];
+        const long *productRow = product->elements[row];
+        for( int col = 0; col < result->size; col++ )
+            overflow |= __builtin_add_overflow( resultRow[col], productRow[col], &resultRow[col] );
+    }
+    return overflow ? OUT_OF_CORE_OVERFLOW : 0;
+}
+
+/*
+ * Function <private>:  _computeTiles
+ * --------------------
+ *      computes consecutive tiles of result from tiles prepared by I/O thread and passes them back for writing
+ *
+ *      stallSeconds: pointer to memory where time of waiting for tiles should be stored
+ *
+ */
+static void _computeTiles( OutOfCoreContext *context, OperationControl *control, double *stallSeconds )
+{
+    const long resultTiles = ( long )context->tilesPerRow * context->tilesPerRow;
+    struct timespec start;
+
+    for( long tile = 0; tile < resultTiles; tile++ )
+    {
+        Matrix *result = context->results[tile % 2];
+        int errorCode = 0;
+
+        clock_gettime( CLOCK_MONOTONIC, &start );
+        pthread_mutex_lock( &context->lock );
+        while( context->errorCode == 0 && context->pendingTiles[tile % 2] != -1 )   // Buffer is still being written
+            pthread_cond_wait( &context->changed, &context->lock );
+        pthread_mutex_unlock( &context->lock );
+        *stallSeconds += _secondsSince( &start );
+
+        for( long k = 0; k < context->tilesPerRow && errorCode == 0; k++ )
+        {
+            const long step = tile * context->tilesPerRow + k;
+            TileSlot *slot = &context->slots[step % OUT_OF_CORE_PREFETCH_DEPTH];
+
+            clock_gettime( CLOCK_MONOTONIC, &start );
+            pthread_mutex_lock( &context->lock );
+            while( context->errorCode == 0 && slot->step != step )
+                pthread_cond_wait( &context->changed, &context->lock );
+            errorCode = context->errorCode;
+            pthread_mutex_unlock( &context->lock );
+            *stallSeconds += _secondsSince( &start );
+            if( errorCode != 0 )
+                return;
+
+            if( k == 0 )                                    // First product is written directly to result tile
+                errorCode = multiplySquareMatrixInto( slot->tiles[0], slot->tiles[1], result );
+            else if( ( errorCode = multiplySquareMatrixInto( slot->tiles[0], slot->tiles[1], context->product ) ) == 0 )
+                errorCode = _accumulateTile( result, context->product );
+            if( errorCode == -3 )
+                errorCode = OUT_OF_CORE_OVERFLOW;
+            if( errorCode == 0 && isOperationCancelled( control ) )
+                errorCode = OPERATION_CANCELLED;
+            addOperationProgress( control, 1 );
+
+            pthread_mutex_lock( &context->lock );
+            slot->step = -1;
+            if( errorCode != 0 && context->errorCode == 0 )
+                context->errorCode = errorCode;
+            pthread_cond_broadcast( &context->changed );
+            pthread_mutex_unlock( &context->lock );
+        }
+        if( errorCode != 0 )
+            return;
+
+        pthread_mutex_lock( &context->lock );
+        context->pendingTiles[tile % 2] = tile;
+        pthread_cond_broadcast( &context->changed );
+        pthread_mutex_unlock( &context->lock );
+    }
+}
+
+/*
+ * Function <private>:  _createTiles
+ * --------------------
+ *      creates all tile buffers of context
+ *
+ *      returns: 0 on success, -1 on out of memory (already created buffers are deleted later by _deleteTiles)
+ *
+ */
+static int _createTiles( OutOfCoreContext *context )
+{
+    for( int i = 0; i < OUT_OF_CORE_PREFETCH_DEPTH; i++ )
+    {
+        context->slots[i].step = -1;
+        for( int j = 0; j < 2; j++ )
+            if( createSquareMatrix( context->tileSize, &context->slots[i].tiles[j] ) != 0 )
+                return -1;
+    }
+    for( int i = 0; i < 2; i++ )
+    {
+        context->pendingTiles[i] = -1;
+        if( createSquareMatrix( context->tileSize, &context->results[i] ) != 0 )
+            return -1;
+    }
+    return createSquareMatrix( context->tileSize, &context->product ) != 0 ? -1 : 0;
+}
+
+/*
+ * Function <private>:  _deleteTiles
+ * --------------------
+ *      deletes all tile buffers of context (NULL ones are skipped)
+ *
+ */
+static void _deleteTiles( OutOfCoreContext *context )
+{
+    for( int i = 0; i < OUT_OF_CORE_PREFETCH_DEPTH; i++ )
+        for( int j = 0; j < 2; j++ )
+            deleteSquareMatrix( context->slots[i].tiles[j] );
+    for( int i = 0; i < 2; i++ )
+        deleteSquareMatrix( context->results[i] );
+    deleteSquareMatrix( context->product );
+}
+
+/*
+ * Function <private>:  _multiplyOpenedFiles
+ * --------------------
+ *      multiplies factors from opened files of context into opened output file (its header is written here)
+ *
+ *      returns: the same values as multiplyMatrixFiles
+ *
+ */
+static int _multiplyOpenedFiles( OutOfCoreContext *context, size_t memoryBudget, OperationControl *control,
+                                 OutOfCoreStats *stats )
+{
+    const size_t rowLength = sizeof( long ) * ( size_t )context->outputHeader.stride;
+    pthread_t thread;
+    int errorCode;
+
+    if( ( errorCode = _transferFully( context->output, &context->outputHeader, sizeof( context->outputHeader ), 0, 1 ) ) != 0
+        || ftruncate( context->output, ( off_t )( context->outputHeader.payloadOffset + rowLength * ( size_t )context->size ) ) != 0 )
+        return -2;                                          // Padding of rows is filled with zeros by ftruncate
+    if( context->size == 0 )
+        return 0;
+
+    context->tileSize = outOfCoreTileSize( context->size, memoryBudget );
+    context->tilesPerRow = ( context->size + context->tileSize - 1 ) / context->tileSize;
+    context->steps = ( long )context->tilesPerRow * context->tilesPerRow * context->tilesPerRow;
+    stats->tileSize = context->tileSize;
+    if( control != NULL )
+        __atomic_store_n( &control->stepsTotal, context->steps, __ATOMIC_RELAXED );
+
+    if( _createTiles( context ) != 0 )
+    {
+        _deleteTiles( context );
+        return -1;
+    }
+    pthread_mutex_init( &context->lock, NULL );
+    pthread_cond_init( &context->changed, NULL );
+
+    if( pthread_create( &thread, NULL, _runIO, context ) != 0 )
+        errorCode = -1;
+    else
+    {
+        _computeTiles( context, control, &stats->stallSeconds );
+        pthread_join( thread, NULL );
+        errorCode = context->errorCode;
+    }
+
+    stats->tilesRead = context->tilesRead;
+    pthread_mutex_destroy( &context->lock );
+    pthread_cond_destroy( &context->changed );
+    _deleteTiles( context );
+    return errorCode;
+}
+
+/*
+ * Function:  multiplyMatrixFiles
+ * --------------------
+ *      multiplies matrices stored in binary matrix files and writes result to another file, keeping in memory
+ *      only tiles fitting in memory budget. Result is first written under temporary name and then renamed (as in
+ *      saveMatrixToFile), so output path may be the same as one of inputs
+ *
+ *      path1, path2: paths to files of first and second factor
+ *      outputPath:   path to file of result
+ *      memoryBudget: number of bytes which may be used by tiles (tiles of OUT_OF_CORE_MIN_TILE rows are used if
+ *                    budget is lower)
+ *      control:      progress (in multiplications of tiles) and cancellation of operation (can be NULL)
+ *      stats:        pointer to memory where statistics of multiplication should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on I/O error, -3 if some file has invalid format or matrices
+ *               don't have the same size, OPERATION_CANCELLED if operation was cancelled, OUT_OF_CORE_OVERFLOW on
+ *               long integer overflow (output file isn't changed on error)
+ *
+ */
+int multiplyMatrixFiles( const char *path1, const char *path2, const char *outputPath, size_t memoryBudget,
+                         OperationControl *control, OutOfCoreStats *stats )
+{
+    OutOfCoreContext context = { { -1, -1 }, .output = -1 };
+    const char *paths[2] = { path1, path2 };
+    struct timespec start;
+    int errorCode = 0;
+
+    clock_gettime( CLOCK_MONOTONIC, &start );
+    memset( stats, 0, sizeof( *stats ) );
+
+    char *temporaryPath = malloc( strlen( outputPath ) + sizeof( ".tmp" ) );
+    if( temporaryPath == NULL )
+        return -1;
+    sprintf( temporaryPath, "%s.tmp", outputPath );
+
+    for( int i = 0; i < 2 && errorCode == 0; i++ )
+    {
+        context.inputs[i] = open( paths[i], O_RDONLY );
+        if( context.inputs[i] < 0 )
+            errorCode = -2;
+        else
+            errorCode = readMatrixFileHeader( context.inputs[i], &context.headers[i], NULL );
+    }
+    if( errorCode == 0 && context.headers[0].rows != context.headers[1].rows )
+        errorCode = -3;
+
+    if( errorCode == 0 )
+    {
+        context.size = ( int )context.headers[0].rows;
+        prepareMatrixFileHeader( context.size, &context.outputHeader );
+        context.output = open( temporaryPath, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if( context.output < 0 )
+            errorCode = -2;
+        else
+        {
+            errorCode = _multiplyOpenedFiles( &context, memoryBudget, control, stats );
+            if( errorCode == 0 && fdatasync( context.output ) != 0 )    // Wait until data reaches the file
+                errorCode = -2;
+            if( close( context.output ) != 0 && errorCode == 0 )
+                errorCode = -2;
+            if( errorCode == 0 && rename( temporaryPath, outputPath ) != 0 )
+                errorCode = -2;
+            if( errorCode != 0 )
+                unlink( temporaryPath );
+        }
+    }
+
+    for( int i = 0; i < 2; i++ )
+        if( context.inputs[i] >= 0 )
+            close( context.inputs[i] );
+    free( temporaryPath );
+    stats->elapsedSeconds = _secondsSince( &start );
+    return errorCode;
+}
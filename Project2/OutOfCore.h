@@ -0,0 +1,42 @@
+/*
+ * File: OutOfCore.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file OutOfCore.c
+ */
+
+#ifndef PROJEKT2_OUTOFCORE_H
+#define PROJEKT2_OUTOFCORE_H
+
+#include <stddef.h>
+#include "SquareMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define OUT_OF_CORE_PREFETCH_DEPTH  2           // Number of pairs of input tiles in memory (computed one + prefetched)
+#define OUT_OF_CORE_TILE_BUFFERS    ( 2 * OUT_OF_CORE_PREFETCH_DEPTH + 3 )  // Input tiles, 2 result tiles, product
+#define OUT_OF_CORE_MIN_TILE        8           // Smallest tile used even if memory budget is lower
+#define OUT_OF_CORE_OVERFLOW        -5          // Error code returned on long integer overflow
+#define OUT_OF_CORE_DEFAULT_BUDGET  256         // Memory budget (in megabytes) used if user doesn't give one
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Statistics of out-of-core multiplication
+struct OutOfCoreStats {
+    int tileSize;                   // Number of rows and columns of tile
+    long tilesRead;                 // Number of tiles of factors read from files
+    double elapsedSeconds;          // Duration of whole multiplication
+    double stallSeconds;            // Time in which computation waited for tiles - near 0 when compute-bound
+};
+typedef struct OutOfCoreStats OutOfCoreStats;
+
+/************************************
+ * Function declarations
+ ************************************/
+int outOfCoreTileSize( int size, size_t memoryBudget );
+int multiplyMatrixFiles( const char *path1, const char *path2, const char *outputPath, size_t memoryBudget,
+                         OperationControl *control, OutOfCoreStats *stats );
+
+#endif //PROJEKT2_OUTOFCORE_H
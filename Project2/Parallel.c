@@ -0,0 +1,319 @@
+/*
+ * File: Parallel.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Splitting work between threads; parts of loops are run by pool of threads started once and kept
+ *              waiting for next loop, so short loops don't pay for creating and joining threads
+ */
+
+#define _GNU_SOURCE                             // cpu_set_t and sched_setaffinity are needed to pin threads
+
+#include "Parallel.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Arguments of one thread started by parallelFor
+struct ParallelTask {
+    ParallelBody body;
+    void *context;
+    long begin;
+    long end;
+    int worker;
+};
+typedef struct ParallelTask ParallelTask;
+
+// Threads waiting for parts of loops; thread i runs part i of loop (part 0 is run by calling thread)
+struct ThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t loopStarted;     // Signalled when new loop is published...
+    pthread_cond_t loopFinished;    // ...and when the last of its parts run by pool is finished
+    ParallelTask *tasks;            // Parts of current loop
+    int parts;                      // Number of parts of current loop (all but the first one are run by pool)
+    int pending;                    // Number of parts run by pool which aren't finished yet
+    unsigned long generation;       // Number of published loops - threads compare it to notice new loop
+    int threads;                    // Number of started threads (they are never stopped)
+};
+typedef struct ThreadPool ThreadPool;
+
+// Shared state of parallelForDynamic - workers take elements one by one
+struct DynamicLoop {
+    ParallelBody body;
+    void *context;
+    long count;
+    long next;              // First element not taken by any worker yet
+};
+typedef struct DynamicLoop DynamicLoop;
+
+/************************************
+ * Global variables
+ ************************************/
+static int _pinnedProcessors[MAX_NUMBER_OF_THREADS];   // Processor of every worker while threads are pinned...
+static int _numberOfPinnedProcessors = 0;              // ...and number of such processors (0 - threads aren't pinned)
+static ThreadPool _pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                            NULL, 0, 0, 0, 1 };         // Calling thread counts as thread of worker 0
+static pthread_mutex_t _poolOwner = PTHREAD_MUTEX_INITIALIZER;  // Held by thread whose loop is run by pool
+static int _poolEnabled = 1;                           // If zero, every loop starts its own threads
+
+/*
+ * Function:  availableThreads
+ * --------------------
+ *      returns number of threads that should be used for parallel work (number of online processors, but no more
+ *      than MAX_NUMBER_OF_THREADS)
+ *
+ */
+int availableThreads( void )
+{
+    static int threads = 0;                                 // Computed once - sysconf is a system call
+    int cached = __atomic_load_n( &threads, __ATOMIC_RELAXED );
+
+    if( cached == 0 )                                       // Threads computing it at once store the same value
+    {
+        long processors = sysconf( _SC_NPROCESSORS_ONLN );
+        cached = processors < 1 ? 1 : processors > MAX_NUMBER_OF_THREADS ? MAX_NUMBER_OF_THREADS : ( int )processors;
+        __atomic_store_n( &threads, cached, __ATOMIC_RELAXED );
+    }
+    return cached;
+}
+
+/*
+ * Function <private>:  _pinThread
+ * --------------------
+ *      binds calling thread to processor of given worker (workers are assigned to allowed processors in order)
+ *
+ */
+static void _pinThread( int worker )
+{
+    cpu_set_t processors;
+
+    CPU_ZERO( &processors );
+    CPU_SET( _pinnedProcessors[worker % _numberOfPinnedProcessors], &processors );
+    sched_setaffinity( 0, sizeof( processors ), &processors );     // 0 - calling thread
+}
+
+/*
+ * Function:  pinParallelThreads
+ * --------------------
+ *      binds (enable != 0) worker i of every parallelFor to i-th processor which process is allowed to run on, so
+ *      that threads don't migrate between processors during measurements; calling thread is bound to the first
+ *      processor at once. Should be called before any parallel work starts
+ *
+ *      returns: 0 on success, -1 if set of allowed processors can't be read
+ *
+ */
+int pinParallelThreads( int enable )
+{
+    cpu_set_t allowed;
+    int count = 0;
+
+    _numberOfPinnedProcessors = 0;
+    if( !enable )
+        return 0;
+    if( sched_getaffinity( 0, sizeof( allowed ), &allowed ) != 0 )
+        return -1;
+    for( int processor = 0; processor < CPU_SETSIZE && count < MAX_NUMBER_OF_THREADS; processor++ )
+        if( CPU_ISSET( processor, &allowed ) )
+            _pinnedProcessors[count++] = processor;
+    if( count == 0 )
+        return -1;
+
+    _numberOfPinnedProcessors = count;
+    _pinThread( 0 );
+    return 0;
+}
+
+/*
+ * Function <private>:  _runTask
+ * --------------------
+ *      entry point of thread started by parallelFor
+ *
+ */
+static void* _runTask( void *argument )
+{
+    ParallelTask *task = argument;
+    if( _numberOfPinnedProcessors > 0 && task->worker > 0 )         // Calling thread (worker 0) is already pinned
+        _pinThread( task->worker );
+    task->body( task->begin, task->end, task->worker, task->context );
+    return NULL;
+}
+
+/*
+ * Function <private>:  _runPoolThread
+ * --------------------
+ *      entry point of thread of pool - waits for loops and runs its part of every loop which has one
+ *
+ */
+static void* _runPoolThread( void *argument )
+{
+    const int worker = ( int )( long )argument;
+    unsigned long generation = 0;
+
+    pthread_mutex_lock( &_pool.lock );
+    while( 1 )
+    {
+        while( _pool.generation == generation )
+            pthread_cond_wait( &_pool.loopStarted, &_pool.lock );
+        generation = _pool.generation;
+        if( worker >= _pool.parts )                         // Loop has fewer parts than pool has threads
+            continue;
+
+        pthread_mutex_unlock( &_pool.lock );
+        _runTask( &_pool.tasks[worker] );
+        pthread_mutex_lock( &_pool.lock );
+        if( --_pool.pending == 0 )
+            pthread_cond_signal( &_pool.loopFinished );
+    }
+    return NULL;
+}
+
+/*
+ * Function <private>:  _runOnPool
+ * --------------------
+ *      runs parts of loop on threads of pool (starting missing threads first); calling thread runs the first part
+ *      and parts for which thread couldn't be started. Pool runs one loop at a time, so loops started meanwhile
+ *      by other threads (or by parts of this loop) aren't run by pool
+ *
+ *      returns: 0 if loop was run, -1 if pool is busy with another loop (or disabled)
+ *
+ */
+static int _runOnPool( ParallelTask *tasks, int parts )
+{
+    if( !__atomic_load_n( &_poolEnabled, __ATOMIC_RELAXED ) || pthread_mutex_trylock( &_poolOwner ) != 0 )
+        return -1;
+
+    pthread_mutex_lock( &_pool.lock );
+    while( _pool.threads < parts )
+    {
+        pthread_t thread;
+        if( pthread_create( &thread, NULL, _runPoolThread, ( void* )( long )_pool.threads ) != 0 )
+            break;
+        pthread_detach( thread );
+        _pool.threads++;
+    }
+    const int pooled = parts < _pool.threads ? parts : _pool.threads;
+    _pool.tasks = tasks;
+    _pool.parts = pooled;
+    _pool.pending = pooled - 1;
+    _pool.generation++;
+    pthread_cond_broadcast( &_pool.loopStarted );
+    pthread_mutex_unlock( &_pool.lock );
+
+    _runTask( &tasks[0] );                                  // Calling thread takes first part...
+    for( int worker = pooled; worker < parts; worker++ )    // ...and parts without thread
+        _runTask( &tasks[worker] );
+
+    pthread_mutex_lock( &_pool.lock );
+    while( _pool.pending > 0 )
+        pthread_cond_wait( &_pool.loopFinished, &_pool.lock );
+    pthread_mutex_unlock( &_pool.lock );
+    pthread_mutex_unlock( &_poolOwner );
+    return 0;
+}
+
+/*
+ * Function:  enableThreadPool
+ * --------------------
+ *      enables (enable != 0) or disables running loops on pool of threads; while pool is disabled, every loop
+ *      starts threads for its parts and joins them before it returns (ex. counters of calling thread inheriting
+ *      counts of finished threads see all work of loop then)
+ *
+ */
+void enableThreadPool( int enable )
+{
+    __atomic_store_n( &_poolEnabled, enable != 0, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function:  parallelFor
+ * --------------------
+ *      splits range <0, count) into contiguous parts of equal length (but not shorter than minChunk) and calls
+ *      body for each of them on separate thread of pool; calling thread processes first part itself. Function
+ *      returns when all parts were processed. If pool is busy with another loop (called concurrently or from body
+ *      of loop) or disabled, threads are started only for this call; if thread can't be created, its part is
+ *      processed by calling thread
+ *
+ *      count:    number of elements to be processed
+ *      minChunk: minimal number of elements worth running separate thread for
+ *      body:     function processing range of elements
+ *      context:  pointer passed to body
+ *
+ */
+void parallelFor( long count, long minChunk, ParallelBody body, void *context )
+{
+    ParallelTask tasks[MAX_NUMBER_OF_THREADS];
+    pthread_t threads[MAX_NUMBER_OF_THREADS];
+    int started[MAX_NUMBER_OF_THREADS] = { 0 };
+    long workers = availableThreads();
+
+    if( count <= 0 )
+        return;
+    if( minChunk < 1 )
+        minChunk = 1;
+    if( workers > ( count + minChunk - 1 ) / minChunk )     // Don't start threads with too little work
+        workers = ( count + minChunk - 1 ) / minChunk;
+
+    for( int worker = 0; worker < workers; worker++ )
+    {
+        tasks[worker].body = body;
+        tasks[worker].context = context;
+        tasks[worker].begin = count * worker / workers;
+        tasks[worker].end = count * ( worker + 1 ) / workers;
+        tasks[worker].worker = worker;
+    }
+    if( workers == 1 )
+    {
+        _runTask( &tasks[0] );
+        return;
+    }
+    if( _runOnPool( tasks, ( int )workers ) == 0 )
+        return;
+
+    for( int worker = 1; worker < workers; worker++ )
+        started[worker] = pthread_create( &threads[worker], NULL, _runTask, &tasks[worker] ) == 0;
+    _runTask( &tasks[0] );                                  // Calling thread takes first part
+    for( int worker = 1; worker < workers; worker++ )
+    {
+        if( started[worker] )
+            pthread_join( threads[worker], NULL );
+        else                                                // Thread wasn't created - do its work here
+            _runTask( &tasks[worker] );
+    }
+}
+
+/*
+ * Function <private>:  _runDynamicLoop
+ * --------------------
+ *      body of every worker of parallelForDynamic - processes elements until none is left
+ *
+ */
+static void _runDynamicLoop( long begin, long end, int worker, void *context )
+{
+    DynamicLoop *loop = context;
+    long index;
+
+    while( ( index = __atomic_fetch_add( &loop->next, 1, __ATOMIC_RELAXED ) ) < loop->count )
+        loop->body( index, index + 1, worker, loop->context );
+}
+
+/*
+ * Function:  parallelForDynamic
+ * --------------------
+ *      calls body for every element of range <0, count) (one element at a time) on all available threads; unlike
+ *      parallelFor, elements are not split in advance, but every thread takes next element when it finishes
+ *      previous one, so elements taking very different time are still spread evenly
+ *
+ *      count:    number of elements to be processed
+ *      body:     function processing range of elements (always of length 1)
+ *      context:  pointer passed to body
+ *
+ */
+void parallelForDynamic( long count, ParallelBody body, void *context )
+{
+    DynamicLoop loop = { body, context, count, 0 };
+    const long workers = count < availableThreads() ? count : availableThreads();
+
+    parallelFor( workers, 1, _runDynamicLoop, &loop );     // One part per worker
+}
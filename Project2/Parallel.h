@@ -0,0 +1,32 @@
+/*
+ * File: Parallel.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file Parallel.c
+ */
+
+#ifndef PROJEKT2_PARALLEL_H
+#define PROJEKT2_PARALLEL_H
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define MAX_NUMBER_OF_THREADS   64          // Upper limit of threads used by parallelFor
+
+/************************************
+ * Type definitions
+ ************************************/
+// Function processing elements with indexes in range <begin, end); worker is index of thread calling it
+// (in range <0, availableThreads()) ), so it can be used to select per-thread buffers
+typedef void ( *ParallelBody )( long begin, long end, int worker, void *context );
+
+/************************************
+ * Function declarations
+ ************************************/
+int availableThreads( void );
+int pinParallelThreads( int enable );
+void enableThreadPool( int enable );
+void parallelFor( long count, long minChunk, ParallelBody body, void *context );
+void parallelForDynamic( long count, ParallelBody body, void *context );
+
+#endif //PROJEKT2_PARALLEL_H
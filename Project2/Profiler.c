@@ -0,0 +1,450 @@
+/*
+ * File: Profiler.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Measuring of operations on matrices - for every operation wall time, number of arithmetic operations,
+ *              memory of matrix elements allocated and freed and (optionally) hardware counters of processor are
+ *              summed. Counters of memory and hardware are global for the whole program, so calls of operations
+ *              running concurrently (on background) are charged with each other's allocations and cycles.
+ *              Profiling is disabled by default - then profileBegin and profileEnd return after one check of flag,
+ *              so the smallest operations aren't slowed down by measuring. While it's enabled, every thread sums
+ *              its calls in its own totals (no locked instructions on shared cache lines), which are added up
+ *              only when statistics are read
+ */
+
+#define _DEFAULT_SOURCE                         // syscall() is needed to call perf_event_open
+
+#include "Profiler.h"
+#include "Parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Hardware counters read by profiler
+enum HardwareCounter { COUNTER_CYCLES, COUNTER_CACHE_MISSES, NUMBER_OF_COUNTERS };
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Totals of operations measured by one thread - written only by that thread
+struct ThreadProfiles {
+    OperationProfile profiles[NUMBER_OF_PROFILED_OPERATIONS];
+    struct ThreadProfiles *next;                // Next thread on list of threads which measured some call
+};
+typedef struct ThreadProfiles ThreadProfiles;
+
+/************************************
+ * Global variables
+ ************************************/
+static const char *_operationNames[NUMBER_OF_PROFILED_OPERATIONS] = {
+    "sum", "difference", "product", "power", "determinant", "render"
+};
+static int _profilingEnabled;                                       // Calls are measured only while non-zero
+static pthread_once_t _threadKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t _threadKey;                                    // ThreadProfiles of calling thread
+static pthread_mutex_t _threadsLock = PTHREAD_MUTEX_INITIALIZER;    // Guards three variables below
+static ThreadProfiles *_threads;                                    // Totals of running threads
+static OperationProfile _finishedProfiles[NUMBER_OF_PROFILED_OPERATIONS];  // Totals of finished threads
+static OperationProfile _resetProfiles[NUMBER_OF_PROFILED_OPERATIONS];     // Totals when profiler was reset
+static long _bytesAllocated, _bytesFreed, _allocations, _frees;     // Totals of the whole program
+static int _counters[NUMBER_OF_COUNTERS] = { -1, -1 };              // Descriptors of hardware counters (-1 - closed)
+
+/*
+ * Function:  profileAllocation
+ * --------------------
+ *      records allocation of memory for matrix elements (only while profiling is enabled)
+ *
+ */
+void profileAllocation( size_t bytes )
+{
+    if( !__atomic_load_n( &_profilingEnabled, __ATOMIC_RELAXED ) )
+        return;
+    __atomic_add_fetch( &_bytesAllocated, ( long )bytes, __ATOMIC_RELAXED );
+    __atomic_add_fetch( &_allocations, 1, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function:  profileRelease
+ * --------------------
+ *      records freeing of memory recorded earlier by profileAllocation
+ *
+ */
+void profileRelease( size_t bytes )
+{
+    if( !__atomic_load_n( &_profilingEnabled, __ATOMIC_RELAXED ) )
+        return;
+    __atomic_add_fetch( &_bytesFreed, ( long )bytes, __ATOMIC_RELAXED );
+    __atomic_add_fetch( &_frees, 1, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function <private>:  _readCounter
+ * --------------------
+ *      returns current value of hardware counter or -1 if it is disabled (or can't be read)
+ *
+ */
+static long _readCounter( int counter )
+{
+    const int descriptor = __atomic_load_n( &_counters[counter], __ATOMIC_RELAXED );
+    long value;
+
+    if( descriptor == -1 || read( descriptor, &value, sizeof( value ) ) != sizeof( value ) )
+        return -1;
+    return value;
+}
+
+/*
+ * Function <private>:  _addProfiles
+ * --------------------
+ *      adds (sign = 1) or subtracts (sign = -1) all NUMBER_OF_PROFILED_OPERATIONS profiles to totals
+ *
+ */
+static void _addProfiles( OperationProfile *totals, const OperationProfile *profiles, long sign )
+{
+    for( int operation = 0; operation < NUMBER_OF_PROFILED_OPERATIONS; operation++ )
+    {
+        const OperationProfile *profile = &profiles[operation];
+        OperationProfile *total = &totals[operation];
+        total->calls += sign * __atomic_load_n( &profile->calls, __ATOMIC_RELAXED );
+        total->nanoseconds += sign * __atomic_load_n( &profile->nanoseconds, __ATOMIC_RELAXED );
+        total->flops += sign * __atomic_load_n( &profile->flops, __ATOMIC_RELAXED );
+        total->bytesAllocated += sign * __atomic_load_n( &profile->bytesAllocated, __ATOMIC_RELAXED );
+        total->bytesFreed += sign * __atomic_load_n( &profile->bytesFreed, __ATOMIC_RELAXED );
+        total->allocations += sign * __atomic_load_n( &profile->allocations, __ATOMIC_RELAXED );
+        total->frees += sign * __atomic_load_n( &profile->frees, __ATOMIC_RELAXED );
+        total->cycles += sign * __atomic_load_n( &profile->cycles, __ATOMIC_RELAXED );
+        total->cacheMisses += sign * __atomic_load_n( &profile->cacheMisses, __ATOMIC_RELAXED );
+    }
+}
+
+/*
+ * Function <private>:  _finishThread
+ * --------------------
+ *      adds totals of finishing thread to totals of finished threads and frees them (destructor of _threadKey)
+ *
+ */
+static void _finishThread( void *context )
+{
+    ThreadProfiles *own = context;
+
+    pthread_mutex_lock( &_threadsLock );
+    _addProfiles( _finishedProfiles, own->profiles, 1 );
+    ThreadProfiles **link = &_threads;
+    while( *link != own )
+        link = &( *link )->next;
+    *link = own->next;
+    pthread_mutex_unlock( &_threadsLock );
+    free( own );
+}
+
+/*
+ * Function <private>:  _createThreadKey
+ * --------------------
+ *      creates key of totals of threads (called once)
+ *
+ */
+static void _createThreadKey( void )
+{
+    pthread_key_create( &_threadKey, _finishThread );
+}
+
+/*
+ * Function <private>:  _threadProfiles
+ * --------------------
+ *      returns totals of calling thread, creating them at its first measured call
+ *
+ *      returns: pointer to totals, NULL on out of memory
+ *
+ */
+static ThreadProfiles* _threadProfiles( void )
+{
+    pthread_once( &_threadKeyOnce, _createThreadKey );
+    ThreadProfiles *own = pthread_getspecific( _threadKey );
+    if( own != NULL )
+        return own;
+
+    if( ( own = calloc( 1, sizeof( ThreadProfiles ) ) ) == NULL )
+        return NULL;
+    pthread_mutex_lock( &_threadsLock );
+    own->next = _threads;
+    _threads = own;
+    pthread_mutex_unlock( &_threadsLock );
+    pthread_setspecific( _threadKey, own );
+    return own;
+}
+
+/*
+ * Function <private>:  _accumulate
+ * --------------------
+ *      adds value to total owned by calling thread; other threads only read it, so no locked instruction is needed
+ *
+ */
+static void _accumulate( long *total, long value )
+{
+    __atomic_store_n( total, __atomic_load_n( total, __ATOMIC_RELAXED ) + value, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function:  enableProfiling
+ * --------------------
+ *      starts (enable != 0) or stops measuring of calls; only calls which start while profiling is enabled are
+ *      measured
+ *
+ */
+void enableProfiling( int enable )
+{
+    __atomic_store_n( &_profilingEnabled, enable != 0, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function:  profilingEnabled
+ * --------------------
+ *      returns non-zero if calls are measured
+ *
+ */
+int profilingEnabled( void )
+{
+    return __atomic_load_n( &_profilingEnabled, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function:  profileBegin
+ * --------------------
+ *      starts measuring one call of operation; if profiling is disabled, call isn't measured
+ *
+ *      scope:     structure storing state of measurement (usually local variable of measured function)
+ *      operation: measured operation (one of ProfiledOperation)
+ *
+ */
+void profileBegin( ProfileScope *scope, int operation )
+{
+    if( !__atomic_load_n( &_profilingEnabled, __ATOMIC_RELAXED ) )
+    {
+        scope->operation = -1;                                  // profileEnd won't record call
+        return;
+    }
+    scope->operation = operation;
+    scope->bytesAllocated = __atomic_load_n( &_bytesAllocated, __ATOMIC_RELAXED );
+    scope->bytesFreed = __atomic_load_n( &_bytesFreed, __ATOMIC_RELAXED );
+    scope->allocations = __atomic_load_n( &_allocations, __ATOMIC_RELAXED );
+    scope->frees = __atomic_load_n( &_frees, __ATOMIC_RELAXED );
+    scope->cycles = _readCounter( COUNTER_CYCLES );
+    scope->cacheMisses = _readCounter( COUNTER_CACHE_MISSES );
+    clock_gettime( CLOCK_MONOTONIC, &scope->start );
+}
+
+/*
+ * Function:  profileEnd
+ * --------------------
+ *      finishes measuring call of operation and adds its measurements to totals of operation
+ *
+ *      scope: structure passed to profileBegin
+ *      flops: number of arithmetic operations done by call
+ *
+ */
+void profileEnd( ProfileScope *scope, long flops )
+{
+    struct timespec now;
+
+    if( scope->operation == -1 )
+        return;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    const long cycles = _readCounter( COUNTER_CYCLES ), cacheMisses = _readCounter( COUNTER_CACHE_MISSES );
+    ThreadProfiles *own = _threadProfiles();
+    if( own == NULL )                                           // Call can't be recorded without memory
+        return;
+    OperationProfile *profile = &own->profiles[scope->operation];
+
+    _accumulate( &profile->calls, 1 );
+    _accumulate( &profile->nanoseconds, ( now.tv_sec - scope->start.tv_sec ) * 1000000000L
+                                        + ( now.tv_nsec - scope->start.tv_nsec ) );
+    _accumulate( &profile->flops, flops );
+    _accumulate( &profile->bytesAllocated,
+                 __atomic_load_n( &_bytesAllocated, __ATOMIC_RELAXED ) - scope->bytesAllocated );
+    _accumulate( &profile->bytesFreed, __atomic_load_n( &_bytesFreed, __ATOMIC_RELAXED ) - scope->bytesFreed );
+    _accumulate( &profile->allocations, __atomic_load_n( &_allocations, __ATOMIC_RELAXED ) - scope->allocations );
+    _accumulate( &profile->frees, __atomic_load_n( &_frees, __ATOMIC_RELAXED ) - scope->frees );
+    if( cycles != -1 && scope->cycles != -1 )                   // Counters were enabled during the whole call
+        _accumulate( &profile->cycles, cycles - scope->cycles );
+    if( cacheMisses != -1 && scope->cacheMisses != -1 )
+        _accumulate( &profile->cacheMisses, cacheMisses - scope->cacheMisses );
+}
+
+/*
+ * Function:  profiledOperationName
+ * --------------------
+ *      returns name of operation used in statistics
+ *
+ */
+const char* profiledOperationName( int operation )
+{
+    return _operationNames[operation];
+}
+
+/*
+ * Function <private>:  _sumProfiles
+ * --------------------
+ *      sums totals of all threads, running and finished, since program start (_threadsLock has to be held)
+ *
+ */
+static void _sumProfiles( OperationProfile *profiles )
+{
+    memcpy( profiles, _finishedProfiles, sizeof( _finishedProfiles ) );
+    for( const ThreadProfiles *thread = _threads; thread != NULL; thread = thread->next )
+        _addProfiles( profiles, thread->profiles, 1 );
+}
+
+/*
+ * Function:  getOperationProfiles
+ * --------------------
+ *      copies totals of all operations (of all threads since the last reset) to array of
+ *      NUMBER_OF_PROFILED_OPERATIONS profiles
+ *
+ */
+void getOperationProfiles( OperationProfile *profiles )
+{
+    pthread_mutex_lock( &_threadsLock );
+    _sumProfiles( profiles );
+    _addProfiles( profiles, _resetProfiles, -1 );
+    pthread_mutex_unlock( &_threadsLock );
+}
+
+/*
+ * Function:  resetProfiler
+ * --------------------
+ *      clears totals of all operations (calls finishing later are still added); totals of threads aren't
+ *      modified by other threads - current sums are remembered and subtracted when totals are read
+ *
+ */
+void resetProfiler( void )
+{
+    pthread_mutex_lock( &_threadsLock );
+    _sumProfiles( _resetProfiles );
+    pthread_mutex_unlock( &_threadsLock );
+}
+
+/*
+ * Function <private>:  _openCounter
+ * --------------------
+ *      opens hardware counter of given event, counting in user mode in calling thread and all threads created by
+ *      it later - counts of thread are added when it finishes, so threads of parallelFor are counted only when
+ *      they are created for every operation (see enableHardwareCounters)
+ *
+ *      returns: descriptor of counter, -1 if counters aren't supported or permitted
+ *
+ */
+static int _openCounter( unsigned long event )
+{
+#ifdef __linux__
+    struct perf_event_attr attributes;
+
+    memset( &attributes, 0, sizeof( attributes ) );
+    attributes.size = sizeof( attributes );
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.config = event;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.inherit = 1;                                     // Counts of finished threads are added to ours
+    return ( int )syscall( SYS_perf_event_open, &attributes, 0, -1, -1, 0 );
+#else
+    ( void )event;
+    return -1;
+#endif
+}
+
+/*
+ * Function:  enableHardwareCounters
+ * --------------------
+ *      opens (enable != 0) or closes hardware counters of cycles and last level cache misses; only calls which
+ *      start and finish while counters are enabled are counted. Threads of pool never finish, so while counters
+ *      are enabled, parallel loops don't use pool (see enableThreadPool)
+ *
+ *      returns: 0 on success, -1 if counters aren't available (kernel without perf events or not permitted by
+ *               /proc/sys/kernel/perf_event_paranoid)
+ *
+ */
+int enableHardwareCounters( int enable )
+{
+#ifdef __linux__
+    const unsigned long events[NUMBER_OF_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES };
+#else
+    const unsigned long events[NUMBER_OF_COUNTERS] = { 0, 0 };
+#endif
+    int descriptors[NUMBER_OF_COUNTERS];
+
+    for( int counter = 0; counter < NUMBER_OF_COUNTERS; counter++ )
+    {
+        const int old = __atomic_exchange_n( &_counters[counter], -1, __ATOMIC_RELAXED );
+        if( old != -1 )
+            close( old );
+    }
+    enableThreadPool( 1 );
+    if( !enable )
+        return 0;
+
+    for( int counter = 0; counter < NUMBER_OF_COUNTERS; counter++ )
+    {
+        descriptors[counter] = _openCounter( events[counter] );
+        if( descriptors[counter] == -1 )
+        {
+            for( int opened = 0; opened < counter; opened++ )
+                close( descriptors[opened] );
+            return -1;
+        }
+    }
+    enableThreadPool( 0 );
+    for( int counter = 0; counter < NUMBER_OF_COUNTERS; counter++ )
+        __atomic_store_n( &_counters[counter], descriptors[counter], __ATOMIC_RELAXED );
+    return 0;
+}
+
+/*
+ * Function:  hardwareCountersEnabled
+ * --------------------
+ *      returns non-zero if hardware counters are enabled
+ *
+ */
+int hardwareCountersEnabled( void )
+{
+    return __atomic_load_n( &_counters[COUNTER_CYCLES], __ATOMIC_RELAXED ) != -1;
+}
+
+/*
+ * Function:  writeProfileJson
+ * --------------------
+ *      writes totals of all operations as single-line JSON object:
+ *          {"profiling":BOOL,"hardwareCounters":BOOL,"operations":[{"name":NAME,"calls":N,"nanoseconds":N,"flops":N,
+ *          "bytesAllocated":N,"bytesFreed":N,"allocations":N,"frees":N,"cycles":N,"cacheMisses":N},...]}
+ *      cycles and cacheMisses are null when hardware counters are disabled
+ *
+ */
+void writeProfileJson( FILE *file )
+{
+    OperationProfile profiles[NUMBER_OF_PROFILED_OPERATIONS];
+    const int counters = hardwareCountersEnabled();
+
+    getOperationProfiles( profiles );
+    fprintf( file, "{\"profiling\":%s,\"hardwareCounters\":%s,\"operations\":[",
+             profilingEnabled() ? "true" : "false", counters ? "true" : "false" );
+    for( int operation = 0; operation < NUMBER_OF_PROFILED_OPERATIONS; operation++ )
+    {
+        const OperationProfile *profile = &profiles[operation];
+        fprintf( file, "%s{\"name\":\"%s\",\"calls\":%ld,\"nanoseconds\":%ld,\"flops\":%ld,\"bytesAllocated\":%ld,"
+                       "\"bytesFreed\":%ld,\"allocations\":%ld,\"frees\":%ld,", operation == 0 ? "" : ",",
+                 _operationNames[operation], profile->calls, profile->nanoseconds, profile->flops,
+                 profile->bytesAllocated, profile->bytesFreed, profile->allocations, profile->frees );
+        if( counters )
+            fprintf( file, "\"cycles\":%ld,\"cacheMisses\":%ld}", profile->cycles, profile->cacheMisses );
+        else
+            fprintf( file, "\"cycles\":null,\"cacheMisses\":null}" );
+    }
+    fprintf( file, "]}" );
+}
@@ -0,0 +1,63 @@
+/*
+ * File: Profiler.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file Profiler.c
+ */
+
+#ifndef PROJEKT2_PROFILER_H
+#define PROJEKT2_PROFILER_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Operations measured by profiler
+enum ProfiledOperation {
+    PROFILE_SUM, PROFILE_DIFFERENCE, PROFILE_PRODUCT, PROFILE_POWER, PROFILE_DETERMINANT, PROFILE_RENDER,
+    NUMBER_OF_PROFILED_OPERATIONS
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Totals of all finished calls of one operation
+struct OperationProfile {
+    long calls;
+    long nanoseconds;                           // Wall time
+    long flops;                                 // Arithmetic operations on elements done by algorithm
+    long bytesAllocated, bytesFreed;            // Memory of matrix elements allocated and freed during calls...
+    long allocations, frees;                    // ...and number of such allocations and frees
+    long cycles, cacheMisses;                   // Hardware counters (only while they are enabled)
+};
+typedef struct OperationProfile OperationProfile;
+
+// One measured call of operation - started with profileBegin and finished with profileEnd
+struct ProfileScope {
+    int operation;                                          // -1 if call isn't measured (profiling is disabled)
+    struct timespec start;
+    long bytesAllocated, bytesFreed, allocations, frees;    // Counters of the whole program at start
+    long cycles, cacheMisses;                               // Hardware counters at start (-1 if disabled)
+};
+typedef struct ProfileScope ProfileScope;
+
+/************************************
+ * Function declarations
+ ************************************/
+void enableProfiling( int enable );
+int profilingEnabled( void );
+void profileBegin( ProfileScope *scope, int operation );
+void profileEnd( ProfileScope *scope, long flops );
+void profileAllocation( size_t bytes );
+void profileRelease( size_t bytes );
+const char* profiledOperationName( int operation );
+void getOperationProfiles( OperationProfile *profiles );
+void resetProfiler( void );
+int enableHardwareCounters( int enable );
+int hardwareCountersEnabled( void );
+void writeProfileJson( FILE *file );
+
+#endif //PROJEKT2_PROFILER_H
@@ -0,0 +1,320 @@
+/*
+ * File: ResultCache.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Cache of results of matrix operations
+ */
+
+#include "ResultCache.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Function:  createResultCache
+ * --------------------
+ *      creates empty cache
+ *
+ *      budgetBytes: maximal amount of memory used by cached results
+ *      output:      pointer to memory where pointer to created cache should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createResultCache( size_t budgetBytes, ResultCache **output )
+{
+    ResultCache *cache = calloc( 1, sizeof( ResultCache ) );
+    if( cache == NULL )
+        return -1;
+
+    cache->budgetBytes = budgetBytes;
+    pthread_mutex_init( &cache->lock, NULL );
+    *output = cache;
+    return 0;
+}
+
+/*
+ * Function <private>:  _deleteEntry
+ * --------------------
+ *      frees memory occupied by entry (entry has to be already removed from list and hash table)
+ *
+ */
+static void _deleteEntry( CacheEntry *entry )
+{
+    deleteSquareMatrix( entry->matrix );
+    free( entry );
+}
+
+/*
+ * Function:  deleteResultCache
+ * --------------------
+ *      frees memory occupied by cache and all cached results
+ *
+ */
+void deleteResultCache( ResultCache *cache )
+{
+    if( cache == NULL )
+        return;
+
+    for( CacheEntry *entry = cache->newest, *older; entry != NULL; entry = older )
+    {
+        older = entry->older;
+        _deleteEntry( entry );
+    }
+    pthread_mutex_destroy( &cache->lock );
+    free( cache );
+}
+
+/*
+ * Function:  makeCacheKey
+ * --------------------
+ *      creates key identifying result of operation on given operands; since key contains content hashes of
+ *      operands, modifying matrix (which changes its version and so its hash) automatically makes results
+ *      computed for old content unreachable - they are evicted from cache as least recently used
+ *
+ *      operation:   one of CachedOperation values
+ *      m1, m2:      operands of operation (m2 can be NULL for unary operations)
+ *      parameter1, parameter2: additional parameters of operation (0 if not used)
+ *
+ */
+CacheKey makeCacheKey( int operation, Matrix *m1, Matrix *m2, long parameter1, long parameter2 )
+{
+    Matrix *operands[2] = { m1, m2 };
+    unsigned long hash[2];
+    CacheKey key;
+
+    memset( &key, 0, sizeof( key ) );                               // Clear padding - keys are compared with memcmp
+    key.operation = operation;
+    for( int i = 0; i < 2; i++ )
+        if( operands[i] != NULL )
+        {
+            hashSquareMatrix( operands[i], hash );
+            key.sizes[i] = operands[i]->size;
+            key.operands[i] = hash[0];
+            key.checks[i] = hash[1];
+        }
+    key.parameters[0] = parameter1;
+    key.parameters[1] = parameter2;
+    return key;
+}
+
+/*
+ * Function <private>:  _bucketOf
+ * --------------------
+ *      returns index of hash table bucket for key
+ *
+ */
+static size_t _bucketOf( const CacheKey *key )
+{
+    unsigned long hash = ( unsigned long )key->operation * 0x9E3779B97F4A7C15UL;
+    hash = ( hash ^ key->operands[0] ) * 0xBF58476D1CE4E5B9UL;
+    hash = ( hash ^ key->operands[1] ) * 0x94D049BB133111EBUL;
+    hash = ( hash ^ ( unsigned long )key->parameters[0] ) * 0xBF58476D1CE4E5B9UL;
+    hash = ( hash ^ ( unsigned long )key->parameters[1] ) * 0x94D049BB133111EBUL;
+    return ( hash ^ ( hash >> 32 ) ) & ( RESULT_CACHE_BUCKETS - 1 );
+}
+
+/*
+ * Function <private>:  _unlinkFromList
+ * --------------------
+ *      removes entry from LRU list
+ *
+ */
+static void _unlinkFromList( ResultCache *cache, CacheEntry *entry )
+{
+    if( entry->newer != NULL )
+        entry->newer->older = entry->older;
+    else
+        cache->newest = entry->older;
+    if( entry->older != NULL )
+        entry->older->newer = entry->newer;
+    else
+        cache->oldest = entry->newer;
+    entry->newer = entry->older = NULL;
+}
+
+/*
+ * Function <private>:  _pushNewest
+ * --------------------
+ *      puts entry at the beginning (most recently used end) of LRU list
+ *
+ */
+static void _pushNewest( ResultCache *cache, CacheEntry *entry )
+{
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if( cache->newest != NULL )
+        cache->newest->newer = entry;
+    cache->newest = entry;
+    if( cache->oldest == NULL )
+        cache->oldest = entry;
+}
+
+/*
+ * Function <private>:  _find
+ * --------------------
+ *      finds entry with given key (all its fields, including sizes and second hashes of operands, have to be
+ *      equal) and marks it as most recently used; updates statistics
+ *
+ *      returns: pointer to entry, NULL if there's no such entry
+ *
+ */
+static CacheEntry* _find( ResultCache *cache, const CacheKey *key )
+{
+    for( CacheEntry *entry = cache->buckets[_bucketOf( key )]; entry != NULL; entry = entry->nextInBucket )
+        if( memcmp( &entry->key, key, sizeof( CacheKey ) ) == 0 )
+        {
+            _unlinkFromList( cache, entry );
+            _pushNewest( cache, entry );
+            cache->hits++;
+            return entry;
+        }
+    cache->misses++;
+    return NULL;
+}
+
+/*
+ * Function <private>:  _evictOldest
+ * --------------------
+ *      removes least recently used entry from cache
+ *
+ */
+static void _evictOldest( ResultCache *cache )
+{
+    CacheEntry *entry = cache->oldest;
+    CacheEntry **link = &cache->buckets[_bucketOf( &entry->key )];
+
+    while( *link != entry )                                         // Find pointer to entry in its bucket
+        link = &( *link )->nextInBucket;
+    *link = entry->nextInBucket;
+
+    _unlinkFromList( cache, entry );
+    cache->usedBytes -= entry->bytes;
+    _deleteEntry( entry );
+}
+
+/*
+ * Function <private>:  _insert
+ * --------------------
+ *      inserts entry into cache, evicting least recently used entries until it fits in budget; if entry is
+ *      bigger than the whole budget (or result with the same key already exists), it is deleted instead
+ *
+ */
+static void _insert( ResultCache *cache, CacheEntry *entry )
+{
+    const size_t bucket = _bucketOf( &entry->key );
+
+    for( CacheEntry *existing = cache->buckets[bucket]; existing != NULL; existing = existing->nextInBucket )
+        if( memcmp( &existing->key, &entry->key, sizeof( CacheKey ) ) == 0 )
+        {
+            _deleteEntry( entry );
+            return;
+        }
+    if( entry->bytes > cache->budgetBytes )
+    {
+        _deleteEntry( entry );
+        return;
+    }
+
+    while( cache->usedBytes + entry->bytes > cache->budgetBytes )
+        _evictOldest( cache );
+
+    entry->nextInBucket = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    _pushNewest( cache, entry );
+    cache->usedBytes += entry->bytes;
+}
+
+/*
+ * Function:  cacheLookupScalar
+ * --------------------
+ *      looks for cached number being result of operation identified by key
+ *
+ *      result:  pointer to long integer where cached result should be stored
+ *
+ *      returns: 1 if result was found, 0 if not
+ *
+ */
+int cacheLookupScalar( ResultCache *cache, CacheKey key, long *result )
+{
+    pthread_mutex_lock( &cache->lock );
+    CacheEntry *entry = _find( cache, &key );
+    if( entry != NULL )
+        *result = entry->scalar;
+    pthread_mutex_unlock( &cache->lock );
+    return entry != NULL;
+}
+
+/*
+ * Function:  cacheLookupMatrix
+ * --------------------
+ *      looks for cached matrix being result of operation identified by key; caller gets its own copy-on-write
+ *      snapshot of result, so it can modify it freely
+ *
+ *      result:  pointer to memory where pointer to snapshot of cached matrix should be stored
+ *
+ *      returns: 1 if result was found, 0 if not (or there was no memory to create snapshot)
+ *
+ */
+int cacheLookupMatrix( ResultCache *cache, CacheKey key, Matrix **result )
+{
+    int found = 0;
+
+    pthread_mutex_lock( &cache->lock );
+    CacheEntry *entry = _find( cache, &key );
+    if( entry != NULL && entry->matrix != NULL && snapshotSquareMatrix( entry->matrix, result ) == 0 )
+        found = 1;
+    pthread_mutex_unlock( &cache->lock );
+    return found;
+}
+
+/*
+ * Function:  cacheStoreScalar
+ * --------------------
+ *      saves number being result of operation identified by key (nothing happens if there's no memory for it)
+ *
+ */
+void cacheStoreScalar( ResultCache *cache, CacheKey key, long result )
+{
+    CacheEntry *entry = calloc( 1, sizeof( CacheEntry ) );
+    if( entry == NULL )
+        return;
+
+    entry->key = key;
+    entry->scalar = result;
+    entry->bytes = sizeof( CacheEntry );
+
+    pthread_mutex_lock( &cache->lock );
+    _insert( cache, entry );
+    pthread_mutex_unlock( &cache->lock );
+}
+
+/*
+ * Function:  cacheStoreMatrix
+ * --------------------
+ *      saves snapshot of matrix being result of operation identified by key (nothing happens if there's no memory
+ *      for it or it is bigger than budget of cache); caller keeps ownership of result. Memory is accounted as if
+ *      result was copied, because snapshot keeps rows alive even after caller deletes result
+ *
+ */
+void cacheStoreMatrix( ResultCache *cache, CacheKey key, Matrix *result )
+{
+    const size_t bytes = sizeof( CacheEntry ) + sizeof( Matrix ) + sizeof( long* ) * ( size_t )result->size
+                         + sizeof( long ) * ( size_t )result->stride * ( size_t )result->size;
+    if( bytes > cache->budgetBytes )                                // Don't even copy it
+        return;
+
+    CacheEntry *entry = calloc( 1, sizeof( CacheEntry ) );
+    if( entry == NULL )
+        return;
+    if( snapshotSquareMatrix( result, &entry->matrix ) != 0 )
+    {
+        free( entry );
+        return;
+    }
+    entry->key = key;
+    entry->bytes = bytes;
+
+    pthread_mutex_lock( &cache->lock );
+    _insert( cache, entry );
+    pthread_mutex_unlock( &cache->lock );
+}
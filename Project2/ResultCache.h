@@ -0,0 +1,75 @@
+/*
+ * File: ResultCache.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file ResultCache.c
+ */
+
+#ifndef PROJEKT2_RESULTCACHE_H
+#define PROJEKT2_RESULTCACHE_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "SquareMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define RESULT_CACHE_BUCKETS    1024            // Number of buckets of hash table (power of two)
+
+/************************************
+ * Enums definitions
+ ************************************/
+// Operations whose results can be cached
+enum CachedOperation {
+    CACHED_DETERMINANT, CACHED_SUM, CACHED_SUB, CACHED_MULTIPLY, CACHED_POWER, CACHED_POWER_MOD
+};
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Identifies result: operation, sizes and content hashes of operands (0 if not used) and additional parameters;
+// whole key is compared on every hit, so result is returned only if both independent hashes of operands match
+struct CacheKey {
+    int operation;                              // One of CachedOperation values
+    int sizes[2];                               // Sizes of operands
+    unsigned long operands[2];                  // First hash of hashSquareMatrix of operands (selects bucket)...
+    unsigned long checks[2];                    // ...and the second one, which only confirms hit
+    long parameters[2];                         // Ex. exponent and modulus of power
+};
+typedef struct CacheKey CacheKey;
+
+// Cached result - either scalar or matrix
+struct CacheEntry {
+    CacheKey key;
+    long scalar;                                // Result of operations returning number
+    Matrix *matrix;                             // Result of operations returning matrix (NULL for scalar results)
+    size_t bytes;                               // Memory used by entry
+    struct CacheEntry *newer, *older;           // Neighbours on LRU list
+    struct CacheEntry *nextInBucket;            // Next entry with the same bucket in hash table
+};
+typedef struct CacheEntry CacheEntry;
+
+// Least-recently-used cache of operation results with limited memory budget; functions are thread safe
+struct ResultCache {
+    CacheEntry *buckets[RESULT_CACHE_BUCKETS];  // Hash table of entries
+    CacheEntry *newest, *oldest;                // Ends of LRU list
+    size_t usedBytes;                           // Memory used by all entries
+    size_t budgetBytes;                         // Maximal memory used by entries
+    long hits, misses;                          // Statistics
+    pthread_mutex_t lock;
+};
+typedef struct ResultCache ResultCache;
+
+/************************************
+ * Function declarations
+ ************************************/
+int createResultCache( size_t budgetBytes, ResultCache **output );
+void deleteResultCache( ResultCache *cache );
+CacheKey makeCacheKey( int operation, Matrix *m1, Matrix *m2, long parameter1, long parameter2 );
+int cacheLookupScalar( ResultCache *cache, CacheKey key, long *result );
+int cacheLookupMatrix( ResultCache *cache, CacheKey key, Matrix **result );
+void cacheStoreScalar( ResultCache *cache, CacheKey key, long result );
+void cacheStoreMatrix( ResultCache *cache, CacheKey key, Matrix *result );
+
+#endif //PROJEKT2_RESULTCACHE_H
@@ -0,0 +1,349 @@
+/*
+ * File: SmallMatrix.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Kernels of sum, difference, product, determinant and adjugate specialized for every size from
+ *              SMALL_MATRIX_MIN_SIZE to SMALL_MATRIX_MAX_SIZE. They are generated by macro SMALL_MATRIX_KERNELS, so
+ *              size is compile-time constant: loops are unrolled completely, temporaries live on stack (no memory
+ *              is allocated) and overflow flags are collected without branches. Public functions of SquareMatrix.c
+ *              dispatch to them automatically, but sum, difference and product still create result matrix on
+ *              heap, which costs more than the kernel itself. Callers which need the lowest latency of one call use
+ *              functions of this file (or multiplySquareMatrixInto) with preallocated output - they allocate
+ *              nothing and aren't measured by profiler
+ *
+ * Determinant and adjugate are computed from minors of the last rows: minor of k last rows and set of k columns
+ * (bit mask) is expansion of its first row along minors of k - 1 last rows, so all 2^n minors are computed once
+ * (n * 2^(n-1) multiplications instead of about e * n! of Laplace expansion). Laplace expansion along the first row
+ * multiplies and adds exactly the same minors, so both methods report overflow for the same matrices (except terms
+ * equal to LONG_MIN, whose negation silently wrapped around in Laplace expansion).
+ */
+
+#include "SmallMatrix.h"
+#include <string.h>
+#include <limits.h>
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define SMALL_UNROLL            _Pragma( "GCC unroll 8" )   // Unroll following loop over rows or columns completely
+#define SMALL_UNROLL_MASKS      _Pragma( "GCC unroll 64" )  // Unroll following loop over sets of columns completely
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Kernels of one size; matrices must have this size, output must be writable (see prepareMatrixForWrite) and may
+// be the same as input
+struct SmallMatrixKernels {
+    int ( *sum )( Matrix *m1, Matrix *m2, Matrix *output );
+    int ( *sub )( Matrix *m1, Matrix *m2, Matrix *output );
+    int ( *multiply )( Matrix *m1, Matrix *m2, Matrix *output );
+    int ( *determinant )( Matrix *matrix, long *result );
+    int ( *adjugate )( Matrix *matrix, Matrix *output, long *determinant );
+};
+typedef struct SmallMatrixKernels SmallMatrixKernels;
+
+/*
+ * Function <private>:  _absSmall
+ * --------------------
+ *      returns absolute value of long integer as unsigned long (also of LONG_MIN)
+ *
+ */
+static inline unsigned long _absSmall( long value )
+{
+    return value < 0 ? -( unsigned long )value : ( unsigned long )value;
+}
+
+/*
+ * Function <private>:  _sumSmall<N>, _subSmall<N>
+ * --------------------
+ *      compute output = m1 +/- m2 with wrap around, OR-ing overflow flags of all elements (as _addRowChecked)
+ *
+ *      returns: 0 on success, -3 if any element overflowed (output is written anyway)
+ *
+ * Function <private>:  _multiplySmall<N>
+ * --------------------
+ *      computes output = m1 * m2 from copies of inputs on stack; if n * max|m1| * max|m2| fits in long nothing can
+ *      overflow and products are summed in long, otherwise they are summed in __int128 with overflow flags
+ *
+ *      returns: 0 on success, -3 if any element doesn't fit in long integer
+ *
+ * Function <private>:  _minorsSmall<N>
+ * --------------------
+ *      computes minors[mask] - determinant of submatrix of columns from mask and as many last rows as there are
+ *      columns, omitting row skipRow (N - no row is omitted); masks having more bits than used rows are skipped
+ *
+ *      returns: non-zero if any multiplication or addition overflowed
+ *
+ * Function <private>:  _detSmall<N>
+ * --------------------
+ *      computes determinant as minor of all rows and columns
+ *
+ *      returns: 0 on success, -2 on long integer overflow
+ *
+ * Function <private>:  _adjugateSmall<N>
+ * --------------------
+ *      computes adjugate (transposed matrix of cofactors) - minors of all rows but i give cofactors of row i -
+ *      and determinant as expansion along the first row
+ *
+ *      returns: 0 on success, -2 on long integer overflow
+ *
+ */
+#define SMALL_MATRIX_KERNELS( N )                                                                                   \
+static int _sumSmall##N( Matrix *m1, Matrix *m2, Matrix *output )                                                   \
+{                                                                                                                   \
+    long overflowFlags = 0;                                                                                         \
+    SMALL_UNROLL                                                                                                    \
+    for( int row = 0; row < N; row++ )                                                                              \
+    {                                                                                                               \
+        const long *a = m1->elements[row], *b = m2->elements[row];                                                  \
+        long *c = output->elements[row];                                                                            \
+        SMALL_UNROLL                                                                                                \
+        for( int col = 0; col < N; col++ )                                                                          \
+        {                                                                                                           \
+            const long result = ( long )( ( unsigned long )a[col] + ( unsigned long )b[col] );                      \
+            overflowFlags |= ( a[col] ^ result ) & ( b[col] ^ result );                                             \
+            c[col] = result;                                                                                        \
+        }                                                                                                           \
+    }                                                                                                               \
+    return overflowFlags < 0 ? -3 : 0;                                                                              \
+}                                                                                                                   \
+                                                                                                                    \
+static int _subSmall##N( Matrix *m1, Matrix *m2, Matrix *output )                                                   \
+{                                                                                                                   \
+    long overflowFlags = 0;                                                                                         \
+    SMALL_UNROLL                                                                                                    \
+    for( int row = 0; row < N; row++ )                                                                              \
+    {                                                                                                               \
+        const long *a = m1->elements[row], *b = m2->elements[row];                                                  \
+        long *c = output->elements[row];                                                                            \
+        SMALL_UNROLL                                                                                                \
+        for( int col = 0; col < N; col++ )                                                                          \
+        {                                                                                                           \
+            const long result = ( long )( ( unsigned long )a[col] - ( unsigned long )b[col] );                      \
+            overflowFlags |= ( a[col] ^ b[col] ) & ( a[col] ^ result );                                             \
+            c[col] = result;                                                                                        \
+        }                                                                                                           \
+    }                                                                                                               \
+    return overflowFlags < 0 ? -3 : 0;                                                                              \
+}                                                                                                                   \
+                                                                                                                    \
+static int _multiplySmall##N( Matrix *m1, Matrix *m2, Matrix *output )                                              \
+{                                                                                                                   \
+    long a[N][N], b[N][N];                                                                                          \
+    unsigned long maxInA = 0, maxInB = 0, productBound, sumBound;                                                   \
+    int overflowed = 0;                                                                                             \
+                                                                                                                    \
+    SMALL_UNROLL                                                                                                    \
+    for( int row = 0; row < N; row++ )                                                                              \
+    {                                                                                                               \
+        memcpy( a[row], m1->elements[row], sizeof( a[row] ) );                                                      \
+        memcpy( b[row], m2->elements[row], sizeof( b[row] ) );                                                      \
+        SMALL_UNROLL                                                                                                \
+        for( int col = 0; col < N; col++ )                                                                          \
+        {                                                                                                           \
+            const unsigned long absA = _absSmall( a[row][col] ), absB = _absSmall( b[row][col] );                   \
+            maxInA = absA > maxInA ? absA : maxInA;                                                                 \
+            maxInB = absB > maxInB ? absB : maxInB;                                                                 \
+        }                                                                                                           \
+    }                                                                                                               \
+                                                                                                                    \
+    if( !__builtin_umull_overflow( maxInA, maxInB, &productBound )                                                  \
+        && !__builtin_umull_overflow( productBound, N, &sumBound ) && sumBound <= LONG_MAX )                        \
+    {                                                                                                               \
+        SMALL_UNROLL                                                                                                \
+        for( int row = 0; row < N; row++ )                                                                          \
+        {                                                                                                           \
+            long *c = output->elements[row];                                                                        \
+            SMALL_UNROLL                                                                                            \
+            for( int col = 0; col < N; col++ )                                                                      \
+            {                                                                                                       \
+                long sum = 0;                                                                                       \
+                SMALL_UNROLL                                                                                        \
+                for( int r = 0; r < N; r++ )                                                                        \
+                    sum += a[row][r] * b[r][col];                                                                   \
+                c[col] = sum;                                                                                       \
+            }                                                                                                       \
+        }                                                                                                           \
+        return 0;                                                                                                   \
+    }                                                                                                               \
+                                                                                                                    \
+    SMALL_UNROLL                                                                                                    \
+    for( int row = 0; row < N; row++ )                                                                              \
+    {                                                                                                               \
+        long *c = output->elements[row];                                                                            \
+        SMALL_UNROLL                                                                                                \
+        for( int col = 0; col < N; col++ )                                                                          \
+        {                                                                                                           \
+            __int128 sum = 0;                                                                                       \
+            SMALL_UNROLL                                                                                            \
+            for( int r = 0; r < N; r++ )                                                                            \
+                overflowed |= __builtin_add_overflow( sum, ( __int128 )a[row][r] * b[r][col], &sum );               \
+            overflowed |= ( sum > LONG_MAX ) | ( sum < LONG_MIN );                                                  \
+            c[col] = ( long )sum;                                                                                   \
+        }                                                                                                           \
+    }                                                                                                               \
+    return overflowed ? -3 : 0;                                                                                     \
+}                                                                                                                   \
+                                                                                                                    \
+static inline int _minorsSmall##N( long a[N][N], int skipRow, long minors[1 << N] )                                 \
+{                                                                                                                   \
+    const int usedRows = skipRow < N ? N - 1 : N;                                                                   \
+    int overflowed = 0;                                                                                             \
+                                                                                                                    \
+    minors[0] = 1;                                                                                                  \
+    SMALL_UNROLL_MASKS                                                                                              \
+    for( int mask = 1; mask < ( 1 << N ); mask++ )                                                                  \
+    {                                                                                                               \
+        const int columns = __builtin_popcount( mask );                                                             \
+        int row = usedRows - columns, odd = 0;                                                                      \
+        long sum = 0;                                                                                               \
+        if( columns > usedRows )                                                                                    \
+            continue;                                                                                               \
+        row += row >= skipRow;                                                                                      \
+        SMALL_UNROLL                                                                                                \
+        for( int col = 0; col < N; col++ )                                                                          \
+            if( mask & ( 1 << col ) )                                                                               \
+            {                                                                                                       \
+                long term;                                                                                          \
+                overflowed |= __builtin_mul_overflow( a[row][col], minors[mask ^ ( 1 << col )], &term );            \
+                overflowed |= odd ? __builtin_sub_overflow( sum, term, &sum )                                       \
+                                  : __builtin_add_overflow( sum, term, &sum );                                      \
+                odd ^= 1;                                                                                           \
+            }                                                                                                       \
+        minors[mask] = sum;                                                                                         \
+    }                                                                                                               \
+    return overflowed;                                                                                              \
+}                                                                                                                   \
+                                                                                                                    \
+static int _detSmall##N( Matrix *matrix, long *result )                                                             \
+{                                                                                                                   \
+    long a[N][N], minors[1 << N];                                                                                   \
+                                                                                                                    \
+    SMALL_UNROLL                                                                                                    \
+    for( int row = 0; row < N; row++ )                                                                              \
+        memcpy( a[row], matrix->elements[row], sizeof( a[row] ) );                                                  \
+    if( _minorsSmall##N( a, N, minors ) )                                                                           \
+        return -2;                                                                                                  \
+    *result = minors[( 1 << N ) - 1];                                                                               \
+    return 0;                                                                                                       \
+}                                                                                                                   \
+                                                                                                                    \
+static int _adjugateSmall##N( Matrix *matrix, Matrix *output, long *determinant )                                   \
+{                                                                                                                   \
+    long a[N][N], minors[1 << N], sum = 0;                                                                          \
+    int overflowed = 0;                                                                                             \
+                                                                                                                    \
+    SMALL_UNROLL                                                                                                    \
+    for( int row = 0; row < N; row++ )                                                                              \
+        memcpy( a[row], matrix->elements[row], sizeof( a[row] ) );                                                  \
+    for( int row = 0; row < N; row++ )                                                                              \
+    {                                                                                                               \
+        overflowed |= _minorsSmall##N( a, row, minors );                                                            \
+        SMALL_UNROLL                                                                                                \
+        for( int col = 0; col < N; col++ )                                                                          \
+        {                                                                                                           \
+            long cofactor = minors[( ( 1 << N ) - 1 ) ^ ( 1 << col )], term;                                        \
+            if( ( row + col ) % 2 == 1 )                                                                            \
+                overflowed |= __builtin_sub_overflow( 0L, cofactor, &cofactor );                                    \
+            output->elements[col][row] = cofactor;                                                                  \
+            if( row == 0 )                                                                                          \
+            {                                                                                                       \
+                overflowed |= __builtin_mul_overflow( a[0][col], cofactor, &term );                                 \
+                overflowed |= __builtin_add_overflow( sum, term, &sum );                                            \
+            }                                                                                                       \
+        }                                                                                                           \
+    }                                                                                                               \
+    *determinant = sum;                                                                                             \
+    return overflowed ? -2 : 0;                                                                                     \
+}
+
+#define SMALL_MATRIX_KERNEL_TABLE( N )                                                                              \
+    { _sumSmall##N, _subSmall##N, _multiplySmall##N, _detSmall##N, _adjugateSmall##N }
+
+SMALL_MATRIX_KERNELS( 2 )
+SMALL_MATRIX_KERNELS( 3 )
+SMALL_MATRIX_KERNELS( 4 )
+SMALL_MATRIX_KERNELS( 5 )
+SMALL_MATRIX_KERNELS( 6 )
+
+/************************************
+ * Global variables
+ ************************************/
+// Kernels indexed by size
+static const SmallMatrixKernels _kernels[SMALL_MATRIX_MAX_SIZE + 1] = {
+    [2] = SMALL_MATRIX_KERNEL_TABLE( 2 ),
+    [3] = SMALL_MATRIX_KERNEL_TABLE( 3 ),
+    [4] = SMALL_MATRIX_KERNEL_TABLE( 4 ),
+    [5] = SMALL_MATRIX_KERNEL_TABLE( 5 ),
+    [6] = SMALL_MATRIX_KERNEL_TABLE( 6 )
+};
+
+/*
+ * Function:  hasSmallMatrixKernels
+ * --------------------
+ *      returns non-zero if there are kernels specialized for matrices of given size
+ *
+ */
+int hasSmallMatrixKernels( int size )
+{
+    return size >= SMALL_MATRIX_MIN_SIZE && size <= SMALL_MATRIX_MAX_SIZE;
+}
+
+/*
+ * Functions:  (sum | sub)SmallMatrix
+ * --------------------
+ *      store m1 + m2 or m1 - m2 in output; all matrices must have the same size having kernels and output must be
+ *      writable (it can be the same as input)
+ *
+ *      returns: 0 on success, -3 on long integer overflow (output is written anyway)
+ *
+ */
+int sumSmallMatrix( Matrix *m1, Matrix *m2, Matrix *output )
+{
+    return _kernels[m1->size].sum( m1, m2, output );
+}
+
+int subSmallMatrix( Matrix *m1, Matrix *m2, Matrix *output )
+{
+    return _kernels[m1->size].sub( m1, m2, output );
+}
+
+/*
+ * Function:  multiplySmallMatrix
+ * --------------------
+ *      stores m1 * m2 in output (requirements as in sumSmallMatrix)
+ *
+ *      returns: 0 on success, -3 if any element of result doesn't fit in long integer
+ *
+ */
+int multiplySmallMatrix( Matrix *m1, Matrix *m2, Matrix *output )
+{
+    return _kernels[m1->size].multiply( m1, m2, output );
+}
+
+/*
+ * Function:  detSmallMatrix
+ * --------------------
+ *      calculates determinant of matrix of size having kernels
+ *
+ *      returns: 0 on success, -2 on long integer overflow
+ *
+ */
+int detSmallMatrix( Matrix *matrix, long *result )
+{
+    return _kernels[matrix->size].determinant( matrix, result );
+}
+
+/*
+ * Function:  adjugateSmallMatrix
+ * --------------------
+ *      stores adjugate of matrix (transposed matrix of cofactors) in output and its determinant in "determinant";
+ *      requirements as in sumSmallMatrix
+ *
+ *      returns: 0 on success, -2 on long integer overflow
+ *
+ */
+int adjugateSmallMatrix( Matrix *matrix, Matrix *output, long *determinant )
+{
+    return _kernels[matrix->size].adjugate( matrix, output, determinant );
+}
@@ -0,0 +1,29 @@
+/*
+ * File: SmallMatrix.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file SmallMatrix.c
+ */
+
+#ifndef PROJEKT2_SMALLMATRIX_H
+#define PROJEKT2_SMALLMATRIX_H
+
+#include "SquareMatrix.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define SMALL_MATRIX_MIN_SIZE   2                   // Sizes having kernels specialized at compile time...
+#define SMALL_MATRIX_MAX_SIZE   6                   // ...up to the biggest matrix edited interactively (MAX_NUMBER_OF_ROWS)
+
+/************************************
+ * Function declarations
+ ************************************/
+int hasSmallMatrixKernels( int size );
+int sumSmallMatrix( Matrix *m1, Matrix *m2, Matrix *output );
+int subSmallMatrix( Matrix *m1, Matrix *m2, Matrix *output );
+int multiplySmallMatrix( Matrix *m1, Matrix *m2, Matrix *output );
+int detSmallMatrix( Matrix *matrix, long *result );
+int adjugateSmallMatrix( Matrix *matrix, Matrix *output, long *determinant );
+
+#endif //PROJEKT2_SMALLMATRIX_H
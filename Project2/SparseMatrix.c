@@ -0,0 +1,583 @@
+/*
+ * File: SparseMatrix.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Implementation of sparse (CSR) matrices and operations on them
+ */
+
+#include "SparseMatrix.h"
+#include "Parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Context shared by threads converting dense matrix to sparse one
+struct ConversionContext {
+    Matrix *dense;
+    SparseMatrix *sparse;
+    long *rowCounts;                                // Number of non-zero elements in each row (first pass)
+};
+typedef struct ConversionContext ConversionContext;
+
+// Context shared by threads multiplying sparse matrix by vector
+struct VectorContext {
+    SparseMatrix *matrix;
+    const long *vector;
+    long *output;
+    int productFits;                                // Every product of element and vector fits in 64 bits
+    int errors[MAX_NUMBER_OF_THREADS];              // Error code found by each worker
+};
+typedef struct VectorContext VectorContext;
+
+// Context shared by threads multiplying sparse matrices
+struct ProductContext {
+    SparseMatrix *m1;
+    SparseMatrix *m2;
+    SparseMatrix *output;
+    long *rowCounts;                                // Upper bound (first pass), then real number of elements in row
+    int productFits;                                // Every product of elements of m1 and m2 fits in 64 bits
+    int errors[MAX_NUMBER_OF_THREADS];              // Error code found by each worker
+};
+typedef struct ProductContext ProductContext;
+
+/*
+ * Function:  createSparseMatrix
+ * --------------------
+ *      allocates memory on heap for sparse matrix able to store "nonZeros" elements; all rows are empty
+ *
+ *      size:      number of cols|rows
+ *      nonZeros:  number of elements that will be stored
+ *      output:    pointer to memory where pointer to structure should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createSparseMatrix( int size, long nonZeros, SparseMatrix **output )
+{
+    SparseMatrix *matrix = malloc( sizeof( SparseMatrix ) );
+    if( matrix == NULL )
+        return -1;
+
+    matrix->size = size;
+    matrix->nonZeros = nonZeros;
+    matrix->rowOffsets = calloc( ( size_t )size + 1, sizeof( long ) );
+    // Always allocate at least one element - malloc( 0 ) may return NULL
+    matrix->columns = malloc( sizeof( int ) * ( size_t )( nonZeros > 0 ? nonZeros : 1 ) );
+    matrix->values = malloc( sizeof( long ) * ( size_t )( nonZeros > 0 ? nonZeros : 1 ) );
+    if( matrix->rowOffsets == NULL || matrix->columns == NULL || matrix->values == NULL )
+    {
+        deleteSparseMatrix( matrix );
+        return -1;
+    }
+
+    *output = matrix;
+    return 0;
+}
+
+/*
+ * Function:  deleteSparseMatrix
+ * --------------------
+ *      frees memory occupied by sparse matrix
+ *
+ */
+void deleteSparseMatrix( SparseMatrix *matrix )
+{
+    if( matrix == NULL )
+        return;
+
+    free( matrix->rowOffsets );
+    free( matrix->columns );
+    free( matrix->values );
+    free( matrix );
+}
+
+/*
+ * Function <private>:  _prefixSum
+ * --------------------
+ *      sets offsets[r] to sum of counts[0..r-1] for r in <0, size>
+ *
+ *      returns: sum of all counts
+ *
+ */
+static long _prefixSum( const long *counts, long *offsets, int size )
+{
+    offsets[0] = 0;
+    for( int row = 0; row < size; row++ )
+        offsets[row + 1] = offsets[row] + counts[row];
+    return offsets[size];
+}
+
+/*
+ * Functions <private>:  _countNonZeros, _fillNonZeros
+ * --------------------
+ *      ParallelBodies of both passes of conversion from dense matrix: counting non-zero elements in rows and
+ *      copying them to already allocated sparse matrix
+ *
+ */
+static void _countNonZeros( long begin, long end, int worker, void *argument )
+{
+    ConversionContext *context = argument;
+    for( long row = begin; row < end; row++ )
+    {
+        long count = 0;
+        for( int col = 0; col < context->dense->size; col++ )
+            count += context->dense->elements[row][col] != 0;
+        context->rowCounts[row] = count;
+    }
+}
+
+static void _fillNonZeros( long begin, long end, int worker, void *argument )
+{
+    ConversionContext *context = argument;
+    for( long row = begin; row < end; row++ )
+    {
+        long position = context->sparse->rowOffsets[row];
+        for( int col = 0; col < context->dense->size; col++ )
+            if( context->dense->elements[row][col] != 0 )
+            {
+                context->sparse->columns[position] = col;
+                context->sparse->values[position++] = context->dense->elements[row][col];
+            }
+    }
+}
+
+/*
+ * Function:  denseToSparseMatrix
+ * --------------------
+ *      creates sparse matrix containing non-zero elements of dense matrix; rows are processed in parallel
+ *
+ *      input:   pointer to Matrix structure
+ *      output:  pointer to memory where pointer to created sparse matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int denseToSparseMatrix( Matrix *input, SparseMatrix **output )
+{
+    ConversionContext context = { input, NULL, NULL };
+    long *offsets;
+
+    context.rowCounts = malloc( sizeof( long ) * ( ( size_t )input->size + 1 ) );
+    offsets = malloc( sizeof( long ) * ( ( size_t )input->size + 1 ) );
+    if( context.rowCounts == NULL || offsets == NULL )
+    {
+        free( context.rowCounts );
+        free( offsets );
+        return -1;
+    }
+
+    parallelFor( input->size, 64, _countNonZeros, &context );
+    long nonZeros = _prefixSum( context.rowCounts, offsets, input->size );
+    free( context.rowCounts );
+
+    if( createSparseMatrix( input->size, nonZeros, &context.sparse ) != 0 )
+    {
+        free( offsets );
+        return -1;
+    }
+    free( context.sparse->rowOffsets );                                 // Use already computed offsets
+    context.sparse->rowOffsets = offsets;
+
+    parallelFor( input->size, 64, _fillNonZeros, &context );
+    *output = context.sparse;
+    return 0;
+}
+
+/*
+ * Function:  sparseToDenseMatrix
+ * --------------------
+ *      creates dense matrix with the same elements as sparse matrix
+ *
+ *      input:   pointer to SparseMatrix structure
+ *      output:  pointer to memory where pointer to created matrix should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int sparseToDenseMatrix( SparseMatrix *input, Matrix **output )
+{
+    if( createSquareMatrix( input->size, output ) != 0 )
+        return -1;
+
+    for( int row = 0; row < input->size; row++ )                        // Created matrix is filled with zeros
+        for( long i = input->rowOffsets[row]; i < input->rowOffsets[row + 1]; i++ )
+            ( *output )->elements[row][input->columns[i]] = input->values[i];
+    return 0;
+}
+
+/*
+ * Function <private>:  _productFits
+ * --------------------
+ *      checks if product of any element of first array and any element of second array fits in 64 bits (its
+ *      absolute value); then sum of less than 2^63 such products fits in __int128 and needs no checks
+ *
+ */
+static int _productFits( const long *first, long firstCount, const long *second, long secondCount )
+{
+    unsigned long maxFirst = 0, maxSecond = 0, bound;
+
+    for( long i = 0; i < firstCount; i++ )
+    {
+        const unsigned long absolute = first[i] < 0 ? -( unsigned long )first[i] : ( unsigned long )first[i];
+        maxFirst = absolute > maxFirst ? absolute : maxFirst;
+    }
+    for( long i = 0; i < secondCount; i++ )
+    {
+        const unsigned long absolute = second[i] < 0 ? -( unsigned long )second[i] : ( unsigned long )second[i];
+        maxSecond = absolute > maxSecond ? absolute : maxSecond;
+    }
+    return !__builtin_umull_overflow( maxFirst, maxSecond, &bound );
+}
+
+/*
+ * Function <private>:  _multiplyRowsByVector
+ * --------------------
+ *      ParallelBody computing rows <begin, end) of product of sparse matrix and vector; every row is accumulated
+ *      in __int128 and its range is checked once - unless products may not fit in 64 bits, then every addition
+ *      is checked (the same tiers as in dense multiplication)
+ *
+ */
+static void _multiplyRowsByVector( long begin, long end, int worker, void *argument )
+{
+    VectorContext *context = argument;
+    const SparseMatrix *matrix = context->matrix;
+
+    for( long row = begin; row < end; row++ )
+    {
+        __int128 sum = 0;
+        if( context->productFits )
+            for( long i = matrix->rowOffsets[row]; i < matrix->rowOffsets[row + 1]; i++ )
+                sum += ( __int128 )matrix->values[i] * context->vector[matrix->columns[i]];
+        else
+            for( long i = matrix->rowOffsets[row]; i < matrix->rowOffsets[row + 1]; i++ )
+                if( __builtin_add_overflow( sum, ( __int128 )matrix->values[i] * context->vector[matrix->columns[i]],
+                                            &sum ) )
+                {
+                    context->errors[worker] = -3;
+                    break;
+                }
+        if( sum > LONG_MAX || sum < LONG_MIN )
+            context->errors[worker] = -3;
+        context->output[row] = ( long )sum;
+    }
+}
+
+/*
+ * Function:  multiplySparseMatrixByVector
+ * --------------------
+ *      computes output = matrix * vector (SpMV); rows are processed in parallel. Cost is proportional to number
+ *      of non-zero elements
+ *
+ *      matrix:  pointer to SparseMatrix structure
+ *      vector:  array of matrix->size elements
+ *      output:  array of matrix->size elements where result should be stored (can't be the same as vector)
+ *
+ *      returns: 0 on success, -3 on long integer overflow
+ *
+ */
+int multiplySparseMatrixByVector( SparseMatrix *matrix, const long *vector, long *output )
+{
+    VectorContext context = { matrix, vector, output, 0, { 0 } };
+
+    context.productFits = _productFits( matrix->values, matrix->rowOffsets[matrix->size], vector, matrix->size );
+
+    // Split by rows, but don't start thread for less than about 64k multiplications
+    long rowsPerChunk = matrix->size > 0 ? 65536 / ( matrix->nonZeros / matrix->size + 1 ) : 1;
+    parallelFor( matrix->size, rowsPerChunk, _multiplyRowsByVector, &context );
+
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+        if( context.errors[worker] != 0 )
+            return context.errors[worker];
+    return 0;
+}
+
+/*
+ * Function <private>:  _sumSparseMatrix
+ * --------------------
+ *      computes m1 + sign * m2 by merging sorted rows of both matrices; elements which sum to zero are not stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on overflow
+ *
+ */
+static int _sumSparseMatrix( SparseMatrix *m1, SparseMatrix *m2, int sign, SparseMatrix **output )
+{
+    SparseMatrix *result;
+    long position = 0;
+
+    if( m1->size != m2->size )
+        return -2;
+    // Result can't have more elements than both matrices together - extra memory is released at the end
+    if( createSparseMatrix( m1->size, m1->nonZeros + m2->nonZeros, &result ) != 0 )
+        return -1;
+
+    for( int row = 0; row < m1->size; row++ )
+    {
+        long i = m1->rowOffsets[row], j = m2->rowOffsets[row];
+        const long iEnd = m1->rowOffsets[row + 1], jEnd = m2->rowOffsets[row + 1];
+
+        while( i < iEnd || j < jEnd )
+        {
+            long value;
+            int col;
+            if( j == jEnd || ( i < iEnd && m1->columns[i] < m2->columns[j] ) )   // Element only in m1
+            {
+                col = m1->columns[i];
+                value = m1->values[i++];
+            } else if( i == iEnd || m2->columns[j] < m1->columns[i] )             // Element only in m2
+            {
+                col = m2->columns[j];
+                if( __builtin_smull_overflow( m2->values[j++], sign, &value ) )
+                {
+                    deleteSparseMatrix( result );
+                    return -3;
+                }
+            } else                                                                // Element in both
+            {
+                col = m1->columns[i];
+                if( sign > 0 ? __builtin_saddl_overflow( m1->values[i], m2->values[j], &value )
+                             : __builtin_ssubl_overflow( m1->values[i], m2->values[j], &value ) )
+                {
+                    deleteSparseMatrix( result );
+                    return -3;
+                }
+                i++, j++;
+            }
+
+            if( value != 0 )
+            {
+                result->columns[position] = col;
+                result->values[position++] = value;
+            }
+        }
+        result->rowOffsets[row + 1] = position;
+    }
+
+    result->nonZeros = position;
+    if( position > 0 )                                                  // Shrinking can't fail in practice
+    {
+        int *columns = realloc( result->columns, sizeof( int ) * ( size_t )position );
+        long *values = realloc( result->values, sizeof( long ) * ( size_t )position );
+        result->columns = columns != NULL ? columns : result->columns;
+        result->values = values != NULL ? values : result->values;
+    }
+    *output = result;
+    return 0;
+}
+
+/*
+ * Functions:  (sum | sub)SparseMatrix
+ * --------------------
+ *      creates sparse matrix being sum (or difference) of sparse matrices being arguments
+ *
+ *      m1:      pointer to first SparseMatrix structure
+ *      m2:      pointer to second SparseMatrix structure
+ *      output:  pointer to memory where pointer to result should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on long overflow
+ *
+ */
+int sumSparseMatrix( SparseMatrix *m1, SparseMatrix *m2, SparseMatrix **output )
+{
+    return _sumSparseMatrix( m1, m2, 1, output );
+}
+
+int subSparseMatrix( SparseMatrix *m1, SparseMatrix *m2, SparseMatrix **output )
+{
+    return _sumSparseMatrix( m1, m2, -1, output );
+}
+
+/*
+ * Function <private>:  _countProductRows
+ * --------------------
+ *      ParallelBody of first (symbolic) pass of sparse matrix multiplication: counts distinct columns which appear
+ *      in rows <begin, end) of product, using per-thread array of markers (marker[col] == row if col was seen)
+ *
+ */
+static void _countProductRows( long begin, long end, int worker, void *argument )
+{
+    ProductContext *context = argument;
+    const SparseMatrix *m1 = context->m1, *m2 = context->m2;
+    long *marker = malloc( sizeof( long ) * ( size_t )( m2->size > 0 ? m2->size : 1 ) );
+
+    if( marker == NULL )
+    {
+        context->errors[worker] = -1;
+        return;
+    }
+    for( int col = 0; col < m2->size; col++ )
+        marker[col] = -1;
+
+    for( long row = begin; row < end; row++ )
+    {
+        long count = 0;
+        for( long i = m1->rowOffsets[row]; i < m1->rowOffsets[row + 1]; i++ )
+        {
+            const int r = m1->columns[i];
+            for( long j = m2->rowOffsets[r]; j < m2->rowOffsets[r + 1]; j++ )
+                if( marker[m2->columns[j]] != row )
+                {
+                    marker[m2->columns[j]] = row;
+                    count++;
+                }
+        }
+        context->rowCounts[row] = count;
+    }
+    free( marker );
+}
+
+/*
+ * Function <private>:  _compareColumns
+ * --------------------
+ *      comparator of column numbers used by qsort
+ *
+ */
+static int _compareColumns( const void *a, const void *b )
+{
+    return *( const int* )a - *( const int* )b;
+}
+
+/*
+ * Function <private>:  _computeProductRows
+ * --------------------
+ *      ParallelBody of second (numeric) pass of sparse matrix multiplication (Gustavson's algorithm): for each row
+ *      of m1, rows of m2 scaled by its elements are accumulated in per-thread dense array of __int128, touched
+ *      columns are remembered, sorted and copied to output (skipping elements which summed to zero). Number of
+ *      stored elements of each row replaces its upper bound in rowCounts. If every product of elements fits in
+ *      64 bits, range of accumulated elements is checked once at the end of row, otherwise every addition is checked
+ *
+ */
+static void _computeProductRows( long begin, long end, int worker, void *argument )
+{
+    ProductContext *context = argument;
+    const SparseMatrix *m1 = context->m1, *m2 = context->m2;
+    const size_t size = ( size_t )( m2->size > 0 ? m2->size : 1 );
+    __int128 *accumulator = malloc( sizeof( __int128 ) * size );
+    long *marker = malloc( sizeof( long ) * size );
+    int *touched = malloc( sizeof( int ) * size );
+
+    if( accumulator == NULL || marker == NULL || touched == NULL )
+    {
+        context->errors[worker] = -1;
+        free( accumulator ), free( marker ), free( touched );
+        return;
+    }
+    for( int col = 0; col < m2->size; col++ )
+        marker[col] = -1;
+
+    for( long row = begin; row < end && context->errors[worker] == 0; row++ )
+    {
+        int touchedCount = 0;
+        for( long i = m1->rowOffsets[row]; i < m1->rowOffsets[row + 1]; i++ )
+        {
+            const int r = m1->columns[i];
+            const __int128 a = m1->values[i];
+            for( long j = m2->rowOffsets[r]; j < m2->rowOffsets[r + 1]; j++ )
+            {
+                const int col = m2->columns[j];
+                if( marker[col] != row )                                // First contribution to this column
+                {
+                    marker[col] = row;
+                    accumulator[col] = 0;
+                    touched[touchedCount++] = col;
+                }
+                // Every product fits in __int128; sum of less than 2^63 products fitting in 64 bits fits as well
+                if( context->productFits )
+                    accumulator[col] += a * m2->values[j];
+                else if( __builtin_add_overflow( accumulator[col], a * m2->values[j], &accumulator[col] ) )
+                    context->errors[worker] = -3;
+            }
+        }
+
+        qsort( touched, ( size_t )touchedCount, sizeof( int ), _compareColumns );
+
+        long position = context->output->rowOffsets[row];
+        for( int t = 0; t < touchedCount; t++ )
+        {
+            const __int128 value = accumulator[touched[t]];
+            if( value > LONG_MAX || value < LONG_MIN )
+                context->errors[worker] = -3;
+            if( value != 0 )
+            {
+                context->output->columns[position] = touched[t];
+                context->output->values[position++] = ( long )value;
+            }
+        }
+        context->rowCounts[row] = position - context->output->rowOffsets[row];
+    }
+
+    free( accumulator ), free( marker ), free( touched );
+}
+
+/*
+ * Function:  multiplySparseMatrix
+ * --------------------
+ *      creates sparse matrix being product of sparse matrices (SpGEMM); work and memory are proportional to number
+ *      of multiplied non-zero pairs, not to size^3. Rows of result are computed in parallel in two passes:
+ *      symbolic (counting elements of each row to allocate result) and numeric
+ *
+ *      m1:      pointer to first SparseMatrix structure
+ *      m2:      pointer to second SparseMatrix structure
+ *      output:  pointer to memory where pointer to result should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on long overflow
+ *
+ */
+int multiplySparseMatrix( SparseMatrix *m1, SparseMatrix *m2, SparseMatrix **output )
+{
+    ProductContext context = { m1, m2, NULL, NULL, 0, { 0 } };
+    int errorCode = 0;
+
+    if( m1->size != m2->size )
+        return -2;
+    context.productFits = _productFits( m1->values, m1->rowOffsets[m1->size], m2->values, m2->rowOffsets[m2->size] );
+
+    context.rowCounts = malloc( sizeof( long ) * ( ( size_t )m1->size + 1 ) );
+    if( context.rowCounts == NULL )
+        return -1;
+
+    // Split by rows; symbolic and numeric pass use the same split so every thread has similar amount of work
+    const long rowsPerChunk = 64;
+    parallelFor( m1->size, rowsPerChunk, _countProductRows, &context );
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+        errorCode = context.errors[worker] != 0 ? context.errors[worker] : errorCode;
+
+    long upperBound = 0;
+    for( int row = 0; row < m1->size; row++ )
+        upperBound += context.rowCounts[row];
+
+    if( errorCode == 0 && createSparseMatrix( m1->size, upperBound, &context.output ) != 0 )
+        errorCode = -1;
+    if( errorCode == 0 )
+    {
+        _prefixSum( context.rowCounts, context.output->rowOffsets, m1->size );
+        parallelFor( m1->size, rowsPerChunk, _computeProductRows, &context );
+        for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+            errorCode = context.errors[worker] != 0 ? context.errors[worker] : errorCode;
+    }
+
+    if( errorCode == 0 )
+    {
+        // Remove gaps left by elements which summed to zero - rows only move towards beginning
+        long position = 0;
+        for( int row = 0; row < m1->size; row++ )
+        {
+            const long start = context.output->rowOffsets[row];
+            memmove( context.output->columns + position, context.output->columns + start,
+                     sizeof( int ) * ( size_t )context.rowCounts[row] );
+            memmove( context.output->values + position, context.output->values + start,
+                     sizeof( long ) * ( size_t )context.rowCounts[row] );
+            context.output->rowOffsets[row] = position;
+            position += context.rowCounts[row];
+        }
+        context.output->rowOffsets[m1->size] = position;
+        context.output->nonZeros = position;
+        *output = context.output;
+    } else
+        deleteSparseMatrix( context.output );
+
+    free( context.rowCounts );
+    return errorCode;
+}
@@ -0,0 +1,39 @@
+/*
+ * File: SparseMatrix.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file SparseMatrix.c
+ */
+
+#ifndef PROJEKT2_SPARSEMATRIX_H
+#define PROJEKT2_SPARSEMATRIX_H
+
+#include "SquareMatrix.h"
+
+/************************************
+ * Structure declarations
+ ************************************/
+// Square matrix in compressed sparse row (CSR) format: non-zero elements of row r are values[i] for
+// i in <rowOffsets[r], rowOffsets[r + 1]), placed in columns columns[i] (sorted ascending within each row)
+struct SparseMatrix {
+    int size;               // Number of rows|cols
+    long nonZeros;          // Number of stored (non-zero) elements
+    long *rowOffsets;       // Array of size + 1 offsets of rows in arrays "columns" and "values"
+    int *columns;           // Column of each stored element
+    long *values;           // Value of each stored element
+};
+typedef struct SparseMatrix SparseMatrix;
+
+/************************************
+ * Function declarations
+ ************************************/
+int createSparseMatrix( int size, long nonZeros, SparseMatrix **output );
+void deleteSparseMatrix( SparseMatrix *matrix );
+int denseToSparseMatrix( Matrix *input, SparseMatrix **output );
+int sparseToDenseMatrix( SparseMatrix *input, Matrix **output );
+int multiplySparseMatrixByVector( SparseMatrix *matrix, const long *vector, long *output );
+int sumSparseMatrix( SparseMatrix *m1, SparseMatrix *m2, SparseMatrix **output );
+int subSparseMatrix( SparseMatrix *m1, SparseMatrix *m2, SparseMatrix **output );
+int multiplySparseMatrix( SparseMatrix *m1, SparseMatrix *m2, SparseMatrix **output );
+
+#endif //PROJEKT2_SPARSEMATRIX_H
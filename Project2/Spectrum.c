@@ -0,0 +1,837 @@
+/*
+ * File: Spectrum.c
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Characteristic polynomial (exact - computed modulo primes and reconstructed as integers of arbitrary
+ *              size) and eigenvalues (in floating point arithmetic) of square matrices
+ */
+
+#include "Spectrum.h"
+#include "ModularMatrix.h"
+#include "Parallel.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+/************************************
+ * Characteristic polynomial
+ ************************************/
+// Context shared by threads computing characteristic polynomial modulo primes
+struct ResidueContext {
+    Matrix *matrix;
+    const long *primes;
+    unsigned int *residues;                         // Coefficients modulo primes[i] start at index i * (size + 1)
+    OperationControl *control;
+    int errors[MAX_NUMBER_OF_THREADS];              // Error code found by each worker
+};
+typedef struct ResidueContext ResidueContext;
+
+/*
+ * Function <private>:  _coefficientBits
+ * --------------------
+ *      returns number of bits enough for absolute value of every coefficient of characteristic polynomial.
+ *      Coefficient of x^(n - k) is (up to sign) sum of principal minors of size k and by Hadamard's inequality every
+ *      minor is at most product of norms of its rows, so all these sums are bounded by product of (1 + norm of row)
+ *
+ */
+static double _coefficientBits( Matrix *matrix )
+{
+    double bits = 0.0;
+
+    for( int row = 0; row < matrix->size; row++ )
+    {
+        double norm = 0.0;
+        for( int col = 0; col < matrix->size; col++ )
+        {
+            const double element = ( double )matrix->elements[row][col];
+            norm += element * element;
+        }
+        bits += log2( 1.0 + sqrt( norm ) );
+    }
+    return bits;
+}
+
+/*
+ * Function <private>:  _choosePrimes
+ * --------------------
+ *      returns array of the greatest primes accepted by ModularMatrix (in descending order) whose product exceeds
+ *      2^(bits + 2), so that every integer of absolute value below 2^bits is determined by its residues
+ *
+ *      count: number of primes in array
+ *
+ *      returns: array of primes (to be freed with free) or NULL on out of memory
+ *
+ */
+static long* _choosePrimes( double bits, int *count )
+{
+    long *primes = NULL;
+    double productBits = 0.0;
+    int capacity = 0;
+
+    *count = 0;
+    for( long candidate = MODULAR_MAX_MODULUS; productBits < bits + 2.0; candidate -= 2 )
+    {
+        if( !isValidModulus( candidate ) )
+            continue;
+        if( *count == capacity )
+        {
+            capacity = capacity == 0 ? 16 : capacity * 2;
+            long *resized = realloc( primes, sizeof( long ) * ( size_t )capacity );
+            if( resized == NULL )
+            {
+                free( primes );
+                return NULL;
+            }
+            primes = resized;
+        }
+        primes[( *count )++] = candidate;
+        productBits += log2( ( double )candidate );
+    }
+    return primes;
+}
+
+/*
+ * Function <private>:  _residuesModuloPrime
+ * --------------------
+ *      computes characteristic polynomial modulo one prime (body of parallelForDynamic)
+ *
+ */
+static void _residuesModuloPrime( long begin, long end, int worker, void *context )
+{
+    ResidueContext *residues = context;
+    const int size = residues->matrix->size;
+
+    for( long i = begin; i < end && residues->errors[worker] == 0; i++ )
+    {
+        if( isOperationCancelled( residues->control ) )
+        {
+            residues->errors[worker] = OPERATION_CANCELLED;
+            break;
+        }
+        residues->errors[worker] = characteristicPolynomialModular( residues->matrix, residues->primes[i],
+                                                                    residues->residues + i * ( size + 1 ) );
+        addOperationProgress( residues->control, 1 );
+    }
+}
+
+/*
+ * Function <private>:  _inverseModulo
+ * --------------------
+ *      returns inverse of value (coprime with modulus) modulo modulus (extended Euclidean algorithm)
+ *
+ */
+static unsigned long _inverseModulo( unsigned long value, long modulus )
+{
+    long a = ( long )value, b = modulus, x = 1, y = 0;
+
+    while( b != 0 )
+    {
+        const long quotient = a / b, remainder = a % b, previous = x - quotient * y;
+        a = b;
+        b = remainder;
+        x = y;
+        y = previous;
+    }
+    return ( unsigned long )( x < 0 ? x + modulus : x );
+}
+
+/*
+ * Function <private>:  _resetNumbers
+ * --------------------
+ *      sets "count" numbers to 0 and frees limbs of their arena
+ *
+ */
+static void _resetNumbers( BigInteger *numbers, int count, LimbArena *arena )
+{
+    freeLimbArena( arena );
+    memset( numbers, 0, sizeof( BigInteger ) * ( size_t )count );
+}
+
+/*
+ * Function <private>:  _reconstructCoefficients
+ * --------------------
+ *      recovers coefficients from their residues with Garner's algorithm: coefficient is written in mixed radix
+ *      system as d_0 + d_1 p_0 + d_2 p_0 p_1 + ..., where digit d_i is found modulo p_i from residue and previous
+ *      digits. Digits are taken from range (-p_i / 2, p_i / 2), so that the sum is the only solution of absolute
+ *      value below p_0 ... p_(count - 1) / 2 (primes are odd), and then evaluated with Horner's method
+ *
+ *      returns: 0 on success, -1 on out of memory, OPERATION_CANCELLED if control requested cancellation
+ *
+ */
+static int _reconstructCoefficients( const long *primes, int count, const unsigned int *residues, int size,
+                                     BigInteger *coefficients, LimbArena *arena, OperationControl *control )
+{
+    long *digits = malloc( sizeof( long ) * ( size_t )count );
+    unsigned long *inverses = malloc( sizeof( unsigned long ) * ( size_t )count );
+    BigInteger values[2] = { { 0 } }, prime = { 0 };
+    LimbArena valueArena, scratch;
+    int errorCode = 0;
+
+    initLimbArena( &valueArena );
+    initLimbArena( &scratch );
+    if( digits == NULL || inverses == NULL )
+        errorCode = -1;
+
+    for( int i = 0; i < count && errorCode == 0; i++ )      // Inverses of p_0 ... p_(i - 1) modulo p_i
+    {
+        unsigned long product = 1;
+        for( int j = 0; j < i; j++ )
+            product = product * ( unsigned long )( primes[j] % primes[i] ) % ( unsigned long )primes[i];
+        inverses[i] = _inverseModulo( product, primes[i] );
+    }
+
+    for( int k = 0; k <= size && errorCode == 0; k++ )
+    {
+        if( isOperationCancelled( control ) )
+        {
+            errorCode = OPERATION_CANCELLED;
+            break;
+        }
+        for( int i = 0; i < count; i++ )
+        {
+            const long p = primes[i];
+            unsigned long sum = 0;                          // d_0 + d_1 p_0 + ... + d_(i - 1) p_0 ... p_(i - 2) mod p_i
+            for( int j = i - 1; j >= 0; j-- )
+            {
+                const long digit = digits[j] % p;
+                sum = ( sum * ( unsigned long )( primes[j] % p ) + ( unsigned long )( digit < 0 ? digit + p : digit ) )
+                      % ( unsigned long )p;
+            }
+            const unsigned long residue = residues[( size_t )i * ( size + 1 ) + k];
+            const unsigned long digit = ( residue + ( unsigned long )p - sum ) % ( unsigned long )p * inverses[i]
+                                        % ( unsigned long )p;
+            digits[i] = digit > ( unsigned long )p / 2 ? ( long )digit - p : ( long )digit;
+        }
+
+        int current = 0;
+        setBigInteger( &values[current], digits[count - 1] );
+        for( int i = count - 2; i >= 0 && errorCode == 0; i-- )    // value = value * p_i + d_i
+        {
+            setBigInteger( &values[1 - current], digits[i] );
+            setBigInteger( &prime, primes[i] );
+            errorCode = addProductBigInteger( &values[1 - current], &values[current], &prime, &valueArena, &scratch );
+            current = 1 - current;
+        }
+        if( errorCode == 0 )
+            errorCode = copyBigInteger( &coefficients[k], &values[current], arena );
+        _resetNumbers( values, 2, &valueArena );
+    }
+
+    free( digits );
+    free( inverses );
+    freeLimbArena( &valueArena );
+    freeLimbArena( &scratch );
+    return errorCode;
+}
+
+/*
+ * Function:  characteristicPolynomialControlled
+ * --------------------
+ *      computes coefficients of det(xI - A) exactly: polynomial is computed modulo as many word-size primes as
+ *      needed to determine coefficients of any magnitude allowed by Hadamard's inequality (see _coefficientBits),
+ *      in parallel and with O(n^3) operations on residues per prime (see characteristicPolynomialModular), and then
+ *      coefficients are reconstructed with Chinese remainder theorem. Every prime is one step of progress
+ *
+ *      matrix:       pointer to Matrix structure
+ *      coefficients: array of size + 1 numbers (initially zero) - coefficient of x^(size - k) is stored at index k
+ *      arena:        arena from which limbs of coefficients are taken
+ *      control:      progress and cancellation of computation (or NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory, OPERATION_CANCELLED if control requested cancellation
+ *
+ */
+int characteristicPolynomialControlled( Matrix *matrix, BigInteger *coefficients, LimbArena *arena,
+                                        OperationControl *control )
+{
+    const int size = matrix->size;
+    ResidueContext context = { 0 };
+    int count, errorCode = 0;
+
+    setBigInteger( &coefficients[0], 1 );
+    if( size == 0 )
+        return 0;
+    long *primes = _choosePrimes( _coefficientBits( matrix ), &count );
+    unsigned int *residues = primes == NULL ? NULL : malloc( sizeof( unsigned int ) * ( size_t )count * ( size + 1 ) );
+    if( residues == NULL )
+    {
+        free( primes );
+        return -1;
+    }
+
+    if( control != NULL )
+        __atomic_store_n( &control->stepsTotal, count, __ATOMIC_RELAXED );
+    context.matrix = matrix;
+    context.primes = primes;
+    context.residues = residues;
+    context.control = control;
+    parallelForDynamic( count, _residuesModuloPrime, &context );
+    for( int worker = 0; worker < MAX_NUMBER_OF_THREADS; worker++ )
+        if( context.errors[worker] != 0 )
+            errorCode = context.errors[worker];
+    if( errorCode == 0 )
+        errorCode = _reconstructCoefficients( primes, count, residues, size, coefficients, arena, control );
+
+    free( primes );
+    free( residues );
+    return errorCode;
+}
+
+/*
+ * Function:  characteristicPolynomial
+ * --------------------
+ *      computes coefficients of det(xI - A) (see characteristicPolynomialControlled)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int characteristicPolynomial( Matrix *matrix, BigInteger *coefficients, LimbArena *arena )
+{
+    return characteristicPolynomialControlled( matrix, coefficients, arena, NULL );
+}
+
+/************************************
+ * Eigenvalues
+ ************************************/
+// All matrices below are stored column after column: element (row, col) of matrix of size n is a[row + col * n]
+
+/*
+ * Function <private>:  _householder
+ * --------------------
+ *      generates Householder reflector H = I - tau * v * v^T such that H * (alpha, x) = (beta, 0); v[0] = 1 and
+ *      the rest of v overwrites x, beta overwrites alpha (as LAPACK's dlarfg)
+ *
+ *      length:  number of elements of (alpha, x)
+ *
+ *      returns: tau (0 if H is identity)
+ *
+ */
+static double _householder( int length, double *alpha, double *x )
+{
+    double norm = 0.0;
+
+    if( length <= 1 )
+        return 0.0;
+    for( int i = 0; i < length - 1; i++ )
+        norm = hypot( norm, x[i] );
+    if( norm == 0.0 )
+        return 0.0;
+
+    const double beta = -copysign( hypot( *alpha, norm ), *alpha );
+    const double tau = ( beta - *alpha ) / beta;
+    const double scale = 1.0 / ( *alpha - beta );
+    for( int i = 0; i < length - 1; i++ )
+        x[i] *= scale;
+    *alpha = beta;
+    return tau;
+}
+
+/*
+ * Function <private>:  _reduceColumn
+ * --------------------
+ *      reduces column "col" of matrix (already reduced in previous columns) with single reflector applied from both
+ *      sides - step of unblocked Hessenberg reduction
+ *
+ */
+static void _reduceColumn( double *a, int n, int col, double *work )
+{
+    double *v = a + col + 1 + ( size_t )col * n;            // Reflector is stored in place of annihilated elements
+    const int length = n - col - 1;
+    const double tau = _householder( length, v, v + 1 );
+    if( tau == 0.0 )
+        return;
+
+    const double subdiagonal = v[0];
+    v[0] = 1.0;
+
+    for( int row = 0; row < n; row++ )                      // A := A * H for columns col + 1, ...
+        work[row] = 0.0;
+    for( int q = 0; q < length; q++ )
+    {
+        const double *column = a + ( size_t )( col + 1 + q ) * n;
+        for( int row = 0; row < n; row++ )
+            work[row] += column[row] * v[q];
+    }
+    for( int q = 0; q < length; q++ )
+    {
+        double *column = a + ( size_t )( col + 1 + q ) * n;
+        const double factor = tau * v[q];
+        for( int row = 0; row < n; row++ )
+            column[row] -= factor * work[row];
+    }
+
+    for( int c = col + 1; c < n; c++ )                      // A := H * A for rows col + 1, ...
+    {
+        double *column = a + col + 1 + ( size_t )c * n, sum = 0.0;
+        for( int q = 0; q < length; q++ )
+            sum += v[q] * column[q];
+        sum *= tau;
+        for( int q = 0; q < length; q++ )
+            column[q] -= sum * v[q];
+    }
+    v[0] = subdiagonal;
+}
+
+/*
+ * Function <private>:  _reducePanel
+ * --------------------
+ *      reduces columns <i, i + nb) of matrix like LAPACK's dlahr2: reflectors are generated one by one, but only
+ *      the panel is updated. Returns upper triangular T and Y = A * V * T, so that the whole block of reflectors
+ *      is I - V * T * V^T and can be applied to the rest of matrix by matrix-matrix products
+ *
+ *      a:   matrix (reflectors V are stored below subdiagonal of panel, with unit elements implied)
+ *      t:   nb x nb workspace for T (column after column)
+ *      y:   n x nb workspace for Y (column after column)
+ *
+ */
+static void _reducePanel( double *a, int n, int i, int nb, double *t, double *y )
+{
+    #define A( row, col ) a[( row ) + ( size_t )( col ) * n]
+    #define T( row, col ) t[( row ) + ( size_t )( col ) * nb]
+    #define Y( row, col ) y[( row ) + ( size_t )( col ) * n]
+    double *w = &T( 0, nb - 1 );                            // Last column of T is free until the last step
+    double ei = 0.0;
+
+    for( int j = 0; j < nb; j++ )
+    {
+        const int column = i + j;
+        if( j > 0 )
+        {
+            // Update column of panel: b := b - Y * V(row i + j)^T ...
+            for( int p = 0; p < j; p++ )
+            {
+                const double factor = A( i + j, i + p );
+                for( int row = i + 1; row < n; row++ )
+                    A( row, column ) -= Y( row, p ) * factor;
+            }
+            // ... and b := (I - V * T^T * V^T) * b, with w = T^T * V^T * b
+            for( int p = 0; p < j; p++ )
+                w[p] = A( i + 1 + p, column );
+            for( int p = 0; p < j; p++ )                    // w := V1^T * w (V1 - unit lower triangular part of V)
+                for( int q = p + 1; q < j; q++ )
+                    w[p] += A( i + 1 + q, i + p ) * w[q];
+            for( int p = 0; p < j; p++ )                    // w := w + V2^T * b2
+            {
+                double sum = 0.0;
+                for( int row = i + 1 + j; row < n; row++ )
+                    sum += A( row, i + p ) * A( row, column );
+                w[p] += sum;
+            }
+            for( int p = j - 1; p >= 0; p-- )               // w := T^T * w
+            {
+                double sum = 0.0;
+                for( int q = 0; q <= p; q++ )
+                    sum += T( q, p ) * w[q];
+                w[p] = sum;
+            }
+            for( int p = 0; p < j; p++ )                    // b2 := b2 - V2 * w
+                for( int row = i + 1 + j; row < n; row++ )
+                    A( row, column ) -= A( row, i + p ) * w[p];
+            for( int p = j - 1; p >= 0; p-- )               // b1 := b1 - V1 * w
+            {
+                for( int q = 0; q < p; q++ )
+                    w[p] += A( i + 1 + p, i + q ) * w[q];
+                A( i + 1 + p, column ) -= w[p];
+            }
+            A( i + j, column - 1 ) = ei;
+        }
+
+        // Reflector annihilating elements below subdiagonal of column
+        const double tau = _householder( n - i - j - 1, &A( i + j + 1, column ), &A( i + j + 1, column ) + 1 );
+        ei = A( i + j + 1, column );
+        A( i + j + 1, column ) = 1.0;
+
+        // Y(:, j) = tau * (A * v - Y * T(:, j)), where T(:, j) = V^T * v temporarily
+        for( int row = i + 1; row < n; row++ )
+            Y( row, j ) = 0.0;
+        for( int q = 0; q < n - i - j - 1; q++ )
+        {
+            const double factor = A( i + j + 1 + q, column );
+            for( int row = i + 1; row < n; row++ )
+                Y( row, j ) += A( row, column + 1 + q ) * factor;
+        }
+        for( int p = 0; p < j; p++ )
+        {
+            double sum = 0.0;
+            for( int row = i + j + 1; row < n; row++ )
+                sum += A( row, i + p ) * A( row, column );
+            T( p, j ) = sum;
+        }
+        for( int p = 0; p < j; p++ )
+            for( int row = i + 1; row < n; row++ )
+                Y( row, j ) -= Y( row, p ) * T( p, j );
+        for( int row = i + 1; row < n; row++ )
+            Y( row, j ) *= tau;
+
+        // T(:, j) = -tau * T * T(:, j), T(j, j) = tau
+        for( int p = 0; p < j; p++ )
+            T( p, j ) *= -tau;
+        for( int p = 0; p < j; p++ )
+        {
+            double sum = 0.0;
+            for( int q = p; q < j; q++ )
+                sum += T( p, q ) * T( q, j );
+            T( p, j ) = sum;
+        }
+        T( j, j ) = tau;
+    }
+    A( i + nb, i + nb - 1 ) = ei;
+
+    // Rows 0..i of Y: Y = A(0:i, i+1:n) * V * T
+    for( int p = 0; p < nb; p++ )
+        for( int row = 0; row <= i; row++ )
+            Y( row, p ) = A( row, i + 1 + p );
+    for( int p = 0; p < nb; p++ )                           // Y := Y * V1
+        for( int q = p + 1; q < nb; q++ )
+        {
+            const double factor = A( i + 1 + q, i + p );
+            for( int row = 0; row <= i; row++ )
+                Y( row, p ) += Y( row, q ) * factor;
+        }
+    for( int p = 0; p < nb; p++ )                           // Y := Y + A(0:i, i+1+nb:n) * V2
+        for( int q = i + 1 + nb; q < n; q++ )
+        {
+            const double factor = A( q, i + p );
+            const double *source = &A( 0, q );
+            for( int row = 0; row <= i; row++ )
+                Y( row, p ) += source[row] * factor;
+        }
+    for( int p = nb - 1; p >= 0; p-- )                      // Y := Y * T
+        for( int row = 0; row <= i; row++ )
+        {
+            double sum = 0.0;
+            for( int q = 0; q <= p; q++ )
+                sum += Y( row, q ) * T( q, p );
+            Y( row, p ) = sum;
+        }
+    #undef A
+    #undef T
+    #undef Y
+}
+
+/*
+ * Function <private>:  _reduceToHessenberg
+ * --------------------
+ *      transforms matrix to upper Hessenberg form Q^T * A * Q with the same eigenvalues. Blocks of HESSENBERG_BLOCK
+ *      columns are reduced by _reducePanel and the rest of matrix is updated with the whole block at once, so
+ *      every pass over trailing matrix does HESSENBERG_BLOCK times more work than in unblocked algorithm (as in
+ *      LAPACK's dgehrd); elements below subdiagonal are set to 0
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _reduceToHessenberg( double *a, int n )
+{
+    #define A( row, col ) a[( row ) + ( size_t )( col ) * n]
+    const int nb = HESSENBERG_BLOCK;
+    double *t = malloc( sizeof( double ) * nb * nb );
+    double *y = malloc( sizeof( double ) * ( size_t )n * nb );
+    double *work = malloc( sizeof( double ) * ( ( size_t )n + nb ) );
+    int i = 0;
+
+    if( t == NULL || y == NULL || work == NULL )
+    {
+        free( t );
+        free( y );
+        free( work );
+        return -1;
+    }
+
+    for( ; i <= n - 2 - HESSENBERG_CROSSOVER; i += nb )
+    {
+        _reducePanel( a, n, i, nb, t, y );
+
+        // A(:, i+nb:n) -= Y * V^T (right side of the block of reflectors)
+        const double ei = A( i + nb, i + nb - 1 );
+        A( i + nb, i + nb - 1 ) = 1.0;
+        for( int col = i + nb; col < n; col++ )
+            for( int p = 0; p < nb; p += 4 )                // Four columns of Y at once - column of A is loaded once
+            {
+                const double f0 = A( col, i + p ), f1 = A( col, i + p + 1 );
+                const double f2 = A( col, i + p + 2 ), f3 = A( col, i + p + 3 );
+                const double *s0 = y + ( size_t )p * n, *s1 = s0 + n, *s2 = s1 + n, *s3 = s2 + n;
+                double *target = &A( 0, col );
+                for( int row = 0; row < n; row++ )
+                    target[row] -= s0[row] * f0 + s1[row] * f1 + s2[row] * f2 + s3[row] * f3;
+            }
+        A( i + nb, i + nb - 1 ) = ei;
+
+        // Rows 0..i of panel columns: A(0:i, i+1:i+nb) -= Y(0:i, 0:nb-1) * V1^T
+        for( int p = nb - 2; p >= 0; p-- )
+            for( int q = 0; q < p; q++ )
+            {
+                const double factor = A( i + 1 + p, i + q );
+                for( int row = 0; row <= i; row++ )
+                    y[row + ( size_t )p * n] += y[row + ( size_t )q * n] * factor;
+            }
+        for( int p = 0; p < nb - 1; p++ )
+            for( int row = 0; row <= i; row++ )
+                A( row, i + 1 + p ) -= y[row + ( size_t )p * n];
+
+        // A(i+1:n, i+nb:n) := (I - V * T^T * V^T) * A(i+1:n, i+nb:n) (left side), column by column
+        for( int col = i + nb; col < n; col++ )
+        {
+            double *target = &A( i + 1, col ), *z = work;
+            const int length = n - i - 1;
+            for( int p = 0; p < nb; p++ )                   // z = V^T * column
+            {
+                const double *v = &A( i + 1, i + p );
+                double sum = target[p];
+                for( int q = p + 1; q < length; q++ )
+                    sum += v[q] * target[q];
+                z[p] = sum;
+            }
+            for( int p = nb - 1; p >= 0; p-- )              // z := T^T * z
+            {
+                double sum = 0.0;
+                for( int q = 0; q <= p; q++ )
+                    sum += t[q + ( size_t )p * nb] * z[q];
+                z[p] = sum;
+            }
+            for( int p = 0; p < nb; p++ )                   // column -= V * z
+            {
+                const double *v = &A( i + 1, i + p );
+                target[p] -= z[p];
+                for( int q = p + 1; q < length; q++ )
+                    target[q] -= v[q] * z[p];
+            }
+        }
+    }
+
+    for( ; i < n - 2; i++ )                                 // Unblocked reduction of the last columns
+        _reduceColumn( a, n, i, work );
+
+    for( int col = 0; col < n; col++ )                      // Remove reflectors
+        for( int row = col + 2; row < n; row++ )
+            A( row, col ) = 0.0;
+
+    free( t );
+    free( y );
+    free( work );
+    return 0;
+    #undef A
+}
+
+/*
+ * Function <private>:  _hessenbergEigenvalues
+ * --------------------
+ *      computes eigenvalues of upper Hessenberg matrix with Francis double shift QR algorithm (as EISPACK's hqr):
+ *      negligible subdiagonal elements split matrix, 1x1 and 2x2 blocks found at the bottom give eigenvalues and
+ *      the active part shrinks; exceptional shifts are used after 10 and 20 iterations without convergence
+ *
+ *      h:         Hessenberg matrix (destroyed)
+ *      real, imaginary: arrays for n real and imaginary parts of eigenvalues (conjugate pairs are adjacent)
+ *
+ *      returns: 0 on success, -2 if some eigenvalue didn't converge in QR_MAX_ITERATIONS iterations
+ *
+ */
+static int _hessenbergEigenvalues( double *h, int n, double *real, double *imaginary )
+{
+    // Indices are 1-based in this function, as in original algorithm
+    #define H( row, col ) h[( row ) - 1 + ( size_t )( ( col ) - 1 ) * n]
+    double norm = 0.0, shift = 0.0;
+    double p = 0.0, q = 0.0, r = 0.0, s, w, x, y, z;
+    int last = n, l, m, iterations;
+
+    for( int i = 1; i <= n; i++ )
+        for( int j = i > 1 ? i - 1 : 1; j <= n; j++ )
+            norm += fabs( H( i, j ) );
+
+    while( last >= 1 )
+    {
+        iterations = 0;
+        do
+        {
+            for( l = last; l >= 2; l-- )                    // Look for single small subdiagonal element
+            {
+                s = fabs( H( l - 1, l - 1 ) ) + fabs( H( l, l ) );
+                if( s == 0.0 )
+                    s = norm;
+                if( fabs( H( l, l - 1 ) ) <= DBL_EPSILON * s )
+                {
+                    H( l, l - 1 ) = 0.0;
+                    break;
+                }
+            }
+            x = H( last, last );
+            if( l == last )                                 // One root found
+            {
+                real[last - 1] = x + shift;
+                imaginary[last - 1] = 0.0;
+                last--;
+                continue;
+            }
+            y = H( last - 1, last - 1 );
+            w = H( last, last - 1 ) * H( last - 1, last );
+            if( l == last - 1 )                             // Two roots found
+            {
+                p = 0.5 * ( y - x );
+                q = p * p + w;
+                z = sqrt( fabs( q ) );
+                x += shift;
+                if( q >= 0.0 )                              // Real pair
+                {
+                    z = p + copysign( z, p );
+                    real[last - 2] = real[last - 1] = x + z;
+                    if( z != 0.0 )
+                        real[last - 1] = x - w / z;
+                    imaginary[last - 2] = imaginary[last - 1] = 0.0;
+                } else                                      // Complex pair
+                {
+                    real[last - 2] = real[last - 1] = x + p;
+                    imaginary[last - 2] = z;
+                    imaginary[last - 1] = -z;
+                }
+                last -= 2;
+                continue;
+            }
+
+            if( iterations == QR_MAX_ITERATIONS )
+                return -2;
+            if( iterations == 10 || iterations == 20 )      // Exceptional shift
+            {
+                shift += x;
+                for( int i = 1; i <= last; i++ )
+                    H( i, i ) -= x;
+                s = fabs( H( last, last - 1 ) ) + fabs( H( last - 1, last - 2 ) );
+                y = x = 0.75 * s;
+                w = -0.4375 * s * s;
+            }
+            iterations++;
+
+            for( m = last - 2; m >= l; m-- )                // Look for two consecutive small subdiagonal elements
+            {
+                z = H( m, m );
+                r = x - z;
+                s = y - z;
+                p = ( r * s - w ) / H( m + 1, m ) + H( m, m + 1 );
+                q = H( m + 1, m + 1 ) - z - r - s;
+                r = H( m + 2, m + 1 );
+                s = fabs( p ) + fabs( q ) + fabs( r );
+                p /= s;
+                q /= s;
+                r /= s;
+                if( m == l )
+                    break;
+                const double u = fabs( H( m, m - 1 ) ) * ( fabs( q ) + fabs( r ) );
+                const double v = fabs( p ) * ( fabs( H( m - 1, m - 1 ) ) + fabs( z ) + fabs( H( m + 1, m + 1 ) ) );
+                if( u <= DBL_EPSILON * v )
+                    break;
+            }
+            for( int i = m + 2; i <= last; i++ )
+            {
+                H( i, i - 2 ) = 0.0;
+                if( i != m + 2 )
+                    H( i, i - 3 ) = 0.0;
+            }
+
+            for( int k = m; k <= last - 1; k++ )            // Double QR step on rows l..last and columns m..last
+            {
+                if( k != m )
+                {
+                    p = H( k, k - 1 );
+                    q = H( k + 1, k - 1 );
+                    r = k != last - 1 ? H( k + 2, k - 1 ) : 0.0;
+                    if( ( x = fabs( p ) + fabs( q ) + fabs( r ) ) != 0.0 )
+                    {
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                }
+                if( ( s = copysign( sqrt( p * p + q * q + r * r ), p ) ) == 0.0 )
+                    continue;
+                if( k == m )
+                {
+                    if( l != m )
+                        H( k, k - 1 ) = -H( k, k - 1 );
+                } else
+                    H( k, k - 1 ) = -s * x;
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+                for( int j = k; j <= last; j++ )            // Row modification
+                {
+                    p = H( k, j ) + q * H( k + 1, j );
+                    if( k != last - 1 )
+                    {
+                        p += r * H( k + 2, j );
+                        H( k + 2, j ) -= p * z;
+                    }
+                    H( k + 1, j ) -= p * y;
+                    H( k, j ) -= p * x;
+                }
+                const int lastRow = last < k + 3 ? last : k + 3;
+                for( int i = l; i <= lastRow; i++ )         // Column modification
+                {
+                    p = x * H( i, k ) + y * H( i, k + 1 );
+                    if( k != last - 1 )
+                    {
+                        p += z * H( i, k + 2 );
+                        H( i, k + 2 ) -= p * r;
+                    }
+                    H( i, k + 1 ) -= p * q;
+                    H( i, k ) -= p;
+                }
+            }
+        } while( l < last - 1 );
+    }
+    return 0;
+    #undef H
+}
+
+/*
+ * Function:  eigenvaluesDoubleMatrix
+ * --------------------
+ *      computes all (also complex) eigenvalues of matrix of doubles: matrix is reduced to Hessenberg form and then
+ *      shifted QR algorithm is applied
+ *
+ *      elements:  size * size elements of matrix, row after row
+ *      size:      number of cols|rows
+ *      real, imaginary: arrays for "size" real and imaginary parts of eigenvalues (conjugate pairs are adjacent,
+ *                       with positive imaginary part first)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if QR algorithm didn't converge
+ *
+ */
+int eigenvaluesDoubleMatrix( const double *elements, int size, double *real, double *imaginary )
+{
+    double *a = malloc( sizeof( double ) * ( size_t )size * ( size_t )size + 1 );
+    if( a == NULL )
+        return -1;
+    for( int row = 0; row < size; row++ )                   // Store column after column
+        for( int col = 0; col < size; col++ )
+            a[row + ( size_t )col * size] = elements[( size_t )row * size + col];
+
+    int errorCode = _reduceToHessenberg( a, size );
+    if( errorCode == 0 )
+        errorCode = _hessenbergEigenvalues( a, size, real, imaginary );
+    free( a );
+    return errorCode;
+}
+
+/*
+ * Function:  eigenvaluesSquareMatrix
+ * --------------------
+ *      computes all eigenvalues of matrix of long integers (see eigenvaluesDoubleMatrix)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if QR algorithm didn't converge
+ *
+ */
+int eigenvaluesSquareMatrix( Matrix *matrix, double *real, double *imaginary )
+{
+    const int size = matrix->size;
+    double *elements = malloc( sizeof( double ) * ( size_t )size * ( size_t )size + 1 );
+    if( elements == NULL )
+        return -1;
+    for( int row = 0; row < size; row++ )
+        for( int col = 0; col < size; col++ )
+            elements[( size_t )row * size + col] = ( double )matrix->elements[row][col];
+
+    int errorCode = eigenvaluesDoubleMatrix( elements, size, real, imaginary );
+    free( elements );
+    return errorCode;
+}
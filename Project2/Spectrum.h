@@ -0,0 +1,30 @@
+/*
+ * File: Spectrum.h
+ * Author: Paweł Wieczorek
+ * Date: 18 Oct 2026
+ * Description: Header of file Spectrum.c
+ */
+
+#ifndef PROJEKT2_SPECTRUM_H
+#define PROJEKT2_SPECTRUM_H
+
+#include "SquareMatrix.h"
+#include "BigInteger.h"
+
+/************************************
+ * Macros definitions
+ ************************************/
+#define HESSENBERG_BLOCK        32      // Number of columns reduced together by blocked Hessenberg reduction (multiple of 4)
+#define HESSENBERG_CROSSOVER    128     // The last columns (and whole smaller matrices) are reduced one by one
+#define QR_MAX_ITERATIONS       30      // Maximal number of QR iterations spent on one eigenvalue
+
+/************************************
+ * Function declarations
+ ************************************/
+int characteristicPolynomial( Matrix *matrix, BigInteger *coefficients, LimbArena *arena );
+int characteristicPolynomialControlled( Matrix *matrix, BigInteger *coefficients, LimbArena *arena,
+                                        OperationControl *control );
+int eigenvaluesDoubleMatrix( const double *elements, int size, double *real, double *imaginary );
+int eigenvaluesSquareMatrix( Matrix *matrix, double *real, double *imaginary );
+
+#endif //PROJEKT2_SPECTRUM_H
@@ -5,150 +5,1556 @@
  * Description: Implementation of matrices and basic operations on them
  */
 #include "SquareMatrix.h"
+#include "Profiler.h"
+#include "SmallMatrix.h"
 #include <stdlib.h>
 #include <memory.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+
+/*
+ * Function <private>:  _releaseStorage
+ * --------------------
+ *      drops one reference to storage; when the last reference is dropped, memory is freed (or unmapped)
+ *
+ */
+static void _releaseStorage( MatrixStorage *storage )
+{
+    if( __atomic_sub_fetch( &storage->refCount, 1, __ATOMIC_ACQ_REL ) != 0 )
+        return;
+
+    if( storage->mapping != NULL )                              // Elements are stored in file mapped into memory
+        munmap( storage->mapping, storage->mappingLength );
+    else
+    {
+        profileRelease( storage->heapLength );
+        if( storage->allocatedData )
+            releaseMatrixMemory( storage->allocator, storage->data, storage->heapLength );
+        else
+            free( storage->data );
+    }
+    releaseMatrixMemory( storage->allocator, storage, sizeof( MatrixStorage ) );
+}
+
+/*
+ * Function <private>:  _releaseBlock
+ * --------------------
+ *      drops one reference to block of rows; when the last matrix using block drops it, block is freed
+ *
+ */
+static void _releaseBlock( MatrixBlock *block )
+{
+    if( __atomic_sub_fetch( &block->refCount, 1, __ATOMIC_ACQ_REL ) != 0 )
+        return;
+
+    _releaseStorage( block->storage );
+    releaseMatrixMemory( block->allocator, block, sizeof( MatrixBlock ) );
+}
+
+/*
+ * Function <private>:  _numberOfBlocks
+ * --------------------
+ *      returns number of row blocks of matrix of given size (every matrix has at least one block)
+ *
+ */
+static int _numberOfBlocks( int size )
+{
+    return size > 0 ? ( size + MATRIX_BLOCK_ROWS - 1 ) / MATRIX_BLOCK_ROWS : 1;
+}
+
+/*
+ * Function <private>:  _freeMatrixStructure
+ * --------------------
+ *      gives matrix structure and its arrays back to allocator (arrays can be NULL)
+ *
+ */
+static void _freeMatrixStructure( Matrix *matrix )
+{
+    releaseMatrixMemory( matrix->allocator, matrix->elements,
+                         sizeof( long* ) * ( size_t )( matrix->size > 0 ? matrix->size : 1 ) );
+    releaseMatrixMemory( matrix->allocator, matrix->blocks, sizeof( MatrixBlock* ) * ( size_t )_numberOfBlocks( matrix->size ) );
+    releaseMatrixMemory( matrix->allocator, matrix, sizeof( Matrix ) );
+}
+
+/*
+ * Function <private>:  _createMatrixStructure
+ * --------------------
+ *      allocates matrix structure with arrays of row pointers and blocks (which are left empty)
+ *
+ *      allocator: allocator of structure (NULL - default pool)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _createMatrixStructure( int size, long stride, MatrixAllocator *allocator, Matrix **output )
+{
+    if( allocator == NULL )
+        allocator = defaultMatrixAllocator();
+    Matrix *matrix = allocateMatrixMemory( allocator, sizeof( Matrix ) );         // Allocate matrix structure
+    if( matrix == NULL )                                                          // We are out of memory
+        return -1;
+
+    matrix->size = size;
+    matrix->allocator = allocator;
+    // Always allocate at least one pointer (even for empty matrix)
+    matrix->elements = allocateMatrixMemory( allocator, sizeof( long* ) * ( size_t )( size > 0 ? size : 1 ) );
+    matrix->blocks = allocateMatrixMemory( allocator, sizeof( MatrixBlock* ) * ( size_t )_numberOfBlocks( size ) );
+    if( matrix->elements == NULL || matrix->blocks == NULL )
+    {
+        _freeMatrixStructure( matrix );
+        return -1;
+    }
+
+    matrix->stride = stride;
+    matrix->version = 1;
+    matrix->hashedVersion = 0;                                                    // Hash will be computed when needed
+    *output = matrix;
+    return 0;
+}
+
+/*
+ * Function <private>:  _createMatrixFromStorage
+ * --------------------
+ *      common part of createSquareMatrixFromStorage and createSquareMatrixWithAllocator
+ *
+ *      allocator:     allocator of structures of matrix (never NULL)
+ *      allocatedData: non-zero if data was taken from allocator, zero if it was allocated with malloc (or mapped)
+ *
+ *      returns: 0 on success, -1 on out of memory (ownership of data is not taken then)
+ *
+ */
+static int _createMatrixFromStorage( int size, long stride, long *data, void *mapping, size_t mappingLength,
+                                     MatrixAllocator *allocator, int allocatedData, Matrix **output )
+{
+    const int numberOfBlocks = _numberOfBlocks( size );
+    MatrixStorage *storage = allocateMatrixMemory( allocator, sizeof( MatrixStorage ) );
+    if( storage == NULL )
+        return -1;
+    if( _createMatrixStructure( size, stride, allocator, output ) != 0 )
+    {
+        releaseMatrixMemory( allocator, storage, sizeof( MatrixStorage ) );
+        return -1;
+    }
+
+    storage->refCount = numberOfBlocks;                                           // Every block refers to storage
+    storage->data = data;
+    storage->mapping = mapping;
+    storage->mappingLength = mappingLength;
+    storage->heapLength = mapping == NULL ? sizeof( long ) * ( size_t )stride * ( size_t )( size > 0 ? size : 1 ) : 0;
+    storage->allocator = allocator;
+    storage->allocatedData = allocatedData;
+
+    for( int block = 0; block < numberOfBlocks; block++ )
+    {
+        ( *output )->blocks[block] = allocateMatrixMemory( allocator, sizeof( MatrixBlock ) );
+        if( ( *output )->blocks[block] == NULL )
+        {
+            for( int created = 0; created < block; created++ )                    // Free already created blocks...
+                releaseMatrixMemory( allocator, ( *output )->blocks[created], sizeof( MatrixBlock ) );
+            releaseMatrixMemory( allocator, storage, sizeof( MatrixStorage ) );   // ...but not data - caller owns it
+            _freeMatrixStructure( *output );
+            return -1;
+        }
+        ( *output )->blocks[block]->refCount = 1;
+        ( *output )->blocks[block]->storage = storage;
+        ( *output )->blocks[block]->rows = data + ( size_t )block * MATRIX_BLOCK_ROWS * stride;
+        ( *output )->blocks[block]->allocator = allocator;
+    }
+
+    for( int row = 0; row < size; row++ )
+        ( *output )->elements[row] = data + ( size_t )row * stride;
+    if( mapping == NULL )
+        profileAllocation( storage->heapLength );
+    return 0;
+}
 
 /*
  * Function:  createSquareMatrix
  * --------------------
- *      allocates memory on heap for structure and array holding matrix elements
+ *      allocates memory on heap for structure and array holding matrix elements; all elements are stored in one
+ *      contiguous block aligned to MATRIX_ALIGNMENT bytes, and every row starts at aligned address (row length is
+ *      rounded up to "stride" elements)
+ *
+ *      size:    number of cols|rows (cols == rows for square matrix)
+ *      output:  pointer to memory where pointer to structure should be stored
+ *               ex. Matrix* matrix; createSquareMatrix( 3, &matrix ); //Now „matrix” contains pointer to created matrix
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createSquareMatrix( int size, Matrix **output )
+{
+    return createSquareMatrixWithAllocator( size, NULL, output );
+}
+
+/*
+ * Function:  createSquareMatrixWithAllocator
+ * --------------------
+ *      the same as createSquareMatrix, but all memory of matrix (structure, arrays of rows and elements) is taken
+ *      from given allocator and given back to it by deleteSquareMatrix; matrix created in arena mustn't be used
+ *      after arena is released
+ *
+ *      allocator: pool or arena (NULL - default pool)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int createSquareMatrixWithAllocator( int size, MatrixAllocator *allocator, Matrix **output )
+{
+    const long stride = alignedMatrixStride( size );
+    const size_t bytes = sizeof( long ) * ( size_t )stride * ( size_t )( size > 0 ? size : 1 );
+
+    if( allocator == NULL )
+        allocator = defaultMatrixAllocator();
+    long *data = allocateMatrixMemory( allocator, bytes );                        // Allocate elements of matrix
+    if( data == NULL )                                                            // We are out of memory
+        return -1;
+    memset( data, 0, bytes );
+
+    if( _createMatrixFromStorage( size, stride, data, NULL, 0, allocator, 1, output ) != 0 )
+    {
+        releaseMatrixMemory( allocator, data, bytes );
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Function:  createSquareMatrixFromStorage
+ * --------------------
+ *      creates matrix structure using already existing block of elements (without copying it); matrix takes
+ *      ownership of this block - it will be freed (or unmapped) when the last matrix using it is deleted
+ *
+ *      size:           number of cols|rows
+ *      stride:         distance (in elements) between beginnings of consecutive rows, at least "size"
+ *      data:           pointer to first element
+ *      mapping:        NULL if data was allocated with malloc/posix_memalign, otherwise beginning of memory mapped
+ *                      region (returned by mmap) containing data
+ *      mappingLength:  length of mapped region (ignored if mapping is NULL)
+ *      output:         pointer to memory where pointer to structure should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory (ownership of data is not taken then)
+ *
+ */
+int createSquareMatrixFromStorage( int size, long stride, long *data, void *mapping, size_t mappingLength,
+                                   Matrix **output )
+{
+    return _createMatrixFromStorage( size, stride, data, mapping, mappingLength, defaultMatrixAllocator(), 0, output );
+}
+
+/*
+ * Function:  snapshotSquareMatrix
+ * --------------------
+ *      creates matrix with the same content as "input" without copying elements - both matrices share blocks of
+ *      rows until one of them modifies them (copy-on-write); only the array of row pointers is copied. Any
+ *      number of snapshots of matrix can exist and each modified block is copied only for matrix modifying it
+ *
+ *      input:   pointer to Matrix structure
+ *      output:  pointer to memory where pointer to created snapshot should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int snapshotSquareMatrix( Matrix *input, Matrix **output )
+{
+    return snapshotSquareMatrixWithAllocator( input, NULL, output );
+}
+
+/*
+ * Function:  snapshotSquareMatrixWithAllocator
+ * --------------------
+ *      the same as snapshotSquareMatrix, but structure of snapshot (and blocks it copies when it's modified) is
+ *      taken from given allocator; shared blocks are still given back to allocator of matrix which created them
+ *
+ *      allocator: pool or arena (NULL - default pool)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int snapshotSquareMatrixWithAllocator( Matrix *input, MatrixAllocator *allocator, Matrix **output )
+{
+    if( _createMatrixStructure( input->size, input->stride, allocator, output ) != 0 )
+        return -1;
+
+    for( int block = 0; block < _numberOfBlocks( input->size ); block++ )
+    {
+        ( *output )->blocks[block] = input->blocks[block];
+        __atomic_add_fetch( &input->blocks[block]->refCount, 1, __ATOMIC_RELAXED );
+    }
+    memcpy( ( *output )->elements, input->elements, sizeof( long* ) * ( size_t )input->size );
+
+    ( *output )->version = input->version;                                        // Content is the same, so is hash
+    ( *output )->hash[0] = input->hash[0];
+    ( *output )->hash[1] = input->hash[1];
+    ( *output )->hashedVersion = input->hashedVersion;
+    return 0;
+}
+
+/*
+ * Function <private>:  _prepareBlockForWrite
+ * --------------------
+ *      makes sure that block of rows isn't shared with other matrices - if it is, its rows are copied to new block
+ *      owned only by this matrix
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+static int _prepareBlockForWrite( Matrix *matrix, int block )
+{
+    MatrixBlock *shared = matrix->blocks[block];
+    if( __atomic_load_n( &shared->refCount, __ATOMIC_ACQUIRE ) == 1 )          // Only this matrix uses block
+        return 0;
+
+    const int firstRow = block * MATRIX_BLOCK_ROWS;
+    const int rows = matrix->size - firstRow < MATRIX_BLOCK_ROWS ? matrix->size - firstRow : MATRIX_BLOCK_ROWS;
+    const size_t bytes = sizeof( long ) * ( size_t )matrix->stride * ( size_t )( rows > 0 ? rows : 1 );
+    MatrixBlock *copy = allocateMatrixMemory( matrix->allocator, sizeof( MatrixBlock ) );
+    MatrixStorage *storage = allocateMatrixMemory( matrix->allocator, sizeof( MatrixStorage ) );
+    long *data = allocateMatrixMemory( matrix->allocator, bytes );
+
+    if( copy == NULL || storage == NULL || data == NULL )
+    {
+        releaseMatrixMemory( matrix->allocator, copy, sizeof( MatrixBlock ) );
+        releaseMatrixMemory( matrix->allocator, storage, sizeof( MatrixStorage ) );
+        releaseMatrixMemory( matrix->allocator, data, bytes );
+        return -1;
+    }
+    memcpy( data, shared->rows, sizeof( long ) * ( size_t )matrix->stride * ( size_t )rows );
+
+    storage->refCount = 1;
+    storage->data = data;
+    storage->mapping = NULL;
+    storage->heapLength = bytes;
+    storage->allocator = matrix->allocator;
+    storage->allocatedData = 1;
+    profileAllocation( bytes );
+    copy->refCount = 1;
+    copy->allocator = matrix->allocator;
+    copy->storage = storage;
+    copy->rows = data;
+
+    for( int row = 0; row < rows; row++ )
+        matrix->elements[firstRow + row] = copy->rows + ( size_t )row * matrix->stride;
+    matrix->blocks[block] = copy;
+    _releaseBlock( shared );
+    return 0;
+}
+
+/*
+ * Function:  prepareMatrixForWrite
+ * --------------------
+ *      makes sure that no block of rows of matrix is shared with its snapshots, so elements can be written
+ *      directly through matrix->elements (call markMatrixModified afterwards)
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int prepareMatrixForWrite( Matrix *matrix )
+{
+    for( int block = 0; block < _numberOfBlocks( matrix->size ); block++ )
+        if( _prepareBlockForWrite( matrix, block ) != 0 )
+            return -1;
+    return 0;
+}
+
+/*
+ * Function:  alignedMatrixStride
+ * --------------------
+ *      returns number of elements in row of matrix of given size after rounding its length up to MATRIX_ALIGNMENT
+ *
+ */
+long alignedMatrixStride( int size )
+{
+    const long elementsInAlignment = MATRIX_ALIGNMENT / sizeof( long );
+    return ( ( long )size + elementsInAlignment - 1 ) / elementsInAlignment * elementsInAlignment;
+}
+
+/*
+ * Function:  setMatrixElement
+ * --------------------
+ *      sets value of one element of matrix and marks matrix as modified; use it instead of writing to
+ *      matrix->elements directly, so that results cached for old content of matrix are not used and snapshots
+ *      of matrix are not modified (only block containing element is copied if it is shared)
+ *
+ *      matrix:  pointer to Matrix structure
+ *      row:     row of element (counted from 0)
+ *      col:     column of element (counted from 0)
+ *      value:   new value of element
+ *
+ *      returns: 0 on success, -1 on out of memory
+ *
+ */
+int setMatrixElement( Matrix *matrix, int row, int col, long value )
+{
+    if( _prepareBlockForWrite( matrix, row / MATRIX_BLOCK_ROWS ) != 0 )
+        return -1;
+    matrix->elements[row][col] = value;
+    markMatrixModified( matrix );
+    return 0;
+}
+
+/*
+ * Function:  markMatrixModified
+ * --------------------
+ *      increments version of matrix - must be called after elements were modified directly through
+ *      matrix->elements (functions from this file do it themselves)
+ *
+ */
+void markMatrixModified( Matrix *matrix )
+{
+    matrix->version++;
+}
+
+/*
+ * Function <private>:  _mixHash
+ * --------------------
+ *      returns value with all bits mixed (finalizer of splitmix64), so that similar values give unrelated results
+ *
+ */
+static inline unsigned long _mixHash( unsigned long value )
+{
+    value = ( value ^ ( value >> 30 ) ) * 0xBF58476D1CE4E5B9UL;
+    value = ( value ^ ( value >> 27 ) ) * 0x94D049BB133111EBUL;
+    return value ^ ( value >> 31 );
+}
+
+/*
+ * Function:  hashSquareMatrix
+ * --------------------
+ *      computes two independent 64-bit hashes of size and elements of matrix; hashes are computed only if matrix
+ *      was modified since last call, otherwise remembered values are returned
+ *
+ *      matrix:  pointer to Matrix structure
+ *      hash:    array where both hashes should be stored
+ *
+ */
+void hashSquareMatrix( Matrix *matrix, unsigned long hash[2] )
+{
+    if( matrix->hashedVersion != matrix->version )              // Content changed - compute hashes again
+    {
+        // Every row is hashed independently, then row hashes are chained, so inner loop has no dependency between
+        // elements and can be vectorized. Element is mixed before it's combined with seed of its column and mixed
+        // again, so changes of elements in different columns can't cancel out in sum of row
+        unsigned long first = 0x9E3779B97F4A7C15UL ^ ( unsigned long )matrix->size;
+        unsigned long second = 0xD6E8FEB86659FD93UL ^ ( unsigned long )matrix->size;
+        for( int row = 0; row < matrix->size; row++ )
+        {
+            unsigned long firstRow = 0, secondRow = 0;
+            for( int col = 0; col < matrix->size; col++ )
+            {
+                const unsigned long value = _mixHash( ( unsigned long )matrix->elements[row][col] );
+                firstRow += _mixHash( value ^ ( ( unsigned long )col * 0x9E3779B97F4A7C15UL ) );
+                secondRow += _mixHash( value ^ ( ( unsigned long )col * 0xD6E8FEB86659FD93UL + 0x2545F4914F6CDD1DUL ) );
+            }
+            first = _mixHash( first ^ firstRow );
+            second = _mixHash( second + secondRow );
+        }
+        matrix->hash[0] = first;
+        matrix->hash[1] = second;
+        matrix->hashedVersion = matrix->version;
+    }
+    hash[0] = matrix->hash[0];
+    hash[1] = matrix->hash[1];
+}
+
+/*
+ * Function:  deleteSquareMatrix
+ * --------------------
+ *      frees memory occupied by matrix structure; blocks of elements are freed when no other snapshot uses them
+ *
+ *      input:  initiated Matrix structure
+ *
+ */
+void deleteSquareMatrix( Matrix *matrix )
+{
+    if( matrix == NULL )
+        return;
+
+    for( int block = 0; block < _numberOfBlocks( matrix->size ); block++ )
+        _releaseBlock( matrix->blocks[block] );
+    _freeMatrixStructure( matrix );
+}
+
+/*
+ * Function <private>:  _absValue
+ * --------------------
+ *      returns absolute value of long integer as unsigned long; works also for LONG_MIN, which has no positive
+ *      counterpart in long type
+ *
+ */
+static unsigned long _absValue( long value )
+{
+    return value < 0 ? ( unsigned long )( -( value + 1 ) ) + 1 : ( unsigned long )value;
+}
+
+/*
+ * Function <private>:  _maxAbsInRow
+ * --------------------
+ *      returns biggest absolute value of first "length" elements of row
+ *
+ */
+static unsigned long _maxAbsInRow( const long *row, int length )
+{
+    unsigned long maxValue = 0;
+    for( int col = 0; col < length; col++ )
+    {
+        unsigned long value = _absValue( row[col] );
+        maxValue = value > maxValue ? value : maxValue;
+    }
+    return maxValue;
+}
+
+/*
+ * Function <private>:  _addRowChecked, _subRowChecked
+ * --------------------
+ *      computes output[i] = a[i] +/- b[i] for whole row; elements are added with wrap around (through unsigned type)
+ *      and overflow flags of all elements are OR-ed together, so the loop has no branches and can be vectorized;
+ *      overflow is checked only once per row
+ *
+ *      returns: 0 on success, -3 if any element overflowed
+ *
+ */
+static int _addRowChecked( const long *a, const long *b, long *output, int length )
+{
+    long overflowFlags = 0;
+    for( int col = 0; col < length; col++ )
+    {
+        long result = ( long )( ( unsigned long )a[col] + ( unsigned long )b[col] );
+        overflowFlags |= ( a[col] ^ result ) & ( b[col] ^ result );     // Sign of result differs from both operands
+        output[col] = result;
+    }
+    return overflowFlags < 0 ? -3 : 0;                                  // Sign bit set means overflow
+}
+
+static int _subRowChecked( const long *a, const long *b, long *output, int length )
+{
+    long overflowFlags = 0;
+    for( int col = 0; col < length; col++ )
+    {
+        long result = ( long )( ( unsigned long )a[col] - ( unsigned long )b[col] );
+        overflowFlags |= ( a[col] ^ b[col] ) & ( a[col] ^ result );     // Operands of different signs and result sign != a
+        output[col] = result;
+    }
+    return overflowFlags < 0 ? -3 : 0;
+}
+
+/*
+ * Function <private>:  _elementwiseOperation
+ * --------------------
+ *      common part of sum and sub functions: creates output matrix and applies operation to each row
+ *
+ *      allocator: allocator of output (NULL - default pool)
+ *      checked: non-zero if overflow should be reported
+ *      subtract: non-zero for m1 - m2, zero for m1 + m2
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on overflow
+ *
+ */
+static int _elementwiseOperation( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output, int subtract,
+                                  int checked )
+{
+    int overflowed = 0;
+
+    if( m1->size != m2->size )
+        return -2;
+    if( createSquareMatrixWithAllocator( m1->size, allocator, output ) != 0 )
+        return -1;
+
+    if( hasSmallMatrixKernels( m1->size ) )                            // Unrolled kernel of this size
+        overflowed = subtract ? subSmallMatrix( m1, m2, *output ) : sumSmallMatrix( m1, m2, *output );
+    else
+    {
+        for( int row = 0; row < m1->size; row++ )
+        {
+            if( subtract )
+                overflowed |= _subRowChecked( m1->elements[row], m2->elements[row], ( *output )->elements[row],
+                                              m1->size );
+            else
+                overflowed |= _addRowChecked( m1->elements[row], m2->elements[row], ( *output )->elements[row],
+                                              m1->size );
+        }
+    }
+
+    if( checked && overflowed )
+    {
+        deleteSquareMatrix( *output );
+        *output = NULL;
+        return -3;
+    }
+    return 0;
+}
+
+/*
+ * Function:  sumSquareMatrix
+ * --------------------
+ *      creates matrix and sets its elements to sum of matrices being arguments
+ *
+ *      m1:      pointer to first Matrix structure
+ *      m2:      pointer to second Matrix structure
+ *      output:  pointer to memory where pointer to structure should be stored
+ *               output->elements will store sum of matrices m1 and m2
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if input matrices don't have the same size,
+ *               -3 on long integer overflow (nothing is stored in output then)
+ *
+ */
+int sumSquareMatrix( Matrix *m1, Matrix *m2, Matrix **output )
+{
+    return sumSquareMatrixWithAllocator( m1, m2, NULL, output );
+}
+
+/*
+ * Function:  subSquareMatrix
+ * --------------------
+ *      creates matrix and sets its elements to differential of matrices being arguments
+ *      (for details look at comment block above function sumSquareMatrix)
+ *
+ */
+int subSquareMatrix( Matrix *m1, Matrix *m2, Matrix **output )
+{
+    return subSquareMatrixWithAllocator( m1, m2, NULL, output );
+}
+
+/*
+ * Functions:  (sum | sub)SquareMatrixWithAllocator
+ * --------------------
+ *      the same as sumSquareMatrix and subSquareMatrix, but memory of result is taken from given allocator
+ *
+ *      allocator: pool or arena (NULL - default pool)
+ *
+ */
+int sumSquareMatrixWithAllocator( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output )
+{
+    ProfileScope scope;
+
+    profileBegin( &scope, PROFILE_SUM );
+    const int errorCode = _elementwiseOperation( m1, m2, allocator, output, 0, 1 );
+    profileEnd( &scope, errorCode == 0 ? ( long )m1->size * m1->size : 0 );
+    return errorCode;
+}
+
+int subSquareMatrixWithAllocator( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output )
+{
+    ProfileScope scope;
+
+    profileBegin( &scope, PROFILE_DIFFERENCE );
+    const int errorCode = _elementwiseOperation( m1, m2, allocator, output, 1, 1 );
+    profileEnd( &scope, errorCode == 0 ? ( long )m1->size * m1->size : 0 );
+    return errorCode;
+}
+
+/*
+ * Functions:  (sum | sub)SquareMatrixUnchecked
+ * --------------------
+ *      the same as sumSquareMatrix and subSquareMatrix, but overflowed elements silently wrap around
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if input matrices don't have the same size
+ *
+ */
+int sumSquareMatrixUnchecked( Matrix *m1, Matrix *m2, Matrix **output )
+{
+    return _elementwiseOperation( m1, m2, NULL, output, 0, 0 );
+}
+
+int subSquareMatrixUnchecked( Matrix *m1, Matrix *m2, Matrix **output )
+{
+    return _elementwiseOperation( m1, m2, NULL, output, 1, 0 );
+}
+
+/*
+ * Function:  cancelOperation
+ * --------------------
+ *      requests stopping of operation controlled by "control"; operation returns OPERATION_CANCELLED after it
+ *      frees all memory allocated by it (it can be called from any thread)
+ *
+ */
+void cancelOperation( OperationControl *control )
+{
+    __atomic_store_n( &control->cancelRequested, 1, __ATOMIC_RELEASE );
+}
+
+/*
+ * Function:  isOperationCancelled
+ * --------------------
+ *      returns 1 if cancelling of operation was requested, 0 otherwise (or if control is NULL)
+ *
+ */
+int isOperationCancelled( OperationControl *control )
+{
+    return control != NULL && __atomic_load_n( &control->cancelRequested, __ATOMIC_ACQUIRE );
+}
+
+/*
+ * Function:  addOperationProgress
+ * --------------------
+ *      marks "steps" more steps of operation as done (nothing happens if control is NULL)
+ *
+ */
+void addOperationProgress( OperationControl *control, long steps )
+{
+    if( control != NULL )
+        __atomic_add_fetch( &control->stepsDone, steps, __ATOMIC_RELAXED );
+}
+
+/*
+ * Function:  operationProgress
+ * --------------------
+ *      returns fraction (in range <0, 1>) of steps of operation which are already done
+ *
+ */
+double operationProgress( OperationControl *control )
+{
+    long done = __atomic_load_n( &control->stepsDone, __ATOMIC_RELAXED );
+    long total = __atomic_load_n( &control->stepsTotal, __ATOMIC_RELAXED );
+    if( total <= 0 )
+        return 0.0;
+    return done >= total ? 1.0 : ( double )done / ( double )total;
+}
+
+/*
+ * Function <private>:  _tilesPerRow
+ * --------------------
+ *      returns number of tiles of MULTIPLY_TILE_WIDTH columns in one row of matrix of given size (progress of
+ *      multiplications is measured in tiles)
+ *
+ */
+static long _tilesPerRow( int size )
+{
+    return ( size + MULTIPLY_TILE_WIDTH - 1 ) / MULTIPLY_TILE_WIDTH;
+}
+
+/*
+ * Function:  multiplySquareMatrix
+ * --------------------
+ *      creates matrix and sets its elements to multiplication of matrices being arguments
+ *
+ *      m1:      pointer to first Matrix structure
+ *      m2:      pointer to second Matrix structure
+ *      output:  pointer to memory where pointer to structure should be stored
+ *               output->elements will store multiplication of matrices m1 and m2
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if input matrices don't have the same size,
+ *               -3 on long integer overflow (nothing is stored in output then)
+ *
+ */
+int multiplySquareMatrix( Matrix *m1, Matrix *m2, Matrix **output )
+{
+    return multiplySquareMatrixControlled( m1, m2, output, NULL );
+}
+
+/*
+ * Function:  multiplySquareMatrixUnchecked
+ * --------------------
+ *      the same as multiplySquareMatrix, but overflowed elements silently wrap around
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if input matrices don't have the same size
+ *
+ */
+int multiplySquareMatrixUnchecked( Matrix *m1, Matrix *m2, Matrix **output )
+{
+    if( m1->size != m2->size )
+        return -2;
+    if( createSquareMatrix( m1->size, output ) != 0 )
+        return -1;
+
+    const int size = m1->size;
+    for( int row = 0; row < size; row++ )
+    {
+        long *outputRow = ( *output )->elements[row];
+        for( int r = 0; r < size; r++ )                                // Row of output += m1[row][r] * r-th row of m2
+        {
+            const unsigned long a = ( unsigned long )m1->elements[row][r];
+            const long *m2Row = m2->elements[r];
+            for( int col = 0; col < size; col++ )                      // Unsigned arithmetic - wrap around is defined
+                outputRow[col] = ( long )( ( unsigned long )outputRow[col] + a * ( unsigned long )m2Row[col] );
+        }
+    }
+    return 0;
+}
+
+/*
+ * Function:  copySquareMatrix
+ * --------------------
+ *      copies all elements of "input" to already created matrix "output" of the same size
+ *
+ *      input:  pointer to Matrix structure which elements should be copied
+ *      output: pointer to Matrix structure in which copy should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory (when output shares rows with its snapshots)
+ *
+ */
+int copySquareMatrix( Matrix *input, Matrix *output )
+{
+    if( prepareMatrixForWrite( output ) != 0 )
+        return -1;
+    for( int row = 0; row < input->size; row++ )
+        memcpy( output->elements[row], input->elements[row], sizeof( long ) * input->size );
+    markMatrixModified( output );
+    return 0;
+}
+
+/*
+ * Function:  setIdentitySquareMatrix
+ * --------------------
+ *      sets elements of matrix to identity matrix (ones on diagonal, zeros elsewhere)
+ *
+ *      matrix: pointer to Matrix structure which should be overwritten
+ *
+ *      returns: 0 on success, -1 on out of memory (when matrix shares rows with its snapshots)
+ *
+ */
+int setIdentitySquareMatrix( Matrix *matrix )
+{
+    if( prepareMatrixForWrite( matrix ) != 0 )
+        return -1;
+    for( int row = 0; row < matrix->size; row++ )
+    {
+        memset( matrix->elements[row], 0, sizeof( long ) * matrix->size );
+        matrix->elements[row][row] = 1;
+    }
+    markMatrixModified( matrix );
+    return 0;
+}
+
+/*
+ * Function <private>:  _multiplySquareMatrixInto
+ * --------------------
+ *      multiplies matrices m1 and m2 and stores result in already created matrix "output"; progress is reported
+ *      to control (one step per tile) and cancelling is checked before every row
+ *
+ *      Overflow is detected without branch per element. Result is computed in tiles of MULTIPLY_TILE_WIDTH
+ *      columns of one output row. Before each row is computed, bound of its elements is estimated from maximal
+ *      absolute values of the row of m1 and the whole m2:
+ *        - if n * max|row| * max|m2| fits in long, nothing can overflow and tile is accumulated in long lanes,
+ *        - if max|row| * max|m2| fits in 64 bits, tile is accumulated in __int128 lanes (sum of 2^31 such
+ *          products can't overflow them) and range of whole tile is checked once after accumulation,
+ *        - otherwise (elements bigger than 2^32) every addition to __int128 accumulator is checked.
+ *
+ *      m1:      pointer to first Matrix structure
+ *      m2:      pointer to second Matrix structure
+ *      output:  pointer to Matrix structure where result should be stored - it can't be the same as m1 or m2
+ *      control: progress and cancellation of operation (can be NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory (when output shares rows with its snapshots), -2 if matrices
+ *               don't have the same size, -3 on long integer overflow, OPERATION_CANCELLED if operation was
+ *               cancelled
+ *
+ */
+static int _multiplySquareMatrixInto( Matrix *m1, Matrix *m2, Matrix *output, OperationControl *control )
+{
+    if( m1->size != m2->size || m1->size != output->size )
+        return -2;
+    if( prepareMatrixForWrite( output ) != 0 )
+        return -1;
+    markMatrixModified( output );                                       // Even partially computed result is a change
+
+    const int size = m1->size;
+    if( hasSmallMatrixKernels( size ) )                                 // Unrolled kernel - too fast to be cancelled
+    {
+        const int errorCode = multiplySmallMatrix( m1, m2, output );
+        if( errorCode == 0 )
+            addOperationProgress( control, size * _tilesPerRow( size ) );
+        return errorCode;
+    }
+
+    unsigned long maxInM2 = 0;
+    for( int row = 0; row < size; row++ )
+    {
+        unsigned long rowMax = _maxAbsInRow( m2->elements[row], size );
+        maxInM2 = rowMax > maxInM2 ? rowMax : maxInM2;
+    }
+
+    for( int row = 0; row < size; row++ )
+    {
+        if( isOperationCancelled( control ) )
+            return OPERATION_CANCELLED;
+
+        const long *m1Row = m1->elements[row];
+        long *outputRow = output->elements[row];
+        unsigned long productBound, sumBound;
+        int productFits = !__builtin_umull_overflow( _maxAbsInRow( m1Row, size ), maxInM2, &productBound );
+        int sumFits = productFits && !__builtin_umull_overflow( productBound, ( unsigned long )size, &sumBound )
+                      && sumBound <= LONG_MAX;
+
+        for( int tileStart = 0; tileStart < size; tileStart += MULTIPLY_TILE_WIDTH )
+        {
+            const int tileWidth = size - tileStart < MULTIPLY_TILE_WIDTH ? size - tileStart : MULTIPLY_TILE_WIDTH;
+
+            if( sumFits )                                               // Fast path - no overflow possible
+            {
+                long tile[MULTIPLY_TILE_WIDTH] = { 0 };
+                for( int r = 0; r < size; r++ )
+                {
+                    const long a = m1Row[r];
+                    const long *m2Row = m2->elements[r] + tileStart;
+                    for( int col = 0; col < tileWidth; col++ )
+                        tile[col] += a * m2Row[col];
+                }
+                memcpy( outputRow + tileStart, tile, sizeof( long ) * tileWidth );
+            } else if( productFits )                                    // Wide lanes, one check per tile
+            {
+                __int128 tile[MULTIPLY_TILE_WIDTH] = { 0 };
+                for( int r = 0; r < size; r++ )
+                {
+                    const __int128 a = m1Row[r];
+                    const long *m2Row = m2->elements[r] + tileStart;
+                    for( int col = 0; col < tileWidth; col++ )
+                        tile[col] += a * m2Row[col];
+                }
+                int outOfRange = 0;
+                for( int col = 0; col < tileWidth; col++ )
+                {
+                    outOfRange |= ( tile[col] > LONG_MAX ) | ( tile[col] < LONG_MIN );
+                    outputRow[tileStart + col] = ( long )tile[col];
+                }
+                if( outOfRange )
+                    return -3;
+            } else                                                      // Huge elements - check every step
+            {
+                for( int col = tileStart; col < tileStart + tileWidth; col++ )
+                {
+                    __int128 sum = 0;
+                    for( int r = 0; r < size; r++ )
+                        // Product of two longs always fits in __int128, only the sum has to be checked
+                        // (see comment block in detSquareMatrix for details about __builtin_*_overflow)
+                        if( __builtin_add_overflow( sum, ( __int128 )m1Row[r] * m2->elements[r][col], &sum ) )
+                            return -3;
+                    if( sum > LONG_MAX || sum < LONG_MIN )
+                        return -3;
+                    outputRow[col] = ( long )sum;
+                }
+            }
+        }
+        addOperationProgress( control, _tilesPerRow( size ) );
+    }
+    return 0;
+}
+
+/*
+ * Function:  multiplySquareMatrixInto
+ * --------------------
+ *      multiplies matrices m1 and m2 and stores result in already created matrix "output"; unlike
+ *      multiplySquareMatrix it doesn't allocate any memory (and isn't measured by profiler), so it can be called
+ *      repeatedly on the same workspace - for matrices up to SMALL_MATRIX_MAX_SIZE it's just the unrolled kernel
+ *      (see _multiplySquareMatrixInto for description of overflow detection)
+ *
+ *      returns: 0 on success, -1 on out of memory (when output shares rows with its snapshots), -2 if matrices
+ *               don't have the same size, -3 on long integer overflow
+ *
+ */
+int multiplySquareMatrixInto( Matrix *m1, Matrix *m2, Matrix *output )
+{
+    return _multiplySquareMatrixInto( m1, m2, output, NULL );
+}
+
+/*
+ * Function <private>:  _multiplySquareMatrixControlled
+ * --------------------
+ *      common part of multiplySquareMatrixControlled and multiplySquareMatrixWithAllocator
+ *
+ *      allocator: allocator of result (NULL - default pool)
+ *
+ */
+static int _multiplySquareMatrixControlled( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output,
+                                            OperationControl *control )
+{
+    int errorCode = 0;
+    ProfileScope scope;
+
+    if( m1->size != m2->size )
+        return -2;
+    if( control != NULL )
+        __atomic_store_n( &control->stepsTotal, m1->size * _tilesPerRow( m1->size ), __ATOMIC_RELAXED );
+    profileBegin( &scope, PROFILE_PRODUCT );
+    if( createSquareMatrixWithAllocator( m1->size, allocator, output ) != 0 )
+    {
+        profileEnd( &scope, 0 );
+        return -1;
+    }
+
+    errorCode = _multiplySquareMatrixInto( m1, m2, *output, control );
+    if( errorCode != 0 )
+    {
+        deleteSquareMatrix( *output );
+        *output = NULL;
+    }
+    profileEnd( &scope, errorCode == 0 ? 2L * m1->size * m1->size * m1->size : 0 );   // Multiply and add per term
+    return errorCode;
+}
+
+/*
+ * Function:  multiplySquareMatrixControlled
+ * --------------------
+ *      the same as multiplySquareMatrix, but progress (in tiles) is reported to control and computation can be
+ *      cancelled - partial result is deleted then
+ *
+ *      control: progress and cancellation of operation (can be NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if input matrices don't have the same size,
+ *               -3 on long integer overflow, OPERATION_CANCELLED if operation was cancelled
+ *
+ */
+int multiplySquareMatrixControlled( Matrix *m1, Matrix *m2, Matrix **output, OperationControl *control )
+{
+    return _multiplySquareMatrixControlled( m1, m2, NULL, output, control );
+}
+
+/*
+ * Function:  multiplySquareMatrixWithAllocator
+ * --------------------
+ *      the same as multiplySquareMatrix, but memory of result is taken from given allocator
+ *
+ *      allocator: pool or arena (NULL - default pool)
+ *
+ */
+int multiplySquareMatrixWithAllocator( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output )
+{
+    return _multiplySquareMatrixControlled( m1, m2, allocator, output, NULL );
+}
+
+/*
+ * Function <private>:  _reduceMod
+ * --------------------
+ *      returns value reduced to range <0, modulus)
+ *
+ */
+static long _reduceMod( long value, long modulus )
+{
+    const long remainder = value % modulus;                             // % of negative number is negative in C
+    return remainder < 0 ? remainder + modulus : remainder;
+}
+
+/*
+ * Function <private>:  _isReducedMatrix
+ * --------------------
+ *      returns non-zero if all elements of matrix are in range <0, modulus)
+ *
+ */
+static int _isReducedMatrix( Matrix *matrix, long modulus )
+{
+    for( int row = 0; row < matrix->size; row++ )
+    {
+        int outOfRange = 0;
+        for( int col = 0; col < matrix->size; col++ )
+            outOfRange |= ( matrix->elements[row][col] < 0 ) | ( matrix->elements[row][col] >= modulus );
+        if( outOfRange )
+            return 0;
+    }
+    return 1;
+}
+
+/*
+ * Function <private>:  _reduceSquareMatrixMod
+ * --------------------
+ *      stores elements of "input" reduced to range <0, modulus) in already created matrix "output" of the same size
+ *      (it can be the same matrix as input)
+ *
+ *      returns: 0 on success, -1 on out of memory (when output shares rows with its snapshots)
+ *
+ */
+static int _reduceSquareMatrixMod( Matrix *input, long modulus, Matrix *output )
+{
+    if( prepareMatrixForWrite( output ) != 0 )
+        return -1;
+    for( int row = 0; row < input->size; row++ )
+        for( int col = 0; col < input->size; col++ )
+            output->elements[row][col] = _reduceMod( input->elements[row][col], modulus );
+    markMatrixModified( output );
+    return 0;
+}
+
+/*
+ * Function <private>:  _multiplyReducedModInto
+ * --------------------
+ *      multiplies matrices m1 and m2 modulo "modulus" and stores result in already created matrix "output" (of the
+ *      same size, prepared for write); elements of m2 must be already in range <0, modulus), elements of m1 are
+ *      reduced when they are taken (once per tile)
+ *
+ *      Tiles of output row are computed in the same way as in _multiplySquareMatrixInto (row of m2 is multiplied by
+ *      element of m1 and added to tile), but lanes aren't reduced after every addition: product of reduced values
+ *      is smaller than (modulus - 1)^2, so lanes are folded only after as many additions as they can take without
+ *      wrapping around. Moduli up to 2^32 use 64-bit lanes, bigger ones 128-bit lanes (at least 3 additions per
+ *      folding).
  *
- *      size:    number of cols|rows (cols == rows for square matrix)
- *      output:  pointer to memory where pointer to structure should be stored
- *               ex. Matrix* matrix; createSquareMatrix( 3, &matrix ); //Now „matrix” contains pointer to created matrix
+ *      control: progress (the same steps as in _multiplySquareMatrixInto) and cancellation (can be NULL)
  *
- *      returns: 0 on success, -1 on out of memory
+ *      returns: 0 on success, OPERATION_CANCELLED if operation was cancelled
  *
  */
-int createSquareMatrix( int size, Matrix **output )
+static int _multiplyReducedModInto( Matrix *m1, Matrix *m2, long modulus, Matrix *output, OperationControl *control )
 {
-    long** elements = calloc( ( size_t )size, sizeof( long* ) );                  // Allocate rows of 2D array
-    if( elements == NULL )                                                        // We are out of memory
-        return -1;
+    const int size = m1->size;
+    const unsigned long mod = ( unsigned long )modulus, maxReduced = mod - 1;
+    const int narrowLanes = mod <= ( 1UL << 32 );
+    long foldEvery = size;                                              // Additions between foldings of lanes
 
-    *output = ( Matrix * ) malloc( sizeof( Matrix ) );                            // Allocate matrix structure
-    if( *output == NULL )                                                         // We are out of memory
+    if( maxReduced != 0 && narrowLanes )
+        foldEvery = ( long )( ( ULONG_MAX - maxReduced ) / ( maxReduced * maxReduced ) );
+    else if( maxReduced != 0 )
     {
-        free( elements );
-        return -1;
+        const unsigned __int128 maxLane = ~( unsigned __int128 )0;
+        const unsigned __int128 additions = ( maxLane - maxReduced ) / ( ( unsigned __int128 )maxReduced * maxReduced );
+        foldEvery = additions > ( unsigned __int128 )size ? size : ( long )additions;
     }
+    foldEvery = foldEvery > size || foldEvery <= 0 ? size : foldEvery;
 
-    for( int column = 0; column < size; column++ )
+    for( int row = 0; row < size; row++ )
     {
-        elements[column] = calloc( ( size_t )size, sizeof(long) );
-        if( elements[column] == NULL )                                               // We are out of memory
+        if( isOperationCancelled( control ) )
+            return OPERATION_CANCELLED;
+
+        const long *m1Row = m1->elements[row];
+        long *outputRow = output->elements[row];
+        for( int tileStart = 0; tileStart < size; tileStart += MULTIPLY_TILE_WIDTH )
         {
-            for( int createdColumns = 0; createdColumns < column; createdColumns++ ) // For each column we already created
-                free( elements[createdColumns] );                                    // free it.
-            free( elements );                                                        // Don't forget about cols...
-            free( *output );                                                         // ...and output!
-            return -1;
+            const int tileWidth = size - tileStart < MULTIPLY_TILE_WIDTH ? size - tileStart : MULTIPLY_TILE_WIDTH;
+
+            if( narrowLanes )
+            {
+                unsigned long tile[MULTIPLY_TILE_WIDTH] = { 0 };
+                for( int chunk = 0; chunk < size; chunk += ( int )foldEvery )
+                {
+                    const int chunkEnd = size - chunk < foldEvery ? size : chunk + ( int )foldEvery;
+                    for( int r = chunk; r < chunkEnd; r++ )
+                    {
+                        const unsigned long a = ( unsigned long )_reduceMod( m1Row[r], modulus );
+                        const long *m2Row = m2->elements[r] + tileStart;
+                        for( int col = 0; col < tileWidth; col++ )
+                            tile[col] += a * ( unsigned long )m2Row[col];
+                    }
+                    for( int col = 0; col < tileWidth; col++ )          // Fold lanes before they could wrap around
+                        tile[col] %= mod;
+                }
+                for( int col = 0; col < tileWidth; col++ )
+                    outputRow[tileStart + col] = ( long )tile[col];
+            } else
+            {
+                unsigned __int128 tile[MULTIPLY_TILE_WIDTH] = { 0 };
+                for( int chunk = 0; chunk < size; chunk += ( int )foldEvery )
+                {
+                    const int chunkEnd = size - chunk < foldEvery ? size : chunk + ( int )foldEvery;
+                    for( int r = chunk; r < chunkEnd; r++ )
+                    {
+                        const unsigned __int128 a = ( unsigned long )_reduceMod( m1Row[r], modulus );
+                        const long *m2Row = m2->elements[r] + tileStart;
+                        for( int col = 0; col < tileWidth; col++ )
+                            tile[col] += a * ( unsigned long )m2Row[col];
+                    }
+                    for( int col = 0; col < tileWidth; col++ )
+                        tile[col] %= mod;
+                }
+                for( int col = 0; col < tileWidth; col++ )
+                    outputRow[tileStart + col] = ( long )tile[col];
+            }
         }
+        addOperationProgress( control, _tilesPerRow( size ) );
     }
-
-    ( *output )->size = size;
-    ( *output )->elements = elements;
     return 0;
 }
 
 /*
- * Function:  deleteSquareMatrix
+ * Function <private>:  _multiplySquareMatrixModInto
  * --------------------
- *      frees memory occupied by matrix structure and elements array
+ *      multiplies matrices m1 and m2 modulo "modulus" and stores result in already created matrix "output"
+ *      (elements of result are in range <0, modulus) ); input elements may be any long integers - if m2 has
+ *      elements out of range <0, modulus), it is reduced once into temporary copy before multiplication
  *
- *      input:  initiated Matrix structure
+ *      m1:      pointer to first Matrix structure
+ *      m2:      pointer to second Matrix structure
+ *      modulus: positive modulus
+ *      output:  pointer to Matrix structure where result should be stored - it can't be the same as m1 or m2
+ *      control: progress (the same steps as in _multiplySquareMatrixInto) and cancellation (can be NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on invalid
+ *               modulus, OPERATION_CANCELLED if operation was cancelled
  *
  */
-void deleteSquareMatrix( Matrix *matrix )
+static int _multiplySquareMatrixModInto( Matrix *m1, Matrix *m2, long modulus, Matrix *output,
+                                         OperationControl *control )
 {
-    if( matrix == NULL )
-        return;
+    Matrix *reduced = NULL;
+    int errorCode = 0;
 
-    if( matrix->elements != NULL )
+    if( m1->size != m2->size || m1->size != output->size )
+        return -2;
+    if( modulus <= 0 )
+        return -3;
+    if( prepareMatrixForWrite( output ) != 0 )
+        return -1;
+    markMatrixModified( output );
+
+    if( !_isReducedMatrix( m2, modulus ) )
     {
-        for( int row = 0; row < matrix->size; row++ )
-            free( matrix->elements[row] );
+        if( createSquareMatrix( m2->size, &reduced ) != 0 )
+            return -1;
+        _reduceSquareMatrixMod( m2, modulus, reduced );
     }
-    free( matrix->elements );                                   // Free can deal with NULL
-    free( matrix );
+    errorCode = _multiplyReducedModInto( m1, reduced != NULL ? reduced : m2, modulus, output, control );
+    deleteSquareMatrix( reduced );
+    return errorCode;
 }
 
 /*
- * Function:  sumSquareMatrix
+ * Function:  multiplySquareMatrixModInto
  * --------------------
- *      creates matrix and sets its elements to sum of matrices being arguments
+ *      multiplies matrices m1 and m2 modulo "modulus" and stores result in already created matrix "output"
+ *      (elements of result are in range <0, modulus) ); input elements may be any long integers, but if elements
+ *      of m2 are reduced (in range <0, modulus) ), no memory is allocated
  *
- *      m1:      pointer to first Matrix structure
- *      m2:      pointer to second Matrix structure
- *      output:  pointer to memory where pointer to structure should be stored
- *               output->elements will store sum of matrices m1 and m2
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on invalid modulus
+ *
+ */
+int multiplySquareMatrixModInto( Matrix *m1, Matrix *m2, long modulus, Matrix *output )
+{
+    return _multiplySquareMatrixModInto( m1, m2, modulus, output, NULL );
+}
+
+/*
+ * Function <private>:  _powerSquareMatrix
+ * --------------------
+ *      calculates matrix^exponent using binary exponentiation (exponentiation by squaring); the whole computation
+ *      uses only three matrices allocated at the beginning: result, power of base and workspace which is swapped
+ *      (ping-ponged) with one of them after each multiplication, so no memory is allocated per step
  *
- *      returns: 0 on success, -2 if input matrices don't have the same size
+ *      matrix:   pointer to Matrix structure
+ *      exponent: non-negative exponent
+ *      modulus:  0 for exact (overflow-checked) arithmetic, positive value for arithmetic modulo it
+ *      allocator: allocator of result and both workspaces (NULL - default pool)
+ *      output:   pointer to memory where pointer to structure with result should be stored
+ *      control:  progress (tiles of all multiplications) and cancellation of operation (can be NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow, -3 on invalid modulus,
+ *               OPERATION_CANCELLED if operation was cancelled
  *
  */
-int sumSquareMatrix( Matrix *m1, Matrix *m2, Matrix **output )
+static int _powerSquareMatrix( Matrix *matrix, unsigned long exponent, long modulus, MatrixAllocator *allocator,
+                               Matrix **output, OperationControl *control )
 {
-    if( m1-> size != m2->size )                                    // Can only sum matrices of the same size
-        return -2;
+    Matrix *result, *base, *workspace, *swap;
+    int errorCode = 0;
+
+    if( modulus < 0 )
+        return -3;
+    if( control != NULL && exponent != 0 )          // One multiplication per set bit, one squaring per bit but last
+        __atomic_store_n( &control->stepsTotal,
+                          ( long )( __builtin_popcountl( exponent ) + 63 - __builtin_clzl( exponent ) )
+                          * matrix->size * _tilesPerRow( matrix->size ), __ATOMIC_RELAXED );
+
+    if( createSquareMatrixWithAllocator( matrix->size, allocator, &result ) != 0 )
+        return -1;
+    if( createSquareMatrixWithAllocator( matrix->size, allocator, &base ) != 0 )
+    {
+        deleteSquareMatrix( result );
+        return -1;
+    }
+    if( createSquareMatrixWithAllocator( matrix->size, allocator, &workspace ) != 0 )
+    {
+        deleteSquareMatrix( result );
+        deleteSquareMatrix( base );
+        return -1;
+    }
 
-    createSquareMatrix( m1->size, output );
+    setIdentitySquareMatrix( result );
+    if( modulus == 0 )
+        copySquareMatrix( matrix, base );
+    else
+    {
+        _reduceSquareMatrixMod( matrix, modulus, base );                   // Operands of all products are reduced
+        if( modulus == 1 )                                                  // Identity is zero matrix modulo 1 - and so is base
+            copySquareMatrix( base, result );
+    }
 
-    for( int row = 0; row < m1->size; row++ )
-        for( int col = 0; col < m1->size; col++ )
-        ( *output )->elements[row][col] = m1->elements[row][col] + m2->elements[row][col];
+    while( exponent != 0 && errorCode == 0 )
+    {
+        if( exponent & 1 )                                                  // Current bit is set - multiply result by base
+        {
+            errorCode = modulus == 0 ? _multiplySquareMatrixInto( result, base, workspace, control )
+                                     : _multiplySquareMatrixModInto( result, base, modulus, workspace, control );
+            swap = result, result = workspace, workspace = swap;            // Workspace now holds previous result
+        }
+        exponent >>= 1;
+        if( exponent != 0 && errorCode == 0 )                               // Square base only if it will be used again
+        {
+            errorCode = modulus == 0 ? _multiplySquareMatrixInto( base, base, workspace, control )
+                                     : _multiplySquareMatrixModInto( base, base, modulus, workspace, control );
+            swap = base, base = workspace, workspace = swap;
+        }
+    }
 
+    deleteSquareMatrix( base );
+    deleteSquareMatrix( workspace );
+    if( errorCode != 0 )
+    {
+        deleteSquareMatrix( result );
+        // Out of memory, cancelled or overflow
+        return errorCode == -1 || errorCode == OPERATION_CANCELLED ? errorCode : -2;
+    }
+    *output = result;
     return 0;
 }
 
 /*
- * Function:  subSquareMatrix
+ * Function <private>:  _profiledPowerSquareMatrix
  * --------------------
- *      creates matrix and sets its elements to differential of matrices being arguments
- *      (for details look at comment block above function sumSquareMatrix)
+ *      calls _powerSquareMatrix and records it in profiler (one multiplication per set bit of exponent and one
+ *      squaring per bit but last, 2 * size^3 operations each)
  *
  */
-int subSquareMatrix(Matrix *m1, Matrix *m2, Matrix **output)
+static int _profiledPowerSquareMatrix( Matrix *matrix, unsigned long exponent, long modulus,
+                                       MatrixAllocator *allocator, Matrix **output, OperationControl *control )
 {
-    if( m1-> size != m2->size )                                    // Can only sub. matrices of the same size
-        return -2;
+    const long multiplications = exponent == 0 ? 0 : __builtin_popcountl( exponent ) + 63 - __builtin_clzl( exponent );
+    ProfileScope scope;
 
-    createSquareMatrix( m1->size, output );
+    profileBegin( &scope, PROFILE_POWER );
+    const int errorCode = _powerSquareMatrix( matrix, exponent, modulus, allocator, output, control );
+    profileEnd( &scope, errorCode == 0 ? multiplications * 2L * matrix->size * matrix->size * matrix->size : 0 );
+    return errorCode;
+}
 
-    for( int row = 0; row < m1->size; row++ )
-        for( int col = 0; col < m1->size; col++ )
-            ( *output )->elements[row][col] = m1->elements[row][col] - m2->elements[row][col];
+/*
+ * Function:  powerSquareMatrix
+ * --------------------
+ *      creates matrix and sets its elements to matrix^exponent; matrix^0 is identity matrix
+ *      about 2*log2(exponent) multiplications are done, so exponent = 10^9 costs about 60 multiplications
+ *
+ *      matrix:   pointer to Matrix structure
+ *      exponent: non-negative exponent
+ *      output:   pointer to memory where pointer to structure with result should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow
+ *
+ */
+int powerSquareMatrix( Matrix *matrix, unsigned long exponent, Matrix **output )
+{
+    return _profiledPowerSquareMatrix( matrix, exponent, 0, NULL, output, NULL );
+}
 
-    return 0;
+/*
+ * Function:  powerSquareMatrixMod
+ * --------------------
+ *      creates matrix and sets its elements to matrix^exponent modulo "modulus"
+ *      (for details look at comment block above function powerSquareMatrix)
+ *
+ *      returns: 0 on success, -1 on out of memory, -3 if modulus isn't positive
+ *
+ */
+int powerSquareMatrixMod( Matrix *matrix, unsigned long exponent, long modulus, Matrix **output )
+{
+    if( modulus <= 0 )
+        return -3;
+    return _profiledPowerSquareMatrix( matrix, exponent, modulus, NULL, output, NULL );
 }
 
 /*
- * Function:  multiplySquareMatrix
+ * Function:  powerSquareMatrixControlled
  * --------------------
- *      creates matrix and sets its elements to multiplication of matrices being arguments
+ *      the same as powerSquareMatrix (modulus = 0) or powerSquareMatrixMod (modulus > 0), but progress is reported
+ *      to control and computation can be cancelled - all matrices allocated by it are deleted then
  *
- *      m1:      pointer to first Matrix structure
- *      m2:      pointer to second Matrix structure
- *      output:  pointer to memory where pointer to structure should be stored
- *               output->elements will store multiplication of matrices m1 and m2
+ *      control: progress and cancellation of operation (can be NULL)
  *
- *      returns: 0 on success, -2 if input matrices don't have the same size
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow, -3 if modulus is negative,
+ *               OPERATION_CANCELLED if operation was cancelled
  *
  */
-int multiplySquareMatrix( Matrix *m1, Matrix *m2, Matrix **output )
+int powerSquareMatrixControlled( Matrix *matrix, unsigned long exponent, long modulus, Matrix **output,
+                                 OperationControl *control )
 {
-    if( m1-> size != m2->size )
-        return -2;
+    return _profiledPowerSquareMatrix( matrix, exponent, modulus, NULL, output, control );
+}
+
+/*
+ * Function:  powerSquareMatrixWithAllocator
+ * --------------------
+ *      the same as powerSquareMatrix (modulus = 0) or powerSquareMatrixMod (modulus > 0), but memory of result and
+ *      of both workspaces is taken from given allocator (so with arena whole power takes no memory from heap
+ *      once arena has grown)
+ *
+ *      allocator: pool or arena (NULL - default pool)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow, -3 if modulus is negative
+ *
+ */
+int powerSquareMatrixWithAllocator( Matrix *matrix, unsigned long exponent, long modulus, MatrixAllocator *allocator,
+                                    Matrix **output )
+{
+    return _profiledPowerSquareMatrix( matrix, exponent, modulus, allocator, output, NULL );
+}
+
+/*
+ * Function <private>:  _randomBits
+ * --------------------
+ *      returns 64 pseudo-random bits (SplitMix64 generator); state is seeded with current time on first call and
+ *      advanced atomically, so threads (background jobs, server workers) calling it concurrently get different bits
+ *
+ */
+static unsigned long _randomBits( void )
+{
+    static unsigned long state = 0;
+    if( __atomic_load_n( &state, __ATOMIC_RELAXED ) == 0 )
+    {
+        unsigned long expected = 0;
+        const unsigned long seed = ( ( unsigned long )time( NULL ) ^ ( ( unsigned long )clock() << 32 )
+                                     ^ ( unsigned long )&state ) | 1;
+        __atomic_compare_exchange_n( &state, &expected, seed, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED );
+    }
+
+    unsigned long z = __atomic_add_fetch( &state, 0x9E3779B97F4A7C15UL, __ATOMIC_RELAXED );
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9UL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBUL;
+    return z ^ ( z >> 31 );
+}
+
+/*
+ * Function <private>:  _mulMod
+ * --------------------
+ *      returns a * b modulo "modulus" (a, b < modulus)
+ *
+ */
+static unsigned long _mulMod( unsigned long a, unsigned long b, unsigned long modulus )
+{
+    return ( unsigned long )( ( unsigned __int128 )a * b % modulus );
+}
+
+/*
+ * Function <private>:  _isPrime
+ * --------------------
+ *      checks if odd number greater than 37 is prime with Miller-Rabin test; the first 12 prime bases are enough
+ *      for deterministic answer for all 64-bit numbers
+ *
+ */
+static int _isPrime( unsigned long number )
+{
+    static const unsigned long bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    const int twos = __builtin_ctzl( number - 1 );
+    const unsigned long odd = ( number - 1 ) >> twos;                   // number - 1 = odd * 2^twos
+
+    for( int i = 0; i < ( int )( sizeof( bases ) / sizeof( bases[0] ) ); i++ )
+    {
+        unsigned long power = 1, base = bases[i];
+        for( unsigned long exponent = odd; exponent != 0; exponent >>= 1 )  // power = base^odd
+        {
+            if( exponent & 1 )
+                power = _mulMod( power, base, number );
+            base = _mulMod( base, base, number );
+        }
+        if( power == 1 || power == number - 1 )
+            continue;
+
+        int witness = 1;
+        for( int square = 1; square < twos && witness; square++ )
+        {
+            power = _mulMod( power, power, number );
+            witness = power != number - 1;
+        }
+        if( witness )
+            return 0;
+    }
+    return 1;
+}
 
-    createSquareMatrix( m1->size, output );
+/*
+ * Function <private>:  _randomPrime
+ * --------------------
+ *      returns random prime from range <2^60, 2^61)
+ *
+ */
+static unsigned long _randomPrime( void )
+{
+    unsigned long candidate;
+    do
+        candidate = ( _randomBits() >> 4 ) | ( 1UL << 60 ) | 1;
+    while( !_isPrime( candidate ) );
+    return candidate;
+}
 
-    for( int rowInM1 = 0; rowInM1 < m1->size; rowInM1++ )              // For each row in matrix m1
-        for( int colInM2 = 0; colInM2 < m2->size; colInM2++ )          // For each col in matrix m2
+/*
+ * Function <private>:  _multiplyByVector
+ * --------------------
+ *      computes output = matrix * vector modulo prime (elements of vector are smaller than prime); products are
+ *      accumulated in unsigned __int128 and reduced every 64 terms (a product is below 2^122)
+ *
+ */
+static void _multiplyByVector( Matrix *matrix, const unsigned long *vector, unsigned long prime,
+                               unsigned long *output )
+{
+    for( int row = 0; row < matrix->size; row++ )
+    {
+        const long *elements = matrix->elements[row];
+        unsigned __int128 sum = 0;
+        for( int col = 0; col < matrix->size; col++ )
         {
-            (*output)->elements[rowInM1][colInM2] = 0;                 // Set value in this cell to zero
-            for (int r = 0; r < m2->size; r++)
-                // From Cauchy's definition: multiply r-th value in row of matrix m1 with r-th value in col of m2
-                (*output)->elements[rowInM1][colInM2] += m1->elements[rowInM1][r] * m2->elements[r][colInM2];
+            const long reduced = elements[col] % ( long )prime;        // % of negative number is negative in C
+            sum += ( unsigned __int128 )( unsigned long )( reduced < 0 ? reduced + ( long )prime : reduced )
+                   * vector[col];
+            if( col % 64 == 63 )
+                sum %= prime;
         }
+        output[row] = ( unsigned long )( sum % prime );
+    }
+}
+
+/*
+ * Function:  verifyProductSquareMatrix
+ * --------------------
+ *      checks whether m1 * m2 == product using Freivalds' algorithm: for random vector r m1 * (m2 * r) is compared
+ *      with product * r, which costs O(n^2) instead of O(n^3) needed to recompute the product.
+ *      Every round computes vectors modulo new random prime p from range <2^60, 2^61) with elements of r taken
+ *      from <0, p). Differences of elements of m1 * m2 and product are smaller than 2^158, so at most 2 such
+ *      primes divide any of them, out of more than 2^54 primes in the range - wrong product stays wrong modulo p
+ *      with probability at least 1 - 2^-53. Then m1 * (m2 * r) == product * r modulo p for at most 1/p of vectors
+ *      r, so single round accepts wrong product with probability below VERIFY_ROUND_ERROR = 2^-52 and rounds are
+ *      repeated until VERIFY_ROUND_ERROR^k <= errorBound. Unlike arithmetic modulo 2^64, products which are wrong
+ *      by multiple of 2^64 (e.g. wrapped around by multiplySquareMatrixUnchecked) are detected as well.
+ *
+ *      m1:          pointer to first Matrix structure
+ *      m2:          pointer to second Matrix structure
+ *      product:     pointer to Matrix structure with (supposed) result of m1 * m2
+ *      errorBound:  maximal accepted probability of accepting wrong product, in range (0, 1)
+ *      isCorrect:   pointer to int where 1 should be stored if product is (probably) correct, 0 if it is wrong
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 if matrices don't have the same size, -3 on invalid errorBound
+ *
+ */
+int verifyProductSquareMatrix( Matrix *m1, Matrix *m2, Matrix *product, double errorBound, int *isCorrect )
+{
+    const int size = m1->size;
+    int rounds = 0;
+
+    if( m2->size != size || product->size != size )
+        return -2;
+    if( !( errorBound > 0 && errorBound < 1 ) )                        // Also rejects NaN
+        return -3;
+
+    for( double probability = 1; probability > errorBound; probability *= VERIFY_ROUND_ERROR )
+        rounds++;
+
+    unsigned long *vectors = malloc( sizeof( unsigned long ) * 4 * ( size_t )size );
+    if( vectors == NULL )
+        return -1;
+    unsigned long *random = vectors;                                    // r
+    unsigned long *m2TimesRandom = vectors + size;                      // m2 * r
+    unsigned long *left = vectors + 2 * size;                           // m1 * (m2 * r)
+    unsigned long *right = vectors + 3 * size;                          // product * r
+
+    *isCorrect = 1;
+    for( int round = 0; round < rounds && *isCorrect; round++ )
+    {
+        const unsigned long prime = _randomPrime();
+        for( int i = 0; i < size; i++ )
+            random[i] = _randomBits() % prime;
+
+        _multiplyByVector( m2, random, prime, m2TimesRandom );
+        _multiplyByVector( m1, m2TimesRandom, prime, left );
+        _multiplyByVector( product, random, prime, right );
+
+        if( memcmp( left, right, sizeof( unsigned long ) * size ) != 0 )
+            *isCorrect = 0;                                             // Difference found - product is surely wrong
+    }
+
+    free( vectors );
     return 0;
 }
 
@@ -162,6 +1568,8 @@ int multiplySquareMatrix( Matrix *m1, Matrix *m2, Matrix **output )
  *      omitRow: number of row (counted from 0) which should be omitted
  *      omitCol: number of col (counted from 0) which should be omitted
  *
+ *      output must be matrix created for this purpose - not shared with any snapshot
+ *
  */
 void copyMinorFromMatrix( Matrix *input, Matrix *output, int omitRow, int omitCol )
 {
@@ -185,18 +1593,27 @@ void copyMinorFromMatrix( Matrix *input, Matrix *output, int omitRow, int omitCo
     }
 }
 /*
- * Function:  detSquareMatrix
+ * Function <private>:  _detSquareMatrix
  * --------------------
- *      calculates determinant of matrix using Laplace expansion
+ *      calculates determinant of matrix using Laplace expansion; minors of size up to SMALL_MATRIX_MAX_SIZE are
+ *      computed by kernels of SmallMatrix.c. Cancelling is checked before every minor
  *
- *      matrix:  pointer to Matrix structure
- *      result:  pointer to long integer where determinant should be stored
+ *      matrix:       pointer to Matrix structure
+ *      result:       pointer to long integer where determinant should be stored
+ *      control:      progress and cancellation of operation (can be NULL)
+ *      progressSize: size of minors counted as steps of progress
+ *      arena:        arena from which minors are allocated (each of them is freed with all its minors at once, so
+ *                    after the first minor of every size no memory is allocated from heap)
  *
- *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow, OPERATION_CANCELLED if operation
+ *               was cancelled
  *
  */
-int detSquareMatrix( Matrix *matrix, long *result )
+static int _detSquareMatrix( Matrix *matrix, long *result, OperationControl *control, int progressSize,
+                             MatrixAllocator *arena )
 {
+    if( hasSmallMatrixKernels( matrix->size ) )                        // The same minors, computed by unrolled kernel
+        return detSmallMatrix( matrix, result );
     if( matrix->size == 1 )
     {                                                                  // For matrix having only one element, determinant
         *result = matrix->elements[0][0];                              // is this element.
@@ -209,13 +1626,19 @@ int detSquareMatrix( Matrix *matrix, long *result )
     for( int col = 0; col < matrix->size; col++ )
     {
         Matrix *minor;
-        if( createSquareMatrix( matrix->size - 1, &minor) != 0 )       // Can't create new matrix - out of memory
+        const MatrixArenaMark mark = markMatrixArena( arena );
+        if( isOperationCancelled( control ) )
+            return OPERATION_CANCELLED;
+        if( createSquareMatrixWithAllocator( matrix->size - 1, arena, &minor) != 0 ) // Can't create new matrix - out of memory
             return -1;
         copyMinorFromMatrix( matrix, minor, selectedRow, col );        // Copy minor to newly created matrix
-        if( detSquareMatrix( minor, &partialDeterminant ) != 0)        // Child function returned non-zero code
-            return -1;
-        deleteSquareMatrix(minor);                                     // Free used memory
-
+        int errorCode = _detSquareMatrix( minor, &partialDeterminant, control, progressSize, arena );
+        deleteSquareMatrix(minor);
+        releaseMatrixArena( arena, mark );                             // Free used memory (also of all minors of minor)
+        if( errorCode != 0 )                                           // Child function returned non-zero code
+            return errorCode;
+        if( matrix->size - 1 == progressSize )
+            addOperationProgress( control, 1 );
         if( ( col + selectedRow ) % 2 == 1 )                           // If sum of current coordinates is odd
             partialDeterminant *= -1;                                  // multiply it by -1 (from Laplace expansions formula)
 
@@ -244,4 +1667,187 @@ int detSquareMatrix( Matrix *matrix, long *result )
     }
     *result = sumOfPartialDeterminant;
     return 0;
-}
\ No newline at end of file
+}
+
+/*
+ * Function <private>:  _laplaceOperations
+ * --------------------
+ *      returns number of multiplications and additions done by Laplace expansion of matrix of given size
+ *      (size * (operations of minor + 2)), or LONG_MAX if it doesn't fit in long
+ *
+ */
+static long _laplaceOperations( int size )
+{
+    long operations = 0;
+
+    for( int minorSize = 2; minorSize <= size; minorSize++ )
+        if( __builtin_smull_overflow( operations + 2, minorSize, &operations ) )
+            return LONG_MAX;
+    return operations;
+}
+
+/*
+ * Function:  detSquareMatrix
+ * --------------------
+ *      calculates determinant of matrix using Laplace expansion; matrices up to SMALL_MATRIX_MAX_SIZE go straight
+ *      to unrolled kernel unless profiling is enabled
+ *
+ *      matrix:  pointer to Matrix structure
+ *      result:  pointer to long integer where determinant should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow
+ *
+ */
+int detSquareMatrix( Matrix *matrix, long *result )
+{
+    if( hasSmallMatrixKernels( matrix->size ) && !profilingEnabled() )  // Nothing to measure or report - call kernel
+        return detSmallMatrix( matrix, result );
+    return detSquareMatrixControlled( matrix, result, NULL );
+}
+
+/*
+ * Function:  detSquareMatrixControlled
+ * --------------------
+ *      the same as detSquareMatrix, but progress is reported to control and computation can be cancelled
+ *
+ *      control: progress and cancellation of operation (can be NULL)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow, OPERATION_CANCELLED if operation
+ *               was cancelled
+ *
+ */
+int detSquareMatrixControlled( Matrix *matrix, long *result, OperationControl *control )
+{
+    int progressSize = matrix->size;                                   // Size of minors counted as progress
+    long minors = 1, moreMinors;                                       // Number of such minors
+    MatrixAllocator *arena;                                            // Memory of all minors
+    ProfileScope scope;
+
+    // Every minor of size k has k minors of size k - 1 (stop before number of them overflows)
+    while( progressSize > DETERMINANT_PROGRESS_MINOR && !__builtin_smull_overflow( minors, progressSize, &moreMinors ) )
+    {
+        minors = moreMinors;
+        progressSize--;
+    }
+
+    if( control != NULL )
+        __atomic_store_n( &control->stepsTotal, minors, __ATOMIC_RELAXED );
+    profileBegin( &scope, PROFILE_DETERMINANT );
+    if( hasSmallMatrixKernels( matrix->size ) )                         // No minors are allocated
+    {
+        const int errorCode = detSmallMatrix( matrix, result );
+        addOperationProgress( control, minors );
+        profileEnd( &scope, errorCode == 0 ? _laplaceOperations( matrix->size ) : 0 );
+        return errorCode;
+    }
+    if( createMatrixArena( &arena ) != 0 )
+    {
+        profileEnd( &scope, 0 );
+        return -1;
+    }
+    const int errorCode = _detSquareMatrix( matrix, result, control, progressSize, arena );
+    profileEnd( &scope, errorCode == 0 ? _laplaceOperations( matrix->size ) : 0 );
+    deleteMatrixAllocator( arena );
+    return errorCode;
+}
+
+/*
+ * Function <private>:  _adjugateSquareMatrix
+ * --------------------
+ *      computes adjugate of matrix of size without kernels: every cofactor is determinant of minor (with sign), and
+ *      determinant is expansion along the first row
+ *
+ *      allocator: allocator of minor (NULL - default pool)
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow
+ *
+ */
+static int _adjugateSquareMatrix( Matrix *matrix, MatrixAllocator *allocator, Matrix *output, long *determinant )
+{
+    const int size = matrix->size;
+    Matrix *minor;
+    long sum = 0;
+
+    if( size == 1 )
+    {
+        output->elements[0][0] = 1;
+        *determinant = matrix->elements[0][0];
+        return 0;
+    }
+    if( createSquareMatrixWithAllocator( size - 1, allocator, &minor ) != 0 )
+        return -1;
+
+    for( int row = 0; row < size; row++ )
+        for( int col = 0; col < size; col++ )
+        {
+            long cofactor, term;
+            copyMinorFromMatrix( matrix, minor, row, col );
+            int errorCode = detSquareMatrix( minor, &cofactor );
+            if( errorCode == 0 && ( row + col ) % 2 == 1 && __builtin_ssubl_overflow( 0, cofactor, &cofactor ) )
+                errorCode = -2;
+            if( errorCode == 0 && row == 0 && ( __builtin_smull_overflow( matrix->elements[0][col], cofactor, &term )
+                                                || __builtin_saddl_overflow( sum, term, &sum ) ) )
+                errorCode = -2;
+            if( errorCode != 0 )
+            {
+                deleteSquareMatrix( minor );
+                return errorCode;
+            }
+            output->elements[col][row] = cofactor;                      // Adjugate is transposed matrix of cofactors
+        }
+
+    deleteSquareMatrix( minor );
+    *determinant = sum;
+    return 0;
+}
+
+/*
+ * Function:  inverseSquareMatrix
+ * --------------------
+ *      calculates inverse of matrix exactly, as adjugate divided by determinant: inverse = adjugate / determinant
+ *      (both have integer elements, unlike inverse itself); matrices of sizes up to SMALL_MATRIX_MAX_SIZE are
+ *      handled by kernels of SmallMatrix.c, bigger ones by determinants of all minors
+ *
+ *      matrix:      pointer to Matrix structure
+ *      adjugate:    pointer to memory where pointer to created adjugate should be stored
+ *      determinant: pointer to long integer where determinant should be stored
+ *
+ *      returns: 0 on success, -1 on out of memory, -2 on long integer overflow, -3 if matrix is singular
+ *               (nothing is stored in adjugate on error)
+ *
+ */
+int inverseSquareMatrix( Matrix *matrix, Matrix **adjugate, long *determinant )
+{
+    return inverseSquareMatrixWithAllocator( matrix, NULL, adjugate, determinant );
+}
+
+/*
+ * Function:  inverseSquareMatrixWithAllocator
+ * --------------------
+ *      the same as inverseSquareMatrix, but memory of adjugate (and of minor used for its cofactors) is taken
+ *      from given allocator
+ *
+ *      allocator: pool or arena (NULL - default pool)
+ *
+ */
+int inverseSquareMatrixWithAllocator( Matrix *matrix, MatrixAllocator *allocator, Matrix **adjugate,
+                                      long *determinant )
+{
+    int errorCode;
+
+    if( createSquareMatrixWithAllocator( matrix->size, allocator, adjugate ) != 0 )
+        return -1;
+    if( hasSmallMatrixKernels( matrix->size ) )
+        errorCode = adjugateSmallMatrix( matrix, *adjugate, determinant );
+    else
+        errorCode = _adjugateSquareMatrix( matrix, allocator, *adjugate, determinant );
+    if( errorCode == 0 && *determinant == 0 )
+        errorCode = -3;
+
+    if( errorCode != 0 )
+    {
+        deleteSquareMatrix( *adjugate );
+        *adjugate = NULL;
+    }
+    return errorCode;
+}
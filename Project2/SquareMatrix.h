@@ -8,32 +8,113 @@
 #ifndef PROJEKT2_SQUAREMATRIX_H
 #define PROJEKT2_SQUAREMATRIX_H
 
+#include <stddef.h>
+#include "MatrixPool.h"
+
 /************************************
  * Macros definitions
  ************************************/
 #define MAX_MATRIX_FIELD_VALUE  65536
 #define MIN_MATRIX_FIELD_VALUE  -65536
 #define MAX_NUMBER_OF_ROWS 6
+#define MATRIX_ALIGNMENT 64     // Alignment (in bytes) of every row of matrix
+#define MATRIX_BLOCK_ROWS 64    // Number of rows in block - unit of sharing between snapshots of matrix
+#define MULTIPLY_TILE_WIDTH 64  // Number of output columns computed at once by multiplication kernels
+#define OPERATION_CANCELLED -4  // Error code returned by operations stopped with cancelOperation
+#define DETERMINANT_PROGRESS_MINOR 8 // Size of minors counted as steps of progress of determinant
+#define VERIFY_ROUND_ERROR ( 1.0 / ( double )( 1UL << 52 ) ) // Bound of false positive of one round of verification
 
 /************************************
  * Structure declarations
  ************************************/
+// Memory holding rows of matrices; freed when no block refers to it
+struct MatrixStorage {
+    long refCount;          // Number of blocks using this storage
+    long *data;             // Beginning of memory, aligned to MATRIX_ALIGNMENT bytes
+    void *mapping;          // Beginning of memory mapped file containing data or NULL if data was allocated on heap
+    size_t mappingLength;   // Length of mapped region
+    size_t heapLength;      // Length of data allocated on heap (0 if data is mapped)
+    MatrixAllocator *allocator; // Allocator of this structure...
+    int allocatedData;      // ...and of data if this is non-zero (otherwise data is freed with free or unmapped)
+};
+typedef struct MatrixStorage MatrixStorage;
+
+// MATRIX_BLOCK_ROWS consecutive rows of matrix, shared by all snapshots of matrix which didn't modify them
+struct MatrixBlock {
+    long refCount;          // Number of matrices using this block
+    MatrixStorage *storage; // Memory containing rows of block
+    long *rows;             // First element of first row of block
+    MatrixAllocator *allocator; // Allocator of this structure
+};
+typedef struct MatrixBlock MatrixBlock;
+
 struct Matrix {
     int size;               // Number of rows|cols (rows == cols for square matrix)
-    long **elements;        // Pointer to 2D array of long ints containing elements of matrix
+    long stride;            // Distance (in elements) between beginnings of consecutive rows
+    long **elements;        // Pointer to array of pointers to rows of matrix (rows are parts of blocks)
+    MatrixBlock **blocks;   // Blocks of rows - block i contains rows <i * MATRIX_BLOCK_ROWS, (i + 1) * MATRIX_BLOCK_ROWS)
+    unsigned long version;  // Incremented on every modification of elements (see markMatrixModified)
+    unsigned long hash[2];  // Hashes of elements computed by hashSquareMatrix...
+    unsigned long hashedVersion; // ...when version was equal to this value (0 - hash wasn't computed yet)
+    MatrixAllocator *allocator; // Allocator of structure, arrays of rows and blocks and of elements it allocates
 };
 typedef struct Matrix Matrix;
 
+// Progress and cancellation request of long-running operation, shared by thread computing it and other threads;
+// fields should be accessed only by functions operating on OperationControl
+struct OperationControl {
+    int cancelRequested;    // Set when operation should stop as soon as possible
+    long stepsDone;         // Number of finished steps (tiles of products, minors of determinant)...
+    long stepsTotal;        // ...out of all steps of operation
+};
+typedef struct OperationControl OperationControl;
+
 
 /************************************
  * Function declarations
  ************************************/
 int createSquareMatrix( int size, Matrix **output );
+int createSquareMatrixWithAllocator( int size, MatrixAllocator *allocator, Matrix **output );
+int createSquareMatrixFromStorage( int size, long stride, long *data, void *mapping, size_t mappingLength,
+                                   Matrix **output );
+int snapshotSquareMatrix( Matrix *input, Matrix **output );
+int snapshotSquareMatrixWithAllocator( Matrix *input, MatrixAllocator *allocator, Matrix **output );
+int prepareMatrixForWrite( Matrix *matrix );
+long alignedMatrixStride( int size );
+int setMatrixElement( Matrix *matrix, int row, int col, long value );
+void markMatrixModified( Matrix *matrix );
+void hashSquareMatrix( Matrix *matrix, unsigned long hash[2] );
 void deleteSquareMatrix( Matrix *matrix );
 int sumSquareMatrix( Matrix *m1, Matrix *m2, Matrix **output );
-int subSquareMatrix(Matrix *m1, Matrix *m2, Matrix **output);
+int subSquareMatrix( Matrix *m1, Matrix *m2, Matrix **output );
 int multiplySquareMatrix( Matrix *m1, Matrix *m2, Matrix **output );
+int sumSquareMatrixWithAllocator( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output );
+int subSquareMatrixWithAllocator( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output );
+int multiplySquareMatrixWithAllocator( Matrix *m1, Matrix *m2, MatrixAllocator *allocator, Matrix **output );
+int sumSquareMatrixUnchecked( Matrix *m1, Matrix *m2, Matrix **output );
+int subSquareMatrixUnchecked( Matrix *m1, Matrix *m2, Matrix **output );
+int multiplySquareMatrixUnchecked( Matrix *m1, Matrix *m2, Matrix **output );
+int copySquareMatrix( Matrix *input, Matrix *output );
+int setIdentitySquareMatrix( Matrix *matrix );
+int multiplySquareMatrixInto( Matrix *m1, Matrix *m2, Matrix *output );
+int multiplySquareMatrixModInto( Matrix *m1, Matrix *m2, long modulus, Matrix *output );
+int powerSquareMatrix( Matrix *matrix, unsigned long exponent, Matrix **output );
+int powerSquareMatrixMod( Matrix *matrix, unsigned long exponent, long modulus, Matrix **output );
+int powerSquareMatrixWithAllocator( Matrix *matrix, unsigned long exponent, long modulus, MatrixAllocator *allocator,
+                                    Matrix **output );
+void cancelOperation( OperationControl *control );
+int isOperationCancelled( OperationControl *control );
+void addOperationProgress( OperationControl *control, long steps );
+double operationProgress( OperationControl *control );
+int multiplySquareMatrixControlled( Matrix *m1, Matrix *m2, Matrix **output, OperationControl *control );
+int powerSquareMatrixControlled( Matrix *matrix, unsigned long exponent, long modulus, Matrix **output,
+                                 OperationControl *control );
+int verifyProductSquareMatrix( Matrix *m1, Matrix *m2, Matrix *product, double errorBound, int *isCorrect );
 void copyMinorFromMatrix( Matrix *input, Matrix *output, int omitRow, int omitCol );
 int detSquareMatrix( Matrix *matrix, long *result );
+int detSquareMatrixControlled( Matrix *matrix, long *result, OperationControl *control );
+int inverseSquareMatrix( Matrix *matrix, Matrix **adjugate, long *determinant );
+int inverseSquareMatrixWithAllocator( Matrix *matrix, MatrixAllocator *allocator, Matrix **adjugate,
+                                      long *determinant );
 
 #endif //PROJEKT2_SQUAREMATRIX_H